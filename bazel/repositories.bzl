@@ -806,6 +806,10 @@ def _com_google_absl():
         name = "abseil_strings",
         actual = "@com_google_absl//absl/strings:strings",
     )
+    native.bind(
+        name = "abseil_bits",
+        actual = "@com_google_absl//absl/numeric:bits",
+    )
     native.bind(
         name = "abseil_int128",
         actual = "@com_google_absl//absl/numeric:int128",
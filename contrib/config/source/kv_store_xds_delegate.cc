@@ -21,9 +21,11 @@ namespace {
 using ::Envoy::Config::XdsSourceId;
 using ::envoy::extensions::config::v3alpha::KeyValueStoreXdsDelegateConfig;
 
+// The delimiter between the source key and the resource name in a KeyValueStore key.
+constexpr char DELIMITER[] = "+";
+
 // Constructs the key for the resource, to be used in the KeyValueStore.
 std::string constructKey(const XdsSourceId& source_id, const std::string& resource_name) {
-  static constexpr char DELIMITER[] = "+";
   return absl::StrCat(source_id.toKey(), DELIMITER, resource_name);
 }
 
@@ -77,19 +79,30 @@ std::vector<envoy::service::discovery::v3::Resource> KeyValueStoreXdsDelegate::g
 std::vector<envoy::service::discovery::v3::Resource>
 KeyValueStoreXdsDelegate::getAllResources(const XdsSourceId& source_id) const {
   std::vector<envoy::service::discovery::v3::Resource> resources;
-  // TODO(abeyad): This is slow as we are iterating over all entries in the KV store; the
-  // expectation is we won't be iterating over too many values. But still, try to find a better way.
+  std::vector<std::string> unparseable_keys;
+  // All the keys of the source share this prefix, so it is only built once for the iteration.
+  const std::string key_prefix = absl::StrCat(source_id.toKey(), DELIMITER);
   xds_config_store_->iterate(
-      [&resources, &source_id](const std::string& key, const std::string& value) {
-        if (absl::StartsWith(key, source_id.toKey())) {
+      [&resources, &unparseable_keys, &key_prefix](const std::string& key,
+                                                   const std::string& value) {
+        if (absl::StartsWith(key, key_prefix)) {
           // The source id is a prefix of the key, so it should be included in the list of returned
           // resources.
           envoy::service::discovery::v3::Resource r;
-          r.ParseFromString(value);
-          resources.push_back(std::move(r));
+          if (r.ParseFromString(value)) {
+            resources.push_back(std::move(r));
+          } else {
+            unparseable_keys.push_back(key);
+          }
         }
         return KeyValueStore::Iterate::Continue;
       });
+  // The store can't be modified while iterating over it, so unparseable resources are removed
+  // afterwards.
+  for (const std::string& key : unparseable_keys) {
+    xds_config_store_->remove(key);
+    stats_.parse_failed_.inc();
+  }
   return resources;
 }
 
@@ -111,6 +124,9 @@ void KeyValueStoreXdsDelegate::onConfigUpdated(
       }
       std::string serialized_resource;
       if (r.SerializeToString(&serialized_resource)) {
+        // SotW updates carry every resource of the type, most of which are typically unchanged.
+        // They are still written, as that keeps them recent in stores that evict the oldest
+        // entries, but KeyValueStoreBase doesn't flush for a rewrite of an unchanged value.
         xds_config_store_->addOrUpdate(constructKey(source_id, r.name()),
                                        std::move(serialized_resource), ttl);
       } else {
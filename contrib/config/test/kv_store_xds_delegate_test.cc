@@ -217,6 +217,42 @@ TEST_F(KeyValueStoreXdsDelegateTest, UpdatedSotwResources) {
   EXPECT_EQ(0, store_.counter("xds.kv_store.parse_failed").value());
 }
 
+TEST_F(KeyValueStoreXdsDelegateTest, UnchangedSotwResources) {
+  const std::string authority_1 = "rtds_cluster";
+  auto runtime_resource_1 = parseYamlIntoRuntimeResource(R"EOF(
+    name: some_resource_1
+    layer:
+      foo: bar
+  )EOF");
+  auto runtime_resource_2 = parseYamlIntoRuntimeResource(R"EOF(
+    name: some_resource_2
+    layer:
+      abc: xyz
+  )EOF");
+
+  const XdsConfigSourceId source_id{authority_1, Config::TypeUrl::get().Runtime};
+
+  // Save xDS resources.
+  const auto saved_resources =
+      TestUtility::decodeResources({runtime_resource_1, runtime_resource_2});
+  xds_delegate_->onConfigUpdated(source_id, saved_resources.refvec_);
+
+  // A SotW update that only changes some_resource_2.
+  runtime_resource_2 = parseYamlIntoRuntimeResource(R"EOF(
+    name: some_resource_2
+    layer:
+      abc: klm
+  )EOF");
+  const auto updated_resources =
+      TestUtility::decodeResources({runtime_resource_1, runtime_resource_2});
+  xds_delegate_->onConfigUpdated(source_id, updated_resources.refvec_);
+
+  checkSavedResources<envoy::service::runtime::v3::Runtime>(
+      source_id, /*resource_names=*/{"some_resource_1", "some_resource_2"},
+      updated_resources.refvec_);
+  EXPECT_EQ(1, store_.counter("xds.kv_store.load_success").value());
+}
+
 TEST_F(KeyValueStoreXdsDelegateTest, Wildcard) {
   const std::string authority_1 = "rtds_cluster";
   auto runtime_resource_1 = parseYamlIntoRuntimeResource(R"EOF(
@@ -370,6 +370,24 @@ Api::IoCallUint64Result VclIoHandle::recvmsg(Buffer::RawSlice* slices, const uin
   return vclCallResultToIoCallResult(result);
 }
 
+Api::IoCallUint64Result
+VclIoHandle::sendmmsg(const Buffer::RawSlice* datagrams, uint64_t num_datagrams, int flags,
+                      const Envoy::Network::Address::Instance& peer_address) {
+  // VCL has no sendmmsg semantics- Send the datagrams one at a time.
+  uint64_t num_sent = 0;
+  for (; num_sent < num_datagrams; ++num_sent) {
+    Api::IoCallUint64Result result =
+        sendmsg(&datagrams[num_sent], 1, flags, nullptr, peer_address);
+    if (!result.ok()) {
+      if (num_sent == 0) {
+        return result;
+      }
+      break;
+    }
+  }
+  return {num_sent, Api::IoErrorPtr(nullptr, Envoy::Network::IoSocketError::deleteIoError)};
+}
+
 Api::IoCallUint64Result VclIoHandle::recvmmsg(RawSliceArrays&, uint32_t, RecvMsgOutput&) {
   PANIC("not implemented");
 }
@@ -20,6 +20,19 @@ public:
    * @see sched_getaffinity (man 2 sched_getaffinity)
    */
   virtual SysCallIntResult sched_getaffinity(pid_t pid, size_t cpusetsize, cpu_set_t* mask) PURE;
+
+  /**
+   * @see pipe2 (man 2 pipe2)
+   */
+  virtual SysCallIntResult pipe2(int pipefd[2], int flags) PURE;
+
+  /**
+   * Moves data between two file descriptors, one of which must be a pipe, without copying it
+   * through user space. Offsets are not supported, both file descriptors must be streams.
+   * @see splice (man 2 splice)
+   */
+  virtual SysCallSizeResult splice(os_fd_t fd_in, os_fd_t fd_out, size_t len,
+                                   unsigned int flags) PURE;
 };
 
 using LinuxOsSysCallsPtr = std::unique_ptr<LinuxOsSysCalls>;
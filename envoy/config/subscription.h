@@ -81,6 +81,19 @@ public:
    */
   virtual ProtobufTypes::MessagePtr decodeResource(const ProtobufWkt::Any& resource) PURE;
 
+  /**
+   * Like decodeResource(), but safe to call from threads other than the main thread. Decoders that
+   * can't decode a resource off the main thread, e.g. because its validation would need to warn
+   * about deprecated fields, return nullptr or throw so that the caller falls back to
+   * decodeResource() on the main thread, which reports any error.
+   * @param resource some opaque resource (ProtobufWkt::Any).
+   * @return ProtobufTypes::MessagePtr decoded protobuf message in the opaque resource, or nullptr
+   *         if the resource must be decoded with decodeResource() instead.
+   */
+  virtual ProtobufTypes::MessagePtr decodeResourceConcurrently(const ProtobufWkt::Any&) {
+    return nullptr;
+  }
+
   /**
    * @param resource some opaque resource (Protobuf::Message).
    * @return std::String the resource name in a Protobuf::Message returned by decodeResource(), e.g.
@@ -194,6 +207,27 @@ public:
       const Protobuf::RepeatedPtrField<std::string>& removed_resources,
       const std::string& system_version_info) PURE;
 
+  /**
+   * Called instead of the delta onConfigUpdate() for each chunk of a delta configuration update
+   * that the server split into several responses (see DeltaDiscoveryResponse.more_chunks).
+   * @param added_resources resources newly added by this chunk.
+   * @param removed_resources names of resources that this chunk instructed to be removed.
+   * @param system_version_info aggregate response data "version", for debugging.
+   * @param more_chunks whether more chunks of the update follow this one.
+   * @throw EnvoyException with reason if the config changes are rejected.
+   */
+  virtual void onChunkedConfigUpdate(
+      const Protobuf::RepeatedPtrField<envoy::service::discovery::v3::Resource>& added_resources,
+      const Protobuf::RepeatedPtrField<std::string>& removed_resources,
+      const std::string& system_version_info, bool more_chunks) PURE;
+
+  /**
+   * Called when a chunked delta configuration update ends before its last chunk, because a chunk
+   * was rejected or the stream was reset. The chunks received before were accepted.
+   * @throw EnvoyException with reason if the config changes are rejected.
+   */
+  virtual void onChunkedConfigUpdateInterrupted() PURE;
+
   /**
    * Called when either the Subscription is unable to fetch a config update or when onConfigUpdate
    * invokes an exception.
@@ -148,6 +148,15 @@ public:
    */
   virtual Event::TimerPtr createScaledTimer(Event::ScaledTimerMinimum minimum, TimerCb cb) PURE;
 
+  /**
+   * Allocates a coarse timer. @see Timer for docs on how to use the timer. A coarse timer never
+   * fires early, but may fire up to a few milliseconds later than requested. In exchange enabling
+   * and disabling it is cheaper than for a timer from createTimer(), which makes it suitable for
+   * timeouts that are reset frequently, such as idle timeouts.
+   * @param cb supplies the callback to invoke when the timer fires.
+   */
+  virtual Event::TimerPtr createCoarseTimer(TimerCb cb) PURE;
+
   /**
    * Allocates a schedulable callback. @see SchedulableCallback for docs on how to use the wrapped
    * callback.
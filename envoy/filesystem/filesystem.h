@@ -12,6 +12,7 @@
 
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
+#include "absl/types/span.h"
 
 namespace Envoy {
 namespace Filesystem {
@@ -76,6 +77,15 @@ public:
    */
   virtual Api::IoCallSizeResult write(absl::string_view buffer) PURE;
 
+  /**
+   * Write several buffers to the file with a single call where the platform supports it. The file
+   * must be explicitly opened before writing. As with write(), only part of the buffers may be
+   * written.
+   *
+   * @return ssize_t number of bytes written, or -1 for failure
+   */
+  virtual Api::IoCallSizeResult writev(absl::Span<const absl::string_view> buffers) PURE;
+
   /**
    * Get additional details about the file. May or may not require a file system operation.
    *
@@ -63,6 +63,23 @@ public:
   virtual void onBelowWriteBufferLowWatermark() PURE;
 };
 
+/**
+ * Callbacks for data that a connection forwards to a peer connection without buffering it, see
+ * Connection::startSplice().
+ */
+class SpliceCallbacks {
+public:
+  virtual ~SpliceCallbacks() = default;
+
+  /**
+   * Called on the dispatcher thread after data has been read from the source connection and handed
+   * to the peer connection.
+   * @param bytes supplies the number of bytes that were forwarded, possibly zero.
+   * @param end_stream supplies whether the source connection has been half closed by the remote.
+   */
+  virtual void onSplicedData(uint64_t bytes, bool end_stream) PURE;
+};
+
 /**
  * Type of connection close to perform.
  */
@@ -346,6 +363,25 @@ public:
    */
   virtual bool startSecureTransport() PURE;
 
+  /**
+   * Instructs the connection to forward all data subsequently read from its socket directly to
+   * the socket of the peer connection, bypassing the read filters and both connection buffers.
+   * On Linux this is done with splice(2) through a kernel pipe, so payload is never copied to user
+   * space. Write buffer watermarks and half close are preserved: the connection stops reading
+   * while the peer has data pending, and a remote half close is propagated to the peer once the
+   * forwarded data has been flushed.
+   * Note: the fast path is only available when both connections are plaintext TCP connections of
+   * the same dispatcher with empty buffers, and half close enabled on the peer. Since no filter
+   * sees the forwarded data, this connection must have no read filter other than the one starting
+   * the splice, and the peer no write filters.
+   * @param peer supplies the connection to forward data to.
+   * @param callbacks supplies the callbacks notified when data has been forwarded. They must
+   *        outlive the connection, or the splice must be stopped by closing either connection.
+   * @return boolean telling if the connection started forwarding data to the peer. If false, data
+   *         keeps being delivered to the read filters.
+   */
+  virtual bool startSplice(Connection& peer, SpliceCallbacks& callbacks) PURE;
+
   /**
    *  @return absl::optional<std::chrono::milliseconds> An optional of the most recent round-trip
    *  time of the connection. If the platform does not support this, then an empty optional is
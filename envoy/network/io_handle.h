@@ -120,6 +120,21 @@ public:
                                           int flags, const Address::Ip* self_ip,
                                           const Address::Instance& peer_address) PURE;
 
+  /**
+   * Send several datagrams to the same address, with a single system call if the platform
+   * supports sendmmsg().
+   * @param datagrams points to the datagrams to be sent, one slice per datagram.
+   * @param num_datagrams indicates number of datagrams |datagrams| contains.
+   * @param flags flags to pass to the underlying send function (see man 2 sendmmsg).
+   * @param peer_address is the destination address.
+   * @return a Api::IoCallUint64Result with err_ = an Api::IoError instance if the first datagram
+   * couldn't be sent, or err_ = nullptr and rc_ = the number of datagrams sent, which may be less
+   * than |num_datagrams|.
+   */
+  virtual Api::IoCallUint64Result sendmmsg(const Buffer::RawSlice* datagrams,
+                                           uint64_t num_datagrams, int flags,
+                                           const Address::Instance& peer_address) PURE;
+
   struct RecvMsgPerPacketInfo {
     // The destination address from transport header.
     Address::InstanceConstSharedPtr local_address_;
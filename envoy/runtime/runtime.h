@@ -17,6 +17,7 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/node_hash_map.h"
+#include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
 
 namespace Envoy {
@@ -27,6 +28,48 @@ class ClusterManager;
 
 namespace Runtime {
 
+/**
+ * A runtime key interned when the configuration using it is loaded, see Runtime::internKey().
+ * Snapshots resolve the entries of the interned keys when they are created, so that looking up a
+ * value by its interned key is an indexed load rather than a hash map lookup of the key. The key
+ * stays interned as long as a copy of the InternedKey exists.
+ */
+class InternedKey {
+public:
+  // The interned key, shared by the copies of the InternedKey. Releasing the last reference
+  // releases the key.
+  struct Data {
+    const std::string name_;
+    const uint32_t index_;
+    // Tells apart the keys that successively used the same index.
+    const uint64_t id_;
+  };
+
+  explicit InternedKey(std::shared_ptr<const Data> data)
+      : data_(std::move(data)), index_(data_->index_), id_(data_->id_) {}
+
+  /**
+   * @return const std::string& the runtime key.
+   */
+  const std::string& name() const { return data_->name_; }
+
+  /**
+   * @return uint32_t the index of the key among the interned keys of the process. Indexes of
+   *         released keys are reused.
+   */
+  uint32_t index() const { return index_; }
+
+  /**
+   * @return uint64_t an identifier of the key that is never reused.
+   */
+  uint64_t id() const { return id_; }
+
+private:
+  std::shared_ptr<const Data> data_;
+  uint32_t index_;
+  uint64_t id_;
+};
+
 /**
  * A snapshot of runtime data.
  */
@@ -201,6 +244,36 @@ public:
    */
   virtual bool getBoolean(absl::string_view key, bool default_value) const PURE;
 
+  /**
+   * Variants of the lookups above by interned key. Implementations that don't resolve interned keys
+   * look up their names.
+   */
+  virtual bool featureEnabled(const InternedKey& key, uint64_t default_value) const {
+    return featureEnabled(key.name(), default_value);
+  }
+  virtual bool featureEnabled(const InternedKey& key, uint64_t default_value,
+                              uint64_t random_value) const {
+    return featureEnabled(key.name(), default_value, random_value);
+  }
+  virtual bool featureEnabled(const InternedKey& key,
+                              const envoy::type::v3::FractionalPercent& default_value) const {
+    return featureEnabled(key.name(), default_value);
+  }
+  virtual bool featureEnabled(const InternedKey& key,
+                              const envoy::type::v3::FractionalPercent& default_value,
+                              uint64_t random_value) const {
+    return featureEnabled(key.name(), default_value, random_value);
+  }
+  virtual uint64_t getInteger(const InternedKey& key, uint64_t default_value) const {
+    return getInteger(key.name(), default_value);
+  }
+  virtual double getDouble(const InternedKey& key, double default_value) const {
+    return getDouble(key.name(), default_value);
+  }
+  virtual bool getBoolean(const InternedKey& key, bool default_value) const {
+    return getBoolean(key.name(), default_value);
+  }
+
   /**
    * Fetch the OverrideLayers that provide values in this snapshot. Layers are ordered from bottom
    * to top; for instance, the second layer's entries override the first layer's entries, and so on.
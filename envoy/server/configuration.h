@@ -85,6 +85,13 @@ public:
    */
   virtual bool flushOnAdmin() const PURE;
 
+  /**
+   * @return the interval between flushes of all metrics when sinks that support it are otherwise
+   *         only flushed the metrics that changed since the previous flush, or absl::nullopt if
+   *         all metrics are flushed to every sink.
+   */
+  virtual absl::optional<std::chrono::milliseconds> fullFlushInterval() const PURE;
+
   /**
    * @return true if deferred creation of stats is enabled.
    */
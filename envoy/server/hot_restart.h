@@ -9,6 +9,8 @@
 #include "envoy/stats/store.h"
 #include "envoy/thread/thread.h"
 
+#include "absl/container/flat_hash_map.h"
+
 namespace Envoy {
 namespace Server {
 
@@ -31,6 +33,11 @@ public:
     bool enable_reuse_port_default_;
   };
 
+  // Opaque state handed from the parent to the child process, grouped into named sections of
+  // key/value entries. Each section is owned by the component that exported it.
+  using StateSection = absl::flat_hash_map<std::string, std::string>;
+  using State = absl::flat_hash_map<std::string, StateSection>;
+
   virtual ~HotRestart() = default;
 
   /**
@@ -79,6 +86,14 @@ public:
    */
   virtual ServerStatsFromParent mergeParentStatsIfAny(Stats::StoreRoot& stats_store) PURE;
 
+  /**
+   * Retrieve the state exported by the components of our parent process, e.g. the contents of
+   * the DNS caches, so that the new process does not have to start from cold.
+   * @return the parent's state, or an empty state if there is not currently a parent or if the
+   *         parent does not support state transfer.
+   */
+  virtual State getParentState() PURE;
+
   /**
    * Shutdown the half of our hot restarter that acts as a parent.
    */
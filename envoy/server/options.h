@@ -271,6 +271,17 @@ public:
    * responsibility of the caller to handle the duplicates.
    */
   virtual const Stats::TagVector& statsTags() const PURE;
+
+  /**
+   * @return bool indicating whether counters and gauges should be stored in fixed-size slab
+   * records with their names inline, rather than as individual heap objects.
+   */
+  virtual bool statsCompactStorageEnabled() const PURE;
+
+  /**
+   * @return bool indicating whether the per-worker stat caches in each scope have been disabled.
+   */
+  virtual bool statsScopeTlsCachesDisabled() const PURE;
 };
 
 } // namespace Server
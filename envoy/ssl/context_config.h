@@ -117,6 +117,12 @@ public:
    * @return the access log manager object reference
    */
   virtual AccessLog::AccessLogManager& accessLogManager() const PURE;
+
+  /**
+   * @return true if record encryption and decryption should be offloaded to the kernel once the
+   * handshake completes, where supported.
+   */
+  virtual bool kernelTlsOffload() const PURE;
 };
 
 class ClientContextConfig : public virtual ContextConfig {
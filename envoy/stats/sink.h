@@ -98,6 +98,13 @@ public:
    * @param value the value of the sample.
    */
   virtual void onHistogramComplete(const Histogram& histogram, uint64_t value) PURE;
+
+  /**
+   * @return true if, when the server is configured to do so, the sink can be flushed a snapshot
+   *         holding only the metrics that changed since the previous flush. Such a sink is still
+   *         periodically flushed all metrics.
+   */
+  virtual bool supportsChangedMetricsOnly() const { return false; }
 };
 
 using SinkPtr = std::unique_ptr<Sink>;
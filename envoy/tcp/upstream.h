@@ -1,6 +1,7 @@
 #pragma once
 
 #include "envoy/buffer/buffer.h"
+#include "envoy/common/optref.h"
 #include "envoy/extensions/filters/network/tcp_proxy/v3/tcp_proxy.pb.h"
 #include "envoy/http/header_evaluator.h"
 #include "envoy/stream_info/stream_info.h"
@@ -151,6 +152,12 @@ public:
    * @return the const SSL connection data of upstream.
    */
   virtual Ssl::ConnectionInfoConstSharedPtr getUpstreamConnectionSslInfo() PURE;
+
+  /**
+   * @return the upstream network connection, if the upstream proxies data over a dedicated
+   *         connection rather than over a stream of a multiplexed protocol.
+   */
+  virtual OptRef<Network::Connection> upstreamConnection() PURE;
 };
 
 using GenericConnPoolPtr = std::unique_ptr<GenericConnPool>;
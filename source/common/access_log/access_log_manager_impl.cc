@@ -1,5 +1,6 @@
 #include "source/common/access_log/access_log_manager_impl.h"
 
+#include <algorithm>
 #include <string>
 
 #include "envoy/common/exception.h"
@@ -7,8 +8,10 @@
 #include "source/common/common/assert.h"
 #include "source/common/common/fmt.h"
 #include "source/common/common/lock_guard.h"
+#include "source/common/runtime/runtime_features.h"
 
 #include "absl/container/fixed_array.h"
+#include "absl/types/span.h"
 
 namespace Envoy {
 namespace AccessLog {
@@ -34,23 +37,102 @@ AccessLogManagerImpl::createAccessLog(const Filesystem::FilePathAndType& file_in
   if (access_logs_.count(file_name)) {
     return access_logs_[file_name];
   }
-  access_logs_[file_name] =
-      std::make_shared<AccessLogFileImpl>(std::move(file), dispatcher_, lock_, file_stats_,
-                                          file_flush_interval_msec_, api_.threadFactory());
+  access_logs_[file_name] = std::make_shared<AccessLogFileImpl>(
+      std::move(file), dispatcher_, lock_, file_stats_, file_flush_interval_msec_,
+      api_.threadFactory(), flush_thread_);
   return access_logs_[file_name];
 }
 
+AccessLogFlushThread::~AccessLogFlushThread() {
+  {
+    Thread::LockGuard lock(lock_);
+    exit_ = true;
+    work_event_.notifyOne();
+  }
+
+  if (thread_ != nullptr) {
+    thread_->join();
+  }
+}
+
+void AccessLogFlushThread::ensureStarted(Thread::ThreadFactory& thread_factory) {
+  Thread::LockGuard lock(lock_);
+  if (thread_ == nullptr) {
+    thread_ = thread_factory.createThread([this]() -> void { threadFunc(); },
+                                          Thread::Options{"AccessLogFlush"});
+  }
+}
+
+void AccessLogFlushThread::schedule(AccessLogFileImpl& file) {
+  if (file.flush_scheduled_.exchange(true)) {
+    return;
+  }
+  Thread::LockGuard lock(lock_);
+  pending_.push_back(&file);
+  work_event_.notifyOne();
+}
+
+void AccessLogFlushThread::unregister(AccessLogFileImpl& file) {
+  Thread::LockGuard lock(lock_);
+  pending_.erase(std::remove(pending_.begin(), pending_.end(), &file), pending_.end());
+  while (active_ == &file) {
+    // CondVar::wait() does not throw, so it's safe to pass the mutex rather than the guard.
+    idle_event_.wait(lock_);
+  }
+}
+
+void AccessLogFlushThread::threadFunc() {
+  while (true) {
+    AccessLogFileImpl* file;
+
+    {
+      Thread::LockGuard lock(lock_);
+      while (pending_.empty() && !exit_) {
+        // CondVar::wait() does not throw, so it's safe to pass the mutex rather than the guard.
+        work_event_.wait(lock_);
+      }
+
+      if (exit_) {
+        return;
+      }
+
+      file = pending_.front();
+      pending_.pop_front();
+      active_ = file;
+    }
+
+    // The file can't be destroyed while it is active_, see unregister().
+    file->flushFromSharedThread();
+
+    {
+      Thread::LockGuard lock(lock_);
+      active_ = nullptr;
+      idle_event_.notifyAll();
+    }
+  }
+}
+
 AccessLogFileImpl::AccessLogFileImpl(Filesystem::FilePtr&& file, Event::Dispatcher& dispatcher,
                                      Thread::BasicLockable& lock, AccessLogFileStats& stats,
                                      std::chrono::milliseconds flush_interval_msec,
-                                     Thread::ThreadFactory& thread_factory)
+                                     Thread::ThreadFactory& thread_factory,
+                                     AccessLogFlushThread& shared_flush_thread)
     : file_(std::move(file)), file_lock_(lock),
+      write_shards_(
+          Runtime::runtimeFeatureEnabled("envoy.reloadable_features.sharded_access_log_writes")
+              ? std::make_unique<WriteShards>()
+              : nullptr),
       flush_timer_(dispatcher.createTimer([this]() -> void {
         stats_.flushed_by_timer_.inc();
-        flush_event_.notifyOne();
+        if (write_shards_ != nullptr) {
+          shared_flush_thread_.schedule(*this);
+        } else {
+          flush_event_.notifyOne();
+        }
         flush_timer_->enableTimer(flush_interval_msec_);
       })),
-      thread_factory_(thread_factory), flush_interval_msec_(flush_interval_msec), stats_(stats) {
+      thread_factory_(thread_factory), shared_flush_thread_(shared_flush_thread),
+      flush_interval_msec_(flush_interval_msec), stats_(stats) {
   flush_timer_->enableTimer(flush_interval_msec_);
   auto open_result = open();
   if (!open_result.return_value_) {
@@ -73,12 +155,21 @@ Api::IoCallBoolResult AccessLogFileImpl::open() {
 }
 
 void AccessLogFileImpl::reopen() {
-  Thread::LockGuard lock(write_lock_);
-  reopen_file_ = true;
-  flush_event_.notifyOne();
+  {
+    Thread::LockGuard lock(write_lock_);
+    reopen_file_ = true;
+    flush_event_.notifyOne();
+  }
+  if (write_shards_ != nullptr) {
+    shared_flush_thread_.schedule(*this);
+  }
 }
 
 AccessLogFileImpl::~AccessLogFileImpl() {
+  if (write_shards_ != nullptr) {
+    shared_flush_thread_.unregister(*this);
+  }
+
   {
     Thread::LockGuard lock(write_lock_);
     flush_thread_exit_ = true;
@@ -91,8 +182,10 @@ AccessLogFileImpl::~AccessLogFileImpl() {
 
   // Flush any remaining data. If file was not opened for some reason, skip flushing part.
   if (file_->isOpen()) {
-    if (flush_buffer_.length() > 0) {
-      doWrite(flush_buffer_);
+    about_to_write_buffer_.move(flush_buffer_);
+    collectWriteShards();
+    if (about_to_write_buffer_.length() > 0) {
+      doWrite(about_to_write_buffer_);
     }
     const Api::IoCallBoolResult result = file_->close();
     ASSERT(result.return_value_, fmt::format("unable to close file '{}': {}", file_->path(),
@@ -101,7 +194,11 @@ AccessLogFileImpl::~AccessLogFileImpl() {
 }
 
 void AccessLogFileImpl::doWrite(Buffer::Instance& buffer) {
-  Buffer::RawSliceVector slices = buffer.getRawSlices();
+  const Buffer::RawSliceVector slices = buffer.getRawSlices();
+  absl::FixedArray<absl::string_view> data(slices.size());
+  std::transform(slices.begin(), slices.end(), data.begin(), [](const Buffer::RawSlice& slice) {
+    return absl::string_view(static_cast<const char*>(slice.mem_), slice.len_);
+  });
 
   // We must do the actual writes to disk under lock, so that we don't intermix chunks from
   // different AccessLogFileImpl pointing to the same underlying file. This can happen either via
@@ -113,14 +210,24 @@ void AccessLogFileImpl::doWrite(Buffer::Instance& buffer) {
   //            process lock or had multiple locks.
   {
     Thread::LockGuard lock(file_lock_);
-    for (const Buffer::RawSlice& slice : slices) {
-      absl::string_view data(static_cast<char*>(slice.mem_), slice.len_);
-      const Api::IoCallSizeResult result = file_->write(data);
-      if (result.ok() && result.return_value_ == static_cast<ssize_t>(slice.len_)) {
-        stats_.write_completed_.inc();
-      } else {
+    // All the slices are written with as few writev calls as the file allows, resuming after the
+    // last byte written when a call writes only part of them.
+    absl::Span<absl::string_view> pending(data);
+    while (!pending.empty()) {
+      const Api::IoCallSizeResult result = file_->writev(pending);
+      if (!result.ok() || result.return_value_ <= 0) {
         // Probably disk full.
         stats_.write_failed_.inc();
+        break;
+      }
+      stats_.write_completed_.inc();
+      uint64_t written = result.return_value_;
+      while (!pending.empty() && written >= pending.front().size()) {
+        written -= pending.front().size();
+        pending.remove_prefix(1);
+      }
+      if (!pending.empty()) {
+        pending.front().remove_prefix(written);
       }
     }
   }
@@ -129,6 +236,16 @@ void AccessLogFileImpl::doWrite(Buffer::Instance& buffer) {
   buffer.drain(buffer.length());
 }
 
+void AccessLogFileImpl::collectWriteShards() {
+  if (write_shards_ == nullptr) {
+    return;
+  }
+  for (WriteShard& shard : *write_shards_) {
+    Thread::LockGuard lock(shard.lock_);
+    about_to_write_buffer_.move(shard.buffer_);
+  }
+}
+
 void AccessLogFileImpl::flushThreadFunc() {
 
   // Transfer the action from `reopen_file_` to this variable so that `reopen_file_` is only
@@ -185,6 +302,44 @@ void AccessLogFileImpl::flushThreadFunc() {
   }
 }
 
+void AccessLogFileImpl::flushFromSharedThread() {
+  // Clear this first, so that writes racing with this flush schedule another one.
+  flush_scheduled_ = false;
+
+  std::unique_lock<Thread::BasicLockable> flush_lock;
+  {
+    Thread::LockGuard write_lock(write_lock_);
+    flush_lock = std::unique_lock<Thread::BasicLockable>(flush_lock_);
+    // Note: a failed reopen is not retried until the next flush, so that it isn't retried in a
+    // tight loop.
+    if (reopen_file_) {
+      do_reopen_ = true;
+      reopen_file_ = false;
+    }
+  }
+  // The flush can be triggered by enough buffered data, by the timer or by a reopen. In case it
+  // was the timer, there may be no data.
+  collectWriteShards();
+
+  if (do_reopen_) {
+    if (file_->isOpen()) {
+      const Api::IoCallBoolResult result = file_->close();
+      ASSERT(result.return_value_, fmt::format("unable to close file '{}': {}", file_->path(),
+                                               result.err_->getErrorDetails()));
+    }
+    const Api::IoCallBoolResult open_result = open();
+    if (!open_result.return_value_) {
+      stats_.reopen_failed_.inc();
+    } else {
+      do_reopen_ = false;
+    }
+  }
+  // doWrite no matter file isOpen, if not, we can drain buffer
+  if (about_to_write_buffer_.length() > 0) {
+    doWrite(about_to_write_buffer_);
+  }
+}
+
 void AccessLogFileImpl::flush() {
   std::unique_lock<Thread::BasicLockable> flush_buffer_lock;
 
@@ -198,18 +353,30 @@ void AccessLogFileImpl::flush() {
     // return before the pending data has actually been written to disk.
     flush_buffer_lock = std::unique_lock<Thread::BasicLockable>(flush_lock_);
 
-    if (flush_buffer_.length() == 0) {
-      return;
-    }
-
     about_to_write_buffer_.move(flush_buffer_);
     ASSERT(flush_buffer_.length() == 0);
   }
+  collectWriteShards();
+
+  if (about_to_write_buffer_.length() == 0) {
+    return;
+  }
 
   doWrite(about_to_write_buffer_);
 }
 
+uint32_t AccessLogFileImpl::writeShardIndex() {
+  static std::atomic<uint32_t> next_index{0};
+  static thread_local const uint32_t index = next_index++ % std::tuple_size<WriteShards>::value;
+  return index;
+}
+
 void AccessLogFileImpl::write(absl::string_view data) {
+  if (write_shards_ != nullptr) {
+    writeToShard(data);
+    return;
+  }
+
   Thread::LockGuard lock(write_lock_);
 
   if (flush_thread_ == nullptr) {
@@ -224,6 +391,35 @@ void AccessLogFileImpl::write(absl::string_view data) {
   }
 }
 
+void AccessLogFileImpl::writeToShard(absl::string_view data) {
+  bool schedule_flush = false;
+
+  // The first write to a file starts the shared flush thread if it isn't running yet, and is
+  // flushed right away.
+  if (!first_write_done_.load(std::memory_order_relaxed) && !first_write_done_.exchange(true)) {
+    shared_flush_thread_.ensureStarted(thread_factory_);
+    schedule_flush = true;
+  }
+
+  {
+    WriteShard& shard = (*write_shards_)[writeShardIndex()];
+    Thread::LockGuard lock(shard.lock_);
+    if (shard.buffer_.length() + data.size() > MAX_WRITE_SHARD_SIZE) {
+      stats_.write_dropped_.inc();
+      return;
+    }
+
+    stats_.write_buffered_.inc();
+    stats_.write_total_buffered_.add(data.length());
+    shard.buffer_.add(data.data(), data.size());
+    schedule_flush |= shard.buffer_.length() > MIN_FLUSH_SIZE;
+  }
+
+  if (schedule_flush) {
+    shared_flush_thread_.schedule(*this);
+  }
+}
+
 void AccessLogFileImpl::createFlushStructures() {
   flush_thread_ = thread_factory_.createThread([this]() -> void { flushThreadFunc(); },
                                                Thread::Options{"AccessLogFlush"});
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <deque>
+#include <memory>
 #include <string>
 
 #include "envoy/access_log/access_log.h"
@@ -13,6 +17,7 @@
 #include "source/common/common/logger.h"
 #include "source/common/common/thread.h"
 
+#include "absl/base/optimization.h"
 #include "absl/container/node_hash_map.h"
 
 namespace Envoy {
@@ -22,6 +27,7 @@ namespace Envoy {
   COUNTER(reopen_failed)                                                                           \
   COUNTER(write_buffered)                                                                          \
   COUNTER(write_completed)                                                                         \
+  COUNTER(write_dropped)                                                                           \
   COUNTER(write_failed)                                                                            \
   GAUGE(write_total_buffered, Accumulate)
 
@@ -31,6 +37,47 @@ struct AccessLogFileStats {
 
 namespace AccessLog {
 
+class AccessLogFileImpl;
+
+/**
+ * A single thread that drains the write shards of all the files of an AccessLogManagerImpl with
+ * envoy.reloadable_features.sharded_access_log_writes, so that the number of flush threads doesn't
+ * grow with the number of access log files. Disk writes are serialized by the cross process file
+ * lock anyway. Files schedule themselves when enough data is buffered, when their flush timer fires
+ * or when they need to be reopened.
+ */
+class AccessLogFlushThread {
+public:
+  ~AccessLogFlushThread();
+
+  /**
+   * Start the thread if it isn't running yet. This is deferred until a file is first written to.
+   */
+  void ensureStarted(Thread::ThreadFactory& thread_factory);
+
+  /**
+   * Queue a file to be flushed. A file that is already queued is not queued a second time.
+   */
+  void schedule(AccessLogFileImpl& file);
+
+  /**
+   * Remove a file from the queue, waiting for any in progress flush of the file to complete. After
+   * this returns, the thread no longer accesses the file.
+   */
+  void unregister(AccessLogFileImpl& file);
+
+private:
+  void threadFunc();
+
+  Thread::MutexBasicLockable lock_;
+  Thread::CondVar work_event_; // Signalled when a file is queued or the thread needs to exit.
+  Thread::CondVar idle_event_; // Signalled when the thread is done flushing a file.
+  Thread::ThreadPtr thread_;
+  std::deque<AccessLogFileImpl*> pending_ ABSL_GUARDED_BY(lock_);
+  AccessLogFileImpl* active_ ABSL_GUARDED_BY(lock_){};
+  bool exit_ ABSL_GUARDED_BY(lock_){false};
+};
+
 class AccessLogManagerImpl : public AccessLogManager, Logger::Loggable<Logger::Id::main> {
 public:
   AccessLogManagerImpl(std::chrono::milliseconds file_flush_interval_msec, Api::Api& api,
@@ -52,6 +99,8 @@ private:
   Event::Dispatcher& dispatcher_;
   Thread::BasicLockable& lock_;
   AccessLogFileStats file_stats_;
+  // Must outlive the files, which unregister from it on destruction.
+  AccessLogFlushThread flush_thread_;
   absl::node_hash_map<std::string, AccessLogFileSharedPtr> access_logs_;
 };
 
@@ -61,13 +110,21 @@ private:
  * This implementation uses a flush thread per file, with the idea there aren't that many
  * files. If this turns out to be a good implementation we can potentially have a single flush
  * thread that flushes all files, but we will start with this.
+ *
+ * With envoy.reloadable_features.sharded_access_log_writes, writers append to one of several
+ * buffers, picked by the calling thread, so that workers logging to the same file don't contend on
+ * a single lock, and the buffers are drained by the AccessLogFlushThread shared by all the files of
+ * the manager rather than by a thread per file. Entries written by one thread are written out in
+ * order, but entries written by different threads within a flush interval may be reordered, and
+ * entries are dropped rather than buffered without bound when the flush thread falls behind.
  */
 class AccessLogFileImpl : public AccessLogFile {
 public:
   AccessLogFileImpl(Filesystem::FilePtr&& file, Event::Dispatcher& dispatcher,
                     Thread::BasicLockable& lock, AccessLogFileStats& stats,
                     std::chrono::milliseconds flush_interval_msec,
-                    Thread::ThreadFactory& thread_factory);
+                    Thread::ThreadFactory& thread_factory,
+                    AccessLogFlushThread& shared_flush_thread);
   ~AccessLogFileImpl() override;
 
   // AccessLog::AccessLogFile
@@ -82,23 +139,43 @@ public:
   void flush() override;
 
 private:
+  friend class AccessLogFlushThread;
+
+  // A buffer filled by the threads that map to it. Cache line aligned so that writers on different
+  // threads don't share the line holding the lock.
+  struct ABSL_CACHELINE_ALIGNED WriteShard {
+    Thread::MutexBasicLockable lock_;
+    Buffer::OwnedImpl buffer_ ABSL_GUARDED_BY(lock_);
+  };
+  using WriteShards = std::array<WriteShard, 64>;
+
   void doWrite(Buffer::Instance& buffer);
   void flushThreadFunc();
   Api::IoCallBoolResult open();
   void createFlushStructures();
+  void writeToShard(absl::string_view data);
+  void collectWriteShards();
+  // Flushes the write shards and reopens the file if requested, on the shared flush thread.
+  void flushFromSharedThread();
 
   // return default flags set which used by open
   static Filesystem::FlagSet defaultFlags();
+  // return the index of the write shard used by the calling thread
+  static uint32_t writeShardIndex();
 
   // Minimum size before the flush thread will be told to flush.
   static const uint64_t MIN_FLUSH_SIZE = 1024 * 64;
+  // Maximum size of a write shard. Writes are dropped rather than block the calling thread when
+  // the flush thread can't keep up, for example because the disk is stalled.
+  static const uint64_t MAX_WRITE_SHARD_SIZE = 1024 * 1024 * 16;
 
   Filesystem::FilePtr file_;
 
   // These locks are always acquired in the following order if multiple locks are held:
   //    1) write_lock_
   //    2) flush_lock_
-  //    3) file_lock_
+  //    3) WriteShard::lock_
+  //    4) file_lock_
   Thread::BasicLockable& file_lock_;      // This lock is used only by the flush thread when writing
                                           // to disk. This is used to make sure that file blocks do
                                           // not get interleaved by multiple processes writing to
@@ -116,20 +193,29 @@ private:
   Thread::CondVar flush_event_;
   bool flush_thread_exit_ ABSL_GUARDED_BY(write_lock_){false};
   bool reopen_file_ ABSL_GUARDED_BY(write_lock_){false};
+  bool do_reopen_ ABSL_GUARDED_BY(flush_lock_){false}; // Set until a reopen requested with
+                                                       // write shards succeeds.
   Buffer::OwnedImpl
       flush_buffer_ ABSL_GUARDED_BY(write_lock_); // This buffer is used by multiple threads. It
                                                   // gets filled and then flushed either when max
                                                   // size is reached or when a timer fires.
+  // Used instead of flush_buffer_ with envoy.reloadable_features.sharded_access_log_writes, null
+  // otherwise. Threads are assigned shards round robin, so they don't share a shard unless there
+  // are more threads than shards writing access logs.
+  std::unique_ptr<WriteShards> write_shards_;
+  std::atomic<bool> first_write_done_{false};
+  std::atomic<bool> flush_scheduled_{false}; // Set while queued on shared_flush_thread_.
   // TODO(jmarantz): this should be ABSL_GUARDED_BY(flush_lock_) but the analysis cannot poke
   // through the std::make_unique assignment. I do not believe it's possible to annotate this
   // properly now due to limitations in the clang thread annotation analysis.
-  Buffer::OwnedImpl about_to_write_buffer_; // This buffer is used only by the flush thread. Data
-                                            // is moved from flush_buffer_ under lock, and then
-                                            // the lock is released so that flush_buffer_ can
-                                            // continue to fill. This buffer is then used for the
-                                            // final write to disk.
+  Buffer::OwnedImpl about_to_write_buffer_; // This buffer is used only while flushing. Data is
+                                            // moved from flush_buffer_ or the write shards under
+                                            // their locks, and then the locks are released so that
+                                            // they can continue to fill. This buffer is then used
+                                            // for the final write to disk.
   Event::TimerPtr flush_timer_;
   Thread::ThreadFactory& thread_factory_;
+  AccessLogFlushThread& shared_flush_thread_; // Drains the write shards, instead of flush_thread_.
   const std::chrono::milliseconds flush_interval_msec_; // Time interval buffer gets flushed no
                                                         // matter if it reached the MIN_FLUSH_SIZE
                                                         // or not.
@@ -112,9 +112,17 @@ void KeyValueStoreBase::addOrUpdate(absl::string_view key_view, absl::string_vie
   // the linked list.
   ValueWithTtl value_with_ttl(value, absolute_ttl);
   if (!store_.emplace(key, value_with_ttl).second) {
-    store_.erase(key);
+    auto it = store_.find(key);
+    // An entry rewritten without a TTL and with the same value only moves in
+    // the eviction order. It isn't worth flushing on its own: its new position
+    // is persisted by the next flush.
+    const bool unchanged = !ttl && !it->second.ttl_ && it->second.value_ == value;
+    store_.erase(it);
     store_.emplace(key, value_with_ttl);
     ttl_manager_.clear(key);
+    if (unchanged) {
+      return;
+    }
   }
   if (ttl) {
     ttl_manager_.add(std::chrono::milliseconds(ttl.value()), key);
@@ -2,6 +2,7 @@
 
 #include "envoy/config/subscription.h"
 
+#include "source/common/protobuf/message_validator_impl.h"
 #include "source/common/protobuf/utility.h"
 
 namespace Envoy {
@@ -24,6 +25,16 @@ public:
     return typed_message;
   }
 
+  ProtobufTypes::MessagePtr decodeResourceConcurrently(const ProtobufWkt::Any& resource) override {
+    auto typed_message = std::make_unique<Current>();
+    if (!resource.type_url().empty()) {
+      ProtobufMessage::ConcurrentValidationVisitorImpl validation_visitor(
+          validation_visitor_.skipValidation());
+      MessageUtil::anyConvertAndValidate<Current>(resource, *typed_message, validation_visitor);
+    }
+    return typed_message;
+  }
+
   std::string resourceName(const Protobuf::Message& resource) override {
     return MessageUtil::getStringField(resource, name_field_);
   }
@@ -0,0 +1,151 @@
+#include "source/common/config/resource_decode_pool.h"
+
+#include "source/common/common/assert.h"
+#include "source/common/common/thread.h"
+#include "source/common/config/decoded_resource_impl.h"
+
+namespace Envoy {
+namespace Config {
+
+namespace {
+
+// Decodes with OpaqueResourceDecoder::decodeResourceConcurrently(). If the underlying decoder
+// can't decode the resource off the main thread, an empty message is returned and failed() is set
+// so that the resource is decoded again on the calling thread.
+class ConcurrentResourceDecoder : public OpaqueResourceDecoder {
+public:
+  explicit ConcurrentResourceDecoder(OpaqueResourceDecoder& resource_decoder)
+      : resource_decoder_(resource_decoder) {}
+
+  bool failed() const { return failed_; }
+
+  // Config::OpaqueResourceDecoder
+  ProtobufTypes::MessagePtr decodeResource(const ProtobufWkt::Any& resource) override {
+    ProtobufTypes::MessagePtr message = resource_decoder_.decodeResourceConcurrently(resource);
+    if (message == nullptr) {
+      failed_ = true;
+      return std::make_unique<ProtobufWkt::Empty>();
+    }
+    return message;
+  }
+  std::string resourceName(const Protobuf::Message& resource) override {
+    return failed_ ? "" : resource_decoder_.resourceName(resource);
+  }
+
+private:
+  OpaqueResourceDecoder& resource_decoder_;
+  bool failed_{};
+};
+
+} // namespace
+
+ResourceDecodePool::ResourceDecodePool(Thread::ThreadFactory& thread_factory,
+                                       uint32_t num_threads) {
+  for (uint32_t i = 0; i < num_threads; ++i) {
+    threads_.push_back(thread_factory.createThread([this]() { workerLoop(); },
+                                                   Thread::Options{"XdsDecode"}));
+  }
+}
+
+ResourceDecodePool::~ResourceDecodePool() {
+  {
+    absl::MutexLock lock(&mutex_);
+    shutdown_ = true;
+  }
+  for (auto& thread : threads_) {
+    thread->join();
+  }
+}
+
+void ResourceDecodePool::workerLoop() {
+  uint64_t last_job_id = 0;
+  while (true) {
+    const std::function<void(size_t)>* job;
+    size_t count;
+    {
+      absl::MutexLock lock(&mutex_);
+      auto has_work = [this, &last_job_id]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+        return shutdown_ || (job_ != nullptr && job_id_ != last_job_id);
+      };
+      mutex_.Await(absl::Condition(&has_work));
+      if (shutdown_) {
+        return;
+      }
+      last_job_id = job_id_;
+      job = job_;
+      count = job_count_;
+      ++busy_threads_;
+    }
+    decodeClaimed(*job, count);
+    absl::MutexLock lock(&mutex_);
+    --busy_threads_;
+  }
+}
+
+void ResourceDecodePool::decodeClaimed(const std::function<void(size_t)>& job, size_t count) {
+  for (size_t index = next_index_.fetch_add(1); index < count; index = next_index_.fetch_add(1)) {
+    job(index);
+  }
+}
+
+std::vector<DecodedResourcePtr> ResourceDecodePool::decode(OpaqueResourceDecoder& resource_decoder,
+                                                           size_t count,
+                                                           const DecodeFn& decode_fn) {
+  ASSERT_IS_MAIN_OR_TEST_THREAD();
+  std::vector<DecodedResourcePtr> decoded(count);
+#ifndef ENVOY_DISABLE_EXCEPTIONS
+  if (!threads_.empty() && count >= MinResourcesPerDecode) {
+    // Each resource is decoded by whichever thread claims its index first. Failures leave the
+    // resource unset, to be decoded again below.
+    const std::function<void(size_t)> job = [&](size_t index) {
+      TRY_NEEDS_AUDIT {
+        ConcurrentResourceDecoder concurrent_decoder(resource_decoder);
+        DecodedResourcePtr resource = decode_fn(index, concurrent_decoder);
+        if (!concurrent_decoder.failed()) {
+          decoded[index] = std::move(resource);
+        }
+      }
+      END_TRY catch (const std::exception&) {}
+    };
+    {
+      absl::MutexLock lock(&mutex_);
+      next_index_ = 0;
+      job_ = &job;
+      job_count_ = count;
+      ++job_id_;
+    }
+    decodeClaimed(job, count);
+    {
+      // Wait for the pool threads to finish the resources they claimed. Clearing the job under the
+      // same lock keeps threads that wake up late from starting on it.
+      absl::MutexLock lock(&mutex_);
+      auto done = [this]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) { return busy_threads_ == 0; };
+      mutex_.Await(absl::Condition(&done));
+      job_ = nullptr;
+    }
+  }
+#endif
+
+  size_t serial = 0;
+  for (size_t index = 0; index < count; ++index) {
+    if (decoded[index] == nullptr) {
+      decoded[index] = decode_fn(index, resource_decoder);
+      ++serial;
+    }
+  }
+  ENVOY_LOG(debug, "decoded {} xDS resources, {} on the main thread", count, serial);
+  return decoded;
+}
+
+std::vector<DecodedResourcePtr>
+ResourceDecodePool::decode(OpaqueResourceDecoder& resource_decoder,
+                           const Protobuf::RepeatedPtrField<ProtobufWkt::Any>& resources,
+                           const std::string& version) {
+  return decode(resource_decoder, resources.size(),
+                [&resources, &version](size_t index, OpaqueResourceDecoder& decoder) {
+                  return DecodedResourceImpl::fromResource(decoder, resources[index], version);
+                });
+}
+
+} // namespace Config
+} // namespace Envoy
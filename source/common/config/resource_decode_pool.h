@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "envoy/config/subscription.h"
+#include "envoy/thread/thread.h"
+
+#include "source/common/common/logger.h"
+#include "source/common/singleton/threadsafe_singleton.h"
+
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Config {
+
+/**
+ * A pool of threads that decode and validate xDS resources on behalf of the main thread. A call to
+ * decode() hands the resources of one response to the pool threads and the calling thread, and
+ * returns once they are all decoded, in their original order. Resources that can't be decoded off
+ * the main thread (see OpaqueResourceDecoder::decodeResourceConcurrently()), and resources that
+ * fail to decode, are decoded again in order on the calling thread with the regular decoder, so
+ * the first error thrown, and everything logged or counted by validation, is the same as for a
+ * serial decode.
+ */
+class ResourceDecodePool : Logger::Loggable<Logger::Id::config> {
+public:
+  /**
+   * Decodes the resource at an index of a response with the given decoder.
+   */
+  using DecodeFn =
+      std::function<DecodedResourcePtr(size_t index, OpaqueResourceDecoder& resource_decoder)>;
+
+  /**
+   * @param thread_factory used to create the pool threads.
+   * @param num_threads the number of pool threads, in addition to the threads calling decode().
+   */
+  ResourceDecodePool(Thread::ThreadFactory& thread_factory, uint32_t num_threads);
+  ~ResourceDecodePool();
+
+  /**
+   * Decodes count resources with decode_fn, which may be called concurrently from several threads.
+   * @param resource_decoder the decoder of the resources.
+   * @param count the number of resources.
+   * @param decode_fn decodes a resource.
+   * @return the decoded resources, in index order.
+   * @throw EnvoyException if a resource fails to decode on the calling thread.
+   */
+  std::vector<DecodedResourcePtr> decode(OpaqueResourceDecoder& resource_decoder, size_t count,
+                                         const DecodeFn& decode_fn);
+
+  /**
+   * Decodes the resources of a state-of-the-world response with DecodedResourceImpl::fromResource().
+   */
+  std::vector<DecodedResourcePtr>
+  decode(OpaqueResourceDecoder& resource_decoder,
+         const Protobuf::RepeatedPtrField<ProtobufWkt::Any>& resources, const std::string& version);
+
+  uint32_t numThreads() const { return threads_.size(); }
+
+  // Responses with fewer resources than this are decoded on the calling thread only, as handing
+  // them to the pool costs more than it saves.
+  static constexpr size_t MinResourcesPerDecode = 16;
+
+private:
+  void workerLoop();
+  void decodeClaimed(const std::function<void(size_t)>& job, size_t count);
+
+  absl::Mutex mutex_;
+  const std::function<void(size_t)>* job_ ABSL_GUARDED_BY(mutex_){};
+  size_t job_count_ ABSL_GUARDED_BY(mutex_){};
+  uint64_t job_id_ ABSL_GUARDED_BY(mutex_){};
+  uint32_t busy_threads_ ABSL_GUARDED_BY(mutex_){};
+  bool shutdown_ ABSL_GUARDED_BY(mutex_){};
+  // Index of the next resource of the current job to decode.
+  std::atomic<size_t> next_index_{};
+  std::vector<Thread::ThreadPtr> threads_;
+};
+
+/**
+ * The process-wide pool, if the server was configured with xds_decode_threads. xDS muxes decode
+ * serially when it is not set.
+ */
+using ResourceDecodePoolSingleton = InjectableSingleton<ResourceDecodePool>;
+
+} // namespace Config
+} // namespace Envoy
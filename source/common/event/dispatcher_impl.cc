@@ -226,6 +226,17 @@ TimerPtr DispatcherImpl::createScaledTimer(ScaledTimerMinimum minimum, TimerCb c
   return scaled_timer_manager_->createTimer(minimum, std::move(cb));
 }
 
+TimerPtr DispatcherImpl::createCoarseTimer(TimerCb cb) {
+  ASSERT(isThreadSafe());
+  if (!Runtime::runtimeFeatureEnabled("envoy.reloadable_features.coarse_timer_wheel")) {
+    return createTimerInternal(cb);
+  }
+  if (timer_wheel_ == nullptr) {
+    timer_wheel_ = std::make_unique<TimerWheelImpl>(*this);
+  }
+  return timer_wheel_->createTimer(std::move(cb));
+}
+
 Event::SchedulableCallbackPtr DispatcherImpl::createSchedulableCallback(std::function<void()> cb) {
   ASSERT(isThreadSafe());
   return base_scheduler_.createSchedulableCallback([this, cb]() {
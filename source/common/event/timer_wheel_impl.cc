@@ -0,0 +1,309 @@
+#include "source/common/event/timer_wheel_impl.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "source/common/common/assert.h"
+#include "source/common/common/scope_tracker.h"
+
+namespace Envoy {
+namespace Event {
+
+/**
+ * Implementation of Timer that is kept in a slot of a TimerWheelImpl while enabled.
+ */
+class TimerWheelImpl::WheelTimerImpl final : public Timer {
+public:
+  WheelTimerImpl(std::shared_ptr<WheelRef> ref, TimerCb callback)
+      : ref_(std::move(ref)), callback_(std::move(callback)) {}
+
+  ~WheelTimerImpl() override { disableTimer(); }
+
+  // Timer
+  void disableTimer() override {
+    // The wheel clears slot_ of the timers it still holds when it is destroyed.
+    if (slot_ != nullptr) {
+      ref_->wheel_->unlink(*this);
+    }
+    scope_ = nullptr;
+  }
+
+  void enableTimer(std::chrono::milliseconds ms, const ScopeTrackedObject* scope) override {
+    disableTimer();
+    if (ref_->wheel_ == nullptr) {
+      return;
+    }
+    scope_ = scope;
+    ref_->wheel_->schedule(*this, ms);
+  }
+
+  void enableHRTimer(std::chrono::microseconds us, const ScopeTrackedObject* scope) override {
+    enableTimer(std::chrono::ceil<std::chrono::milliseconds>(us), scope);
+  }
+
+  bool enabled() override { return slot_ != nullptr; }
+
+  void trigger() {
+    ASSERT(ref_->wheel_->dispatcher_.isThreadSafe());
+    ASSERT(slot_ == nullptr);
+    if (scope_ == nullptr) {
+      callback_();
+    } else {
+      ScopeTrackerScopeState scope(scope_, ref_->wheel_->dispatcher_);
+      scope_ = nullptr;
+      callback_();
+    }
+  }
+
+private:
+  friend class TimerWheelImpl;
+
+  const std::shared_ptr<WheelRef> ref_;
+  const TimerCb callback_;
+  const ScopeTrackedObject* scope_{};
+
+  // Intrusive list membership. slot_ is non-null while the timer is enabled.
+  Slot* slot_{};
+  WheelTimerImpl* prev_{};
+  WheelTimerImpl* next_{};
+  uint64_t expiry_tick_{};
+};
+
+TimerWheelImpl::TimerWheelImpl(Dispatcher& dispatcher, std::chrono::milliseconds resolution)
+    : dispatcher_(dispatcher), resolution_(std::max(resolution, std::chrono::milliseconds(1))),
+      epoch_(dispatcher.approximateMonotonicTime()),
+      timer_(dispatcher.createTimer([this]() { onTimer(); })),
+      ref_(std::make_shared<WheelRef>(WheelRef{this})) {
+  for (uint32_t level = 0; level < Levels; ++level) {
+    for (uint32_t index = 0; index < SlotsPerLevel; ++index) {
+      slots_[level][index].level_ = level;
+      slots_[level][index].index_ = index;
+    }
+  }
+}
+
+TimerWheelImpl::~TimerWheelImpl() {
+  // Timers may be owned by objects that are destroyed after the dispatcher. Disable the timers that
+  // are still enabled and make all timers inert, so that they never touch the destroyed wheel.
+  ref_->wheel_ = nullptr;
+  for (auto& level : slots_) {
+    for (Slot& slot : level) {
+      detach(slot);
+    }
+  }
+  detach(expired_);
+  size_ = 0;
+}
+
+TimerPtr TimerWheelImpl::createTimer(TimerCb callback) {
+  return std::make_unique<WheelTimerImpl>(ref_, std::move(callback));
+}
+
+void TimerWheelImpl::detach(Slot& slot) {
+  WheelTimerImpl* timer = slot.head_;
+  slot.head_ = nullptr;
+  while (timer != nullptr) {
+    WheelTimerImpl* next = timer->next_;
+    timer->slot_ = nullptr;
+    timer->prev_ = nullptr;
+    timer->next_ = nullptr;
+    timer->scope_ = nullptr;
+    timer = next;
+  }
+}
+
+void TimerWheelImpl::schedule(WheelTimerImpl& timer, std::chrono::milliseconds duration) {
+  ASSERT(dispatcher_.isThreadSafe());
+  ASSERT(timer.slot_ == nullptr);
+  const auto deadline = dispatcher_.approximateMonotonicTime() - epoch_ +
+                        std::max(duration, std::chrono::milliseconds::zero());
+  // Round up, so that the timer never fires before the requested duration has elapsed.
+  const uint64_t expiry_tick =
+      static_cast<uint64_t>(std::chrono::ceil<std::chrono::milliseconds>(deadline).count() +
+                            resolution_.count() - 1) /
+      resolution_.count();
+  timer.expiry_tick_ = std::max(expiry_tick, current_tick_ + 1);
+  place(timer);
+  ++size_;
+  // While processing, timer_ is re-armed once all expired callbacks have run.
+  if (!processing_) {
+    maybeArm(wakeTick(timer));
+  }
+}
+
+void TimerWheelImpl::place(WheelTimerImpl& timer) {
+  if (timer.expiry_tick_ <= current_tick_) {
+    link(expired_, timer);
+    return;
+  }
+  const uint64_t delta = timer.expiry_tick_ - current_tick_;
+  uint32_t level = 0;
+  while (level + 1 < Levels && delta >= (uint64_t(1) << (SlotBits * (level + 1)))) {
+    ++level;
+  }
+  link(slots_[level][(timer.expiry_tick_ >> (SlotBits * level)) & SlotMask], timer);
+}
+
+void TimerWheelImpl::link(Slot& slot, WheelTimerImpl& timer) {
+  timer.slot_ = &slot;
+  timer.prev_ = nullptr;
+  timer.next_ = slot.head_;
+  if (slot.head_ != nullptr) {
+    slot.head_->prev_ = &timer;
+  } else if (slot.level_ < Levels) {
+    occupied_[slot.level_][slot.index_ / 64] |= uint64_t(1) << (slot.index_ % 64);
+  }
+  slot.head_ = &timer;
+}
+
+void TimerWheelImpl::unlink(WheelTimerImpl& timer) {
+  Slot& slot = *timer.slot_;
+  if (timer.prev_ != nullptr) {
+    timer.prev_->next_ = timer.next_;
+  } else {
+    slot.head_ = timer.next_;
+  }
+  if (timer.next_ != nullptr) {
+    timer.next_->prev_ = timer.prev_;
+  }
+  timer.slot_ = nullptr;
+  timer.prev_ = nullptr;
+  timer.next_ = nullptr;
+  if (slot.head_ == nullptr && slot.level_ < Levels) {
+    occupied_[slot.level_][slot.index_ / 64] &= ~(uint64_t(1) << (slot.index_ % 64));
+  }
+  --size_;
+}
+
+void TimerWheelImpl::cascade(Slot& slot) {
+  WheelTimerImpl* timer = slot.head_;
+  if (timer == nullptr) {
+    return;
+  }
+  // Detach the whole list first, as timers may be placed back into the same slot.
+  slot.head_ = nullptr;
+  occupied_[slot.level_][slot.index_ / 64] &= ~(uint64_t(1) << (slot.index_ % 64));
+  while (timer != nullptr) {
+    WheelTimerImpl* next = timer->next_;
+    place(*timer);
+    timer = next;
+  }
+}
+
+void TimerWheelImpl::collectExpired(Slot& slot) {
+  WheelTimerImpl* timer = slot.head_;
+  while (timer != nullptr) {
+    WheelTimerImpl* next = timer->next_;
+    if (timer->expiry_tick_ <= current_tick_) {
+      unlink(*timer);
+      link(expired_, *timer);
+      // unlink() accounts the timer as disabled, but it is still pending until its callback runs.
+      ++size_;
+    }
+    timer = next;
+  }
+}
+
+void TimerWheelImpl::advance(uint64_t target_tick) {
+  ASSERT(target_tick > current_tick_);
+  const uint64_t from_tick = current_tick_;
+  current_tick_ = target_tick;
+
+  // Cascade the slots of every boundary crossed in the upper levels, from the top down so that
+  // timers moving down more than one level are examined by every level on the way.
+  for (uint32_t level = Levels - 1; level > 0; --level) {
+    const uint32_t shift = SlotBits * level;
+    const uint64_t first = (from_tick >> shift) + 1;
+    const uint64_t last = target_tick >> shift;
+    if (last < first) {
+      continue;
+    }
+    const uint64_t count = std::min<uint64_t>(last - first + 1, SlotsPerLevel);
+    for (uint64_t granule = first; granule < first + count; ++granule) {
+      cascade(slots_[level][granule & SlotMask]);
+    }
+  }
+
+  const uint64_t count = std::min<uint64_t>(target_tick - from_tick, SlotsPerLevel);
+  for (uint64_t tick = from_tick + 1; tick <= from_tick + count; ++tick) {
+    collectExpired(slots_[0][tick & SlotMask]);
+  }
+}
+
+void TimerWheelImpl::onTimer() {
+  ASSERT(!processing_);
+  armed_tick_ = NotArmed;
+  // Use the precise time rather than the approximate time of the current loop iteration, so that a
+  // timer that fires on time always finds its tick expired.
+  const uint64_t target_tick =
+      (dispatcher_.timeSource().monotonicTime() - epoch_) / resolution_;
+
+  processing_ = true;
+  if (target_tick > current_tick_) {
+    advance(target_tick);
+  }
+  while (expired_.head_ != nullptr) {
+    WheelTimerImpl& timer = *expired_.head_;
+    unlink(timer);
+    // The callback may destroy the timer, or enable or disable any timer of the wheel.
+    timer.trigger();
+  }
+  processing_ = false;
+
+  armNext();
+}
+
+uint64_t TimerWheelImpl::wakeTick(const WheelTimerImpl& timer) const {
+  ASSERT(timer.slot_ != nullptr);
+  if (timer.slot_->level_ >= Levels) {
+    return current_tick_;
+  }
+  // Timers in the upper levels need the wheel to wake up when their slot is cascaded.
+  const uint32_t shift = SlotBits * timer.slot_->level_;
+  return (timer.expiry_tick_ >> shift) << shift;
+}
+
+void TimerWheelImpl::armNext() {
+  if (size_ == 0) {
+    return;
+  }
+  uint64_t wake_tick = NotArmed;
+  for (uint32_t level = 0; level < Levels; ++level) {
+    const uint32_t shift = SlotBits * level;
+    const uint64_t granule = current_tick_ >> shift;
+    const uint32_t start = granule & SlotMask;
+    // Find the distance, in [1, SlotsPerLevel], to the next occupied slot of this level.
+    for (uint32_t distance = 1; distance <= SlotsPerLevel;) {
+      const uint32_t index = (start + distance) & SlotMask;
+      uint64_t word = occupied_[level][index / 64] >> (index % 64);
+      if (word == 0) {
+        // Skip to the beginning of the next word.
+        distance += 64 - (index % 64);
+        continue;
+      }
+      while ((word & 1) == 0) {
+        word >>= 1;
+        ++distance;
+      }
+      if (distance <= SlotsPerLevel) {
+        wake_tick = std::min(wake_tick, (granule + distance) << shift);
+      }
+      break;
+    }
+  }
+  maybeArm(wake_tick);
+}
+
+void TimerWheelImpl::maybeArm(uint64_t tick) {
+  if (tick >= armed_tick_) {
+    return;
+  }
+  armed_tick_ = tick;
+  const MonotonicTime deadline = epoch_ + resolution_ * static_cast<int64_t>(tick);
+  const MonotonicTime now = dispatcher_.approximateMonotonicTime();
+  timer_->enableTimer(deadline > now ? std::chrono::ceil<std::chrono::milliseconds>(deadline - now)
+                                     : std::chrono::milliseconds::zero());
+}
+
+} // namespace Event
+} // namespace Envoy
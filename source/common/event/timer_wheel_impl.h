@@ -0,0 +1,104 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+#include "envoy/common/time.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
+
+namespace Envoy {
+namespace Event {
+
+/**
+ * A hierarchical timing wheel for timers that tolerate firing slightly late, such as idle and
+ * request timeouts. Enabling, re-enabling and disabling a timer are constant time list operations,
+ * and the wheel drives all of its timers from a single real Timer. This avoids the min-heap
+ * operations that a per-object libevent timer incurs each time it is reset, which adds up when a
+ * large number of long-lived streams reset their idle timers on every frame.
+ *
+ * Time is divided into ticks of `resolution`. A timer never fires before its requested duration has
+ * elapsed, and fires at most one tick after it. The wheel has `Levels` levels of `SlotsPerLevel`
+ * slots each; level N holds timers expiring between SlotsPerLevel^N and SlotsPerLevel^(N+1) ticks
+ * in the future, and its slots are cascaded into the lower levels as time advances. Timers further
+ * in the future than the top level can represent stay in the top level and are re-examined once per
+ * revolution of that level.
+ */
+class TimerWheelImpl {
+public:
+  static constexpr std::chrono::milliseconds DefaultResolution{10};
+
+  TimerWheelImpl(Dispatcher& dispatcher,
+                 std::chrono::milliseconds resolution = DefaultResolution);
+  ~TimerWheelImpl();
+
+  /**
+   * Allocates a timer driven by this wheel. Timers that outlive the wheel are disabled when the
+   * wheel is destroyed, and enabling them afterwards has no effect.
+   * @param callback supplies the callback to invoke when the timer fires.
+   */
+  TimerPtr createTimer(TimerCb callback);
+
+  /**
+   * @return the number of currently enabled timers.
+   */
+  uint64_t size() const { return size_; }
+
+private:
+  class WheelTimerImpl;
+
+  static constexpr uint32_t SlotBits = 8;
+  static constexpr uint32_t SlotsPerLevel = 1 << SlotBits;
+  static constexpr uint32_t SlotMask = SlotsPerLevel - 1;
+  static constexpr uint32_t Levels = 3;
+  static constexpr uint64_t NotArmed = UINT64_MAX;
+
+  // Shared between the wheel and its timers, so that timers can tell when the wheel is gone.
+  struct WheelRef {
+    TimerWheelImpl* wheel_;
+  };
+
+  // An intrusive doubly linked list of timers. Slots with level_ == Levels are not part of the
+  // wheel, and hold timers that expired and are waiting for their callbacks to run.
+  struct Slot {
+    WheelTimerImpl* head_{nullptr};
+    uint32_t level_{Levels};
+    uint32_t index_{0};
+  };
+
+  void schedule(WheelTimerImpl& timer, std::chrono::milliseconds duration);
+  void detach(Slot& slot);
+  void place(WheelTimerImpl& timer);
+  void link(Slot& slot, WheelTimerImpl& timer);
+  void unlink(WheelTimerImpl& timer);
+  void cascade(Slot& slot);
+  void collectExpired(Slot& slot);
+  void advance(uint64_t target_tick);
+  void onTimer();
+  void armNext();
+  void maybeArm(uint64_t tick);
+  uint64_t wakeTick(const WheelTimerImpl& timer) const;
+
+  Dispatcher& dispatcher_;
+  const std::chrono::milliseconds resolution_;
+  const MonotonicTime epoch_;
+  const TimerPtr timer_;
+  const std::shared_ptr<WheelRef> ref_;
+  // The last tick that was processed. Timers always expire after this tick.
+  uint64_t current_tick_{0};
+  // The tick that timer_ is armed for, or NotArmed.
+  uint64_t armed_tick_{NotArmed};
+  std::array<std::array<Slot, SlotsPerLevel>, Levels> slots_;
+  // A bit per slot that is set when the slot is not empty, used to find the next slot to process.
+  std::array<std::array<uint64_t, SlotsPerLevel / 64>, Levels> occupied_{};
+  Slot expired_;
+  bool processing_{false};
+  uint64_t size_{0};
+};
+
+using TimerWheelImplPtr = std::unique_ptr<TimerWheelImpl>;
+
+} // namespace Event
+} // namespace Envoy
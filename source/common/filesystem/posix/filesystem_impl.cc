@@ -1,8 +1,11 @@
 #include <dirent.h>
 #include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
+#include <algorithm>
+
 #include <cstdlib>
 #include <filesystem>
 #include <fstream>
@@ -19,6 +22,7 @@
 #include "source/common/filesystem/filesystem_impl.h"
 #include "source/common/runtime/runtime_features.h"
 
+#include "absl/container/fixed_array.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 
@@ -93,6 +97,17 @@ Api::IoCallSizeResult FileImplPosix::write(absl::string_view buffer) {
   return rc != -1 ? resultSuccess(rc) : resultFailure(rc, errno);
 };
 
+Api::IoCallSizeResult FileImplPosix::writev(absl::Span<const absl::string_view> buffers) {
+  // Buffers beyond IOV_MAX are left for the caller to write, as with any partial write.
+  absl::FixedArray<iovec> iov(std::min<size_t>(buffers.size(), IOV_MAX));
+  for (size_t i = 0; i < iov.size(); ++i) {
+    iov[i].iov_base = const_cast<char*>(buffers[i].data());
+    iov[i].iov_len = buffers[i].size();
+  }
+  const ssize_t rc = ::writev(fd_, iov.data(), iov.size());
+  return rc != -1 ? resultSuccess(rc) : resultFailure(rc, errno);
+}
+
 Api::IoCallBoolResult FileImplPosix::close() {
   ASSERT(isOpen());
   int rc = ::close(fd_);
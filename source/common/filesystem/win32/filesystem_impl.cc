@@ -76,6 +76,27 @@ Api::IoCallSizeResult FileImplWin32::write(absl::string_view buffer) {
   return resultSuccess<ssize_t>(bytes_written);
 };
 
+Api::IoCallSizeResult FileImplWin32::writev(absl::Span<const absl::string_view> buffers) {
+  // Windows has no gather write for files opened without FILE_FLAG_NO_BUFFERING, so the buffers
+  // are written one at a time, stopping at the first partial write.
+  ssize_t total_written = 0;
+  for (absl::string_view buffer : buffers) {
+    DWORD bytes_written;
+    BOOL result = WriteFile(fd_, buffer.data(), buffer.length(), &bytes_written, NULL);
+    if (result == 0) {
+      if (total_written > 0) {
+        break;
+      }
+      return resultFailure<ssize_t>(-1, ::GetLastError());
+    }
+    total_written += bytes_written;
+    if (bytes_written < buffer.length()) {
+      break;
+    }
+  }
+  return resultSuccess<ssize_t>(total_written);
+}
+
 Api::IoCallBoolResult FileImplWin32::close() {
   ASSERT(isOpen());
 
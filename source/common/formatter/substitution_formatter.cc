@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <climits>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
@@ -28,6 +29,7 @@
 #include "source/common/runtime/runtime_features.h"
 #include "source/common/stream_info/utility.h"
 
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_replace.h"
 #include "absl/strings/str_split.h"
@@ -44,6 +46,109 @@ namespace {
 
 const ProtobufWkt::Value& unspecifiedValue() { return ValueUtil::nullValue(); }
 
+// Returns the length of the well-formed UTF-8 sequence at the start of str, as defined by
+// Table 3-7 of the Unicode standard, or 0 if it doesn't start with one.
+size_t utf8SequenceLength(absl::string_view str) {
+  const auto* p = reinterpret_cast<const uint8_t*>(str.data());
+  size_t size;
+  uint8_t min_second = 0x80;
+  uint8_t max_second = 0xbf;
+  if (p[0] >= 0xc2 && p[0] <= 0xdf) {
+    size = 2;
+  } else if (p[0] >= 0xe0 && p[0] <= 0xef) {
+    size = 3;
+    if (p[0] == 0xe0) {
+      min_second = 0xa0; // Overlong encodings.
+    } else if (p[0] == 0xed) {
+      max_second = 0x9f; // Surrogates.
+    }
+  } else if (p[0] >= 0xf0 && p[0] <= 0xf4) {
+    size = 4;
+    if (p[0] == 0xf0) {
+      min_second = 0x90; // Overlong encodings.
+    } else if (p[0] == 0xf4) {
+      max_second = 0x8f; // Beyond U+10FFFF.
+    }
+  } else {
+    return 0;
+  }
+  if (str.size() < size || p[1] < min_second || p[1] > max_second) {
+    return 0;
+  }
+  for (size_t i = 2; i < size; ++i) {
+    if (p[i] < 0x80 || p[i] > 0xbf) {
+      return 0;
+    }
+  }
+  return size;
+}
+
+// Appends value to output, escaped for a JSON string literal. Well-formed UTF-8 is passed through
+// unmodified, and each byte that isn't part of it, which header values can contain, is replaced
+// with U+FFFD so that the line is still valid JSON.
+void appendEscapedString(std::string& output, absl::string_view value) {
+  size_t start = 0;
+  size_t i = 0;
+  while (i < value.size()) {
+    const uint8_t character = value[i];
+    if (character >= 0x20 && character < 0x80 && character != '"' && character != '\\') {
+      ++i;
+      continue;
+    }
+    if (character >= 0x80) {
+      const size_t sequence_length = utf8SequenceLength(value.substr(i));
+      if (sequence_length > 0) {
+        i += sequence_length;
+        continue;
+      }
+    }
+    output.append(value.data() + start, i - start);
+    switch (character) {
+    case '"':
+      output.append("\\\"");
+      break;
+    case '\\':
+      output.append("\\\\");
+      break;
+    case '\b':
+      output.append("\\b");
+      break;
+    case '\f':
+      output.append("\\f");
+      break;
+    case '\n':
+      output.append("\\n");
+      break;
+    case '\r':
+      output.append("\\r");
+      break;
+    case '\t':
+      output.append("\\t");
+      break;
+    default:
+      if (character < 0x20) {
+        absl::StrAppendFormat(&output, "\\u%04x", character);
+      } else {
+        output.append("\\ufffd");
+      }
+      break;
+    }
+    start = ++i;
+  }
+  output.append(value.data() + start, value.size() - start);
+}
+
+// Appends a finite double to output the way the protobuf JSON printer does: the
+// shortest of %.15g and %.17g that round-trips.
+void appendDouble(std::string& output, double value) {
+  std::string str = absl::StrFormat("%.15g", value);
+  double parsed;
+  if (!absl::SimpleAtod(str, &parsed) || parsed != value) {
+    str = absl::StrFormat("%.17g", value);
+  }
+  output.append(str);
+}
+
 void truncate(std::string& str, absl::optional<uint32_t> max_length) {
   if (!max_length) {
     return;
@@ -142,24 +247,245 @@ std::string FormatterImpl::format(const Http::RequestHeaderMap& request_headers,
   return log_line;
 }
 
+JsonFormatterImpl::JsonFormatterImpl(const ProtobufWkt::Struct& format_mapping, bool preserve_types,
+                                     bool omit_empty_values)
+    : JsonFormatterImpl(format_mapping, preserve_types, omit_empty_values, {}) {}
+
+JsonFormatterImpl::JsonFormatterImpl(const ProtobufWkt::Struct& format_mapping, bool preserve_types,
+                                     bool omit_empty_values,
+                                     const std::vector<CommandParserPtr>& commands)
+    : omit_empty_values_(omit_empty_values), preserve_types_(preserve_types),
+      empty_value_(omit_empty_values_ ? EMPTY_STRING : DefaultUnspecifiedValueString),
+      root_(compileObject(format_mapping, commands)) {}
+
+JsonFormatterImpl::JsonElement
+JsonFormatterImpl::compileObject(const ProtobufWkt::Struct& struct_format,
+                                 const std::vector<CommandParserPtr>& commands) const {
+  JsonElement element{JsonElement::Type::Object, {}, {}, {}, {}};
+  // Order the fields by key, as the JSON serialization of a Struct does.
+  std::vector<std::pair<absl::string_view, const ProtobufWkt::Value*>> fields;
+  fields.reserve(struct_format.fields().size());
+  for (const auto& pair : struct_format.fields()) {
+    fields.emplace_back(pair.first, &pair.second);
+  }
+  std::sort(fields.begin(), fields.end());
+  for (const auto& [key, value] : fields) {
+    JsonElement child = compileValue(*value, commands);
+    appendString(child.key_, key);
+    child.key_.push_back(':');
+    element.children_.push_back(std::move(child));
+  }
+  return element;
+}
+
+JsonFormatterImpl::JsonElement
+JsonFormatterImpl::compileList(const ProtobufWkt::ListValue& list_format,
+                               const std::vector<CommandParserPtr>& commands) const {
+  JsonElement element{JsonElement::Type::List, {}, {}, {}, {}};
+  for (const auto& value : list_format.values()) {
+    element.children_.push_back(compileValue(value, commands));
+  }
+  return element;
+}
+
+JsonFormatterImpl::JsonElement
+JsonFormatterImpl::compileValue(const ProtobufWkt::Value& value_format,
+                                const std::vector<CommandParserPtr>& commands) const {
+  switch (value_format.kind_case()) {
+  case ProtobufWkt::Value::kStringValue: {
+    const std::string& string_format = value_format.string_value();
+    if (string_format.find('%') == std::string::npos) {
+      // Plain strings are formatted as themselves.
+      JsonElement element{JsonElement::Type::Literal, {}, {}, {}, {}};
+      appendString(element.literal_, string_format);
+      return element;
+    }
+    return {JsonElement::Type::Providers,
+            {},
+            {},
+            SubstitutionFormatParser::parse(string_format, commands),
+            {}};
+  }
+
+  case ProtobufWkt::Value::kNumberValue: {
+    JsonElement element{JsonElement::Type::Literal, {}, {}, {}, {}};
+    if (preserve_types_) {
+      appendValue(element.literal_, value_format);
+    } else {
+      // Consistent with PlainNumberFormatter::format().
+      appendString(element.literal_, absl::StrFormat("%g", value_format.number_value()));
+    }
+    return element;
+  }
+
+  case ProtobufWkt::Value::kStructValue:
+    return compileObject(value_format.struct_value(), commands);
+
+  case ProtobufWkt::Value::kListValue:
+    return compileList(value_format.list_value(), commands);
+
+  default:
+    throw EnvoyException("Only string values, nested structs, list values and number values are "
+                         "supported in structured access log format.");
+  }
+}
+
+void JsonFormatterImpl::appendString(std::string& output, absl::string_view value) {
+  output.push_back('"');
+  appendEscapedString(output, value);
+  output.push_back('"');
+}
+
+void JsonFormatterImpl::appendValue(std::string& output, const ProtobufWkt::Value& value) {
+  switch (value.kind_case()) {
+  case ProtobufWkt::Value::kNumberValue:
+    if (std::isfinite(value.number_value())) {
+      appendDouble(output, value.number_value());
+    } else {
+      // JSON has no representation for NaN and infinity. The protobuf printer
+      // rejects the whole message here; emit null so the line is still logged.
+      output.append("null");
+    }
+    break;
+  case ProtobufWkt::Value::kStringValue:
+    appendString(output, value.string_value());
+    break;
+  case ProtobufWkt::Value::kBoolValue:
+    output.append(value.bool_value() ? "true" : "false");
+    break;
+  case ProtobufWkt::Value::kStructValue: {
+    std::vector<std::pair<absl::string_view, const ProtobufWkt::Value*>> fields;
+    fields.reserve(value.struct_value().fields().size());
+    for (const auto& pair : value.struct_value().fields()) {
+      fields.emplace_back(pair.first, &pair.second);
+    }
+    std::sort(fields.begin(), fields.end());
+    output.push_back('{');
+    for (size_t i = 0; i < fields.size(); ++i) {
+      if (i > 0) {
+        output.push_back(',');
+      }
+      appendString(output, fields[i].first);
+      output.push_back(':');
+      appendValue(output, *fields[i].second);
+    }
+    output.push_back('}');
+    break;
+  }
+  case ProtobufWkt::Value::kListValue: {
+    output.push_back('[');
+    bool first = true;
+    for (const auto& item : value.list_value().values()) {
+      if (!first) {
+        output.push_back(',');
+      }
+      first = false;
+      appendValue(output, item);
+    }
+    output.push_back(']');
+    break;
+  }
+  case ProtobufWkt::Value::kNullValue:
+  case ProtobufWkt::Value::KIND_NOT_SET:
+    output.append("null");
+    break;
+  }
+}
+
+bool JsonFormatterImpl::writeElement(std::string& output, const JsonElement& element,
+                                     const FormatContext& context) const {
+  switch (element.type_) {
+  case JsonElement::Type::Literal:
+    output.append(element.literal_);
+    return true;
+  case JsonElement::Type::Providers:
+    return writeProviders(output, element.providers_, context);
+  case JsonElement::Type::Object:
+    output.push_back('{');
+    if (!writeChildren(output, element, context) && omit_empty_values_) {
+      return false;
+    }
+    output.push_back('}');
+    return true;
+  case JsonElement::Type::List:
+    output.push_back('[');
+    writeChildren(output, element, context);
+    output.push_back(']');
+    return true;
+  }
+  PANIC_DUE_TO_CORRUPT_ENUM;
+}
+
+bool JsonFormatterImpl::writeChildren(std::string& output, const JsonElement& element,
+                                      const FormatContext& context) const {
+  bool written = false;
+  for (const JsonElement& child : element.children_) {
+    const size_t rollback = output.size();
+    if (written) {
+      output.push_back(',');
+    }
+    output.append(child.key_);
+    if (writeElement(output, child, context)) {
+      written = true;
+    } else {
+      output.resize(rollback);
+    }
+  }
+  return written;
+}
+
+bool JsonFormatterImpl::writeProviders(std::string& output,
+                                       const std::vector<FormatterProviderPtr>& providers,
+                                       const FormatContext& context) const {
+  if (providers.size() == 1) {
+    const auto& provider = providers.front();
+    if (preserve_types_) {
+      const ProtobufWkt::Value value = provider->formatValue(
+          context.request_headers_, context.response_headers_, context.response_trailers_,
+          context.stream_info_, context.local_reply_body_, context.access_log_type_);
+      if (omit_empty_values_ && value.kind_case() == ProtobufWkt::Value::kNullValue) {
+        return false;
+      }
+      appendValue(output, value);
+      return true;
+    }
+
+    const auto str = provider->format(context.request_headers_, context.response_headers_,
+                                      context.response_trailers_, context.stream_info_,
+                                      context.local_reply_body_, context.access_log_type_);
+    if (omit_empty_values_ && !str.has_value()) {
+      return false;
+    }
+    appendString(output, str.has_value() ? str.value() : DefaultUnspecifiedValueString);
+    return true;
+  }
+  // Multiple providers forces string output. Each part is escaped on its own, which yields the same
+  // result as escaping their concatenation.
+  output.push_back('"');
+  for (const auto& provider : providers) {
+    const auto bit = provider->format(context.request_headers_, context.response_headers_,
+                                      context.response_trailers_, context.stream_info_,
+                                      context.local_reply_body_, context.access_log_type_);
+    appendEscapedString(output, bit.has_value() ? absl::string_view(bit.value()) : empty_value_);
+  }
+  output.push_back('"');
+  return true;
+}
+
 std::string JsonFormatterImpl::format(const Http::RequestHeaderMap& request_headers,
                                       const Http::ResponseHeaderMap& response_headers,
                                       const Http::ResponseTrailerMap& response_trailers,
                                       const StreamInfo::StreamInfo& stream_info,
                                       absl::string_view local_reply_body,
                                       AccessLog::AccessLogType access_log_type) const {
-  const ProtobufWkt::Struct output_struct =
-      struct_formatter_.format(request_headers, response_headers, response_trailers, stream_info,
-                               local_reply_body, access_log_type);
-
-#ifdef ENVOY_ENABLE_YAML
-  const std::string log_line =
-      MessageUtil::getJsonStringFromMessageOrError(output_struct, false, true);
-#else
-  IS_ENVOY_BUG("Json support compiled out");
-  const std::string log_line = "";
-#endif
-  return absl::StrCat(log_line, "\n");
+  const FormatContext context{request_headers,    response_headers, response_trailers,
+                              stream_info,        local_reply_body, access_log_type};
+  std::string log_line;
+  log_line.reserve(256);
+  log_line.push_back('{');
+  writeChildren(log_line, root_, context);
+  log_line.append("}\n");
+  return log_line;
 }
 
 StructFormatter::StructFormatter(const ProtobufWkt::Struct& format_mapping, bool preserve_types,
@@ -243,14 +243,17 @@ private:
 
 using StructFormatterPtr = std::unique_ptr<StructFormatter>;
 
+/**
+ * A formatter for JSON log formats. The format mapping is compiled once into a tree whose keys are
+ * already quoted and escaped and whose constant values are already serialized, so that each log
+ * line is written directly into the output string, without building an intermediate Struct.
+ */
 class JsonFormatterImpl : public Formatter {
 public:
   JsonFormatterImpl(const ProtobufWkt::Struct& format_mapping, bool preserve_types,
-                    bool omit_empty_values)
-      : struct_formatter_(format_mapping, preserve_types, omit_empty_values) {}
+                    bool omit_empty_values);
   JsonFormatterImpl(const ProtobufWkt::Struct& format_mapping, bool preserve_types,
-                    bool omit_empty_values, const std::vector<CommandParserPtr>& commands)
-      : struct_formatter_(format_mapping, preserve_types, omit_empty_values, commands) {}
+                    bool omit_empty_values, const std::vector<CommandParserPtr>& commands);
 
   // Formatter::format
   std::string format(const Http::RequestHeaderMap& request_headers,
@@ -259,8 +262,59 @@ public:
                      const StreamInfo::StreamInfo& stream_info, absl::string_view local_reply_body,
                      AccessLog::AccessLogType access_log_type) const override;
 
+  /**
+   * Appends a JSON string literal, including the surrounding quotes, to the output.
+   */
+  static void appendString(std::string& output, absl::string_view value);
+
+  /**
+   * Appends the JSON representation of a Value to the output. Struct fields are written in key
+   * order.
+   */
+  static void appendValue(std::string& output, const ProtobufWkt::Value& value);
+
 private:
-  const StructFormatter struct_formatter_;
+  struct JsonElement {
+    enum class Type { Literal, Providers, Object, List };
+
+    Type type_;
+    // The quoted key followed by a colon when the element is a field of an object.
+    std::string key_;
+    // The serialized value of Literal elements.
+    std::string literal_;
+    std::vector<FormatterProviderPtr> providers_;
+    std::vector<JsonElement> children_;
+  };
+
+  struct FormatContext {
+    const Http::RequestHeaderMap& request_headers_;
+    const Http::ResponseHeaderMap& response_headers_;
+    const Http::ResponseTrailerMap& response_trailers_;
+    const StreamInfo::StreamInfo& stream_info_;
+    absl::string_view local_reply_body_;
+    AccessLog::AccessLogType access_log_type_;
+  };
+
+  JsonElement compileObject(const ProtobufWkt::Struct& struct_format,
+                            const std::vector<CommandParserPtr>& commands) const;
+  JsonElement compileList(const ProtobufWkt::ListValue& list_format,
+                          const std::vector<CommandParserPtr>& commands) const;
+  JsonElement compileValue(const ProtobufWkt::Value& value_format,
+                           const std::vector<CommandParserPtr>& commands) const;
+
+  // Each returns false if the element was omitted because it was empty, in which case the output
+  // may have been partially written.
+  bool writeElement(std::string& output, const JsonElement& element,
+                    const FormatContext& context) const;
+  bool writeProviders(std::string& output, const std::vector<FormatterProviderPtr>& providers,
+                      const FormatContext& context) const;
+  bool writeChildren(std::string& output, const JsonElement& element,
+                     const FormatContext& context) const;
+
+  const bool omit_empty_values_;
+  const bool preserve_types_;
+  const std::string empty_value_;
+  JsonElement root_;
 };
 
 /**
@@ -66,6 +66,9 @@ bool requestWasConnect(const RequestHeaderMapSharedPtr& headers, Protocol protoc
   return HeaderUtility::isConnect(*headers) || Utility::isUpgrade(*headers);
 }
 
+const absl::string_view ConnectionManagerImpl::MaxRequestsPerIoCycle =
+    "http.max_requests_per_io_cycle";
+
 ConnectionManagerStats ConnectionManagerImpl::generateStats(const std::string& prefix,
                                                             Stats::Scope& scope) {
   return ConnectionManagerStats(
@@ -111,7 +114,9 @@ ConnectionManagerImpl::ConnectionManagerImpl(ConnectionManagerConfig& config,
                                      /*server_name=*/config_.serverName(),
                                      /*proxy_status_config=*/config_.proxyStatusConfig())),
       refresh_rtt_after_request_(
-          Runtime::runtimeFeatureEnabled("envoy.reloadable_features.refresh_rtt_after_request")) {
+          Runtime::runtimeFeatureEnabled("envoy.reloadable_features.refresh_rtt_after_request")),
+      max_requests_during_dispatch_(
+          runtime_.snapshot().getInteger(ConnectionManagerImpl::MaxRequestsPerIoCycle, UINT32_MAX)) {
   ENVOY_LOG_ONCE_IF(
       trace, accept_new_http_stream_ == nullptr,
       "LoadShedPoint envoy.load_shed_points.http_connection_manager_decode_headers is not "
@@ -170,6 +175,11 @@ void ConnectionManagerImpl::initializeReadFilterCallbacks(Network::ReadFilterCal
       {stats_.named_.downstream_cx_rx_bytes_total_, stats_.named_.downstream_cx_rx_bytes_buffered_,
        stats_.named_.downstream_cx_tx_bytes_total_, stats_.named_.downstream_cx_tx_bytes_buffered_,
        nullptr, &stats_.named_.downstream_cx_delayed_close_timeout_});
+
+  if (max_requests_during_dispatch_ != UINT32_MAX) {
+    deferred_request_processing_callback_ =
+        dispatcher_->createSchedulableCallback([this]() -> void { onDeferredRequestProcessing(); });
+  }
 }
 
 ConnectionManagerImpl::~ConnectionManagerImpl() {
@@ -457,6 +467,8 @@ Network::FilterStatus ConnectionManagerImpl::onData(Buffer::Instance& data, bool
     createCodec(data);
   }
 
+  requests_during_dispatch_count_ = 0;
+
   bool redispatch;
   do {
     redispatch = false;
@@ -821,16 +833,16 @@ ConnectionManagerImpl::ActiveStream::ActiveStream(ConnectionManagerImpl& connect
 
   if (connection_manager_.config_.requestTimeout().count()) {
     std::chrono::milliseconds request_timeout = connection_manager_.config_.requestTimeout();
-    request_timer_ =
-        connection_manager.dispatcher_->createTimer([this]() -> void { onRequestTimeout(); });
+    request_timer_ = connection_manager.dispatcher_->createCoarseTimer(
+        [this]() -> void { onRequestTimeout(); });
     request_timer_->enableTimer(request_timeout, this);
   }
 
   if (connection_manager_.config_.requestHeadersTimeout().count()) {
     std::chrono::milliseconds request_headers_timeout =
         connection_manager_.config_.requestHeadersTimeout();
-    request_header_timer_ =
-        connection_manager.dispatcher_->createTimer([this]() -> void { onRequestHeaderTimeout(); });
+    request_header_timer_ = connection_manager.dispatcher_->createCoarseTimer(
+        [this]() -> void { onRequestHeaderTimeout(); });
     request_header_timer_->enableTimer(request_headers_timeout, this);
   }
 
@@ -1328,7 +1340,12 @@ void ConnectionManagerImpl::ActiveStream::decodeHeaders(RequestHeaderMapSharedPt
     traceRequest();
   }
 
-  filter_manager_.decodeHeaders(*request_headers_, end_stream);
+  if (!connection_manager_.shouldDeferRequestProxyingToNextIoCycle()) {
+    filter_manager_.decodeHeaders(*request_headers_, end_stream);
+  } else {
+    state_.deferred_to_next_io_iteration_ = true;
+    state_.deferred_end_stream_ = end_stream;
+  }
 
   // Reset it here for both global and overridden cases.
   resetIdleTimer();
@@ -1395,8 +1412,15 @@ void ConnectionManagerImpl::ActiveStream::decodeData(Buffer::Instance& data, boo
                                connection_manager_.read_callbacks_->connection().dispatcher());
   maybeEndDecode(end_stream);
   filter_manager_.streamInfo().addBytesReceived(data.length());
-
-  filter_manager_.decodeData(data, end_stream);
+  if (!state_.deferred_to_next_io_iteration_) {
+    filter_manager_.decodeData(data, end_stream);
+  } else {
+    if (!deferred_data_) {
+      deferred_data_ = std::make_unique<Buffer::OwnedImpl>();
+    }
+    deferred_data_->move(data);
+    state_.deferred_end_stream_ = end_stream;
+  }
 }
 
 void ConnectionManagerImpl::ActiveStream::decodeTrailers(RequestTrailerMapPtr&& trailers) {
@@ -1412,11 +1436,20 @@ void ConnectionManagerImpl::ActiveStream::decodeTrailers(RequestTrailerMapPtr&&
     return;
   }
   maybeEndDecode(true);
-  filter_manager_.decodeTrailers(*request_trailers_);
+  if (!state_.deferred_to_next_io_iteration_) {
+    filter_manager_.decodeTrailers(*request_trailers_);
+  }
 }
 
 void ConnectionManagerImpl::ActiveStream::decodeMetadata(MetadataMapPtr&& metadata_map) {
   resetIdleTimer();
+  if (state_.deferred_to_next_io_iteration_) {
+    // Remember how much of the body was received before the metadata, so that they are replayed
+    // in the order they were received.
+    deferred_metadata_.emplace_back(deferred_data_ != nullptr ? deferred_data_->length() : 0,
+                                    std::move(metadata_map));
+    return;
+  }
   // After going through filters, the ownership of metadata_map will be passed to terminal filter.
   // The terminal filter may encode metadata_map to the next hop immediately or store metadata_map
   // and encode later when connection pool is ready.
@@ -2120,5 +2153,81 @@ void ConnectionManagerImpl::ActiveStream::resetStream(Http::StreamResetReason, a
   connection_manager_.doEndStream(*this);
 }
 
+bool ConnectionManagerImpl::ActiveStream::onDeferredRequestProcessing() {
+  if (!state_.deferred_to_next_io_iteration_) {
+    return false;
+  }
+  state_.deferred_to_next_io_iteration_ = false;
+  bool end_stream = state_.deferred_end_stream_ && deferred_data_ == nullptr &&
+                    request_trailers_ == nullptr && deferred_metadata_.empty();
+  filter_manager_.decodeHeaders(*request_headers_, end_stream);
+  if (end_stream) {
+    return true;
+  }
+  // Interleave the metadata with the body as it was received. The filter manager ignores the body,
+  // metadata and trailers if the request already completed.
+  uint64_t data_dispatched = 0;
+  for (auto& [data_received_before, metadata_map] : deferred_metadata_) {
+    if (data_received_before > data_dispatched) {
+      Buffer::OwnedImpl data;
+      data.move(*deferred_data_, data_received_before - data_dispatched);
+      data_dispatched = data_received_before;
+      filter_manager_.decodeData(data, false);
+    }
+    filter_manager_.decodeMetadata(*metadata_map);
+  }
+  deferred_metadata_.clear();
+  end_stream = state_.deferred_end_stream_ && request_trailers_ == nullptr;
+  if (end_stream || (deferred_data_ != nullptr && deferred_data_->length() > 0)) {
+    Buffer::OwnedImpl empty_data;
+    filter_manager_.decodeData(deferred_data_ != nullptr ? *deferred_data_ : empty_data,
+                               end_stream);
+  }
+  if (request_trailers_ != nullptr) {
+    filter_manager_.decodeTrailers(*request_trailers_);
+  }
+  return true;
+}
+
+bool ConnectionManagerImpl::shouldDeferRequestProxyingToNextIoCycle() {
+  // Do not defer this stream if stream deferral is disabled.
+  if (deferred_request_processing_callback_ == nullptr) {
+    return false;
+  }
+  // Defer this stream if there are already deferred streams, so they are not
+  // processed out of order.
+  if (deferred_request_processing_callback_->enabled()) {
+    return true;
+  }
+  ++requests_during_dispatch_count_;
+  bool defer = requests_during_dispatch_count_ > max_requests_during_dispatch_;
+  if (defer) {
+    deferred_request_processing_callback_->scheduleCallbackNextIteration();
+  }
+  return defer;
+}
+
+void ConnectionManagerImpl::onDeferredRequestProcessing() {
+  if (streams_.empty()) {
+    return;
+  }
+  requests_during_dispatch_count_ = 1; // 1 stream is always let through
+  // Streams are inserted at the head of the list. As such process deferred streams at the back of
+  // the list first, to preserve the order in which they were received.
+  auto iter = std::prev(streams_.end());
+  while (true) {
+    const bool at_front = iter == streams_.begin();
+    // Find the next stream before dispatching, as `onDeferredRequestProcessing` may remove the
+    // current stream from the list.
+    const auto next = at_front ? streams_.end() : std::prev(iter);
+    const bool was_deferred = (*iter)->onDeferredRequestProcessing();
+    if (at_front || read_callbacks_->connection().state() != Network::Connection::State::Open ||
+        (was_deferred && shouldDeferRequestProxyingToNextIoCycle())) {
+      break;
+    }
+    iter = next;
+  }
+}
+
 } // namespace Http
 } // namespace Envoy
@@ -79,6 +79,11 @@ public:
                                                               Stats::Scope& scope);
   static const ResponseHeaderMap& continueHeader();
 
+  // Runtime key for the maximum number of requests that a single connection may dispatch to
+  // the filter chains in one I/O cycle. Requests above this limit are deferred to the next
+  // I/O cycle, so that one connection with many concurrent streams cannot starve the worker.
+  static const absl::string_view MaxRequestsPerIoCycle;
+
   // Currently the ConnectionManager creates a codec lazily when either:
   //   a) onConnection for H3.
   //   b) onData for H1 and H2.
@@ -340,7 +345,8 @@ private:
           : codec_saw_local_complete_(false), codec_encode_complete_(false),
             on_reset_stream_called_(false), is_zombie_stream_(false), saw_connection_close_(false),
             successful_upgrade_(false), is_internally_destroyed_(false),
-            is_internally_created_(false), is_tunneling_(false), decorated_propagate_(true) {}
+            is_internally_created_(false), is_tunneling_(false), decorated_propagate_(true),
+            deferred_to_next_io_iteration_(false), deferred_end_stream_(false) {}
 
       // It's possibly for the codec to see the completed response but not fully
       // encode it.
@@ -366,6 +372,12 @@ private:
       bool is_tunneling_ : 1;
 
       bool decorated_propagate_ : 1;
+
+      // Indicates that sending headers to the filter manager is deferred to the
+      // next I/O cycle. If data, metadata or trailers are received when this
+      // flag is set they are deferred too.
+      bool deferred_to_next_io_iteration_ : 1;
+      bool deferred_end_stream_ : 1;
     };
 
     bool canDestroyStream() const {
@@ -415,6 +427,11 @@ private:
 
     std::weak_ptr<bool> stillAlive() { return std::weak_ptr<bool>(still_alive_); }
 
+    // Dispatch deferred headers, body, metadata and trailers to the filter manager.
+    // Return true if this stream was deferred and dispatched pending headers, body, metadata and
+    // trailers (if present). Return false if this stream was not deferred.
+    bool onDeferredRequestProcessing();
+
     ConnectionManagerImpl& connection_manager_;
     OptRef<const TracingConnectionManagerConfig> connection_manager_tracing_config_;
     // TODO(snowp): It might make sense to move this to the FilterManager to avoid storing it in
@@ -454,6 +471,11 @@ private:
 
     std::chrono::milliseconds idle_timeout_ms_{};
     State state_;
+    // Request body received while the stream was deferred to the next I/O cycle.
+    Buffer::InstancePtr deferred_data_;
+    // Request metadata received while the stream was deferred to the next I/O cycle, along with the
+    // length of the body received before it.
+    std::vector<std::pair<uint64_t, MetadataMapPtr>> deferred_metadata_;
 
     const bool expand_agnostic_stream_lifetime_;
 
@@ -570,6 +592,11 @@ private:
   void doConnectionClose(absl::optional<Network::ConnectionCloseType> close_type,
                          absl::optional<StreamInfo::ResponseFlag> response_flag,
                          absl::string_view details);
+  // Returns true if the number of requests processed in the current I/O cycle exceeded the
+  // limit configured via the `http.max_requests_per_io_cycle` runtime key. In this case the
+  // deferred request processing callback is scheduled to run in the next I/O cycle.
+  bool shouldDeferRequestProxyingToNextIoCycle();
+  void onDeferredRequestProcessing();
 
   enum class DrainState { NotDraining, Draining, Closing };
 
@@ -613,6 +640,12 @@ private:
   const std::string proxy_name_; // for Proxy-Status.
 
   const bool refresh_rtt_after_request_{};
+  // Number of requests dispatched to the filter chains in the current I/O cycle.
+  uint32_t requests_during_dispatch_count_{0};
+  const uint32_t max_requests_during_dispatch_{UINT32_MAX};
+  // Runs the requests that were deferred because the per I/O cycle budget was exhausted. Only
+  // created when the budget is configured.
+  Event::SchedulableCallbackPtr deferred_request_processing_callback_;
 };
 
 } // namespace Http
@@ -12,6 +12,7 @@
 #include "envoy/network/filter.h"
 #include "envoy/network/socket.h"
 
+#include "source/common/api/os_sys_calls_impl.h"
 #include "source/common/common/assert.h"
 #include "source/common/common/dump_state_utils.h"
 #include "source/common/common/empty_string.h"
@@ -22,6 +23,12 @@
 #include "source/common/network/raw_buffer_socket.h"
 #include "source/common/network/utility.h"
 
+#ifdef __linux__
+#include <fcntl.h>
+
+#include "source/common/api/os_sys_calls_impl_linux.h"
+#endif
+
 namespace Envoy {
 namespace Network {
 namespace {
@@ -29,6 +36,10 @@ namespace {
 constexpr absl::string_view kTransportSocketConnectTimeoutTerminationDetails =
     "transport socket timeout was reached";
 
+// The maximum number of bytes moved into a splice pipe by a single splice() call. The pipe itself
+// holds 64KiB by default, so this is only an upper bound.
+constexpr size_t kSpliceChunkSize = 64 * 1024;
+
 std::ostream& operator<<(std::ostream& os, Connection::State connection_state) {
   switch (connection_state) {
   case Connection::State::Open:
@@ -134,7 +145,7 @@ void ConnectionImpl::close(ConnectionCloseType type) {
     return;
   }
 
-  uint64_t data_to_write = write_buffer_->length();
+  uint64_t data_to_write = write_buffer_->length() + splicePipeLength();
   ENVOY_CONN_LOG_EVENT(debug, "connection_closing", "closing data_to_write={} type={}", *this,
                        data_to_write, enumToInt(type));
   const bool delayed_close_timeout_set = delayed_close_timeout_.count() > 0;
@@ -262,6 +273,7 @@ void ConnectionImpl::closeSocket(ConnectionEvent close_type) {
 
   connection_stats_.reset();
 
+  stopSplice();
   socket_->close();
 
   // Call the base class directly as close() is called in the destructor.
@@ -638,6 +650,11 @@ void ConnectionImpl::onReadReady() {
   // reading from the transport if the read buffer is above high watermark at the start of the
   // method.
   transport_wants_read_ = false;
+  if (splice_out_ != nullptr) {
+    onSpliceReadReady();
+    return;
+  }
+
   IoResult result = transport_socket_->doRead(*read_buffer_);
   uint64_t new_buffer_size = read_buffer_->length();
   updateReadBufferStats(result.bytes_processed_, new_buffer_size);
@@ -709,11 +726,33 @@ void ConnectionImpl::onWriteReady() {
     }
   }
 
+  // Data spliced from a peer connection is always written after the data that was already in the
+  // write buffer.
+  uint64_t spliced_bytes = 0;
+  if (splice_in_ != nullptr && write_buffer_->length() == 0 &&
+      drainSplicePipe(spliced_bytes) == PostIoAction::Close) {
+    closeSocket(ConnectionEvent::RemoteClose);
+    return;
+  }
+
   IoResult result = transport_socket_->doWrite(*write_buffer_, write_end_stream_);
   ASSERT(!result.end_stream_read_); // The interface guarantees that only read operations set this.
   uint64_t new_buffer_size = write_buffer_->length();
+  result.bytes_processed_ += spliced_bytes;
   updateWriteBufferStats(result.bytes_processed_, new_buffer_size);
 
+  if (splice_in_ != nullptr && new_buffer_size == 0 && result.action_ == PostIoAction::KeepOpen) {
+    if (splice_in_->bytes_ > 0 && spliced_bytes == 0) {
+      // The write buffer was flushed before the pipe could be drained. As the socket may still be
+      // writable, no further write event would be raised.
+      ioHandle().activateFileEvents(Event::FileReadyType::Write);
+    } else if (splice_in_->bytes_ == 0 && splice_in_->source_waiting_ &&
+               splice_in_->source_ != nullptr) {
+      splice_in_->source_waiting_ = false;
+      splice_in_->source_->setTransportSocketIsReadable();
+    }
+  }
+
   // NOTE: If the delayed_close_timer_ is set, it must only trigger after a delayed_close_timeout_
   // period of inactivity from the last write event. Therefore, the timer must be reset to its
   // original timeout value unless the socket is going to be closed as a result of the doWrite().
@@ -723,7 +762,8 @@ void ConnectionImpl::onWriteReady() {
     // write callback. This can happen if we manage to complete the SSL handshake in the write
     // callback, raise a connected event, and close the connection.
     closeSocket(ConnectionEvent::RemoteClose);
-  } else if ((inDelayedClose() && new_buffer_size == 0) || bothSidesHalfClosed()) {
+  } else if ((inDelayedClose() && new_buffer_size == 0 && splicePipeLength() == 0) ||
+             bothSidesHalfClosed()) {
     ENVOY_CONN_LOG(debug, "write flush complete", *this);
     if (delayed_close_state_ == DelayedCloseState::CloseAfterFlushAndWait) {
       ASSERT(delayed_close_timer_ != nullptr && delayed_close_timer_->enabled());
@@ -782,7 +822,190 @@ void ConnectionImpl::updateWriteBufferStats(uint64_t num_written, uint64_t new_s
 
 bool ConnectionImpl::bothSidesHalfClosed() {
   // If the write_buffer_ is not empty, then the end_stream has not been sent to the transport yet.
-  return read_end_stream_ && write_end_stream_ && write_buffer_->length() == 0;
+  return read_end_stream_ && write_end_stream_ && write_buffer_->length() == 0 &&
+         splicePipeLength() == 0;
+}
+
+bool ConnectionImpl::startSplice(Connection& peer, SpliceCallbacks& callbacks) {
+#ifdef __linux__
+  auto* sink = dynamic_cast<ConnectionImpl*>(&peer);
+  if (sink == nullptr || sink == this || &sink->dispatcher_ != &dispatcher_) {
+    return false;
+  }
+  // Both ends must be plaintext kernel sockets, with no data already buffered or in flight that
+  // would be reordered with the spliced data.
+  for (const ConnectionImpl* connection : {static_cast<const ConnectionImpl*>(this), sink}) {
+    if (connection->state() != State::Open || connection->connecting_ ||
+        connection->connectionInfoProvider().localAddress()->type() != Address::Type::Ip ||
+        dynamic_cast<const RawBufferSocket*>(connection->transport_socket_.get()) == nullptr) {
+      return false;
+    }
+  }
+  if (splice_out_ != nullptr || read_buffer_->length() > 0 || read_end_stream_ ||
+      sink->splice_in_ != nullptr || sink->write_end_stream_) {
+    return false;
+  }
+  // Spliced data bypasses the read filters of this connection and the write filters of the sink,
+  // so only the read filter forwarding the data, which is notified through the callbacks, may be
+  // installed.
+  if (filter_manager_.numReadFilters() != 1 || sink->filter_manager_.numWriteFilters() != 0) {
+    return false;
+  }
+
+  int fds[2];
+  const Api::SysCallIntResult result =
+      Api::LinuxOsSysCallsSingleton::get().pipe2(fds, O_NONBLOCK | O_CLOEXEC);
+  if (result.return_value_ != 0) {
+    ENVOY_CONN_LOG(debug, "unable to create splice pipe: {}", *this, errorDetails(result.errno_));
+    return false;
+  }
+
+  auto pipe = std::make_shared<SplicePipe>();
+  pipe->read_fd_ = fds[0];
+  pipe->write_fd_ = fds[1];
+  pipe->source_ = this;
+  pipe->sink_ = sink;
+  pipe->callbacks_ = &callbacks;
+  splice_out_ = pipe;
+  sink->splice_in_ = std::move(pipe);
+  ENVOY_CONN_LOG(debug, "splicing to connection {}", *this, sink->id());
+
+  // Data may already be pending in the socket, and reads are edge triggered.
+  setTransportSocketIsReadable();
+  return true;
+#else
+  UNREFERENCED_PARAMETER(peer);
+  UNREFERENCED_PARAMETER(callbacks);
+  return false;
+#endif
+}
+
+ConnectionImpl::SplicePipe::~SplicePipe() {
+  auto& os_sys_calls = Api::OsSysCallsSingleton::get();
+  os_sys_calls.close(read_fd_);
+  os_sys_calls.close(write_fd_);
+}
+
+void ConnectionImpl::onSpliceReadReady() {
+#ifdef __linux__
+  // Hold a reference to the pipe, as the callbacks may close either connection.
+  const SplicePipeSharedPtr pipe = splice_out_;
+  if (pipe->end_stream_) {
+    return;
+  }
+
+  auto& os_sys_calls = Api::LinuxOsSysCallsSingleton::get();
+  uint64_t bytes_read = 0;
+  bool end_stream = false;
+  PostIoAction action = PostIoAction::KeepOpen;
+  while (true) {
+    if (pipe->sink_ == nullptr) {
+      break;
+    }
+    if (pipe->sink_->write_buffer_->length() > 0) {
+      // Preserve ordering with the data that was written to the sink through its filter chain.
+      pipe->source_waiting_ = true;
+      break;
+    }
+    const Api::SysCallSizeResult result =
+        os_sys_calls.splice(ioHandle().fdDoNotUse(), pipe->write_fd_, kSpliceChunkSize,
+                            SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    if (result.return_value_ > 0) {
+      bytes_read += result.return_value_;
+      pipe->bytes_ += result.return_value_;
+    } else if (result.return_value_ == 0) {
+      ENVOY_CONN_LOG(trace, "splice read end of stream", *this);
+      end_stream = true;
+      break;
+    } else if (result.errno_ == SOCKET_ERROR_INTR) {
+      continue;
+    } else if (result.errno_ == SOCKET_ERROR_AGAIN) {
+      // Either the socket has no more data or the pipe is full. In the latter case the sink
+      // resumes reading once it has drained the pipe.
+      pipe->source_waiting_ = pipe->bytes_ > 0;
+      break;
+    } else {
+      ENVOY_CONN_LOG(debug, "splice read error: {}", *this, errorDetails(result.errno_));
+      action = PostIoAction::Close;
+      break;
+    }
+  }
+  ENVOY_CONN_LOG(trace, "spliced {} bytes", *this, bytes_read);
+  updateReadBufferStats(bytes_read, 0);
+
+  // If this connection doesn't have half-close semantics, translate end_stream into a connection
+  // close. The data already in the pipe is still flushed by the sink.
+  if (!enable_half_close_ && end_stream) {
+    end_stream = false;
+    action = PostIoAction::Close;
+  }
+  read_end_stream_ |= end_stream;
+  pipe->end_stream_ |= end_stream;
+
+  if (bytes_read > 0 || end_stream) {
+    if (pipe->sink_ != nullptr) {
+      pipe->sink_->ioHandle().activateFileEvents(Event::FileReadyType::Write);
+    }
+    pipe->callbacks_->onSplicedData(bytes_read, end_stream);
+  }
+
+  // The callbacks may have already closed the connection.
+  if (action == PostIoAction::Close || bothSidesHalfClosed()) {
+    ENVOY_CONN_LOG(debug, "remote close", *this);
+    closeSocket(ConnectionEvent::RemoteClose);
+  }
+#endif
+}
+
+PostIoAction ConnectionImpl::drainSplicePipe(uint64_t& bytes_written) {
+#ifdef __linux__
+  SplicePipe& pipe = *splice_in_;
+  auto& os_sys_calls = Api::LinuxOsSysCallsSingleton::get();
+  while (pipe.bytes_ > 0) {
+    const Api::SysCallSizeResult result =
+        os_sys_calls.splice(pipe.read_fd_, ioHandle().fdDoNotUse(), pipe.bytes_,
+                            SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    if (result.return_value_ > 0) {
+      bytes_written += result.return_value_;
+      pipe.bytes_ -= result.return_value_;
+    } else if (result.return_value_ < 0 && result.errno_ == SOCKET_ERROR_INTR) {
+      continue;
+    } else if (result.return_value_ < 0 && result.errno_ != SOCKET_ERROR_AGAIN) {
+      ENVOY_CONN_LOG(debug, "splice write error: {}", *this, errorDetails(result.errno_));
+      return PostIoAction::Close;
+    } else {
+      break;
+    }
+  }
+  // Propagate the half close of the source once all of its data has been written. The shutdown
+  // itself is done by the transport socket.
+  if (pipe.bytes_ == 0 && pipe.end_stream_) {
+    write_end_stream_ = true;
+  }
+#else
+  UNREFERENCED_PARAMETER(bytes_written);
+#endif
+  return PostIoAction::KeepOpen;
+}
+
+void ConnectionImpl::stopSplice() {
+  if (splice_out_ != nullptr) {
+    // Leave the pipe to the sink, so that it can flush the data that was already read.
+    splice_out_->source_ = nullptr;
+    splice_out_.reset();
+  }
+  if (splice_in_ != nullptr) {
+    // The source falls back to reading through its filter chain. The data in the pipe is lost
+    // along with this connection.
+    splice_in_->sink_ = nullptr;
+    if (splice_in_->source_ != nullptr) {
+      splice_in_->source_->splice_out_.reset();
+      if (splice_in_->source_waiting_) {
+        splice_in_->source_->setTransportSocketIsReadable();
+      }
+    }
+    splice_in_.reset();
+  }
 }
 
 absl::string_view ConnectionImpl::transportFailureReason() const {
@@ -110,6 +110,7 @@ public:
   const StreamInfo::StreamInfo& streamInfo() const override { return stream_info_; }
   absl::string_view transportFailureReason() const override;
   bool startSecureTransport() override { return transport_socket_->startSecureTransport(); }
+  bool startSplice(Connection& peer, SpliceCallbacks& callbacks) override;
   absl::optional<std::chrono::milliseconds> lastRoundTripTime() const override;
   void configureInitialCongestionWindow(uint64_t bandwidth_bits_per_sec,
                                         std::chrono::microseconds rtt) override;
@@ -196,6 +197,29 @@ protected:
   bool bind_error_{false};
 
 private:
+  /**
+   * A kernel pipe through which the data read from a source connection is spliced to the socket of
+   * a sink connection. It is shared by both connections, so that the data left in the pipe can
+   * still be flushed to the sink once the source is closed.
+   */
+  struct SplicePipe {
+    ~SplicePipe();
+
+    os_fd_t read_fd_{INVALID_SOCKET};
+    os_fd_t write_fd_{INVALID_SOCKET};
+    // Cleared when the respective connection is closed.
+    ConnectionImpl* source_{};
+    ConnectionImpl* sink_{};
+    SpliceCallbacks* callbacks_{};
+    // The number of bytes that are in the pipe.
+    uint64_t bytes_{};
+    // Whether the source has been half closed by the remote.
+    bool end_stream_{};
+    // Whether the source stopped reading until the pipe and the sink's write buffer are drained.
+    bool source_waiting_{};
+  };
+  using SplicePipeSharedPtr = std::shared_ptr<SplicePipe>;
+
   friend class MultiConnectionBaseImpl;
   friend class Envoy::RandomPauseFilter;
   friend class Envoy::TestPauseFilter;
@@ -204,6 +228,10 @@ private:
   void onRead(uint64_t read_buffer_size);
   void onReadReady();
   void onWriteReady();
+  void onSpliceReadReady();
+  PostIoAction drainSplicePipe(uint64_t& bytes_written);
+  uint64_t splicePipeLength() const { return splice_in_ != nullptr ? splice_in_->bytes_ : 0; }
+  void stopSplice();
   void updateReadBufferStats(uint64_t num_read, uint64_t new_size);
   void updateWriteBufferStats(uint64_t num_written, uint64_t new_size);
 
@@ -224,6 +252,10 @@ private:
   uint64_t last_read_buffer_size_{};
   uint64_t last_write_buffer_size_{};
   Buffer::Instance* current_write_buffer_{};
+  // Set while the data read from this connection is spliced to a peer connection.
+  SplicePipeSharedPtr splice_out_;
+  // Set while the data read from a peer connection is spliced to this connection.
+  SplicePipeSharedPtr splice_in_;
   uint32_t read_disable_count_{0};
   bool write_buffer_above_high_watermark_ : 1;
   bool detect_early_close_ : 1;
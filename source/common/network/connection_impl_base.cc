@@ -43,7 +43,8 @@ void ConnectionImplBase::setDelayedCloseTimeout(std::chrono::milliseconds timeou
 void ConnectionImplBase::initializeDelayedCloseTimer() {
   const auto timeout = delayed_close_timeout_.count();
   ASSERT(delayed_close_timer_ == nullptr && timeout > 0);
-  delayed_close_timer_ = dispatcher_.createTimer([this]() -> void { onDelayedCloseTimeout(); });
+  delayed_close_timer_ =
+      dispatcher_.createCoarseTimer([this]() -> void { onDelayedCloseTimeout(); });
   ENVOY_CONN_LOG(debug, "setting delayed close timer with timeout {} ms", *this, timeout);
   delayed_close_timer_->enableTimer(delayed_close_timeout_);
 }
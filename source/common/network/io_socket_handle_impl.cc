@@ -242,6 +242,51 @@ Api::IoCallUint64Result IoSocketHandleImpl::sendmsg(const Buffer::RawSlice* slic
   }
 }
 
+Api::IoCallUint64Result IoSocketHandleImpl::sendmmsg(const Buffer::RawSlice* datagrams,
+                                                     uint64_t num_datagrams, int flags,
+                                                     const Address::Instance& peer_address) {
+  if (num_datagrams == 0) {
+    return Api::ioCallUint64ResultNoError();
+  }
+  auto& os_syscalls = Api::OsSysCallsSingleton::get();
+  if (!os_syscalls.supportsMmsg()) {
+    // Send the datagrams one at a time, stopping at the first one that can't be sent.
+    uint64_t num_sent = 0;
+    for (; num_sent < num_datagrams; ++num_sent) {
+      Api::IoCallUint64Result result =
+          sendmsg(&datagrams[num_sent], 1, flags, nullptr, peer_address);
+      if (!result.ok()) {
+        if (num_sent == 0) {
+          return result;
+        }
+        break;
+      }
+    }
+    return {num_sent, Api::IoErrorPtr(nullptr, IoSocketError::deleteIoError)};
+  }
+
+  const auto* address_base = dynamic_cast<const Address::InstanceBase*>(&peer_address);
+  sockaddr* sock_addr = const_cast<sockaddr*>(address_base->sockAddr());
+  if (sock_addr == nullptr) {
+    // Unlikely to happen unless the wrong peer address is passed.
+    return IoSocketError::ioResultSocketInvalidAddress();
+  }
+  absl::FixedArray<iovec> iov(num_datagrams);
+  absl::FixedArray<mmsghdr> messages(num_datagrams);
+  for (uint64_t i = 0; i < num_datagrams; i++) {
+    iov[i].iov_base = datagrams[i].mem_;
+    iov[i].iov_len = datagrams[i].len_;
+    memset(&messages[i], 0, sizeof(mmsghdr));
+    messages[i].msg_hdr.msg_name = reinterpret_cast<void*>(sock_addr);
+    messages[i].msg_hdr.msg_namelen = address_base->sockAddrLen();
+    messages[i].msg_hdr.msg_iov = &iov[i];
+    messages[i].msg_hdr.msg_iovlen = 1;
+  }
+  const Api::SysCallIntResult result =
+      os_syscalls.sendmmsg(fd_, messages.begin(), static_cast<unsigned int>(num_datagrams), flags);
+  return sysCallResultToIoCallResult(result);
+}
+
 Address::InstanceConstSharedPtr
 maybeGetDstAddressFromHeader(const cmsghdr& cmsg, uint32_t self_port, os_fd_t fd, bool v6only) {
   if (cmsg.cmsg_type == IPV6_PKTINFO) {
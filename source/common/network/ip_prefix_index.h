@@ -0,0 +1,32 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "envoy/common/pure.h"
+#include "envoy/network/address.h"
+
+namespace Envoy {
+namespace Network {
+
+/**
+ * Index associating data with CIDR ranges, to look up the data of the ranges that contain an IP
+ * address. Both IPv4 and IPv6 addresses are supported.
+ */
+template <class T> class IpPrefixIndex {
+public:
+  virtual ~IpPrefixIndex() = default;
+
+  /**
+   * Retrieve data associated with the CIDR ranges that contain `ip_address`.
+   * @param ip_address supplies the IP address.
+   * @return a vector of data from the CIDR ranges that contain 'ip_address'. An empty vector is
+   *         returned if no CIDR range contains 'ip_address'.
+   */
+  virtual std::vector<T> getData(const Address::InstanceConstSharedPtr& ip_address) const PURE;
+};
+
+template <class T> using IpPrefixIndexPtr = std::unique_ptr<IpPrefixIndex<T>>;
+
+} // namespace Network
+} // namespace Envoy
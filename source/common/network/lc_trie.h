@@ -12,6 +12,7 @@
 #include "source/common/common/utility.h"
 #include "source/common/network/address_impl.h"
 #include "source/common/network/cidr_range.h"
+#include "source/common/network/ip_prefix_index.h"
 #include "source/common/network/utility.h"
 
 #include "absl/container/node_hash_set.h"
@@ -39,7 +40,7 @@ constexpr size_t MaxLcTrieNodes = (1 << 20);
  *
  * Refer to LcTrieInternal for implementation and algorithm details.
  */
-template <class T> class LcTrie {
+template <class T> class LcTrie : public IpPrefixIndex<T> {
 public:
   /**
    * @param data supplies a vector of data and CIDR ranges.
@@ -182,7 +183,8 @@ public:
    * empty vector is returned if no prefix contains 'ip_address' or there is no data for the IP
    * version of the ip_address.
    */
-  std::vector<T> getData(const Network::Address::InstanceConstSharedPtr& ip_address) const {
+  std::vector<T>
+  getData(const Network::Address::InstanceConstSharedPtr& ip_address) const override {
     if (ip_address->ip()->version() == Address::IpVersion::v4) {
       Ipv4 ip = ntohl(ip_address->ip()->ipv4()->address());
       return ipv4_trie_->getData(ip);
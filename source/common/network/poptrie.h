@@ -0,0 +1,387 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "envoy/network/address.h"
+
+#include "source/common/common/assert.h"
+#include "source/common/network/cidr_range.h"
+#include "source/common/network/ip_prefix_index.h"
+#include "source/common/network/utility.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/numeric/bits.h"
+#include "absl/numeric/int128.h"
+#include "absl/types/span.h"
+
+namespace Envoy {
+namespace Network {
+namespace Poptrie {
+
+/**
+ * Compressed multi-bit trie for associating data with CIDR ranges. It returns the same data as
+ * LcTrie, but has no limit on the number of CIDR ranges, and is built in a single pass over the
+ * sorted ranges, so it suits tables of millions of ranges such as threat intelligence feeds.
+ *
+ * The layout is the one described in the paper 'Poptrie: A Compressed Trie with Population Count
+ * for Fast and Scalable Software IP Routing Table Lookup' by 'H. Asai' and 'Y. Ohara':
+ *   - The first root_bits bits of an address index a flat root table.
+ *   - Below the root, each node resolves 6 bits of the address and so has 64 children, each of
+ *     them either another node or a leaf. The node holds a 64-bit bitmap of which children are
+ *     nodes, and a 64-bit bitmap of where runs of identical leaves start. A child is found by
+ *     counting the bits set up to its position, which a single popcount instruction does, and
+ *     the children and leaves of a node are stored contiguously, so a node takes 24 bytes and
+ *     each run of identical leaves takes 4 bytes.
+ *   - Leaves hold the index of the set of data for the addresses they cover. The CIDR ranges are
+ *     pushed to the leaves while building, so a lookup reads a single leaf.
+ */
+template <class T> class Poptrie : public IpPrefixIndex<T> {
+public:
+  /**
+   * @param data supplies a vector of data and CIDR ranges.
+   * @param exclusive if true then only data for the most specific subnet will be returned
+   *                  (i.e. data isn't inherited from wider ranges).
+   * @param root_bits supplies the number of leading address bits resolved by the root table, which
+   *                  takes 4 << root_bits bytes per IP version.
+   */
+  Poptrie(const std::vector<std::pair<T, std::vector<Address::CidrRange>>>& data,
+          bool exclusive = false, uint32_t root_bits = 16) {
+    ASSERT(root_bits > 0);
+    DataSetTable data_sets(exclusive);
+    std::vector<Prefix<Ipv4>> ipv4_prefixes;
+    std::vector<Prefix<Ipv6>> ipv6_prefixes;
+    for (const auto& pair_data : data) {
+      const uint32_t data_set = data_sets.singleton(pair_data.first);
+      for (const auto& cidr_range : pair_data.second) {
+        if (cidr_range.ip()->version() == Address::IpVersion::v4) {
+          ipv4_prefixes.push_back({ntohl(cidr_range.ip()->ipv4()->address()),
+                                   static_cast<uint32_t>(cidr_range.length()), data_set});
+        } else {
+          ipv6_prefixes.push_back({Utility::Ip6ntohl(cidr_range.ip()->ipv6()->address()),
+                                   static_cast<uint32_t>(cidr_range.length()), data_set});
+        }
+      }
+    }
+    ipv4_trie_ = std::make_unique<PoptrieInternal<Ipv4>>(ipv4_prefixes, data_sets, root_bits);
+    ipv6_trie_ = std::make_unique<PoptrieInternal<Ipv6>>(ipv6_prefixes, data_sets, root_bits);
+    data_sets_ = data_sets.release();
+  }
+
+  // Network::IpPrefixIndex
+  std::vector<T>
+  getData(const Network::Address::InstanceConstSharedPtr& ip_address) const override {
+    if (ip_address->ip()->version() == Address::IpVersion::v4) {
+      return data_sets_[ipv4_trie_->getDataSet(ntohl(ip_address->ip()->ipv4()->address()))];
+    }
+    return data_sets_[ipv6_trie_->getDataSet(
+        Utility::Ip6ntohl(ip_address->ip()->ipv6()->address()))];
+  }
+
+private:
+  // IP addresses are stored in host byte order.
+  using Ipv4 = uint32_t;
+  using Ipv6 = absl::uint128;
+
+  // The number of address bits a node below the root resolves, one child per bit of a uint64_t.
+  static constexpr uint32_t NodeBits = 6;
+  // Set in a root table entry, and in the result of a lookup step, that refers to a node rather
+  // than a data set.
+  static constexpr uint32_t NodeFlag = 1U << 31;
+
+  /**
+   * CIDR range with the index of its set of data.
+   */
+  template <class IpType> struct Prefix {
+    IpType ip_;
+    uint32_t length_;
+    uint32_t data_set_;
+  };
+
+  /**
+   * Interns the sets of data that the leaves refer to while building. Set 0 is the empty set, for
+   * addresses no CIDR range contains.
+   */
+  class DataSetTable {
+  public:
+    explicit DataSetTable(bool exclusive) : exclusive_(exclusive) {
+      members_.emplace_back();
+      set_indices_.emplace(members_.back(), 0);
+    }
+
+    /**
+     * @return the index of the set holding just `data`.
+     */
+    uint32_t singleton(const T& data) {
+      const auto [it, inserted] = value_indices_.try_emplace(data, values_.size());
+      if (inserted) {
+        values_.push_back(data);
+      }
+      return intern({it->second});
+    }
+
+    /**
+     * @return the index of the union of two sets.
+     */
+    uint32_t merge(uint32_t first, uint32_t second) {
+      if (first == second || second == 0) {
+        return first;
+      }
+      if (first == 0) {
+        return second;
+      }
+      const std::pair<uint32_t, uint32_t> key = std::minmax(first, second);
+      const auto it = merged_.find(key);
+      if (it != merged_.end()) {
+        return it->second;
+      }
+      std::vector<uint32_t> members;
+      std::set_union(members_[first].begin(), members_[first].end(), members_[second].begin(),
+                     members_[second].end(), std::back_inserter(members));
+      const uint32_t merged = intern(std::move(members));
+      merged_.emplace(key, merged);
+      return merged;
+    }
+
+    /**
+     * @return the index of the set for an address in a CIDR range with the data set `range`,
+     *         given the set `wider` of the wider ranges that contain the range.
+     */
+    uint32_t apply(uint32_t wider, uint32_t range) {
+      return exclusive_ ? range : merge(wider, range);
+    }
+
+    std::vector<std::vector<T>> release() {
+      std::vector<std::vector<T>> data_sets;
+      data_sets.reserve(members_.size());
+      for (const auto& members : members_) {
+        auto& data_set = data_sets.emplace_back();
+        data_set.reserve(members.size());
+        for (const uint32_t value_index : members) {
+          data_set.push_back(values_[value_index]);
+        }
+      }
+      return data_sets;
+    }
+
+  private:
+    uint32_t intern(std::vector<uint32_t>&& members) {
+      const auto it = set_indices_.find(members);
+      if (it != set_indices_.end()) {
+        return it->second;
+      }
+      const uint32_t index = members_.size();
+      set_indices_.emplace(members, index);
+      members_.push_back(std::move(members));
+      return index;
+    }
+
+    const bool exclusive_;
+    std::vector<T> values_;
+    absl::flat_hash_map<T, uint32_t> value_indices_;
+    // Indices into values_ of the data of each set, sorted.
+    std::vector<std::vector<uint32_t>> members_;
+    absl::flat_hash_map<std::vector<uint32_t>, uint32_t> set_indices_;
+    absl::flat_hash_map<std::pair<uint32_t, uint32_t>, uint32_t> merged_;
+  };
+
+  /**
+   * The trie of one IP version.
+   */
+  template <class IpType, uint32_t address_size = CHAR_BIT * sizeof(IpType)>
+  class PoptrieInternal {
+  public:
+    PoptrieInternal(std::vector<Prefix<IpType>>& prefixes, DataSetTable& data_sets,
+                    uint32_t root_bits)
+        : root_bits_(prefixes.empty() ? 1 : std::min(root_bits, address_size)) {
+      // Sorting by address and then length puts each range before the narrower ranges within it,
+      // and the ranges within each subtree next to each other.
+      for (auto& prefix : prefixes) {
+        prefix.ip_ = prefix.length_ == 0 ? IpType(0)
+                                         : prefix.ip_ >> (address_size - prefix.length_)
+                                                          << (address_size - prefix.length_);
+      }
+      std::sort(prefixes.begin(), prefixes.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.ip_ < rhs.ip_ || (lhs.ip_ == rhs.ip_ && lhs.length_ < rhs.length_);
+      });
+      // Merge the data of duplicate CIDR ranges.
+      size_t unique = 0;
+      for (const auto& prefix : prefixes) {
+        if (unique > 0 && prefixes[unique - 1].ip_ == prefix.ip_ &&
+            prefixes[unique - 1].length_ == prefix.length_) {
+          prefixes[unique - 1].data_set_ =
+              data_sets.merge(prefixes[unique - 1].data_set_, prefix.data_set_);
+        } else {
+          prefixes[unique++] = prefix;
+        }
+      }
+      prefixes.resize(unique);
+
+      // One set of slots per level of nodes, reused by the nodes of that level.
+      scratch_.resize((address_size - root_bits_ + NodeBits - 1) / NodeBits);
+      Slots root_slots;
+      pushToSlots(prefixes, 0, root_bits_, 0, data_sets, root_slots);
+      root_.assign(root_slots.data_sets_.begin(), root_slots.data_sets_.end());
+      for (const auto& child : root_slots.children_) {
+        root_[child.slot_] = NodeFlag | static_cast<uint32_t>(nodes_.size());
+        nodes_.emplace_back();
+      }
+      for (const auto& child : root_slots.children_) {
+        buildNode(root_[child.slot_] & ~NodeFlag, child.prefixes_, root_bits_, 0,
+                  root_slots.data_sets_[child.slot_], data_sets);
+      }
+      scratch_.clear();
+      scratch_.shrink_to_fit();
+      nodes_.shrink_to_fit();
+      leaves_.shrink_to_fit();
+    }
+
+    /**
+     * @return the index of the data set for `ip`.
+     */
+    uint32_t getDataSet(IpType ip) const {
+      uint32_t entry = root_[extractBits(0, root_bits_, ip)];
+      for (uint32_t depth = root_bits_; entry & NodeFlag; depth += NodeBits) {
+        entry = step(nodes_[entry & ~NodeFlag], depth, ip);
+      }
+      return entry;
+    }
+
+  private:
+    struct Node {
+      // Bit i is set if child i is a node.
+      uint64_t nodes_bitmap_;
+      // Bit i is set if child i is a leaf that starts a run of identical leaves.
+      uint64_t leaves_bitmap_;
+      // Index of the first child node in nodes_.
+      uint32_t first_node_;
+      // Index of the first leaf in leaves_.
+      uint32_t first_leaf_;
+    };
+
+    /**
+     * Extract n bits from input starting at position p.
+     */
+    static uint32_t extractBits(uint32_t p, uint32_t n, IpType input) {
+      return static_cast<uint32_t>(input << p >> (address_size - n));
+    }
+
+    /**
+     * @return the child of `node` for `ip`: either the index of the data set of a leaf, or the
+     *         index of a node with NodeFlag set.
+     */
+    uint32_t step(const Node& node, uint32_t depth, IpType ip) const {
+      const uint32_t bits = std::min(NodeBits, address_size - depth);
+      const uint64_t slot_bit = uint64_t(1) << extractBits(depth, bits, ip);
+      const uint64_t up_to_slot = slot_bit | (slot_bit - 1);
+      if (node.nodes_bitmap_ & slot_bit) {
+        return NodeFlag | (node.first_node_ + absl::popcount(node.nodes_bitmap_ & up_to_slot) - 1);
+      }
+      return leaves_[node.first_leaf_ + absl::popcount(node.leaves_bitmap_ & up_to_slot) - 1];
+    }
+
+    struct Child {
+      uint32_t slot_;
+      absl::Span<const Prefix<IpType>> prefixes_;
+    };
+
+    struct Slots {
+      // The data set of each slot.
+      std::vector<uint32_t> data_sets_;
+      // The slots that need a node below them, with the ranges within them, in slot order.
+      std::vector<Child> children_;
+    };
+
+    /**
+     * Divides the address range of a subtree into 1 << bits slots, and pushes the CIDR ranges
+     * that contain whole slots to them.
+     * @param prefixes supplies the sorted CIDR ranges within the subtree.
+     * @param depth supplies the number of leading address bits the subtree is at.
+     * @param bits supplies the number of address bits the slots resolve.
+     * @param wider supplies the data set of the ranges that contain the whole subtree.
+     * @param slots receives the data set of each slot, and the ranges narrower than the slots.
+     */
+    static void pushToSlots(absl::Span<const Prefix<IpType>> prefixes, uint32_t depth,
+                            uint32_t bits, uint32_t wider, DataSetTable& data_sets, Slots& slots) {
+      const uint32_t slot_depth = depth + bits;
+      slots.data_sets_.assign(size_t(1) << bits, wider);
+      slots.children_.clear();
+      size_t i = 0;
+      while (i < prefixes.size()) {
+        const uint32_t slot = extractBits(depth, bits, prefixes[i].ip_);
+        if (prefixes[i].length_ <= slot_depth) {
+          // A range that contains whole slots. Wider ranges come first, so narrower ones override
+          // or add to them.
+          // Neighbouring slots mostly have the same data set, so remember the last one applied.
+          const size_t end = slot + (size_t(1) << (slot_depth - prefixes[i].length_));
+          uint32_t previous = slots.data_sets_[slot];
+          uint32_t applied = data_sets.apply(previous, prefixes[i].data_set_);
+          for (size_t covered = slot; covered < end; ++covered) {
+            if (slots.data_sets_[covered] != previous) {
+              previous = slots.data_sets_[covered];
+              applied = data_sets.apply(previous, prefixes[i].data_set_);
+            }
+            slots.data_sets_[covered] = applied;
+          }
+          ++i;
+          continue;
+        }
+        // The ranges within a slot that are narrower than it come after all the ranges that
+        // contain the slot, and are left to a node below the slot.
+        size_t end = i + 1;
+        while (end < prefixes.size() && extractBits(depth, bits, prefixes[end].ip_) == slot) {
+          ++end;
+        }
+        slots.children_.push_back({slot, prefixes.subspan(i, end - i)});
+        i = end;
+      }
+    }
+
+    void buildNode(uint32_t index, absl::Span<const Prefix<IpType>> prefixes, uint32_t depth,
+                   uint32_t level, uint32_t wider, DataSetTable& data_sets) {
+      Slots& slots = scratch_[level];
+      pushToSlots(prefixes, depth, std::min(NodeBits, address_size - depth), wider, data_sets,
+                  slots);
+
+      Node node{0, 0, static_cast<uint32_t>(nodes_.size()), static_cast<uint32_t>(leaves_.size())};
+      auto next_child = slots.children_.begin();
+      for (uint32_t slot = 0; slot < slots.data_sets_.size(); ++slot) {
+        if (next_child != slots.children_.end() && next_child->slot_ == slot) {
+          node.nodes_bitmap_ |= uint64_t(1) << slot;
+          ++next_child;
+        } else if (leaves_.size() == node.first_leaf_ || leaves_.back() != slots.data_sets_[slot]) {
+          node.leaves_bitmap_ |= uint64_t(1) << slot;
+          leaves_.push_back(slots.data_sets_[slot]);
+        }
+      }
+      // Reserve the child nodes next to each other before building any of them.
+      nodes_.resize(nodes_.size() + slots.children_.size());
+      nodes_[index] = node;
+      // The children are built with the slots of the levels below, so these stay intact.
+      for (size_t i = 0; i < slots.children_.size(); ++i) {
+        const Child& child = slots.children_[i];
+        buildNode(node.first_node_ + i, child.prefixes_, depth + NodeBits, level + 1,
+                  slots.data_sets_[child.slot_], data_sets);
+      }
+    }
+
+    const uint32_t root_bits_;
+    std::vector<uint32_t> root_;
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> leaves_;
+    std::vector<Slots> scratch_;
+  };
+
+  std::unique_ptr<PoptrieInternal<Ipv4>> ipv4_trie_;
+  std::unique_ptr<PoptrieInternal<Ipv6>> ipv6_trie_;
+  std::vector<std::vector<T>> data_sets_;
+};
+
+} // namespace Poptrie
+} // namespace Network
+} // namespace Envoy
@@ -623,14 +623,28 @@ Api::IoCallUint64Result Utility::readFromSocket(IoHandle& handle,
       return result;
     }
 
-    // Segment the buffer read by the recvmsg syscall into gso_sized sub buffers.
-    // TODO(mattklein123): The following code should be optimized to avoid buffer copies, either by
-    // switching to slices or by using a CoW buffer type.
-    while (buffer->length() > 0) {
-      const uint64_t bytes_to_copy = std::min(buffer->length(), gso_size);
+    // Segment the buffer read by the recvmsg syscall into gso_sized sub buffers. Segments of at
+    // least GRO_SEGMENT_COPY_THRESHOLD bytes reference the received buffer rather than copying it,
+    // and the received buffer is released once the last of them has been consumed. Shorter
+    // segments, including a short trailing one, are copied so that a processor holding on to a
+    // small datagram does not keep the whole receive buffer alive.
+    const uint64_t total_length = buffer->length();
+    const uint8_t* data = static_cast<const uint8_t*>(buffer->linearize(total_length));
+    std::shared_ptr<Buffer::Instance> shared_buffer = std::move(buffer);
+    for (uint64_t offset = 0; offset < total_length; offset += gso_size) {
+      const uint64_t segment_length = std::min(total_length - offset, gso_size);
       Buffer::InstancePtr sub_buffer = std::make_unique<Buffer::OwnedImpl>();
-      sub_buffer->move(*buffer, bytes_to_copy);
-      passPayloadToProcessor(bytes_to_copy, std::move(sub_buffer), output.msg_[0].peer_address_,
+      if (segment_length < GRO_SEGMENT_COPY_THRESHOLD) {
+        sub_buffer->add(data + offset, segment_length);
+      } else {
+        auto* fragment = new Buffer::BufferFragmentImpl(
+            data + offset, segment_length,
+            [shared_buffer](const void*, size_t, const Buffer::BufferFragmentImpl* this_fragment) {
+              delete this_fragment;
+            });
+        sub_buffer->addBufferFragment(*fragment);
+      }
+      passPayloadToProcessor(segment_length, std::move(sub_buffer), output.msg_[0].peer_address_,
                              output.msg_[0].local_address_, udp_packet_processor, receive_time);
     }
 
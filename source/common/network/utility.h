@@ -73,6 +73,10 @@ public:
 static const uint64_t DEFAULT_UDP_MAX_DATAGRAM_SIZE = 1500;
 static const uint64_t NUM_DATAGRAMS_PER_RECEIVE = 16;
 static const uint64_t MAX_NUM_PACKETS_PER_EVENT_LOOP = 6000;
+// GRO segments shorter than this are copied out of the receive buffer; longer ones reference it.
+// This bounds how much of the receive buffer a single retained segment can keep alive relative to
+// its own size.
+static const uint64_t GRO_SEGMENT_COPY_THRESHOLD = 1024;
 
 /**
  * Wrapper which resolves UDP socket proto config with defaults.
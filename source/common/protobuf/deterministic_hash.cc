@@ -0,0 +1,159 @@
+#include "source/common/protobuf/deterministic_hash.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "source/common/common/assert.h"
+#include "source/common/common/hash.h"
+
+#include "absl/strings/string_view.h"
+
+#if defined(ENVOY_ENABLE_FULL_PROTOS)
+namespace Envoy {
+namespace DeterministicProtoHash {
+namespace {
+
+template <class T> uint64_t hashScalar(T value, uint64_t seed) {
+  return HashUtil::xxHash64(absl::string_view(reinterpret_cast<const char*>(&value), sizeof(value)),
+                            seed);
+}
+
+uint64_t hashMessage(const Protobuf::Message& message, uint64_t seed);
+
+// Returns the message held in an Any of a type linked into the binary, or
+// nullptr if the type is unknown or the value does not parse, in which case the
+// Any is hashed as a regular message.
+std::unique_ptr<Protobuf::Message> unpackAny(const Protobuf::Message& message) {
+  const auto* any = Protobuf::DynamicCastToGenerated<ProtobufWkt::Any>(&message);
+  if (any == nullptr) {
+    return nullptr;
+  }
+  const absl::string_view type_url = any->type_url();
+  const size_t slash = type_url.rfind('/');
+  const absl::string_view type_name =
+      slash == absl::string_view::npos ? type_url : type_url.substr(slash + 1);
+  const Protobuf::Descriptor* descriptor =
+      Protobuf::DescriptorPool::generated_pool()->FindMessageTypeByName(std::string(type_name));
+  if (descriptor == nullptr) {
+    return nullptr;
+  }
+  const Protobuf::Message* prototype =
+      Protobuf::MessageFactory::generated_factory()->GetPrototype(descriptor);
+  if (prototype == nullptr) {
+    return nullptr;
+  }
+  std::unique_ptr<Protobuf::Message> inner(prototype->New());
+  if (!inner->ParseFromString(any->value())) {
+    return nullptr;
+  }
+  return inner;
+}
+
+// Hashes element index of a repeated field, or the value of a singular field if
+// index is negative.
+uint64_t hashFieldValue(const Protobuf::Message& message, const Protobuf::Reflection& reflection,
+                        const Protobuf::FieldDescriptor& field, int index, uint64_t seed) {
+  const bool repeated = index >= 0;
+  switch (field.cpp_type()) {
+  case Protobuf::FieldDescriptor::CPPTYPE_INT32:
+    return hashScalar(repeated ? reflection.GetRepeatedInt32(message, &field, index)
+                               : reflection.GetInt32(message, &field),
+                      seed);
+  case Protobuf::FieldDescriptor::CPPTYPE_INT64:
+    return hashScalar(repeated ? reflection.GetRepeatedInt64(message, &field, index)
+                               : reflection.GetInt64(message, &field),
+                      seed);
+  case Protobuf::FieldDescriptor::CPPTYPE_UINT32:
+    return hashScalar(repeated ? reflection.GetRepeatedUInt32(message, &field, index)
+                               : reflection.GetUInt32(message, &field),
+                      seed);
+  case Protobuf::FieldDescriptor::CPPTYPE_UINT64:
+    return hashScalar(repeated ? reflection.GetRepeatedUInt64(message, &field, index)
+                               : reflection.GetUInt64(message, &field),
+                      seed);
+  case Protobuf::FieldDescriptor::CPPTYPE_DOUBLE:
+    return hashScalar(repeated ? reflection.GetRepeatedDouble(message, &field, index)
+                               : reflection.GetDouble(message, &field),
+                      seed);
+  case Protobuf::FieldDescriptor::CPPTYPE_FLOAT:
+    return hashScalar(repeated ? reflection.GetRepeatedFloat(message, &field, index)
+                               : reflection.GetFloat(message, &field),
+                      seed);
+  case Protobuf::FieldDescriptor::CPPTYPE_BOOL:
+    return hashScalar(repeated ? reflection.GetRepeatedBool(message, &field, index)
+                               : reflection.GetBool(message, &field),
+                      seed);
+  case Protobuf::FieldDescriptor::CPPTYPE_ENUM:
+    return hashScalar(repeated ? reflection.GetRepeatedEnumValue(message, &field, index)
+                               : reflection.GetEnumValue(message, &field),
+                      seed);
+  case Protobuf::FieldDescriptor::CPPTYPE_STRING: {
+    // GetStringReference() avoids a copy when the field is stored as a std::string.
+    std::string scratch;
+    const std::string& value =
+        repeated ? reflection.GetRepeatedStringReference(message, &field, index, &scratch)
+                 : reflection.GetStringReference(message, &field, &scratch);
+    return HashUtil::xxHash64(value, seed);
+  }
+  case Protobuf::FieldDescriptor::CPPTYPE_MESSAGE:
+    return hashMessage(repeated ? reflection.GetRepeatedMessage(message, &field, index)
+                                : reflection.GetMessage(message, &field),
+                       seed);
+  }
+  PANIC_DUE_TO_CORRUPT_ENUM;
+}
+
+uint64_t hashField(const Protobuf::Message& message, const Protobuf::Reflection& reflection,
+                   const Protobuf::FieldDescriptor& field, uint64_t seed) {
+  seed = hashScalar(field.number(), seed);
+  if (!field.is_repeated()) {
+    return hashFieldValue(message, reflection, field, -1, seed);
+  }
+
+  const int size = reflection.FieldSize(message, &field);
+  seed = hashScalar(size, seed);
+  if (field.is_map()) {
+    // Map entries are stored in an unspecified order, so each entry is hashed
+    // on its own and the entry hashes are combined in sorted order.
+    std::vector<uint64_t> entry_hashes;
+    entry_hashes.reserve(size);
+    for (int i = 0; i < size; ++i) {
+      entry_hashes.push_back(hashFieldValue(message, reflection, field, i, 0));
+    }
+    std::sort(entry_hashes.begin(), entry_hashes.end());
+    for (uint64_t entry_hash : entry_hashes) {
+      seed = hashScalar(entry_hash, seed);
+    }
+    return seed;
+  }
+  for (int i = 0; i < size; ++i) {
+    seed = hashFieldValue(message, reflection, field, i, seed);
+  }
+  return seed;
+}
+
+uint64_t hashMessage(const Protobuf::Message& message, uint64_t seed) {
+  seed = HashUtil::xxHash64(message.GetDescriptor()->full_name(), seed);
+  if (std::unique_ptr<Protobuf::Message> unpacked = unpackAny(message); unpacked != nullptr) {
+    return hashMessage(*unpacked, seed);
+  }
+
+  // ListFields() returns the fields that are set, in field number order.
+  const Protobuf::Reflection* reflection = message.GetReflection();
+  std::vector<const Protobuf::FieldDescriptor*> fields;
+  reflection->ListFields(message, &fields);
+  for (const Protobuf::FieldDescriptor* field : fields) {
+    seed = hashField(message, *reflection, *field, seed);
+  }
+  return seed;
+}
+
+} // namespace
+
+uint64_t hash(const Protobuf::Message& message) { return hashMessage(message, 0); }
+
+} // namespace DeterministicProtoHash
+} // namespace Envoy
+#endif
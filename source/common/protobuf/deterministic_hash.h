@@ -0,0 +1,26 @@
+#pragma once
+
+#include "source/common/protobuf/protobuf.h"
+
+#if defined(ENVOY_ENABLE_FULL_PROTOS)
+namespace Envoy {
+namespace DeterministicProtoHash {
+
+/**
+ * Computes a hash of a message by walking its fields with reflection, without
+ * serializing it. The hash is deterministic within a build: fields are visited
+ * in field number order, map entries are combined independently of their
+ * iteration order, and google.protobuf.Any messages of known types are hashed by
+ * their unpacked contents, so that differing serializations of the same Any
+ * hash the same. Unknown fields are ignored.
+ *
+ * The hash is not stable across Envoy versions and must not be persisted.
+ *
+ * @param message the message to hash.
+ * @return uint64_t the hash.
+ */
+uint64_t hash(const Protobuf::Message& message);
+
+} // namespace DeterministicProtoHash
+} // namespace Envoy
+#endif
@@ -88,6 +88,19 @@ void StrictValidationVisitorImpl::onWorkInProgress(absl::string_view description
   onWorkInProgressCommon(description);
 }
 
+void ConcurrentValidationVisitorImpl::onUnknownField(absl::string_view description) {
+  throw UnknownProtoFieldException(
+      absl::StrCat("Protobuf message (", description, ") has unknown fields"));
+}
+
+void ConcurrentValidationVisitorImpl::onDeprecatedField(absl::string_view description, bool) {
+  throw DeprecatedProtoFieldException(std::string(description));
+}
+
+void ConcurrentValidationVisitorImpl::onWorkInProgress(absl::string_view description) {
+  throw EnvoyException(std::string(description));
+}
+
 ValidationVisitor& getNullValidationVisitor() {
   MUTABLE_CONSTRUCT_ON_FIRST_USE(NullValidationVisitorImpl);
 }
@@ -76,6 +76,25 @@ public:
   void onWorkInProgress(absl::string_view description) override;
 };
 
+// Used to validate config off the main thread, where deprecated fields can't be checked against
+// the runtime and stats can't be incremented. Unknown, deprecated and work-in-progress fields
+// throw, so that the caller can validate the config again on the main thread with its own visitor.
+class ConcurrentValidationVisitorImpl : public ValidationVisitor {
+public:
+  explicit ConcurrentValidationVisitorImpl(bool skip_validation)
+      : skip_validation_(skip_validation) {}
+
+  // Envoy::ProtobufMessage::ValidationVisitor
+  void onUnknownField(absl::string_view description) override;
+  bool skipValidation() override { return skip_validation_; }
+  void onDeprecatedField(absl::string_view description, bool soft_deprecation) override;
+  void onWorkInProgress(absl::string_view description) override;
+  OptRef<Runtime::Loader> runtime() override { return {}; }
+
+private:
+  const bool skip_validation_;
+};
+
 // TODO(mattklein123): There are various places where the default strict validator is being used.
 // This does not increment the WIP stat because nothing calls setCounters() on the stock/static
 // version. We should remove this as a public function as well as the stock/static version and
@@ -250,8 +250,11 @@ public:
   using FileExtensions = ConstSingleton<FileExtensionValues>;
 
   /**
-   * A hash function uses Protobuf::TextFormat to force deterministic serialization recursively
-   * including known types in google.protobuf.Any. See
+   * A deterministic hash function, which recursively includes known types in
+   * google.protobuf.Any. By default this walks the message with reflection, see
+   * DeterministicProtoHash::hash(). With the
+   * envoy.restart_features.use_fast_protobuf_hash runtime feature disabled, it
+   * uses Protobuf::TextFormat to force deterministic serialization instead. See
    * https://github.com/protocolbuffers/protobuf/issues/5731 for the context.
    * Using this function is discouraged, see discussion in
    * https://github.com/envoyproxy/envoy/issues/8301.
@@ -63,6 +63,15 @@ public:
     }
     return io_handle_.sendmsg(slices, num_slice, flags, self_ip, peer_address);
   }
+  Api::IoCallUint64Result sendmmsg(const Buffer::RawSlice* datagrams, uint64_t num_datagrams,
+                                   int flags,
+                                   const Network::Address::Instance& peer_address) override {
+    if (closed_) {
+      return {0, Api::IoErrorPtr(new Network::IoSocketError(EBADF),
+                                 Network::IoSocketError::deleteIoError)};
+    }
+    return io_handle_.sendmmsg(datagrams, num_datagrams, flags, peer_address);
+  }
   Api::IoCallUint64Result recvmsg(Buffer::RawSlice* slices, const uint64_t num_slice,
                                   uint32_t self_port, RecvMsgOutput& output) override {
     if (closed_) {
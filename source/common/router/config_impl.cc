@@ -28,6 +28,7 @@
 #include "source/common/common/hash.h"
 #include "source/common/common/logger.h"
 #include "source/common/common/regex.h"
+#include "source/common/common/thread.h"
 #include "source/common/common/utility.h"
 #include "source/common/config/metadata.h"
 #include "source/common/config/utility.h"
@@ -1906,7 +1907,153 @@ RouteConstSharedPtr VirtualHostImpl::getRouteFromEntries(const RouteCallback& cb
   return getRouteFromRoutes(cb, headers, stream_info, random_value, routes_);
 }
 
-const VirtualHostImpl* RouteMatcher::findWildcardVirtualHost(
+RouteConstSharedPtr VirtualHostEntry::route(const RouteCallback& cb,
+                                            const Http::RequestHeaderMap& headers,
+                                            const StreamInfo::StreamInfo& stream_info,
+                                            uint64_t random_value) const {
+  if (virtual_host_ != nullptr) {
+    return virtual_host_->getRouteFromEntries(cb, headers, stream_info, random_value);
+  }
+  // The lazily compiled virtual host may be evicted by another thread, so it's held while routing.
+  // The routes it returns don't depend on it staying compiled.
+  const VirtualHostSharedPtr virtual_host = lazyVirtualHost();
+  if (virtual_host == nullptr) {
+    return nullptr;
+  }
+  return virtual_host->getRouteFromEntries(cb, headers, stream_info, random_value);
+}
+
+VirtualHostEntry::VirtualHostEntry(const envoy::config::route::v3::VirtualHost& config,
+                                   LazyVirtualHostCompiler& compiler)
+    : lazy_config_(std::make_unique<envoy::config::route::v3::VirtualHost>(config)),
+      compiler_(&compiler), per_filter_configs_(compiler.createPerFilterConfigs(*lazy_config_)) {
+  // Compile the virtual host once, so that errors in it reject the route table rather than leaving
+  // the virtual host without routes. Only the compiled virtual host is released until it's used.
+  compiler.build(*lazy_config_, per_filter_configs_);
+}
+
+VirtualHostSharedPtr VirtualHostEntry::compiledVirtualHost() const {
+  absl::ReaderMutexLock lock(&mutex_);
+  return compiled_;
+}
+
+VirtualHostSharedPtr VirtualHostEntry::lazyVirtualHost() const {
+  referenced_.store(true, std::memory_order_relaxed);
+  VirtualHostSharedPtr virtual_host = compiledVirtualHost();
+  if (virtual_host != nullptr) {
+    return virtual_host;
+  }
+  // Requests that need this virtual host wait for the one compiling it, while other virtual hosts
+  // are compiled concurrently.
+  absl::MutexLock lock(&compile_mutex_);
+  virtual_host = compiledVirtualHost();
+  if (virtual_host != nullptr) {
+    return virtual_host;
+  }
+  return compiler_->compile(*this);
+}
+
+LazyVirtualHostCompiler::LazyVirtualHostCompiler(
+    const OptionalHttpFilters& optional_http_filters,
+    const CommonConfigSharedPtr& global_route_config,
+    Server::Configuration::ServerFactoryContext& factory_context, Stats::Scope& scope,
+    ProtobufMessage::ValidationVisitor& validator, uint32_t max_compiled_virtual_hosts)
+    : optional_http_filters_(optional_http_filters), global_route_config_(global_route_config),
+      factory_context_(factory_context), scope_(scope), validator_(validator),
+      max_compiled_virtual_hosts_(max_compiled_virtual_hosts) {}
+
+VirtualHostSharedPtr
+LazyVirtualHostCompiler::build(const envoy::config::route::v3::VirtualHost& config,
+                               const PerFilterConfigs::Prebuilt& per_filter_configs) {
+  // Per filter configs may allocate thread local slots, which is only possible on the main thread,
+  // so the ones created with the route table are used instead.
+  PerFilterConfigs::ScopedPrebuilt prebuilt(per_filter_configs);
+  return std::make_shared<VirtualHostImpl>(config, optional_http_filters_, global_route_config_,
+                                           factory_context_, scope_, validator_, absl::nullopt);
+}
+
+VirtualHostSharedPtr LazyVirtualHostCompiler::compile(const VirtualHostEntry& entry) {
+  VirtualHostSharedPtr virtual_host;
+  TRY_NEEDS_AUDIT { virtual_host = build(*entry.lazy_config_, entry.per_filter_configs_); }
+  END_TRY
+  catch (const EnvoyException& e) {
+    // The virtual host already compiled with the route table, so this isn't expected.
+    IS_ENVOY_BUG(
+        fmt::format("failed to compile virtual host {}: {}", entry.lazy_config_->name(), e.what()));
+    return nullptr;
+  }
+
+  // Released after the locks, since destroying a virtual host isn't free.
+  VirtualHostSharedPtr evicted_virtual_host;
+  absl::MutexLock lock(&mutex_);
+  if (max_compiled_virtual_hosts_ > 0 && compiled_.size() >= max_compiled_virtual_hosts_) {
+    // Give the virtual hosts used since the last sweep a second chance. After a full turn all the
+    // referenced bits are cleared, so the sweep stops even if the virtual hosts keep being used.
+    for (size_t swept = 0; swept < compiled_.size(); ++swept) {
+      if (!compiled_[clock_hand_]->referenced_.exchange(false, std::memory_order_relaxed)) {
+        break;
+      }
+      clock_hand_ = (clock_hand_ + 1) % compiled_.size();
+    }
+    const VirtualHostEntry& evicted = *compiled_[clock_hand_];
+    {
+      absl::WriterMutexLock evicted_lock(&evicted.mutex_);
+      evicted_virtual_host = std::move(evicted.compiled_);
+    }
+    ENVOY_LOG(debug, "evicted compiled virtual host {}", evicted.lazy_config_->name());
+    compiled_[clock_hand_] = &entry;
+    clock_hand_ = (clock_hand_ + 1) % compiled_.size();
+  } else {
+    compiled_.push_back(&entry);
+  }
+
+  // Published under the lock of the compiler, so that the entry can't be evicted before it is.
+  absl::WriterMutexLock entry_lock(&entry.mutex_);
+  entry.compiled_ = virtual_host;
+  return virtual_host;
+}
+
+PerFilterConfigs::Prebuilt LazyVirtualHostCompiler::createPerFilterConfigs(
+    const envoy::config::route::v3::VirtualHost& config) {
+  PerFilterConfigs::Prebuilt prebuilt;
+  const auto add = [&](const Protobuf::Map<std::string, ProtobufWkt::Any>& typed_configs) {
+    if (!typed_configs.empty()) {
+      prebuilt.emplace(&typed_configs, PerFilterConfigs(typed_configs, optional_http_filters_,
+                                                        factory_context_, validator_));
+    }
+  };
+  add(config.typed_per_filter_config());
+  for (const auto& route : config.routes()) {
+    add(route.typed_per_filter_config());
+    for (const auto& cluster : route.route().weighted_clusters().clusters()) {
+      add(cluster.typed_per_filter_config());
+    }
+  }
+  return prebuilt;
+}
+
+bool LazyVirtualHostCompiler::canCompileLazily(
+    const envoy::config::route::v3::VirtualHost& config) {
+  const auto creates_extensions = [](const envoy::config::route::v3::RetryPolicy& retry_policy) {
+    return !retry_policy.retry_host_predicate().empty() || retry_policy.has_retry_priority() ||
+           !retry_policy.retry_options_predicates().empty();
+  };
+  if (config.has_matcher() || creates_extensions(config.retry_policy())) {
+    return false;
+  }
+  for (const auto& route : config.routes()) {
+    const auto& action = route.route();
+    if (action.has_inline_cluster_specifier_plugin() || creates_extensions(action.retry_policy()) ||
+        !action.internal_redirect_policy().predicates().empty() ||
+        action.has_early_data_policy() || action.has_path_rewrite_policy() ||
+        route.match().has_path_match_policy()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+const VirtualHostEntry* RouteMatcher::findWildcardVirtualHost(
     absl::string_view host, const RouteMatcher::WildcardVirtualHosts& wildcard_virtual_hosts,
     RouteMatcher::SubstringFunction substring_function) const {
   // We do a longest wildcard match against the host that's passed in
@@ -1939,11 +2086,21 @@ RouteMatcher::RouteMatcher(const envoy::config::route::v3::RouteConfiguration& r
   absl::optional<Upstream::ClusterManager::ClusterInfoMaps> validation_clusters;
   if (validate_clusters) {
     validation_clusters = factory_context.clusterManager().clusters();
+  } else if (route_config.has_lazy_virtual_host_compilation()) {
+    lazy_compiler_ = std::make_unique<LazyVirtualHostCompiler>(
+        optional_http_filters, global_route_config, factory_context, *vhost_scope_, validator,
+        route_config.lazy_virtual_host_compilation().max_compiled_virtual_hosts());
   }
   for (const auto& virtual_host_config : route_config.virtual_hosts()) {
-    VirtualHostSharedPtr virtual_host = std::make_shared<VirtualHostImpl>(
-        virtual_host_config, optional_http_filters, global_route_config, factory_context,
-        *vhost_scope_, validator, validation_clusters);
+    VirtualHostEntrySharedPtr virtual_host;
+    if (lazy_compiler_ != nullptr &&
+        LazyVirtualHostCompiler::canCompileLazily(virtual_host_config)) {
+      virtual_host = std::make_shared<const VirtualHostEntry>(virtual_host_config, *lazy_compiler_);
+    } else {
+      virtual_host = std::make_shared<const VirtualHostEntry>(std::make_shared<VirtualHostImpl>(
+          virtual_host_config, optional_http_filters, global_route_config, factory_context,
+          *vhost_scope_, validator, validation_clusters));
+    }
     for (const std::string& domain_name : virtual_host_config.domains()) {
       const Http::LowerCaseString lower_case_domain_name(domain_name);
       absl::string_view domain = lower_case_domain_name;
@@ -1974,7 +2131,7 @@ RouteMatcher::RouteMatcher(const envoy::config::route::v3::RouteConfiguration& r
   }
 }
 
-const VirtualHostImpl* RouteMatcher::findVirtualHost(const Http::RequestHeaderMap& headers) const {
+const VirtualHostEntry* RouteMatcher::findVirtualHost(const Http::RequestHeaderMap& headers) const {
   // Fast path the case where we only have a default virtual host.
   if (virtual_hosts_.empty() && wildcard_virtual_host_suffixes_.empty() &&
       wildcard_virtual_host_prefixes_.empty()) {
@@ -2004,7 +2161,7 @@ const VirtualHostImpl* RouteMatcher::findVirtualHost(const Http::RequestHeaderMa
     return iter->second.get();
   }
   if (!wildcard_virtual_host_suffixes_.empty()) {
-    const VirtualHostImpl* vhost = findWildcardVirtualHost(
+    const VirtualHostEntry* vhost = findWildcardVirtualHost(
         host, wildcard_virtual_host_suffixes_,
         [](absl::string_view h, int l) -> absl::string_view { return h.substr(h.size() - l); });
     if (vhost != nullptr) {
@@ -2012,7 +2169,7 @@ const VirtualHostImpl* RouteMatcher::findVirtualHost(const Http::RequestHeaderMa
     }
   }
   if (!wildcard_virtual_host_prefixes_.empty()) {
-    const VirtualHostImpl* vhost = findWildcardVirtualHost(
+    const VirtualHostEntry* vhost = findWildcardVirtualHost(
         host, wildcard_virtual_host_prefixes_,
         [](absl::string_view h, int l) -> absl::string_view { return h.substr(0, l); });
     if (vhost != nullptr) {
@@ -2026,9 +2183,9 @@ RouteConstSharedPtr RouteMatcher::route(const RouteCallback& cb,
                                         const Http::RequestHeaderMap& headers,
                                         const StreamInfo::StreamInfo& stream_info,
                                         uint64_t random_value) const {
-  const VirtualHostImpl* virtual_host = findVirtualHost(headers);
+  const VirtualHostEntry* virtual_host = findVirtualHost(headers);
   if (virtual_host) {
-    return virtual_host->getRouteFromEntries(cb, headers, stream_info, random_value);
+    return virtual_host->route(cb, headers, stream_info, random_value);
   } else {
     return nullptr;
   }
@@ -2126,6 +2283,20 @@ RouteConstSharedPtr ConfigImpl::route(const RouteCallback& cb,
   return route_matcher_->route(cb, headers, stream_info, random_value);
 }
 
+namespace {
+
+// The prebuilt per filter configs in scope on this thread, if any.
+thread_local const PerFilterConfigs::Prebuilt* prebuilt_per_filter_configs = nullptr;
+
+} // namespace
+
+PerFilterConfigs::ScopedPrebuilt::ScopedPrebuilt(const Prebuilt& prebuilt)
+    : previous_(prebuilt_per_filter_configs) {
+  prebuilt_per_filter_configs = &prebuilt;
+}
+
+PerFilterConfigs::ScopedPrebuilt::~ScopedPrebuilt() { prebuilt_per_filter_configs = previous_; }
+
 RouteSpecificFilterConfigConstSharedPtr PerFilterConfigs::createRouteSpecificFilterConfig(
     const std::string& name, const ProtobufWkt::Any& typed_config, bool is_optional,
     Server::Configuration::ServerFactoryContext& factory_context,
@@ -2169,6 +2340,13 @@ PerFilterConfigs::PerFilterConfigs(
     const OptionalHttpFilters& optional_http_filters,
     Server::Configuration::ServerFactoryContext& factory_context,
     ProtobufMessage::ValidationVisitor& validator) {
+  if (prebuilt_per_filter_configs != nullptr) {
+    const auto it = prebuilt_per_filter_configs->find(&typed_configs);
+    if (it != prebuilt_per_filter_configs->end()) {
+      configs_ = it->second.configs_;
+      return;
+    }
+  }
 
   const bool ignore_optional_option_from_hcm_for_route_config(Runtime::runtimeFeatureEnabled(
       "envoy.reloadable_features.ignore_optional_option_from_hcm_for_route_config"));
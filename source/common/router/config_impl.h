@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <cstdint>
 #include <iterator>
@@ -36,7 +37,9 @@
 #include "source/common/router/tls_context_match_criteria_impl.h"
 #include "source/common/stats/symbol_table.h"
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/node_hash_map.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/optional.h"
 
 namespace Envoy {
@@ -86,6 +89,26 @@ public:
     bool disabled_{};
   };
 
+  /**
+   * Per filter configs created ahead of time, by the typed_per_filter_config field they were
+   * created from.
+   */
+  using Prebuilt =
+      absl::flat_hash_map<const Protobuf::Map<std::string, ProtobufWkt::Any>*, PerFilterConfigs>;
+
+  /**
+   * While in scope, the PerFilterConfigs created on the current thread from one of the fields of
+   * prebuilt reuse its configs rather than creating them.
+   */
+  class ScopedPrebuilt {
+  public:
+    explicit ScopedPrebuilt(const Prebuilt& prebuilt);
+    ~ScopedPrebuilt();
+
+  private:
+    const Prebuilt* const previous_;
+  };
+
   PerFilterConfigs(const Protobuf::Map<std::string, ProtobufWkt::Any>& typed_configs,
                    const OptionalHttpFilters& optional_http_filters,
                    Server::Configuration::ServerFactoryContext& factory_context,
@@ -394,6 +417,115 @@ private:
 
 using VirtualHostSharedPtr = std::shared_ptr<VirtualHostImpl>;
 
+class LazyVirtualHostCompiler;
+
+/**
+ * A virtual host indexed by the domains of a route table. The virtual host is either compiled with
+ * the route table or, with lazy virtual host compilation, by the first request that matches it, in
+ * which case it may later be evicted and compiled again by its LazyVirtualHostCompiler. A lazily
+ * compiled virtual host is still compiled once with the route table, and then released, so that
+ * its errors reject the route table. Its per filter configs are created with the route table, on
+ * the main thread, since they may allocate thread local slots, and they live as long as the entry.
+ */
+class VirtualHostEntry {
+public:
+  explicit VirtualHostEntry(VirtualHostSharedPtr virtual_host)
+      : virtual_host_(std::move(virtual_host)) {}
+  VirtualHostEntry(const envoy::config::route::v3::VirtualHost& config,
+                   LazyVirtualHostCompiler& compiler);
+
+  RouteConstSharedPtr route(const RouteCallback& cb, const Http::RequestHeaderMap& headers,
+                            const StreamInfo::StreamInfo& stream_info, uint64_t random_value) const;
+
+private:
+  friend class LazyVirtualHostCompiler;
+
+  // Returns the lazily compiled virtual host, compiling it on first use, or nullptr if it failed to
+  // compile.
+  VirtualHostSharedPtr lazyVirtualHost() const;
+  // Returns the compiled virtual host, or nullptr if it isn't compiled.
+  VirtualHostSharedPtr compiledVirtualHost() const;
+
+  // Set if the virtual host is compiled with the route table.
+  const VirtualHostSharedPtr virtual_host_;
+  // Set if the virtual host is compiled lazily.
+  const std::unique_ptr<const envoy::config::route::v3::VirtualHost> lazy_config_;
+  LazyVirtualHostCompiler* const compiler_{};
+  // The per filter configs of the lazily compiled virtual host.
+  const PerFilterConfigs::Prebuilt per_filter_configs_;
+  // Serializes the compilations of this virtual host, so that concurrent requests compile it only
+  // once. Acquired before the lock of the compiler.
+  mutable absl::Mutex compile_mutex_;
+  mutable absl::Mutex mutex_ ABSL_ACQUIRED_AFTER(compile_mutex_);
+  mutable VirtualHostSharedPtr compiled_ ABSL_GUARDED_BY(mutex_);
+  // Set on every use of a lazily compiled virtual host, and cleared by the eviction sweep of the
+  // compiler.
+  mutable std::atomic<bool> referenced_{};
+};
+
+using VirtualHostEntrySharedPtr = std::shared_ptr<const VirtualHostEntry>;
+
+/**
+ * Compiles the lazily compiled virtual hosts of a route table. When the number of compiled virtual
+ * hosts is bounded, the virtual hosts that weren't used recently are evicted with a CLOCK sweep, so
+ * that using a compiled virtual host only sets its referenced bit.
+ */
+class LazyVirtualHostCompiler : Logger::Loggable<Logger::Id::router> {
+public:
+  LazyVirtualHostCompiler(const OptionalHttpFilters& optional_http_filters,
+                          const CommonConfigSharedPtr& global_route_config,
+                          Server::Configuration::ServerFactoryContext& factory_context,
+                          Stats::Scope& scope, ProtobufMessage::ValidationVisitor& validator,
+                          uint32_t max_compiled_virtual_hosts);
+
+  /**
+   * Compiles the virtual host of an entry, which must not be compiled, and publishes it in the
+   * entry. The compilation itself doesn't hold any lock shared with other entries.
+   * @param entry supplies the entry of the virtual host.
+   * @return the compiled virtual host, or nullptr if it failed to compile.
+   */
+  VirtualHostSharedPtr compile(const VirtualHostEntry& entry);
+
+  /**
+   * Compiles a virtual host.
+   * @param config supplies the config of the virtual host.
+   * @param per_filter_configs supplies the per filter configs created for config.
+   * @return the compiled virtual host.
+   * @throw EnvoyException if the virtual host is invalid.
+   */
+  VirtualHostSharedPtr build(const envoy::config::route::v3::VirtualHost& config,
+                             const PerFilterConfigs::Prebuilt& per_filter_configs);
+
+  /**
+   * Creates the per filter configs of a virtual host, its routes and their weighted clusters.
+   * @param config supplies the config of the virtual host, which must outlive the result.
+   * @return the per filter configs, by the field they were created from.
+   */
+  PerFilterConfigs::Prebuilt
+  createPerFilterConfigs(const envoy::config::route::v3::VirtualHost& config);
+
+  /**
+   * @return whether a virtual host can be compiled lazily. Virtual hosts that create extensions
+   * other than per filter configs, such as match trees, inline cluster specifier plugins, retry
+   * and internal redirect predicates, early data policies or path matchers and rewriters, are
+   * compiled with the route table, since those extensions may only be created on the main thread.
+   */
+  static bool canCompileLazily(const envoy::config::route::v3::VirtualHost& config);
+
+private:
+  const OptionalHttpFilters optional_http_filters_;
+  const CommonConfigSharedPtr global_route_config_;
+  Server::Configuration::ServerFactoryContext& factory_context_;
+  Stats::Scope& scope_;
+  ProtobufMessage::ValidationVisitor& validator_;
+  const uint32_t max_compiled_virtual_hosts_;
+  // Protects the CLOCK list of compiled virtual hosts. It's only held to publish a compiled virtual
+  // host and evict another one, not while compiling.
+  absl::Mutex mutex_;
+  std::vector<const VirtualHostEntry*> compiled_ ABSL_GUARDED_BY(mutex_);
+  size_t clock_hand_ ABSL_GUARDED_BY(mutex_){};
+};
+
 /**
  * Implementation of RetryPolicy that reads from the proto route or virtual host config.
  */
@@ -1506,19 +1638,23 @@ public:
   RouteConstSharedPtr route(const RouteCallback& cb, const Http::RequestHeaderMap& headers,
                             const StreamInfo::StreamInfo& stream_info, uint64_t random_value) const;
 
-  const VirtualHostImpl* findVirtualHost(const Http::RequestHeaderMap& headers) const;
+  const VirtualHostEntry* findVirtualHost(const Http::RequestHeaderMap& headers) const;
 
 private:
   using WildcardVirtualHosts =
-      std::map<int64_t, absl::node_hash_map<std::string, VirtualHostSharedPtr>, std::greater<>>;
+      std::map<int64_t, absl::node_hash_map<std::string, VirtualHostEntrySharedPtr>,
+               std::greater<>>;
   using SubstringFunction = std::function<absl::string_view(absl::string_view, int)>;
-  const VirtualHostImpl* findWildcardVirtualHost(absl::string_view host,
-                                                 const WildcardVirtualHosts& wildcard_virtual_hosts,
-                                                 SubstringFunction substring_function) const;
+  const VirtualHostEntry*
+  findWildcardVirtualHost(absl::string_view host,
+                          const WildcardVirtualHosts& wildcard_virtual_hosts,
+                          SubstringFunction substring_function) const;
   bool ignorePortInHostMatching() const { return ignore_port_in_host_matching_; }
 
   Stats::ScopeSharedPtr vhost_scope_;
-  absl::node_hash_map<std::string, VirtualHostSharedPtr> virtual_hosts_;
+  // Set if the virtual hosts are compiled lazily.
+  std::unique_ptr<LazyVirtualHostCompiler> lazy_compiler_;
+  absl::node_hash_map<std::string, VirtualHostEntrySharedPtr> virtual_hosts_;
   // std::greater as a minor optimization to iterate from more to less specific
   //
   // A note on using an unordered_map versus a vector of (string, VirtualHostSharedPtr) pairs:
@@ -1531,7 +1667,7 @@ private:
   WildcardVirtualHosts wildcard_virtual_host_suffixes_;
   WildcardVirtualHosts wildcard_virtual_host_prefixes_;
 
-  VirtualHostSharedPtr default_virtual_host_;
+  VirtualHostEntrySharedPtr default_virtual_host_;
   const bool ignore_port_in_host_matching_{false};
 };
 
@@ -1,9 +1,12 @@
 #include "source/common/runtime/runtime_features.h"
 
+#include "source/common/common/macros.h"
+
 #include "absl/flags/commandlineflag.h"
 #include "absl/flags/flag.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_replace.h"
+#include "absl/synchronization/mutex.h"
 
 #define RUNTIME_GUARD(name) ABSL_FLAG(bool, name, true, "");        // NOLINT
 #define FALSE_RUNTIME_GUARD(name) ABSL_FLAG(bool, name, false, ""); // NOLINT
@@ -91,6 +94,7 @@ RUNTIME_GUARD(envoy_restart_features_explicit_wildcard_resource);
 RUNTIME_GUARD(envoy_restart_features_remove_runtime_singleton);
 RUNTIME_GUARD(envoy_restart_features_udp_read_normalize_addresses);
 RUNTIME_GUARD(envoy_restart_features_use_apple_api_for_dns_lookups);
+RUNTIME_GUARD(envoy_restart_features_use_fast_protobuf_hash);
 
 // Begin false flags. These should come with a TODO to flip true.
 // Sentinel and test flag.
@@ -106,6 +110,10 @@ FALSE_RUNTIME_GUARD(envoy_reloadable_features_defer_processing_backedup_streams)
 FALSE_RUNTIME_GUARD(envoy_reloadable_features_http2_use_oghttp2);
 // TODO(bencebeky): Flip true after sufficient canarying.
 FALSE_RUNTIME_GUARD(envoy_reloadable_features_http1_use_balsa_parser);
+// TODO(mattklein123): Flip true after the timer wheel has had sufficient soak time.
+FALSE_RUNTIME_GUARD(envoy_reloadable_features_coarse_timer_wheel);
+// TODO(wbpcode): Flip true after the per-thread access log buffers have had sufficient soak time.
+FALSE_RUNTIME_GUARD(envoy_reloadable_features_sharded_access_log_writes);
 // Used to track if runtime is initialized.
 FALSE_RUNTIME_GUARD(envoy_reloadable_features_runtime_initialized);
 // TODO(mattklein123): Flip this to true and/or remove completely once verified by Envoy Mobile.
@@ -194,6 +202,88 @@ bool runtimeFeatureEnabled(absl::string_view feature) {
   return flag->TryGet<bool>().value();
 }
 
+namespace {
+
+// The runtime keys interned by internKey(). The registry doesn't own the keys: they are owned by
+// the InternedKeys referring to them, and removed from the registry when the last one is released.
+class InternedKeyRegistry {
+public:
+  InternedKey intern(absl::string_view key) {
+    absl::MutexLock lock(&mutex_);
+    auto it = keys_.find(key);
+    if (it != keys_.end()) {
+      if (std::shared_ptr<const InternedKey::Data> data = it->second.lock(); data != nullptr) {
+        return InternedKey(std::move(data));
+      }
+      // The last reference is being released concurrently, and release() will leave the new key
+      // alone. The map's key points into the released data, so it must be replaced.
+      keys_.erase(it);
+    }
+    uint32_t index;
+    if (free_indexes_.empty()) {
+      index = slots_.size();
+      slots_.push_back(nullptr);
+    } else {
+      index = free_indexes_.back();
+      free_indexes_.pop_back();
+    }
+    const auto* raw = new InternedKey::Data{std::string(key), index, next_id_++};
+    std::shared_ptr<const InternedKey::Data> data(
+        raw, [this](const InternedKey::Data* data) { release(data); });
+    slots_[index] = raw;
+    keys_.emplace(raw->name_, data);
+    view_.reset();
+    return InternedKey(std::move(data));
+  }
+
+  std::shared_ptr<const InternedKeySlots> view() {
+    absl::MutexLock lock(&mutex_);
+    if (view_ == nullptr) {
+      auto view = std::make_shared<InternedKeySlots>(slots_.size());
+      for (uint32_t index = 0; index < slots_.size(); ++index) {
+        if (slots_[index] != nullptr) {
+          (*view)[index] = {slots_[index]->name_, slots_[index]->id_};
+        }
+      }
+      view_ = std::move(view);
+    }
+    return view_;
+  }
+
+private:
+  void release(const InternedKey::Data* data) {
+    {
+      absl::MutexLock lock(&mutex_);
+      slots_[data->index_] = nullptr;
+      free_indexes_.push_back(data->index_);
+      auto it = keys_.find(data->name_);
+      if (it != keys_.end() && it->first.data() == data->name_.data()) {
+        keys_.erase(it);
+      }
+      view_.reset();
+    }
+    delete data;
+  }
+
+  absl::Mutex mutex_;
+  // Keyed by views of the names held by the data.
+  absl::flat_hash_map<absl::string_view, std::weak_ptr<const InternedKey::Data>>
+      keys_ ABSL_GUARDED_BY(mutex_);
+  std::vector<const InternedKey::Data*> slots_ ABSL_GUARDED_BY(mutex_);
+  std::vector<uint32_t> free_indexes_ ABSL_GUARDED_BY(mutex_);
+  uint64_t next_id_ ABSL_GUARDED_BY(mutex_){1};
+  // Built on demand for the snapshots, and dropped when the keys change.
+  std::shared_ptr<const InternedKeySlots> view_ ABSL_GUARDED_BY(mutex_);
+};
+
+InternedKeyRegistry& internedKeyRegistry() { MUTABLE_CONSTRUCT_ON_FIRST_USE(InternedKeyRegistry); }
+
+} // namespace
+
+InternedKey internKey(absl::string_view key) { return internedKeyRegistry().intern(key); }
+
+std::shared_ptr<const InternedKeySlots> internedKeys() { return internedKeyRegistry().view(); }
+
 uint64_t getInteger(absl::string_view feature, uint64_t default_value) {
   // DO NOT ADD MORE FLAGS HERE. This function deprecated.
   if (absl::StartsWith(feature, "re2.")) {
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "envoy/runtime/runtime.h"
 
@@ -24,6 +26,23 @@ bool isRuntimeInitialized();
 void maybeSetRuntimeGuard(absl::string_view name, bool value);
 
 void maybeSetDeprecatedInts(absl::string_view name, uint32_t value);
+
+// Interns a runtime key for lookups by index in the snapshots created from then on. Interning the
+// same key again while it is interned returns the same index. Meant to be called when loading the
+// configuration using the key, not on the request path.
+InternedKey internKey(absl::string_view key);
+
+// An interned key, as seen by the snapshots. Unused indexes have an id_ of 0.
+struct InternedKeySlot {
+  std::string name_;
+  uint64_t id_{0};
+};
+using InternedKeySlots = std::vector<InternedKeySlot>;
+
+// Returns the currently interned keys, indexed by their index. The returned vector is shared until
+// keys are interned or released, so that creating a snapshot doesn't copy the keys.
+std::shared_ptr<const InternedKeySlots> internedKeys();
+
 constexpr absl::string_view defer_processing_backedup_streams =
     "envoy.reloadable_features.defer_processing_backedup_streams";
 constexpr absl::string_view expand_agnostic_stream_lifetime =
@@ -106,15 +106,7 @@ bool SnapshotImpl::featureEnabled(absl::string_view key, uint64_t default_value,
 }
 
 bool SnapshotImpl::featureEnabled(absl::string_view key, uint64_t default_value) const {
-  // Avoid PRNG if we know we don't need it.
-  uint64_t cutoff = std::min(getInteger(key, default_value), static_cast<uint64_t>(100));
-  if (cutoff == 0) {
-    return false;
-  } else if (cutoff == 100) {
-    return true;
-  } else {
-    return generator_.random() % 100 < cutoff;
-  }
+  return percentEnabled(getInteger(key, default_value));
 }
 
 bool SnapshotImpl::featureEnabled(absl::string_view key, uint64_t default_value,
@@ -140,22 +132,103 @@ bool SnapshotImpl::featureEnabled(absl::string_view key,
 bool SnapshotImpl::featureEnabled(absl::string_view key,
                                   const envoy::type::v3::FractionalPercent& default_value,
                                   uint64_t random_value) const {
-  const auto& entry = key.empty() ? values_.end() : values_.find(key);
+  return fractionalPercentEnabled(key, findEntry(key), default_value, random_value);
+}
+
+uint64_t SnapshotImpl::getInteger(absl::string_view key, uint64_t default_value) const {
+  ASSERT(!isRuntimeFeature(key));
+  return integerValue(findEntry(key), default_value);
+}
+
+double SnapshotImpl::getDouble(absl::string_view key, double default_value) const {
+  ASSERT(!isRuntimeFeature(key)); // Make sure runtime guarding is only used for getBoolean
+  return doubleValue(findEntry(key), default_value);
+}
+
+bool SnapshotImpl::getBoolean(absl::string_view key, bool default_value) const {
+  return booleanValue(findEntry(key), default_value);
+}
+
+bool SnapshotImpl::featureEnabled(const InternedKey& key, uint64_t default_value) const {
+  return percentEnabled(getInteger(key, default_value));
+}
+
+bool SnapshotImpl::featureEnabled(const InternedKey& key, uint64_t default_value,
+                                  uint64_t random_value) const {
+  return random_value % 100 < std::min(getInteger(key, default_value), static_cast<uint64_t>(100));
+}
+
+bool SnapshotImpl::featureEnabled(const InternedKey& key,
+                                  const envoy::type::v3::FractionalPercent& default_value) const {
+  return featureEnabled(key, default_value, generator_.random());
+}
+
+bool SnapshotImpl::featureEnabled(const InternedKey& key,
+                                  const envoy::type::v3::FractionalPercent& default_value,
+                                  uint64_t random_value) const {
+  return fractionalPercentEnabled(key.name(), findEntry(key), default_value, random_value);
+}
+
+uint64_t SnapshotImpl::getInteger(const InternedKey& key, uint64_t default_value) const {
+  ASSERT(!isRuntimeFeature(key.name()));
+  return integerValue(findEntry(key), default_value);
+}
+
+double SnapshotImpl::getDouble(const InternedKey& key, double default_value) const {
+  ASSERT(!isRuntimeFeature(key.name()));
+  return doubleValue(findEntry(key), default_value);
+}
+
+bool SnapshotImpl::getBoolean(const InternedKey& key, bool default_value) const {
+  return booleanValue(findEntry(key), default_value);
+}
+
+const Snapshot::Entry* SnapshotImpl::findEntry(absl::string_view key) const {
+  if (key.empty()) {
+    return nullptr;
+  }
+  const auto entry = values_.find(key);
+  return entry == values_.end() ? nullptr : &entry->second;
+}
+
+const Snapshot::Entry* SnapshotImpl::findEntry(const InternedKey& key) const {
+  if (key.index() < interned_entries_.size() && interned_entries_[key.index()].first == key.id()) {
+    return interned_entries_[key.index()].second;
+  }
+  // The key was interned after this snapshot was created.
+  return findEntry(key.name());
+}
+
+bool SnapshotImpl::percentEnabled(uint64_t percent) const {
+  // Avoid PRNG if we know we don't need it.
+  uint64_t cutoff = std::min(percent, static_cast<uint64_t>(100));
+  if (cutoff == 0) {
+    return false;
+  } else if (cutoff == 100) {
+    return true;
+  } else {
+    return generator_.random() % 100 < cutoff;
+  }
+}
+
+bool SnapshotImpl::fractionalPercentEnabled(
+    absl::string_view key, const Entry* entry,
+    const envoy::type::v3::FractionalPercent& default_value, uint64_t random_value) const {
   envoy::type::v3::FractionalPercent percent;
-  if (entry != values_.end() && entry->second.fractional_percent_value_.has_value()) {
-    percent = entry->second.fractional_percent_value_.value();
-  } else if (entry != values_.end() && entry->second.uint_value_.has_value()) {
+  if (entry != nullptr && entry->fractional_percent_value_.has_value()) {
+    percent = entry->fractional_percent_value_.value();
+  } else if (entry != nullptr && entry->uint_value_.has_value()) {
     // Check for > 100 because the runtime value is assumed to be specified as
     // an integer, and it also ensures that truncating the uint64_t runtime
     // value into a uint32_t percent numerator later is safe
-    if (entry->second.uint_value_.value() > 100) {
+    if (entry->uint_value_.value() > 100) {
       return true;
     }
 
     // The runtime value was specified as an integer rather than a fractional
     // percent proto. To preserve legacy semantics, we treat it as a percentage
     // (i.e. denominator of 100).
-    percent.set_numerator(entry->second.uint_value_.value());
+    percent.set_numerator(entry->uint_value_.value());
     percent.set_denominator(envoy::type::v3::FractionalPercent::HUNDRED);
   } else {
     percent = default_value;
@@ -176,32 +249,27 @@ bool SnapshotImpl::featureEnabled(absl::string_view key,
   return ProtobufPercentHelper::evaluateFractionalPercent(percent, random_value);
 }
 
-uint64_t SnapshotImpl::getInteger(absl::string_view key, uint64_t default_value) const {
-  ASSERT(!isRuntimeFeature(key));
-  const auto& entry = key.empty() ? values_.end() : values_.find(key);
-  if (entry == values_.end() || !entry->second.uint_value_) {
+uint64_t SnapshotImpl::integerValue(const Entry* entry, uint64_t default_value) {
+  if (entry == nullptr || !entry->uint_value_) {
     return default_value;
   } else {
-    return entry->second.uint_value_.value();
+    return entry->uint_value_.value();
   }
 }
 
-double SnapshotImpl::getDouble(absl::string_view key, double default_value) const {
-  ASSERT(!isRuntimeFeature(key)); // Make sure runtime guarding is only used for getBoolean
-  const auto& entry = key.empty() ? values_.end() : values_.find(key);
-  if (entry == values_.end() || !entry->second.double_value_) {
+double SnapshotImpl::doubleValue(const Entry* entry, double default_value) {
+  if (entry == nullptr || !entry->double_value_) {
     return default_value;
   } else {
-    return entry->second.double_value_.value();
+    return entry->double_value_.value();
   }
 }
 
-bool SnapshotImpl::getBoolean(absl::string_view key, bool default_value) const {
-  const auto& entry = key.empty() ? values_.end() : values_.find(key);
-  if (entry == values_.end() || !entry->second.bool_value_.has_value()) {
+bool SnapshotImpl::booleanValue(const Entry* entry, bool default_value) {
+  if (entry == nullptr || !entry->bool_value_.has_value()) {
     return default_value;
   } else {
-    return entry->second.bool_value_.value();
+    return entry->bool_value_.value();
   }
 }
 
@@ -220,6 +288,12 @@ SnapshotImpl::SnapshotImpl(Random::RandomGenerator& generator, RuntimeStats& sta
       values_.emplace(kv.first, kv.second);
     }
   }
+  // values_ isn't modified from here on, so pointers to its entries stay valid.
+  const std::shared_ptr<const InternedKeySlots> interned_keys = internedKeys();
+  interned_entries_.reserve(interned_keys->size());
+  for (const InternedKeySlot& slot : *interned_keys) {
+    interned_entries_.emplace_back(slot.id_, slot.id_ == 0 ? nullptr : findEntry(slot.name_));
+  }
   stats.num_keys_.set(values_.size());
 }
 
@@ -83,6 +83,17 @@ public:
   uint64_t getInteger(absl::string_view key, uint64_t default_value) const override;
   double getDouble(absl::string_view key, double default_value) const override;
   bool getBoolean(absl::string_view key, bool value) const override;
+  bool featureEnabled(const InternedKey& key, uint64_t default_value) const override;
+  bool featureEnabled(const InternedKey& key, uint64_t default_value,
+                      uint64_t random_value) const override;
+  bool featureEnabled(const InternedKey& key,
+                      const envoy::type::v3::FractionalPercent& default_value) const override;
+  bool featureEnabled(const InternedKey& key,
+                      const envoy::type::v3::FractionalPercent& default_value,
+                      uint64_t random_value) const override;
+  uint64_t getInteger(const InternedKey& key, uint64_t default_value) const override;
+  double getDouble(const InternedKey& key, double default_value) const override;
+  bool getBoolean(const InternedKey& key, bool default_value) const override;
   const std::vector<OverrideLayerConstPtr>& getLayers() const override;
 
   const EntryMap& values() const;
@@ -93,8 +104,21 @@ public:
                        const ProtobufWkt::Value& value, absl::string_view raw_string = "");
 
 private:
+  const Entry* findEntry(absl::string_view key) const;
+  const Entry* findEntry(const InternedKey& key) const;
+  bool percentEnabled(uint64_t percent) const;
+  bool fractionalPercentEnabled(absl::string_view key, const Entry* entry,
+                                const envoy::type::v3::FractionalPercent& default_value,
+                                uint64_t random_value) const;
+  static uint64_t integerValue(const Entry* entry, uint64_t default_value);
+  static double doubleValue(const Entry* entry, double default_value);
+  static bool booleanValue(const Entry* entry, bool default_value);
+
   const std::vector<OverrideLayerConstPtr> layers_;
   EntryMap values_;
+  // The entries of the keys interned when the snapshot was created, indexed by the index of the
+  // keys, along with the id of the key. nullptr for the keys that have no value.
+  std::vector<std::pair<uint64_t, const Entry*>> interned_entries_;
   Random::RandomGenerator& generator_;
   RuntimeStats& stats_;
 };
@@ -2,6 +2,8 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <new>
+#include <utility>
 
 #include "envoy/stats/sink.h"
 #include "envoy/stats/stats.h"
@@ -13,6 +15,7 @@
 #include "source/common/common/thread_annotations.h"
 #include "source/common/common/utility.h"
 #include "source/common/stats/metric_impl.h"
+#include "source/common/stats/slab_allocator.h"
 #include "source/common/stats/stat_merger.h"
 #include "source/common/stats/symbol_table.h"
 
@@ -67,12 +70,15 @@ void AllocatorImpl::debugPrint() {
 //
 // We implement the RefcountInterface API to avoid weak counter and destructor overhead in
 // shared_ptr.
-template <class BaseClass> class StatsSharedImpl : public MetricImpl<BaseClass> {
+//
+// MetricBase is either MetricImpl, or InlineMetricImpl for the records of the
+// compact storage mode.
+template <class BaseClass, class MetricBase = MetricImpl<BaseClass>>
+class StatsSharedImpl : public MetricBase {
 public:
   StatsSharedImpl(StatName name, AllocatorImpl& alloc, StatName tag_extracted_name,
                   const StatNameTagVector& stat_name_tags)
-      : MetricImpl<BaseClass>(name, tag_extracted_name, stat_name_tags, alloc.symbolTable()),
-        alloc_(alloc) {}
+      : MetricBase(name, tag_extracted_name, stat_name_tags, alloc.symbolTable()), alloc_(alloc) {}
 
   ~StatsSharedImpl() override {
     // MetricImpl must be explicitly cleared() before destruction, otherwise it
@@ -136,16 +142,17 @@ protected:
   std::atomic<uint16_t> flags_{0};
 };
 
-class CounterImpl : public StatsSharedImpl<Counter> {
+template <class MetricBase = MetricImpl<Counter>>
+class CounterImpl : public StatsSharedImpl<Counter, MetricBase> {
 public:
   CounterImpl(StatName name, AllocatorImpl& alloc, StatName tag_extracted_name,
               const StatNameTagVector& stat_name_tags)
-      : StatsSharedImpl(name, alloc, tag_extracted_name, stat_name_tags) {}
+      : StatsSharedImpl<Counter, MetricBase>(name, alloc, tag_extracted_name, stat_name_tags) {}
 
-  void removeFromSetLockHeld() ABSL_EXCLUSIVE_LOCKS_REQUIRED(alloc_.mutex_) override {
-    const size_t count = alloc_.counters_.erase(statName());
+  void removeFromSetLockHeld() ABSL_EXCLUSIVE_LOCKS_REQUIRED(this->alloc_.mutex_) override {
+    const size_t count = this->alloc_.counters_.erase(this->statName());
     ASSERT(count == 1);
-    alloc_.sinked_counters_.erase(this);
+    this->alloc_.sinked_counters_.erase(this);
   }
 
   // Stats::Counter
@@ -154,7 +161,7 @@ public:
     // used(). From a system perspective this should be eventually consistent.
     value_ += amount;
     pending_increment_ += amount;
-    flags_ |= Flags::Used;
+    this->flags_ |= Metric::Flags::Used;
   }
   void inc() override { add(1); }
   uint64_t latch() override { return pending_increment_.exchange(0); }
@@ -166,17 +173,21 @@ private:
   std::atomic<uint64_t> pending_increment_{0};
 };
 
-class GaugeImpl : public StatsSharedImpl<Gauge> {
+template <class MetricBase = MetricImpl<Gauge>>
+class GaugeImpl : public StatsSharedImpl<Gauge, MetricBase> {
 public:
+  using ImportMode = Gauge::ImportMode;
+  using Flags = Metric::Flags;
+
   GaugeImpl(StatName name, AllocatorImpl& alloc, StatName tag_extracted_name,
             const StatNameTagVector& stat_name_tags, ImportMode import_mode)
-      : StatsSharedImpl(name, alloc, tag_extracted_name, stat_name_tags) {
+      : StatsSharedImpl<Gauge, MetricBase>(name, alloc, tag_extracted_name, stat_name_tags) {
     switch (import_mode) {
     case ImportMode::Accumulate:
-      flags_ |= Flags::LogicAccumulate;
+      this->flags_ |= Flags::LogicAccumulate;
       break;
     case ImportMode::NeverImport:
-      flags_ |= Flags::NeverImport;
+      this->flags_ |= Flags::NeverImport;
       break;
     case ImportMode::Uninitialized:
       // Note that we don't clear any flag bits for import_mode==Uninitialized,
@@ -185,43 +196,47 @@ public:
       // https://github.com/envoyproxy/envoy/issues/7227.
       break;
     case ImportMode::HiddenAccumulate:
-      flags_ |= Flags::Hidden;
-      flags_ |= Flags::LogicAccumulate;
+      this->flags_ |= Flags::Hidden;
+      this->flags_ |= Flags::LogicAccumulate;
       break;
     }
   }
 
-  void removeFromSetLockHeld() override ABSL_EXCLUSIVE_LOCKS_REQUIRED(alloc_.mutex_) {
-    const size_t count = alloc_.gauges_.erase(statName());
+  void removeFromSetLockHeld() override ABSL_EXCLUSIVE_LOCKS_REQUIRED(this->alloc_.mutex_) {
+    const size_t count = this->alloc_.gauges_.erase(this->statName());
     ASSERT(count == 1);
-    alloc_.sinked_gauges_.erase(this);
+    this->alloc_.sinked_gauges_.erase(this);
   }
 
   // Stats::Gauge
   void add(uint64_t amount) override {
     child_value_ += amount;
-    flags_ |= Flags::Used;
+    this->flags_ |= amount == 0 ? Flags::Used : (Flags::Used | Flags::Changed);
   }
   void dec() override { sub(1); }
   void inc() override { add(1); }
   void set(uint64_t value) override {
-    child_value_ = value;
-    flags_ |= Flags::Used;
+    // Many gauges are periodically set to the value they already have, which is not a change.
+    const uint64_t previous = child_value_.exchange(value);
+    this->flags_ |= previous == value ? Flags::Used : (Flags::Used | Flags::Changed);
   }
   void sub(uint64_t amount) override {
     ASSERT(child_value_ >= amount);
-    ASSERT(used() || amount == 0);
+    ASSERT(this->used() || amount == 0);
     child_value_ -= amount;
+    if (amount != 0) {
+      this->flags_ |= Flags::Changed;
+    }
   }
   uint64_t value() const override { return child_value_ + parent_value_; }
 
   // TODO(diazalan): Rename importMode and to more generic name
   ImportMode importMode() const override {
-    if (flags_ & Flags::NeverImport) {
+    if (this->flags_ & Flags::NeverImport) {
       return ImportMode::NeverImport;
-    } else if ((flags_ & Flags::Hidden) && (flags_ & Flags::LogicAccumulate)) {
+    } else if ((this->flags_ & Flags::Hidden) && (this->flags_ & Flags::LogicAccumulate)) {
       return ImportMode::HiddenAccumulate;
-    } else if (flags_ & Flags::LogicAccumulate) {
+    } else if (this->flags_ & Flags::LogicAccumulate) {
       return ImportMode::Accumulate;
     }
     return ImportMode::Uninitialized;
@@ -241,7 +256,7 @@ public:
       break;
     case ImportMode::Accumulate:
       ASSERT(current == ImportMode::Uninitialized);
-      flags_ |= Flags::LogicAccumulate;
+      this->flags_ |= Flags::LogicAccumulate;
       break;
     case ImportMode::NeverImport:
       ASSERT(current == ImportMode::Uninitialized);
@@ -249,24 +264,65 @@ public:
       // thought was Accumulate. But the new version thinks it's NeverImport, so
       // we clear the accumulated value.
       parent_value_ = 0;
-      flags_ &= ~Flags::Used;
-      flags_ |= Flags::NeverImport;
+      this->flags_ &= ~Flags::Used;
+      this->flags_ |= Flags::NeverImport;
       break;
     case ImportMode::HiddenAccumulate:
       ASSERT(current == ImportMode::Uninitialized);
-      flags_ |= Flags::Hidden;
-      flags_ |= Flags::LogicAccumulate;
+      this->flags_ |= Flags::Hidden;
+      this->flags_ |= Flags::LogicAccumulate;
       break;
     }
   }
 
-  void setParentValue(uint64_t value) override { parent_value_ = value; }
+  void setParentValue(uint64_t value) override {
+    if (parent_value_.exchange(value) != value) {
+      this->flags_ |= Flags::Changed;
+    }
+  }
+  bool latchChanged() override {
+    return this->flags_.fetch_and(static_cast<uint16_t>(~Flags::Changed)) & Flags::Changed;
+  }
 
 private:
   std::atomic<uint64_t> parent_value_{0};
   std::atomic<uint64_t> child_value_{0};
 };
 
+// The records of the compact storage mode: a single slab slot holds the stat
+// followed by its encoded names. See AllocatorImpl::makeCompactStat().
+class CompactCounterImpl final
+    : public CounterImpl<InlineMetricImpl<Counter, CompactCounterImpl>> {
+public:
+  using CounterImpl::CounterImpl;
+
+  static void operator delete(void* slot) { SlabAllocator::deallocate(slot); }
+};
+
+class CompactGaugeImpl final : public GaugeImpl<InlineMetricImpl<Gauge, CompactGaugeImpl>> {
+public:
+  using GaugeImpl::GaugeImpl;
+
+  static void operator delete(void* slot) { SlabAllocator::deallocate(slot); }
+};
+
+template <class StatType, class... Args>
+StatType* AllocatorImpl::makeCompactStat(StatName name, StatName tag_extracted_name,
+                                         const StatNameTagVector& stat_name_tags,
+                                         Args&&... args) {
+  const uint64_t size =
+      sizeof(StatType) +
+      InlineMetricNames::storageBytes(name, tag_extracted_name, stat_name_tags);
+  if (size > SlabAllocator::MaxSlotSize) {
+    // Stats with very long names or many tags are rare; they are allocated
+    // from the heap, as in the default mode.
+    return nullptr;
+  }
+  void* slot = slab_allocator_.allocate(size);
+  return new (slot)
+      StatType(name, *this, tag_extracted_name, stat_name_tags, std::forward<Args>(args)...);
+}
+
 class TextReadoutImpl : public StatsSharedImpl<TextReadout> {
 public:
   TextReadoutImpl(StatName name, AllocatorImpl& alloc, StatName tag_extracted_name,
@@ -283,13 +339,16 @@ public:
   void set(absl::string_view value) override {
     std::string value_copy(value);
     absl::MutexLock lock(&mutex_);
+    flags_ |= value_ == value_copy ? Flags::Used : (Flags::Used | Flags::Changed);
     value_ = std::move(value_copy);
-    flags_ |= Flags::Used;
   }
   std::string value() const override {
     absl::MutexLock lock(&mutex_);
     return value_;
   }
+  bool latchChanged() override {
+    return flags_.fetch_and(static_cast<uint16_t>(~Flags::Changed)) & Flags::Changed;
+  }
 
 private:
   mutable absl::Mutex mutex_;
@@ -325,8 +384,14 @@ GaugeSharedPtr AllocatorImpl::makeGauge(StatName name, StatName tag_extracted_na
   if (iter != gauges_.end()) {
     return {*iter};
   }
-  auto gauge =
-      GaugeSharedPtr(new GaugeImpl(name, *this, tag_extracted_name, stat_name_tags, import_mode));
+  GaugeSharedPtr gauge;
+  if (compact_storage_) {
+    gauge = makeCompactStat<CompactGaugeImpl>(name, tag_extracted_name, stat_name_tags,
+                                              import_mode);
+  }
+  if (gauge == nullptr) {
+    gauge = new GaugeImpl<>(name, *this, tag_extracted_name, stat_name_tags, import_mode);
+  }
   gauges_.insert(gauge.get());
   // Add gauge to sinked_gauges_ if it matches the sink predicate.
   if (sink_predicates_ != nullptr && sink_predicates_->includeGauge(*gauge)) {
@@ -366,7 +431,14 @@ bool AllocatorImpl::isMutexLockedForTest() {
 
 Counter* AllocatorImpl::makeCounterInternal(StatName name, StatName tag_extracted_name,
                                             const StatNameTagVector& stat_name_tags) {
-  return new CounterImpl(name, *this, tag_extracted_name, stat_name_tags);
+  if (compact_storage_) {
+    Counter* counter =
+        makeCompactStat<CompactCounterImpl>(name, tag_extracted_name, stat_name_tags);
+    if (counter != nullptr) {
+      return counter;
+    }
+  }
+  return new CounterImpl<>(name, *this, tag_extracted_name, stat_name_tags);
 }
 
 void AllocatorImpl::forEachCounter(SizeFn f_size, StatFn<Counter> f_stat) const {
@@ -9,6 +9,7 @@
 
 #include "source/common/common/thread_synchronizer.h"
 #include "source/common/stats/metric_impl.h"
+#include "source/common/stats/slab_allocator.h"
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/string_view.h"
@@ -20,7 +21,16 @@ class AllocatorImpl : public Allocator {
 public:
   static const char DecrementToZeroSyncPoint[];
 
-  AllocatorImpl(SymbolTable& symbol_table) : symbol_table_(symbol_table) {}
+  /**
+   * @param symbol_table the symbol table for the names of the allocated stats.
+   * @param compact_storage whether to store each counter and gauge as a single
+   *        fixed-size record allocated from a slab, holding the stat's encoded
+   *        names inline, rather than as separate heap allocations for the stat
+   *        and its names. This reduces memory per stat in deployments with a
+   *        large number of stats.
+   */
+  AllocatorImpl(SymbolTable& symbol_table, bool compact_storage = false)
+      : symbol_table_(symbol_table), compact_storage_(compact_storage) {}
   ~AllocatorImpl() override;
 
   // Allocator
@@ -59,6 +69,11 @@ public:
    */
   bool isMutexLockedForTest();
 
+  /**
+   * @return the slab allocator holding the stats of the compact storage mode.
+   */
+  const SlabAllocator& slabAllocator() const { return slab_allocator_; }
+
   void markCounterForDeletion(const CounterSharedPtr& counter) override;
   void markGaugeForDeletion(const GaugeSharedPtr& gauge) override;
   void markTextReadoutForDeletion(const TextReadoutSharedPtr& text_readout) override;
@@ -68,12 +83,18 @@ protected:
                                        const StatNameTagVector& stat_name_tags);
 
 private:
-  template <class BaseClass> friend class StatsSharedImpl;
-  friend class CounterImpl;
-  friend class GaugeImpl;
+  template <class BaseClass, class MetricBase> friend class StatsSharedImpl;
+  template <class MetricBase> friend class CounterImpl;
+  template <class MetricBase> friend class GaugeImpl;
   friend class TextReadoutImpl;
   friend class NotifyingAllocatorImpl;
 
+  // Allocates a stat from the slab allocator, returning nullptr if the stat
+  // and its names don't fit in a slab slot.
+  template <class StatType, class... Args>
+  StatType* makeCompactStat(StatName name, StatName tag_extracted_name,
+                            const StatNameTagVector& stat_name_tags, Args&&... args);
+
   // A mutex is needed here to protect both the stats_ object from both
   // alloc() and free() operations. Although alloc() operations are called under existing locking,
   // free() operations are made from the destructors of the individual stat objects, which are not
@@ -93,6 +114,9 @@ private:
   // Predicates used to filter stats to be flushed.
   std::unique_ptr<SinkPredicates> sink_predicates_;
   SymbolTable& symbol_table_;
+  const bool compact_storage_;
+  // Declared before the deleted stats below, so that it outlives them.
+  SlabAllocator slab_allocator_;
 
   Thread::ThreadSynchronizer sync_;
 
@@ -1,9 +1,13 @@
 #include "source/common/stats/metric_impl.h"
 
+#include <functional>
+
 #include "envoy/stats/tag.h"
 
 #include "source/common/stats/symbol_table.h"
 
+#include "absl/container/fixed_array.h"
+
 namespace Envoy {
 namespace Stats {
 
@@ -14,14 +18,15 @@ MetricHelper::~MetricHelper() {
   ASSERT(!stat_names_.populated());
 }
 
-MetricHelper::MetricHelper(StatName name, StatName tag_extracted_name,
-                           const StatNameTagVector& stat_name_tags, SymbolTable& symbol_table) {
-  // Encode all the names and tags into transient storage so we can count the
-  // required bytes. 2 is added to account for the name and tag_extracted_name,
-  // and we multiply the number of tags by 2 to account for the name and value
-  // of each tag.
-  const uint32_t num_names = 2 + 2 * stat_name_tags.size();
-  absl::FixedArray<StatName> names(num_names);
+namespace {
+
+// Collects the names of a metric in the order they are encoded: the name, the
+// tag-extracted name, then alternating tag names and values. 2 is added to
+// account for the name and tag_extracted_name, and we multiply the number of
+// tags by 2 to account for the name and value of each tag.
+absl::FixedArray<StatName> metricNames(StatName name, StatName tag_extracted_name,
+                                       const StatNameTagVector& stat_name_tags) {
+  absl::FixedArray<StatName> names(2 + 2 * stat_name_tags.size());
   names[0] = name;
   names[1] = tag_extracted_name;
   int index = 1;
@@ -29,46 +34,50 @@ MetricHelper::MetricHelper(StatName name, StatName tag_extracted_name,
     names[++index] = stat_name_tag.first;
     names[++index] = stat_name_tag.second;
   }
-  symbol_table.populateList(names.begin(), num_names, stat_names_);
+  return names;
 }
 
-StatName MetricHelper::statName() const {
-  StatName stat_name;
-  stat_names_.iterate([&stat_name](StatName s) -> bool {
-    stat_name = s;
-    return false; // Returning 'false' stops the iteration.
-  });
-  return stat_name;
-}
+// Names encoded in memory trailing an InlineMetricImpl, iterated like a
+// StatNameList.
+class EncodedNames {
+public:
+  explicit EncodedNames(const uint8_t* storage) : storage_(storage) {}
+  void iterate(const std::function<bool(StatName)>& f) const { StatNameList::iterate(storage_, f); }
 
-StatName MetricHelper::tagExtractedStatName() const {
-  // The name is the first element in stat_names_. The second is the
-  // tag-extracted-name. We don't have random access in that format,
-  // so we iterate through them, skipping the first element (name),
-  // and terminating the iteration after capturing the tag-extracted
-  // name by returning false from the lambda.
-  StatName tag_extracted_stat_name;
-  bool skip = true;
-  stat_names_.iterate([&tag_extracted_stat_name, &skip](StatName s) -> bool {
-    if (skip) {
-      skip = false;
-      return true;
+private:
+  const uint8_t* storage_;
+};
+
+// The accessors below are shared between MetricHelper, which keeps its names in
+// a StatNameList, and InlineMetricImpl, which keeps them in EncodedNames. They
+// are templates rather than taking an iteration function, so that both call
+// iterate() directly with no extra level of std::function.
+
+// We don't have random access in the encoded format, so we iterate through the
+// names, terminating the iteration after capturing the requested one by
+// returning false from the lambda.
+template <class Names> StatName nameAt(const Names& names, uint32_t index) {
+  StatName stat_name;
+  names.iterate([&stat_name, &index](StatName s) -> bool {
+    if (index-- == 0) {
+      stat_name = s;
+      return false; // Returning 'false' stops the iteration.
     }
-    tag_extracted_stat_name = s;
-    return false; // Returning 'false' stops the iteration.
+    return true;
   });
-  return tag_extracted_stat_name;
+  return stat_name;
 }
 
-void MetricHelper::iterateTagStatNames(const Metric::TagStatNameIterFn& fn) const {
+template <class Names>
+void iterateTags(const Names& names, const Metric::TagStatNameIterFn& fn) {
   enum { Name, TagExtractedName, TagName, TagValue } state = Name;
   StatName tag_name;
 
-  // StatNameList maintains a linear ordered collection of StatNames, and we
+  // The encoded names are a linear ordered collection of StatNames, and we
   // are mapping that into a tag-extracted name (the first element), followed
   // by alternating TagName and TagValue. So we use a little state machine
-  // as we iterate through the stat_names_.
-  stat_names_.iterate([&state, &tag_name, &fn](StatName stat_name) -> bool {
+  // as we iterate through them.
+  names.iterate([&state, &tag_name, &fn](StatName stat_name) -> bool {
     switch (state) {
     case Name:
       state = TagExtractedName;
@@ -92,14 +101,73 @@ void MetricHelper::iterateTagStatNames(const Metric::TagStatNameIterFn& fn) cons
   ASSERT(state != TagValue);
 }
 
-TagVector MetricHelper::tags(const SymbolTable& symbol_table) const {
+template <class Names> TagVector tagVector(const Names& names, const SymbolTable& symbol_table) {
   TagVector tags;
-  iterateTagStatNames([&tags, &symbol_table](StatName name, StatName value) -> bool {
+  iterateTags(names, [&tags, &symbol_table](StatName name, StatName value) -> bool {
     tags.emplace_back(Tag{symbol_table.toString(name), symbol_table.toString(value)});
     return true;
   });
   return tags;
 }
 
+} // namespace
+
+MetricHelper::MetricHelper(StatName name, StatName tag_extracted_name,
+                           const StatNameTagVector& stat_name_tags, SymbolTable& symbol_table) {
+  const absl::FixedArray<StatName> names = metricNames(name, tag_extracted_name, stat_name_tags);
+  symbol_table.populateList(names.begin(), names.size(), stat_names_);
+}
+
+StatName MetricHelper::statName() const { return nameAt(stat_names_, 0); }
+
+StatName MetricHelper::tagExtractedStatName() const { return nameAt(stat_names_, 1); }
+
+void MetricHelper::iterateTagStatNames(const Metric::TagStatNameIterFn& fn) const {
+  iterateTags(stat_names_, fn);
+}
+
+TagVector MetricHelper::tags(const SymbolTable& symbol_table) const {
+  return tagVector(stat_names_, symbol_table);
+}
+
+uint64_t InlineMetricNames::storageBytes(StatName name, StatName tag_extracted_name,
+                                         const StatNameTagVector& stat_name_tags) {
+  const absl::FixedArray<StatName> names = metricNames(name, tag_extracted_name, stat_name_tags);
+  return SymbolTable::listStorageBytes(names.begin(), names.size());
+}
+
+void InlineMetricNames::populate(StatName name, StatName tag_extracted_name,
+                                 const StatNameTagVector& stat_name_tags,
+                                 SymbolTable& symbol_table, uint8_t* storage) {
+  const absl::FixedArray<StatName> names = metricNames(name, tag_extracted_name, stat_name_tags);
+  symbol_table.populateListInto(
+      names.begin(), names.size(),
+      absl::MakeSpan(storage, SymbolTable::listStorageBytes(names.begin(), names.size())));
+}
+
+void InlineMetricNames::clear(const uint8_t* storage, SymbolTable& symbol_table) {
+  StatNameList::iterate(storage, [&symbol_table](StatName stat_name) -> bool {
+    symbol_table.free(stat_name);
+    return true;
+  });
+}
+
+StatName InlineMetricNames::statName(const uint8_t* storage) {
+  return nameAt(EncodedNames(storage), 0);
+}
+
+StatName InlineMetricNames::tagExtractedStatName(const uint8_t* storage) {
+  return nameAt(EncodedNames(storage), 1);
+}
+
+void InlineMetricNames::iterateTagStatNames(const uint8_t* storage,
+                                            const Metric::TagStatNameIterFn& fn) {
+  iterateTags(EncodedNames(storage), fn);
+}
+
+TagVector InlineMetricNames::tags(const uint8_t* storage, const SymbolTable& symbol_table) {
+  return tagVector(EncodedNames(storage), symbol_table);
+}
+
 } // namespace Stats
 } // namespace Envoy
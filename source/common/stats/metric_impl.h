@@ -117,5 +117,77 @@ private:
   MetricHelper helper_;
 };
 
+/**
+ * Helpers for metrics that keep their name, tag-extracted name and tags
+ * encoded in memory trailing the metric object, rather than in a separately
+ * allocated StatNameList. See InlineMetricImpl.
+ */
+class InlineMetricNames {
+public:
+  /**
+   * @return the number of bytes needed to encode the names of a metric.
+   */
+  static uint64_t storageBytes(StatName name, StatName tag_extracted_name,
+                               const StatNameTagVector& stat_name_tags);
+
+  /**
+   * Encodes the names of a metric into storage, which must be storageBytes() long.
+   */
+  static void populate(StatName name, StatName tag_extracted_name,
+                       const StatNameTagVector& stat_name_tags, SymbolTable& symbol_table,
+                       uint8_t* storage);
+
+  /**
+   * Frees the names encoded in storage.
+   */
+  static void clear(const uint8_t* storage, SymbolTable& symbol_table);
+
+  static StatName statName(const uint8_t* storage);
+  static StatName tagExtractedStatName(const uint8_t* storage);
+  static void iterateTagStatNames(const uint8_t* storage, const Metric::TagStatNameIterFn& fn);
+  static TagVector tags(const uint8_t* storage, const SymbolTable& symbol_table);
+};
+
+/**
+ * Variant of MetricImpl that keeps the encoded names directly after the most
+ * derived object, Derived, saving the pointer to and the separate allocation of
+ * a StatNameList. Derived objects must be constructed in storage with
+ * InlineMetricNames::storageBytes() spare bytes after the object.
+ */
+template <class BaseClass, class Derived> class InlineMetricImpl : public BaseClass {
+public:
+  InlineMetricImpl(StatName name, StatName tag_extracted_name,
+                   const StatNameTagVector& stat_name_tags, SymbolTable& symbol_table) {
+    InlineMetricNames::populate(name, tag_extracted_name, stat_name_tags, symbol_table,
+                                const_cast<uint8_t*>(storage()));
+  }
+
+  TagVector tags() const override { return InlineMetricNames::tags(storage(), constSymbolTable()); }
+  StatName statName() const override { return InlineMetricNames::statName(storage()); }
+  StatName tagExtractedStatName() const override {
+    return InlineMetricNames::tagExtractedStatName(storage());
+  }
+  void iterateTagStatNames(const Metric::TagStatNameIterFn& fn) const override {
+    InlineMetricNames::iterateTagStatNames(storage(), fn);
+  }
+
+  const SymbolTable& constSymbolTable() const override {
+    // See MetricImpl::constSymbolTable().
+    return const_cast<InlineMetricImpl*>(this)->symbolTable();
+  }
+  std::string name() const override { return constSymbolTable().toString(this->statName()); }
+  std::string tagExtractedName() const override {
+    return constSymbolTable().toString(this->tagExtractedStatName());
+  }
+
+protected:
+  void clear(SymbolTable& symbol_table) { InlineMetricNames::clear(storage(), symbol_table); }
+
+private:
+  const uint8_t* storage() const {
+    return reinterpret_cast<const uint8_t*>(static_cast<const Derived*>(this) + 1);
+  }
+};
+
 } // namespace Stats
 } // namespace Envoy
@@ -0,0 +1,151 @@
+#include "source/common/stats/slab_allocator.h"
+
+#include <new>
+
+#include "source/common/common/assert.h"
+#include "source/common/common/lock_guard.h"
+
+namespace Envoy {
+namespace Stats {
+
+SlabAllocator::~SlabAllocator() {
+  Thread::LockGuard lock(mutex_);
+  // Slabs still holding slots are leaked rather than left for their stats to
+  // release into a destroyed allocator.
+  ASSERT(bytes_allocated_ == 0);
+  for (SizeClass& sizes : size_classes_) {
+    if (sizes.empty_ != nullptr) {
+      freeSlab(sizes.empty_);
+    }
+  }
+}
+
+void* SlabAllocator::allocate(size_t size) {
+  ASSERT(size > 0 && size <= MaxSlotSize);
+  const uint32_t size_class = (size - 1) / SlotAlignment;
+  const uint32_t slot_size = slotSize(size_class);
+
+  Thread::LockGuard lock(mutex_);
+  SizeClass& sizes = size_classes_[size_class];
+  SlabHeader* slab = sizes.available_;
+  if (slab == nullptr) {
+    if (sizes.empty_ != nullptr) {
+      slab = sizes.empty_;
+      sizes.empty_ = nullptr;
+    } else {
+      slab = newSlab(size_class);
+    }
+    linkAvailable(sizes, slab);
+  }
+
+  void* slot;
+  if (slab->free_list_ != nullptr) {
+    slot = slab->free_list_;
+    slab->free_list_ = *static_cast<void**>(slot);
+  } else {
+    slot = slab->next_;
+    slab->next_ += slot_size;
+  }
+  ++slab->used_slots_;
+  if (!hasFreeSlot(*slab)) {
+    unlinkAvailable(sizes, slab);
+  }
+  bytes_allocated_ += slot_size;
+  return slot;
+}
+
+void SlabAllocator::deallocate(void* slot) {
+  auto* slab = reinterpret_cast<SlabHeader*>(reinterpret_cast<uintptr_t>(slot) &
+                                             ~static_cast<uintptr_t>(SlabSize - 1));
+  slab->allocator_->release(slab, slot);
+}
+
+void SlabAllocator::release(SlabHeader* slab, void* slot) {
+  Thread::LockGuard lock(mutex_);
+  SizeClass& sizes = size_classes_[slab->size_class_];
+  const bool was_full = !hasFreeSlot(*slab);
+  *static_cast<void**>(slot) = slab->free_list_;
+  slab->free_list_ = slot;
+  --slab->used_slots_;
+  bytes_allocated_ -= slotSize(slab->size_class_);
+
+  if (slab->used_slots_ > 0) {
+    if (was_full) {
+      linkAvailable(sizes, slab);
+    }
+    return;
+  }
+  if (!was_full) {
+    unlinkAvailable(sizes, slab);
+  }
+  if (sizes.empty_ == nullptr) {
+    // All the slots are free, so the slab can be carved again from its start.
+    slab->free_list_ = nullptr;
+    slab->next_ = reinterpret_cast<uint8_t*>(slab) + HeaderSize;
+    sizes.empty_ = slab;
+  } else {
+    freeSlab(slab);
+  }
+}
+
+bool SlabAllocator::hasFreeSlot(const SlabHeader& slab) {
+  const uint8_t* end = reinterpret_cast<const uint8_t*>(&slab) + SlabSize;
+  return slab.free_list_ != nullptr ||
+         static_cast<size_t>(end - slab.next_) >= slotSize(slab.size_class_);
+}
+
+SlabAllocator::SlabHeader* SlabAllocator::newSlab(uint32_t size_class) {
+  // Slabs are aligned to their size, so deallocate() can find the header by
+  // masking a slot's address.
+  void* memory = ::operator new(SlabSize, std::align_val_t(SlabSize));
+  ++num_slabs_;
+  return new (memory) SlabHeader{this,
+                                 size_class,
+                                 0,
+                                 nullptr,
+                                 static_cast<uint8_t*>(memory) + HeaderSize,
+                                 nullptr,
+                                 nullptr};
+}
+
+void SlabAllocator::freeSlab(SlabHeader* slab) {
+  ASSERT(slab->used_slots_ == 0);
+  --num_slabs_;
+  ::operator delete(slab, std::align_val_t(SlabSize));
+}
+
+void SlabAllocator::linkAvailable(SizeClass& sizes, SlabHeader* slab) {
+  slab->prev_available_ = nullptr;
+  slab->next_available_ = sizes.available_;
+  if (sizes.available_ != nullptr) {
+    sizes.available_->prev_available_ = slab;
+  }
+  sizes.available_ = slab;
+}
+
+void SlabAllocator::unlinkAvailable(SizeClass& sizes, SlabHeader* slab) {
+  if (slab->prev_available_ != nullptr) {
+    slab->prev_available_->next_available_ = slab->next_available_;
+  } else {
+    ASSERT(sizes.available_ == slab);
+    sizes.available_ = slab->next_available_;
+  }
+  if (slab->next_available_ != nullptr) {
+    slab->next_available_->prev_available_ = slab->prev_available_;
+  }
+  slab->prev_available_ = nullptr;
+  slab->next_available_ = nullptr;
+}
+
+uint64_t SlabAllocator::bytesReserved() const {
+  Thread::LockGuard lock(mutex_);
+  return num_slabs_ * SlabSize;
+}
+
+uint64_t SlabAllocator::bytesAllocated() const {
+  Thread::LockGuard lock(mutex_);
+  return bytes_allocated_;
+}
+
+} // namespace Stats
+} // namespace Envoy
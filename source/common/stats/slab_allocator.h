@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "source/common/common/thread.h"
+#include "source/common/common/thread_annotations.h"
+
+namespace Envoy {
+namespace Stats {
+
+/**
+ * Hands out fixed-size slots carved from large, aligned slabs. This is used by
+ * the compact storage mode of AllocatorImpl, where each stat is a single record
+ * holding both its values and its encoded names. Compared to allocating each
+ * stat from the heap, this avoids per-allocation heap overhead, and keeps
+ * stats of the same size densely packed.
+ *
+ * Slot sizes are rounded up to a multiple of SlotAlignment, and each rounded
+ * size has its own slabs. Freed slots are reused for later allocations of the
+ * same size. A slab whose slots have all been freed is returned to the system,
+ * except for one empty slab per size, which is kept so that a size whose
+ * number of stats hovers around a slab boundary does not repeatedly allocate
+ * and free a slab, e.g. when a cluster is updated.
+ *
+ * All the slots must be freed before the allocator is destroyed.
+ */
+class SlabAllocator {
+public:
+  static constexpr uint32_t SlabSize = 64 * 1024;
+  static constexpr uint32_t SlotAlignment = 8;
+  static constexpr uint32_t MaxSlotSize = 512;
+
+  SlabAllocator() = default;
+  ~SlabAllocator();
+
+  /**
+   * @param size the number of bytes to allocate, which must be at most MaxSlotSize.
+   * @return a slot of at least size bytes.
+   */
+  void* allocate(size_t size);
+
+  /**
+   * Returns a slot allocated by allocate() to its slab allocator.
+   * @param slot the slot to free.
+   */
+  static void deallocate(void* slot);
+
+  /**
+   * @return the number of bytes held in slabs, including free slots.
+   */
+  uint64_t bytesReserved() const;
+
+  /**
+   * @return the number of bytes in allocated slots.
+   */
+  uint64_t bytesAllocated() const;
+
+private:
+  static constexpr uint32_t NumSizeClasses = MaxSlotSize / SlotAlignment;
+
+  // Placed at the start of every slab, so that a slot's slab can be found from
+  // its address alone.
+  struct SlabHeader {
+    SlabAllocator* allocator_;
+    uint32_t size_class_;
+    // The number of slots of the slab currently allocated.
+    uint32_t used_slots_;
+    // Singly-linked list of freed slots, threaded through their first bytes.
+    void* free_list_;
+    // The start of the never allocated tail of the slab.
+    uint8_t* next_;
+    // Neighbors in the list of slabs of the size class with free slots.
+    SlabHeader* prev_available_;
+    SlabHeader* next_available_;
+  };
+  static constexpr uint32_t HeaderSize =
+      (sizeof(SlabHeader) + SlotAlignment - 1) / SlotAlignment * SlotAlignment;
+
+  struct SizeClass {
+    // Slabs with both allocated and free slots. Allocations are served from
+    // the first of them. Full slabs are not linked anywhere.
+    SlabHeader* available_{};
+    // A slab with no allocated slots, used once all the available slabs are
+    // full.
+    SlabHeader* empty_{};
+  };
+
+  static uint32_t slotSize(uint32_t size_class) { return (size_class + 1) * SlotAlignment; }
+  static bool hasFreeSlot(const SlabHeader& slab);
+  SlabHeader* newSlab(uint32_t size_class) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void freeSlab(SlabHeader* slab) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  static void linkAvailable(SizeClass& sizes, SlabHeader* slab);
+  static void unlinkAvailable(SizeClass& sizes, SlabHeader* slab);
+  void release(SlabHeader* slab, void* slot);
+
+  mutable Thread::MutexBasicLockable mutex_;
+  SizeClass size_classes_[NumSizeClasses] ABSL_GUARDED_BY(mutex_);
+  uint64_t num_slabs_ ABSL_GUARDED_BY(mutex_){0};
+  uint64_t bytes_allocated_ ABSL_GUARDED_BY(mutex_){0};
+};
+
+} // namespace Stats
+} // namespace Envoy
@@ -1,14 +1,17 @@
 #include "source/common/stats/symbol_table.h"
 
 #include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <memory>
+#include <tuple>
 #include <vector>
 
 #include "source/common/common/assert.h"
 #include "source/common/common/logger.h"
 #include "source/common/common/utility.h"
 
+#include "absl/numeric/bits.h"
 #include "absl/strings/str_cat.h"
 
 namespace Envoy {
@@ -261,11 +264,8 @@ bool StatName::startsWith(StatName prefix) const {
 
 std::vector<absl::string_view> SymbolTable::decodeStrings(StatName stat_name) const {
   std::vector<absl::string_view> strings;
-  Thread::LockGuard lock(lock_);
   Encoding::decodeTokens(
-      stat_name,
-      [this, &strings](Symbol symbol)
-          ABSL_NO_THREAD_SAFETY_ANALYSIS { strings.push_back(fromSymbol(symbol)); },
+      stat_name, [this, &strings](Symbol symbol) { strings.push_back(fromSymbol(symbol)); },
       [&strings](absl::string_view str) { strings.push_back(str); });
   return strings;
 }
@@ -286,6 +286,50 @@ void SymbolTable::Encoding::appendToMemBlock(StatName stat_name,
   }
 }
 
+SymbolTable::SharedSymbol::SharedSymbol(Symbol symbol, absl::string_view str)
+    : symbol_(symbol), size_(str.size()) {
+  RELEASE_ASSERT(str.size() <= 0xffffffff, "size must fit in 32 bits");
+  memcpy(data_, str.data(), str.size()); // NOLINT(safe-memcpy)
+}
+
+SymbolTable::DecodeTable::~DecodeTable() {
+  for (std::atomic<Slot*>& segment : segments_) {
+    delete[] segment.load(std::memory_order_relaxed);
+  }
+}
+
+std::pair<uint32_t, uint32_t> SymbolTable::DecodeTable::segmentAndOffset(Symbol symbol) {
+  // Segment N holds the 2^(N + FirstSegmentBits) slots starting at symbol
+  // 2^(N + FirstSegmentBits) - 2^FirstSegmentBits.
+  const uint64_t index = static_cast<uint64_t>(symbol) + (uint64_t(1) << FirstSegmentBits);
+  const uint32_t bits = absl::bit_width(index) - 1;
+  return {bits - FirstSegmentBits, index - (uint64_t(1) << bits)};
+}
+
+SymbolTable::SharedSymbol* SymbolTable::DecodeTable::get(Symbol symbol) const {
+  const auto [segment, offset] = segmentAndOffset(symbol);
+  const Slot* slots = segments_[segment].load(std::memory_order_acquire);
+  if (slots == nullptr) {
+    return nullptr;
+  }
+  return slots[offset].load(std::memory_order_acquire);
+}
+
+void SymbolTable::DecodeTable::set(Symbol symbol, SharedSymbol* shared_symbol) {
+  const auto [segment, offset] = segmentAndOffset(symbol);
+  Slot* slots = segments_[segment].load(std::memory_order_acquire);
+  ASSERT(slots != nullptr);
+  slots[offset].store(shared_symbol, std::memory_order_release);
+}
+
+void SymbolTable::DecodeTable::reserve(Symbol symbol) {
+  const uint32_t segment = segmentAndOffset(symbol).first;
+  if (segments_[segment].load(std::memory_order_relaxed) == nullptr) {
+    segments_[segment].store(new Slot[uint64_t(1) << (segment + FirstSegmentBits)](),
+                             std::memory_order_release);
+  }
+}
+
 SymbolTable::SymbolTable()
     // Have to be explicitly initialized, if we want to use the ABSL_GUARDED_BY macro.
     : next_symbol_(FirstValidSymbol), monotonic_counter_(FirstValidSymbol) {}
@@ -306,24 +350,25 @@ void SymbolTable::addTokensToEncoding(const absl::string_view name, Encoding& en
     return;
   }
 
-  // We want to hold the lock for the minimum amount of time, so we do the
-  // string-splitting and prepare a temp vector of Symbol first.
   const std::vector<absl::string_view> tokens = absl::StrSplit(name, '.');
   std::vector<Symbol> symbols;
   symbols.reserve(tokens.size());
 
-  // Now take the lock and populate the Symbol objects, which involves bumping
-  // ref-counts in this.
-  {
-    Thread::LockGuard lock(lock_);
+  if (track_recent_lookups_.load(std::memory_order_relaxed)) {
+    Thread::LockGuard lock(lookups_lock_);
     recent_lookups_.lookup(name);
-    for (auto& token : tokens) {
-      // TODO(jmarantz): consider using StatNameDynamicStorage for tokens with
-      // length below some threshold, say 4 bytes. It might be preferable not to
-      // reserve Symbols for every 3 digit number found (for example) in ipv4
-      // addresses.
-      symbols.push_back(toSymbol(token));
-    }
+  } else {
+    untracked_lookups_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Populate the Symbol objects, which involves bumping ref-counts in this.
+  // Each token only locks the shard it belongs to.
+  for (auto& token : tokens) {
+    // TODO(jmarantz): consider using StatNameDynamicStorage for tokens with
+    // length below some threshold, say 4 bytes. It might be preferable not to
+    // reserve Symbols for every 3 digit number found (for example) in ipv4
+    // addresses.
+    symbols.push_back(toSymbol(token));
   }
 
   // Now efficiently encode the array of 32-bit symbols into a uint8_t array.
@@ -331,76 +376,98 @@ void SymbolTable::addTokensToEncoding(const absl::string_view name, Encoding& en
 }
 
 uint64_t SymbolTable::numSymbols() const {
-  Thread::LockGuard lock(lock_);
-  ASSERT(encode_map_.size() == decode_map_.size());
-  return encode_map_.size();
+  uint64_t num_symbols = 0;
+  for (const EncodeShard& shard : encode_shards_) {
+    absl::ReaderMutexLock lock(&shard.lock_);
+    num_symbols += shard.encode_map_.size();
+  }
+  return num_symbols;
 }
 
 std::string SymbolTable::toString(const StatName& stat_name) const {
   return absl::StrJoin(decodeStrings(stat_name), ".");
 }
 
-void SymbolTable::incRefCount(const StatName& stat_name) {
-  // Before taking the lock, decode the array of symbols from the SymbolTable::Storage.
-  const SymbolVec symbols = Encoding::decodeSymbols(stat_name);
-
-  Thread::LockGuard lock(lock_);
-  for (Symbol symbol : symbols) {
-    auto decode_search = decode_map_.find(symbol);
-
-    ASSERT(decode_search != decode_map_.end(),
-           "Please see "
-           "https://github.com/envoyproxy/envoy/blob/main/source/docs/stats.md#"
-           "debugging-symbol-table-assertions");
-    auto encode_search = encode_map_.find(decode_search->second->toStringView());
-    ASSERT(encode_search != encode_map_.end(),
-           "Please see "
-           "https://github.com/envoyproxy/envoy/blob/main/source/docs/stats.md#"
-           "debugging-symbol-table-assertions");
+void SymbolTable::appendTo(StatName stat_name, std::string& out) const {
+  bool first = true;
+  // Capture only references so the callbacks fit in std::function's inline storage.
+  const auto append = [&out, &first](absl::string_view token) {
+    if (!first) {
+      out.push_back('.');
+    }
+    first = false;
+    out.append(token.data(), token.size());
+  };
+  Encoding::decodeTokens(
+      stat_name, [this, &append](Symbol symbol) { append(fromSymbol(symbol)); }, append);
+}
 
-    ++encode_search->second.ref_count_;
-  }
+void SymbolTable::incRefCount(const StatName& stat_name) {
+  // The caller holds a reference to each of the symbols, so none of them can be
+  // removed from the table concurrently, and no lock is needed.
+  Encoding::decodeTokens(
+      stat_name,
+      [this](Symbol symbol) {
+        SharedSymbol* shared_symbol = decode_table_.get(symbol);
+        ASSERT(shared_symbol != nullptr,
+               "Please see "
+               "https://github.com/envoyproxy/envoy/blob/main/source/docs/stats.md#"
+               "debugging-symbol-table-assertions");
+        shared_symbol->ref_count_.fetch_add(1, std::memory_order_relaxed);
+      },
+      [](absl::string_view) {});
 }
 
 void SymbolTable::free(const StatName& stat_name) {
-  // Before taking the lock, decode the array of symbols from the SymbolTable::Storage.
-  const SymbolVec symbols = Encoding::decodeSymbols(stat_name);
-
-  Thread::LockGuard lock(lock_);
-  for (Symbol symbol : symbols) {
-    auto decode_search = decode_map_.find(symbol);
-    ASSERT(decode_search != decode_map_.end());
-
-    auto encode_search = encode_map_.find(decode_search->second->toStringView());
-    ASSERT(encode_search != encode_map_.end());
-
-    // If that was the last remaining client usage of the symbol, erase the
-    // current mappings and add the now-unused symbol to the reuse pool.
-    //
-    // The "if (--EXPR.ref_count_)" pattern speeds up BM_CreateRace by 20% in
-    // symbol_table_speed_test.cc, relative to breaking out the decrement into a
-    // separate step, likely due to the non-trivial dereferences in EXPR.
-    if (--encode_search->second.ref_count_ == 0) {
-      decode_map_.erase(decode_search);
-      encode_map_.erase(encode_search);
-      pool_.push(symbol);
-    }
-  }
+  Encoding::decodeTokens(
+      stat_name,
+      [this](Symbol symbol) {
+        SharedSymbol* shared_symbol = decode_table_.get(symbol);
+        ASSERT(shared_symbol != nullptr);
+
+        // Unless this is the last remaining reference, just drop it.
+        std::atomic<uint32_t>& ref_count = shared_symbol->ref_count_;
+        uint32_t count = ref_count.load(std::memory_order_relaxed);
+        while (count > 1) {
+          if (ref_count.compare_exchange_weak(count, count - 1, std::memory_order_release,
+                                              std::memory_order_relaxed)) {
+            return;
+          }
+        }
+
+        // Otherwise, another thread may still encode the same token before we
+        // get exclusive access to the shard. If that was the last remaining
+        // client usage of the symbol, erase the current mappings and add the
+        // now-unused symbol to the reuse pool.
+        EncodeShard& shard = encodeShard(shared_symbol->toStringView());
+        absl::MutexLock lock(&shard.lock_);
+        if (ref_count.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+          return;
+        }
+        auto encode_search = shard.encode_map_.find(shared_symbol->toStringView());
+        ASSERT(encode_search != shard.encode_map_.end());
+        decode_table_.set(symbol, nullptr);
+        shard.encode_map_.erase(encode_search);
+        Thread::LockGuard alloc_lock(alloc_lock_);
+        pool_.push(symbol);
+      },
+      [](absl::string_view) {});
 }
 
 uint64_t SymbolTable::getRecentLookups(const RecentLookupsFn& iter) const {
   uint64_t total = 0;
   absl::flat_hash_map<std::string, uint64_t> name_count_map;
 
-  // We don't want to hold lock_ while calling the iterator, but we need it to
-  // access recent_lookups_, so we buffer in name_count_map.
+  // We don't want to hold lookups_lock_ while calling the iterator, but we need
+  // it to access recent_lookups_, so we buffer in name_count_map.
   {
-    Thread::LockGuard lock(lock_);
+    Thread::LockGuard lock(lookups_lock_);
     recent_lookups_.forEach(
         [&name_count_map](absl::string_view str, uint64_t count)
             ABSL_NO_THREAD_SAFETY_ANALYSIS { name_count_map[std::string(str)] += count; });
     total += recent_lookups_.total();
   }
+  total += untracked_lookups_.load(std::memory_order_relaxed);
 
   // Now we have the collated name-count map data: we need to vectorize and
   // sort. We define the pair with the count first as std::pair::operator<
@@ -445,17 +512,19 @@ DynamicSpans SymbolTable::getDynamicSpans(StatName stat_name) const {
 }
 
 void SymbolTable::setRecentLookupCapacity(uint64_t capacity) {
-  Thread::LockGuard lock(lock_);
+  Thread::LockGuard lock(lookups_lock_);
   recent_lookups_.setCapacity(capacity);
+  track_recent_lookups_.store(capacity > 0, std::memory_order_relaxed);
 }
 
 void SymbolTable::clearRecentLookups() {
-  Thread::LockGuard lock(lock_);
+  Thread::LockGuard lock(lookups_lock_);
   recent_lookups_.clear();
+  untracked_lookups_.store(0, std::memory_order_relaxed);
 }
 
 uint64_t SymbolTable::recentLookupCapacity() const {
-  Thread::LockGuard lock(lock_);
+  Thread::LockGuard lock(lookups_lock_);
   return recent_lookups_.capacity();
 }
 
@@ -466,39 +535,56 @@ StatNameSetPtr SymbolTable::makeSet(absl::string_view name) {
 }
 
 Symbol SymbolTable::toSymbol(absl::string_view sv) {
-  Symbol result;
-  auto encode_find = encode_map_.find(sv);
-  // If the string segment doesn't already exist,
-  if (encode_find == encode_map_.end()) {
-    // We create the actual string, place it in the decode_map_, and then insert
-    // a string_view pointing to it in the encode_map_. This allows us to only
-    // store the string once. We use unique_ptr so copies are not made as
-    // flat_hash_map moves values around.
-    InlineStringPtr str = InlineString::create(sv);
-    auto encode_insert = encode_map_.insert({str->toStringView(), SharedSymbol(next_symbol_)});
-    ASSERT(encode_insert.second);
-    auto decode_insert = decode_map_.insert({next_symbol_, std::move(str)});
-    ASSERT(decode_insert.second);
-
-    result = next_symbol_;
-    newSymbol();
-  } else {
-    // If the insertion didn't take place, return the actual value at that location and up the
-    // refcount at that location
-    result = encode_find->second.symbol_;
-    ++(encode_find->second.ref_count_);
+  EncodeShard& shard = encodeShard(sv);
+
+  // In the common case the token is already in the table, and we just need to
+  // bump its refcount, which only needs shared access to the shard. The count
+  // can't drop to zero concurrently, as that requires exclusive access.
+  {
+    absl::ReaderMutexLock lock(&shard.lock_);
+    auto encode_find = shard.encode_map_.find(sv);
+    if (encode_find != shard.encode_map_.end()) {
+      encode_find->second->ref_count_.fetch_add(1, std::memory_order_relaxed);
+      return encode_find->second->symbol_;
+    }
+  }
+
+  absl::MutexLock lock(&shard.lock_);
+  auto encode_find = shard.encode_map_.find(sv);
+  if (encode_find != shard.encode_map_.end()) {
+    // Another thread inserted the token since we released the lock, so return
+    // the actual value at that location and up the refcount at that location.
+    encode_find->second->ref_count_.fetch_add(1, std::memory_order_relaxed);
+    return encode_find->second->symbol_;
   }
-  return result;
+
+  // If the string segment doesn't already exist, we create a SharedSymbol
+  // holding the string, and insert a string_view pointing to it in the encode
+  // map. This allows us to only store the string once.
+  const Symbol symbol = allocateSymbol();
+  SharedSymbolPtr shared_symbol = SharedSymbol::create(symbol, sv);
+  decode_table_.set(symbol, shared_symbol.get());
+  auto encode_insert =
+      shard.encode_map_.emplace(shared_symbol->toStringView(), std::move(shared_symbol));
+  ASSERT(encode_insert.second);
+  return symbol;
+}
+
+absl::string_view SymbolTable::fromSymbol(const Symbol symbol) const {
+  const SharedSymbol* shared_symbol = decode_table_.get(symbol);
+  RELEASE_ASSERT(shared_symbol != nullptr, "no such symbol");
+  return shared_symbol->toStringView();
 }
 
-absl::string_view SymbolTable::fromSymbol(const Symbol symbol) const
-    ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_) {
-  auto search = decode_map_.find(symbol);
-  RELEASE_ASSERT(search != decode_map_.end(), "no such symbol");
-  return search->second->toStringView();
+Symbol SymbolTable::allocateSymbol() {
+  Thread::LockGuard lock(alloc_lock_);
+  const Symbol symbol = next_symbol_;
+  decode_table_.reserve(symbol);
+  newSymbol();
+  return symbol;
 }
 
-void SymbolTable::newSymbol() ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_) {
+void SymbolTable::newSymbol() ABSL_EXCLUSIVE_LOCKS_REQUIRED(alloc_lock_) {
   if (pool_.empty()) {
     next_symbol_ = ++monotonic_counter_;
   } else {
@@ -510,15 +596,6 @@ void SymbolTable::newSymbol() ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_) {
 }
 
 bool SymbolTable::lessThan(const StatName& a, const StatName& b) const {
-  // Proactively take the table lock in anticipation that we'll need to
-  // convert at least one symbol to a string_view, and it's easier not to
-  // bother to lazily take the lock.
-  Thread::LockGuard lock(lock_);
-  return lessThanLockHeld(a, b);
-}
-
-bool SymbolTable::lessThanLockHeld(const StatName& a, const StatName& b) const
-    ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_) {
   Encoding::TokenIter a_iter(a), b_iter(b);
   while (true) {
     Encoding::TokenIter::TokenType a_type = a_iter.next();
@@ -548,16 +625,17 @@ bool SymbolTable::lessThanLockHeld(const StatName& a, const StatName& b) const
 
 #ifndef ENVOY_CONFIG_COVERAGE
 void SymbolTable::debugPrint() const {
-  Thread::LockGuard lock(lock_);
-  std::vector<Symbol> symbols;
-  for (const auto& p : decode_map_) {
-    symbols.push_back(p.first);
+  std::vector<std::tuple<Symbol, std::string, uint32_t>> symbols;
+  for (const EncodeShard& shard : encode_shards_) {
+    absl::ReaderMutexLock lock(&shard.lock_);
+    for (const auto& p : shard.encode_map_) {
+      symbols.emplace_back(p.second->symbol_, std::string(p.first),
+                           p.second->ref_count_.load(std::memory_order_relaxed));
+    }
   }
   std::sort(symbols.begin(), symbols.end());
-  for (Symbol symbol : symbols) {
-    const InlineString& token = *decode_map_.find(symbol)->second;
-    const SharedSymbol& shared_symbol = encode_map_.find(token.toStringView())->second;
-    ENVOY_LOG_MISC(info, "{}: '{}' ({})", symbol, token.toStringView(), shared_symbol.ref_count_);
+  for (const auto& [symbol, token, ref_count] : symbols) {
+    ENVOY_LOG_MISC(info, "{}: '{}' ({})", symbol, token, ref_count);
   }
 }
 #endif
@@ -689,15 +767,40 @@ SymbolTable::StoragePtr SymbolTable::join(const StatNameVec& stat_names) const {
   return mem_block.release();
 }
 
-void SymbolTable::populateList(const StatName* names, uint32_t num_names, StatNameList& list) {
-  RELEASE_ASSERT(num_names < 256, "Maximum number elements in a StatNameList exceeded");
+uint64_t SymbolTable::listStorageBytes(const StatName* names, uint32_t num_names) {
+  uint64_t total_size_bytes = 1; /* one byte for holding the number of names */
+  for (uint32_t i = 0; i < num_names; ++i) {
+    total_size_bytes += names[i].size();
+  }
+  return total_size_bytes;
+}
 
-  // First encode all the names.
-  size_t total_size_bytes = 1; /* one byte for holding the number of names */
+void SymbolTable::populateListInto(const StatName* names, uint32_t num_names,
+                                   absl::Span<uint8_t> storage) {
+  RELEASE_ASSERT(num_names < 256, "Maximum number elements in a StatNameList exceeded");
+  ASSERT(storage.size() == listStorageBytes(names, num_names));
 
+  uint8_t* p = storage.data();
+  *p++ = num_names;
   for (uint32_t i = 0; i < num_names; ++i) {
-    total_size_bytes += names[i].size();
+    const StatName stat_name = names[i];
+    const uint8_t* data = stat_name.dataIncludingSize();
+    if (data == nullptr) {
+      *p++ = 0;
+    } else {
+      memcpy(p, data, stat_name.size()); // NOLINT(safe-memcpy)
+      p += stat_name.size();
+    }
+    incRefCount(stat_name);
   }
+  ASSERT(p == storage.data() + storage.size());
+}
+
+void SymbolTable::populateList(const StatName* names, uint32_t num_names, StatNameList& list) {
+  RELEASE_ASSERT(num_names < 256, "Maximum number elements in a StatNameList exceeded");
+
+  // First encode all the names.
+  const size_t total_size_bytes = listStorageBytes(names, num_names);
 
   // Now allocate the exact number of bytes required and move the encodings
   // into storage.
@@ -719,8 +822,8 @@ void SymbolTable::populateList(const StatName* names, uint32_t num_names, StatNa
 
 StatNameList::~StatNameList() { ASSERT(!populated()); }
 
-void StatNameList::iterate(const std::function<bool(StatName)>& f) const {
-  const uint8_t* p = &storage_[0];
+void StatNameList::iterate(const uint8_t* storage, const std::function<bool(StatName)>& f) {
+  const uint8_t* p = storage;
   const uint32_t num_elements = *p++;
   for (uint32_t i = 0; i < num_elements; ++i) {
     const StatName stat_name(p);
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <memory>
 #include <stack>
 #include <string>
@@ -14,11 +16,15 @@
 #include "source/common/common/utility.h"
 #include "source/common/stats/recent_lookups.h"
 
+#include "absl/base/optimization.h"
 #include "absl/container/fixed_array.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/inlined_vector.h"
+#include "absl/hash/hash.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 
 namespace Envoy {
 namespace Stats {
@@ -218,6 +224,15 @@ public:
    */
   std::string toString(const StatName& stat_name) const;
 
+  /**
+   * Appends the period-delimited name of a stat to a string. Unlike toString(), this doesn't build
+   * a temporary vector or string, so it doesn't allocate once the output has enough capacity.
+   *
+   * @param stat_name the stat name.
+   * @param out the string to append to.
+   */
+  void appendTo(StatName stat_name, std::string& out) const;
+
   /**
    * @return uint64_t the number of symbols in the symbol table.
    */
@@ -273,6 +288,27 @@ public:
    */
   void populateList(const StatName* names, uint32_t num_names, StatNameList& list);
 
+  /**
+   * @return the number of bytes needed to encode the names in the StatNameList
+   *         format, for use with populateListInto().
+   *
+   * @param names A pointer to the first name in an array.
+   * @param num_names The number of names.
+   */
+  static uint64_t listStorageBytes(const StatName* names, uint32_t num_names);
+
+  /**
+   * Like populateList(), but encodes the names into caller-owned memory, so
+   * that the list can share an allocation with the object holding it. The
+   * encoding can be read with StatNameList::iterate(const uint8_t*, ...), and
+   * each name must be freed by the caller before the memory is released.
+   *
+   * @param names A pointer to the first name in an array.
+   * @param num_names The number of names.
+   * @param storage The memory to encode into, of listStorageBytes(names, num_names) bytes.
+   */
+  void populateListInto(const StatName* names, uint32_t num_names, absl::Span<uint8_t> storage);
+
 #ifndef ENVOY_CONFIG_COVERAGE
   void debugPrint() const;
 #endif
@@ -324,8 +360,6 @@ public:
    */
   DynamicSpans getDynamicSpans(StatName stat_name) const;
 
-  bool lessThanLockHeld(const StatName& a, const StatName& b) const;
-
   template <class GetStatName, class Obj> struct StatNameCompare {
     StatNameCompare(const SymbolTable& symbol_table, GetStatName getter)
         : symbol_table_(symbol_table), getter_(getter) {}
@@ -337,9 +371,7 @@ public:
   };
 
   /**
-   * Sorts a range by StatName. This API is more efficient than
-   * calling std::sort directly as it takes a single lock for the
-   * entire sort, rather than locking on each comparison.
+   * Sorts a range by StatName.
    *
    * @param begin the beginning of the range to sort
    * @param end the end of the range to sort
@@ -347,9 +379,6 @@ public:
    */
   template <class Obj, class Iter, class GetStatName>
   void sortByStatNames(Iter begin, Iter end, GetStatName get_stat_name) const {
-    // Grab the lock once before sorting begins, so we don't have to re-take
-    // it on every comparison.
-    Thread::LockGuard lock(lock_);
     StatNameCompare<GetStatName, Obj> compare(*this, get_stat_name);
     std::sort(begin, end, compare);
   }
@@ -395,15 +424,71 @@ private:
    */
   void incRefCount(const StatName& stat_name);
 
-  struct SharedSymbol {
-    SharedSymbol(Symbol symbol) : symbol_(symbol) {}
+  class SharedSymbol;
+  using SharedSymbolPtr = std::unique_ptr<SharedSymbol>;
+
+  // A symbol along with its reference count and the token it encodes, stored
+  // inline. The count is only decremented to zero, and the symbol removed from
+  // the table, with the lock of the symbol's encode shard held exclusively.
+  // Otherwise the count is updated without holding any lock, or in the case of
+  // encode() with the shard's lock held in shared mode.
+  class SharedSymbol : public InlineStorage {
+  public:
+    static SharedSymbolPtr create(Symbol symbol, absl::string_view str) {
+      return SharedSymbolPtr(new (str.size()) SharedSymbol(symbol, str));
+    }
+
+    absl::string_view toStringView() const { return {data_, size_}; }
+
+    const Symbol symbol_;
+    std::atomic<uint32_t> ref_count_{1};
+
+  private:
+    SharedSymbol(Symbol symbol, absl::string_view str);
 
-    Symbol symbol_;
-    uint32_t ref_count_{1};
+    const uint32_t size_;
+    char data_[];
   };
 
-  // This must be held during both encode() and free().
-  mutable Thread::MutexBasicLockable lock_;
+  /**
+   * Maps symbols to their SharedSymbol. Slots are held in segments of doubling
+   * size, which are allocated on demand and never moved until the table is
+   * destroyed. This allows callers holding a reference to a symbol to decode it
+   * without taking any lock, while slots for other symbols are being written.
+   */
+  class DecodeTable {
+  public:
+    ~DecodeTable();
+
+    /**
+     * @return the SharedSymbol for symbol, or nullptr if there is none.
+     */
+    SharedSymbol* get(Symbol symbol) const;
+
+    /**
+     * Sets the SharedSymbol for symbol. The slot's segment must have been
+     * allocated with reserve().
+     */
+    void set(Symbol symbol, SharedSymbol* shared_symbol);
+
+    /**
+     * Allocates the segment holding the slot of symbol, if needed. Calls must
+     * be serialized by the caller.
+     */
+    void reserve(Symbol symbol);
+
+  private:
+    using Slot = std::atomic<SharedSymbol*>;
+
+    // The first segment has 2^FirstSegmentBits slots, and enough segments are
+    // available to cover all 2^32 symbols.
+    static constexpr uint32_t FirstSegmentBits = 6;
+    static constexpr uint32_t NumSegments = 32 - FirstSegmentBits + 1;
+
+    static std::pair<uint32_t, uint32_t> segmentAndOffset(Symbol symbol);
+
+    std::array<std::atomic<Slot*>, NumSegments> segments_{};
+  };
 
   /**
    * Decodes a uint8_t array into an array of period-delimited strings. Note
@@ -426,20 +511,27 @@ private:
    * @param sv the individual string to be encoded as a symbol.
    * @return Symbol the encoded string.
    */
-  Symbol toSymbol(absl::string_view sv) ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  Symbol toSymbol(absl::string_view sv);
 
   /**
-   * Convenience function for decode(), decoding one symbol at a time.
+   * Convenience function for decode(), decoding one symbol at a time. The
+   * caller must hold a reference to the symbol, which keeps the returned view
+   * valid.
    *
    * @param symbol the individual symbol to be decoded.
    * @return absl::string_view the decoded string.
    */
-  absl::string_view fromSymbol(Symbol symbol) const ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  absl::string_view fromSymbol(Symbol symbol) const;
+
+  /**
+   * Allocates a symbol for a newly inserted token.
+   */
+  Symbol allocateSymbol();
 
   /**
    * Stages a new symbol for use. To be called after a successful insertion.
    */
-  void newSymbol();
+  void newSymbol() ABSL_EXCLUSIVE_LOCKS_REQUIRED(alloc_lock_);
 
   /**
    * Tokenizes name, finds or allocates symbols for each token, and adds them
@@ -451,30 +543,57 @@ private:
   void addTokensToEncoding(absl::string_view name, Encoding& encoding);
 
   Symbol monotonicCounter() {
-    Thread::LockGuard lock(lock_);
+    Thread::LockGuard lock(alloc_lock_);
     return monotonic_counter_;
   }
 
+  // The encode map is split into shards, each with its own lock, so that
+  // threads encoding unrelated tokens don't contend. Tokens are assigned to a
+  // shard by hash. When both are needed, a shard's lock is taken before
+  // alloc_lock_.
+  static constexpr uint32_t ShardBits = 4;
+  static constexpr uint32_t NumShards = 1 << ShardBits;
+
+  // The encode map owns the SharedSymbols. Using absl::string_view lets us only
+  // store the complete string once, in the SharedSymbol.
+  using EncodeMap = absl::flat_hash_map<absl::string_view, SharedSymbolPtr>;
+
+  struct ABSL_CACHELINE_ALIGNED EncodeShard {
+    mutable absl::Mutex lock_;
+    EncodeMap encode_map_ ABSL_GUARDED_BY(lock_);
+  };
+
+  static uint32_t encodeShardIndex(absl::string_view sv) {
+    // The map uses the low bits of the same hash, so take the shard from the high bits.
+    return absl::Hash<absl::string_view>()(sv) >> (64 - ShardBits);
+  }
+  EncodeShard& encodeShard(absl::string_view sv) { return encode_shards_[encodeShardIndex(sv)]; }
+
+  std::array<EncodeShard, NumShards> encode_shards_;
+  DecodeTable decode_table_;
+
+  // Guards the allocation of symbols.
+  mutable Thread::MutexBasicLockable alloc_lock_;
+
   // Stores the symbol to be used at next insertion. This should exist ahead of insertion time so
   // that if insertion succeeds, the value written is the correct one.
-  Symbol next_symbol_ ABSL_GUARDED_BY(lock_);
+  Symbol next_symbol_ ABSL_GUARDED_BY(alloc_lock_);
 
   // If the free pool is exhausted, we monotonically increase this counter.
-  Symbol monotonic_counter_;
-
-  // Bitmap implementation.
-  // The encode map stores both the symbol and the ref count of that symbol.
-  // Using absl::string_view lets us only store the complete string once, in the decode map.
-  using EncodeMap = absl::flat_hash_map<absl::string_view, SharedSymbol>;
-  using DecodeMap = absl::flat_hash_map<Symbol, InlineStringPtr>;
-  EncodeMap encode_map_ ABSL_GUARDED_BY(lock_);
-  DecodeMap decode_map_ ABSL_GUARDED_BY(lock_);
+  Symbol monotonic_counter_ ABSL_GUARDED_BY(alloc_lock_);
 
   // Free pool of symbols for re-use.
   // TODO(ambuc): There might be an optimization here relating to storing ranges of freed symbols
   // using an Envoy::IntervalSet.
-  std::stack<Symbol> pool_ ABSL_GUARDED_BY(lock_);
-  RecentLookups recent_lookups_ ABSL_GUARDED_BY(lock_);
+  std::stack<Symbol> pool_ ABSL_GUARDED_BY(alloc_lock_);
+
+  // Lookups are only recorded in recent_lookups_ when it has a non-zero
+  // capacity. Otherwise they are just counted in untracked_lookups_, without
+  // taking lookups_lock_.
+  mutable Thread::MutexBasicLockable lookups_lock_;
+  RecentLookups recent_lookups_ ABSL_GUARDED_BY(lookups_lock_);
+  std::atomic<bool> track_recent_lookups_{false};
+  std::atomic<uint64_t> untracked_lookups_{0};
 };
 
 // Base class for holding the backing-storing for a StatName. The two derived
@@ -840,7 +959,16 @@ public:
    *
    * @param f The function to call on each stat.
    */
-  void iterate(const std::function<bool(StatName)>& f) const;
+  void iterate(const std::function<bool(StatName)>& f) const { iterate(storage_.get(), f); }
+
+  /**
+   * Iterates over an encoded list held outside of a StatNameList. See
+   * SymbolTable::populateListInto().
+   *
+   * @param storage The encoded list.
+   * @param f The function to call on each stat.
+   */
+  static void iterate(const uint8_t* storage, const std::function<bool(StatName)>& f);
 
   /**
    * Frees each StatName in the list. Failure to call this before destruction
@@ -1055,7 +1183,7 @@ template <class GetStatName, class Obj>
 bool SymbolTable::StatNameCompare<GetStatName, Obj>::operator()(const Obj& a, const Obj& b) const {
   StatName a_stat_name = getter_(a);
   StatName b_stat_name = getter_(b);
-  return symbol_table_.lessThanLockHeld(a_stat_name, b_stat_name);
+  return symbol_table_.lessThan(a_stat_name, b_stat_name);
 }
 
 using SymbolTablePtr = std::unique_ptr<SymbolTable>;
@@ -223,6 +223,17 @@ bool TagExtractorTokensImpl::extractTag(TagExtractionContext& context, std::vect
     PERF_TAG_INC(missed_);
     return false;
   }
+  addMatchedTag(input_tokens, match_input_index, start, tags, remove_characters);
+
+  PERF_RECORD(perf, "tokens-match", name_);
+  PERF_TAG_INC(matched_);
+  return true;
+}
+
+void TagExtractorTokensImpl::addMatchedTag(const std::vector<absl::string_view>& input_tokens,
+                                           uint32_t match_input_index, uint32_t start,
+                                           std::vector<Tag>& tags,
+                                           IntervalSet<size_t>& remove_characters) const {
   const absl::string_view tag_value = input_tokens[match_input_index];
 
   // Given the starting character-index of the match token, we have to
@@ -250,10 +261,6 @@ bool TagExtractorTokensImpl::extractTag(TagExtractionContext& context, std::vect
   }
   addTagReturningValueRef(tags) = std::string(tag_value);
   remove_characters.insert(start, end);
-
-  PERF_RECORD(perf, "tokens-match", name_);
-  PERF_TAG_INC(matched_);
-  return true;
 }
 
 bool TagExtractorTokensImpl::searchTags(const std::vector<absl::string_view>& input_tokens,
@@ -300,6 +307,103 @@ bool TagExtractorTokensImpl::searchTags(const std::vector<absl::string_view>& in
   return pattern_index == tokens_.size() && input_index == input_tokens.size();
 }
 
+void TagExtractorTokensTrie::add(const TagExtractorTokensImpl& extractor) {
+  const std::vector<std::string>& tokens = extractor.tokens();
+  Node* node = &root_;
+  for (uint32_t i = 0; i < tokens.size(); ++i) {
+    const std::string& token = tokens[i];
+    if (i == extractor.matchIndex()) {
+      node = &child(node->match_child_);
+    } else if (token == "**") {
+      if (i == tokens.size() - 1) {
+        node->trailing_any_sequence_.push_back(&extractor);
+        ++num_patterns_;
+        return;
+      }
+      node = &child(node->any_sequence_child_);
+    } else if (token == "*") {
+      node = &child(node->any_child_);
+    } else {
+      node = &child(node->literal_children_[token]);
+    }
+  }
+  node->terminal_.push_back(&extractor);
+  ++num_patterns_;
+}
+
+TagExtractorTokensTrie::Node& TagExtractorTokensTrie::child(NodePtr& node_ptr) {
+  if (node_ptr == nullptr) {
+    node_ptr = std::make_unique<Node>();
+  }
+  return *node_ptr;
+}
+
+void TagExtractorTokensTrie::match(const std::vector<absl::string_view>& input_tokens,
+                                   Matches& matches) const {
+  search(root_, input_tokens, 0, 0, 0, 0, matches);
+}
+
+const TagExtractorTokensTrie::Match*
+TagExtractorTokensTrie::findMatch(const Matches& matches,
+                                  const TagExtractorTokensImpl* extractor) {
+  for (const Match& match : matches) {
+    if (match.extractor_ == extractor) {
+      return &match;
+    }
+  }
+  return nullptr;
+}
+
+void TagExtractorTokensTrie::addMatch(const std::vector<const TagExtractorTokensImpl*>& extractors,
+                                      uint32_t match_input_index, uint32_t start,
+                                      Matches& matches) {
+  for (const TagExtractorTokensImpl* extractor : extractors) {
+    // The search visits the ways a pattern can match in the same order as
+    // TagExtractorTokensImpl::searchTags, so the first match found wins.
+    if (findMatch(matches, extractor) == nullptr) {
+      matches.push_back(Match{extractor, match_input_index, start});
+    }
+  }
+}
+
+void TagExtractorTokensTrie::search(const Node& node,
+                                    const std::vector<absl::string_view>& input_tokens,
+                                    uint32_t input_index, uint32_t char_index, uint32_t start,
+                                    uint32_t match_input_index, Matches& matches) const {
+  if (input_index == input_tokens.size()) {
+    addMatch(node.terminal_, match_input_index, start, matches);
+    return;
+  }
+  addMatch(node.trailing_any_sequence_, match_input_index, start, matches);
+
+  const absl::string_view input_token = input_tokens[input_index];
+  const uint32_t next_char_index = char_index + input_token.size() + 1;
+  if (!node.literal_children_.empty()) {
+    const auto iter = node.literal_children_.find(input_token);
+    if (iter != node.literal_children_.end()) {
+      search(*iter->second, input_tokens, input_index + 1, next_char_index, start,
+             match_input_index, matches);
+    }
+  }
+  if (node.any_child_ != nullptr) {
+    search(*node.any_child_, input_tokens, input_index + 1, next_char_index, start,
+           match_input_index, matches);
+  }
+  if (node.match_child_ != nullptr) {
+    search(*node.match_child_, input_tokens, input_index + 1, next_char_index, char_index,
+           input_index, matches);
+  }
+  if (node.any_sequence_child_ != nullptr) {
+    // Try the remainder of the patterns after each possible number of tokens
+    // consumed by the "**", fewest first, as searchTags does.
+    for (; input_index < input_tokens.size(); ++input_index) {
+      search(*node.any_sequence_child_, input_tokens, input_index, char_index, start,
+             match_input_index, matches);
+      char_index += input_tokens[input_index].size() + 1;
+    }
+  }
+}
+
 TagExtractorFixedImpl::TagExtractorFixedImpl(absl::string_view name, absl::string_view value)
     : TagExtractorImplBase(name, value), value_(std::string(value)) {}
 
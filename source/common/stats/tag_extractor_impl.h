@@ -12,6 +12,8 @@
 
 #include "source/common/common/regex.h"
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
 #include "absl/strings/string_view.h"
 #include "re2/re2.h"
 
@@ -160,6 +162,22 @@ public:
   bool extractTag(TagExtractionContext& context, std::vector<Tag>& tags,
                   IntervalSet<size_t>& remove_characters) const override;
 
+  /**
+   * Adds the tag for a match of this extractor's pattern, which may have been
+   * found by extractTag or by a TagExtractorTokensTrie.
+   * @param input_tokens the dot-separated tokens of the stat name.
+   * @param match_input_index the index of the input token matching "$".
+   * @param start the character index of that token in the stat name.
+   * @param tags the list of tags to add to.
+   * @param remove_characters the characters to elide from the stat name.
+   */
+  void addMatchedTag(const std::vector<absl::string_view>& input_tokens,
+                     uint32_t match_input_index, uint32_t start, std::vector<Tag>& tags,
+                     IntervalSet<size_t>& remove_characters) const;
+
+  const std::vector<std::string>& tokens() const { return tokens_; }
+  uint32_t matchIndex() const { return match_index_; }
+
 private:
   static uint32_t findMatchIndex(const std::vector<std::string>& tokens);
   bool searchTags(const std::vector<absl::string_view>& input_tokens, uint32_t input_index,
@@ -170,6 +188,73 @@ private:
   const uint32_t match_index_;
 };
 
+/**
+ * Compiles the patterns of a collection of TagExtractorTokensImpl into a trie
+ * over their dot-separated tokens, so that all of them can be matched against
+ * a stat name in a single walk of its tokens. Patterns sharing a prefix, such
+ * as the many that start with "cluster.*." or "http.*.", share its trie nodes
+ * and only look at the corresponding input tokens once. For each extractor,
+ * the match found is the same one that TagExtractorTokensImpl::extractTag
+ * finds: when a "**" in the middle of a pattern can match in more than one
+ * way, the one consuming the fewest tokens wins.
+ */
+class TagExtractorTokensTrie {
+public:
+  struct Match {
+    const TagExtractorTokensImpl* extractor_;
+    uint32_t match_input_index_;
+    uint32_t start_;
+  };
+  using Matches = absl::InlinedVector<Match, 8>;
+
+  /**
+   * Adds the pattern of an extractor to the trie. The extractor must outlive the trie.
+   * @param extractor the extractor to add.
+   */
+  void add(const TagExtractorTokensImpl& extractor);
+
+  /**
+   * Finds every extractor in the trie whose pattern matches a stat name.
+   * @param input_tokens the dot-separated tokens of the stat name.
+   * @param matches receives one match for each matching extractor, in no particular order.
+   */
+  void match(const std::vector<absl::string_view>& input_tokens, Matches& matches) const;
+
+  /**
+   * @return the match for an extractor in matches, or nullptr if it did not match.
+   */
+  static const Match* findMatch(const Matches& matches, const TagExtractorTokensImpl* extractor);
+
+  bool empty() const { return num_patterns_ == 0; }
+
+private:
+  struct Node;
+  using NodePtr = std::unique_ptr<Node>;
+  struct Node {
+    absl::flat_hash_map<std::string, NodePtr> literal_children_;
+    NodePtr any_child_;          // "*"
+    NodePtr match_child_;        // "$"
+    NodePtr any_sequence_child_; // "**", except at the end of a pattern.
+
+    // Extractors whose pattern ends at this node.
+    std::vector<const TagExtractorTokensImpl*> terminal_;
+
+    // Extractors whose pattern ends with a "**" following this node, which
+    // matches one or more remaining tokens.
+    std::vector<const TagExtractorTokensImpl*> trailing_any_sequence_;
+  };
+
+  static Node& child(NodePtr& node_ptr);
+  void search(const Node& node, const std::vector<absl::string_view>& input_tokens,
+              uint32_t input_index, uint32_t char_index, uint32_t start,
+              uint32_t match_input_index, Matches& matches) const;
+  static void addMatch(const std::vector<const TagExtractorTokensImpl*>& extractors,
+                       uint32_t match_input_index, uint32_t start, Matches& matches);
+
+  Node root_;
+  uint32_t num_patterns_{0};
+};
+
 /**
  * Implements a tag with a fixed value. These are added unconditionally, but
  * participate in duplicate reduction.
@@ -58,14 +58,15 @@ int TagProducerImpl::addExtractorsMatching(absl::string_view name) {
   }
   for (const auto& desc : Config::TagNames::get().tokenizedDescriptorVec()) {
     if (desc.name_ == name) {
-      addExtractor(std::make_unique<TagExtractorTokensImpl>(desc.name_, desc.pattern_));
+      addTokensExtractor(desc.name_, desc.pattern_);
       ++num_found;
     }
   }
   return num_found;
 }
 
-void TagProducerImpl::addExtractor(TagExtractorPtr extractor) {
+void TagProducerImpl::addExtractor(TagExtractorPtr extractor,
+                                   const TagExtractorTokensImpl* tokens_extractor) {
   auto insertion = extractor_map_.insert(std::make_pair(extractor->name(), std::ref(*extractor)));
   if (!insertion.second) {
     extractor->setOtherExtractorWithSameNameExists(true);
@@ -73,28 +74,46 @@ void TagProducerImpl::addExtractor(TagExtractorPtr extractor) {
     other.get().setOtherExtractorWithSameNameExists(true);
   }
 
+  if (tokens_extractor != nullptr) {
+    tokens_trie_.add(*tokens_extractor);
+  }
+
   const absl::string_view prefix = extractor->prefixToken();
   if (prefix.empty()) {
-    tag_extractors_without_prefix_.emplace_back(std::move(extractor));
+    tag_extractors_without_prefix_.push_back({std::move(extractor), tokens_extractor});
   } else {
-    tag_extractor_prefix_map_[prefix].emplace_back(std::move(extractor));
+    tag_extractor_prefix_map_[prefix].push_back({std::move(extractor), tokens_extractor});
   }
 }
 
-void TagProducerImpl::forEachExtractorMatching(
-    absl::string_view stat_name, std::function<void(const TagExtractorPtr&)> f) const {
-  IntervalSetImpl<size_t> remove_characters;
-  for (const TagExtractorPtr& tag_extractor : tag_extractors_without_prefix_) {
-    f(tag_extractor);
-  }
+void TagProducerImpl::addTokensExtractor(absl::string_view name, absl::string_view pattern) {
+  auto extractor = std::make_unique<TagExtractorTokensImpl>(name, pattern);
+  const TagExtractorTokensImpl* tokens_extractor = extractor.get();
+  addExtractor(std::move(extractor), tokens_extractor);
+}
+
+const std::vector<TagProducerImpl::ExtractorEntry>*
+TagProducerImpl::prefixExtractors(absl::string_view stat_name) const {
   const absl::string_view::size_type dot = stat_name.find('.');
   if (dot != std::string::npos) {
     const absl::string_view token = absl::string_view(stat_name.data(), dot);
     const auto iter = tag_extractor_prefix_map_.find(token);
     if (iter != tag_extractor_prefix_map_.end()) {
-      for (const TagExtractorPtr& tag_extractor : iter->second) {
-        f(tag_extractor);
-      }
+      return &iter->second;
+    }
+  }
+  return nullptr;
+}
+
+void TagProducerImpl::forEachExtractorMatching(
+    absl::string_view stat_name, std::function<void(const TagExtractorPtr&)> f) const {
+  for (const ExtractorEntry& entry : tag_extractors_without_prefix_) {
+    f(entry.extractor_);
+  }
+  const std::vector<ExtractorEntry>* prefix_extractors = prefixExtractors(stat_name);
+  if (prefix_extractors != nullptr) {
+    for (const ExtractorEntry& entry : *prefix_extractors) {
+      f(entry.extractor_);
     }
   }
 }
@@ -103,26 +122,55 @@ std::string TagProducerImpl::produceTags(absl::string_view metric_name, TagVecto
   // TODO(jmarantz): Skip the creation of string-based tags, creating a StatNameTagVector instead.
   IntervalSetImpl<size_t> remove_characters;
   TagExtractionContext tag_extraction_context(metric_name);
-  std::vector<absl::string_view> tokens;
+
+  // Match all the tokenized extractors in one walk of the tokens of the name. Their
+  // tags are added below, in the same order as the other extractors' tags.
+  TagExtractorTokensTrie::Matches tokens_matches;
+  if (!tokens_trie_.empty()) {
+    tokens_trie_.match(tag_extraction_context.tokens(), tokens_matches);
+  }
+
   absl::flat_hash_set<absl::string_view> dup_set;
-  forEachExtractorMatching(metric_name, [&remove_characters, &tags, &tag_extraction_context,
-                                         &dup_set](const TagExtractorPtr& tag_extractor) {
+  const auto extract = [&](const ExtractorEntry& entry) {
+    const TagExtractor& tag_extractor = *entry.extractor_;
     // It is relatively cheap to populate a set of string_view for every tag,
     // but it saves 2% CPU time to only populate and check dup_set for tag-names
     // where there is more than one extractor. This is rare. For built-in
     // extractors this only occurs with HTTP_CONN_MANAGER_PREFIX. Istio/Wasm
     // add configuration for an alternate pattern for RESPONSE_CODE.
-    bool other_extractor_with_same_name_exists = tag_extractor->otherExtractorWithSameNameExists();
+    bool other_extractor_with_same_name_exists = tag_extractor.otherExtractorWithSameNameExists();
     if (other_extractor_with_same_name_exists &&
-        dup_set.find(tag_extractor->name()) != dup_set.end()) {
-      ENVOY_LOG_EVERY_POW_2_MISC(warn, "Skipping duplicate tag for ", tag_extractor->name());
+        dup_set.find(tag_extractor.name()) != dup_set.end()) {
+      ENVOY_LOG_EVERY_POW_2_MISC(warn, "Skipping duplicate tag for ", tag_extractor.name());
       return;
     }
-    if (tag_extractor->extractTag(tag_extraction_context, tags, remove_characters) &&
-        other_extractor_with_same_name_exists) {
-      dup_set.insert(tag_extractor->name());
+    bool extracted;
+    if (entry.tokens_extractor_ != nullptr) {
+      const TagExtractorTokensTrie::Match* match =
+          TagExtractorTokensTrie::findMatch(tokens_matches, entry.tokens_extractor_);
+      extracted = match != nullptr;
+      if (extracted) {
+        entry.tokens_extractor_->addMatchedTag(tag_extraction_context.tokens(),
+                                               match->match_input_index_, match->start_, tags,
+                                               remove_characters);
+      }
+    } else {
+      extracted = tag_extractor.extractTag(tag_extraction_context, tags, remove_characters);
+    }
+    if (extracted && other_extractor_with_same_name_exists) {
+      dup_set.insert(tag_extractor.name());
+    }
+  };
+
+  for (const ExtractorEntry& entry : tag_extractors_without_prefix_) {
+    extract(entry);
+  }
+  const std::vector<ExtractorEntry>* prefix_extractors = prefixExtractors(metric_name);
+  if (prefix_extractors != nullptr) {
+    for (const ExtractorEntry& entry : *prefix_extractors) {
+      extract(entry);
     }
-  });
+  }
   return StringUtil::removeCharacters(metric_name, remove_characters);
 }
 
@@ -137,7 +185,7 @@ void TagProducerImpl::addDefaultExtractors(const envoy::config::metrics::v3::Sta
                                                             desc.negative_match_, desc.re_type_));
     }
     for (const auto& desc : Config::TagNames::get().tokenizedDescriptorVec()) {
-      addExtractor(std::make_unique<TagExtractorTokensImpl>(desc.name_, desc.pattern_));
+      addTokensExtractor(desc.name_, desc.pattern_);
     }
   }
 }
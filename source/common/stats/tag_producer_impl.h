@@ -14,6 +14,7 @@
 #include "source/common/common/utility.h"
 #include "source/common/config/well_known_names.h"
 #include "source/common/protobuf/protobuf.h"
+#include "source/common/stats/tag_extractor_impl.h"
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/node_hash_set.h"
@@ -46,12 +47,30 @@ public:
 private:
   friend class DefaultTagRegexTester;
 
+  // A TagExtractor, along with the same extractor as a TagExtractorTokensImpl if it is
+  // one. Tokenized extractors are matched all at once by tokens_trie_ in produceTags,
+  // rather than one at a time by calling extractTag.
+  struct ExtractorEntry {
+    TagExtractorPtr extractor_;
+    const TagExtractorTokensImpl* tokens_extractor_;
+  };
+
   /**
    * Adds a TagExtractor to the collection of tags, tracking prefixes to help make
    * produceTags run efficiently by trying only extractors that have a chance to match.
    * @param extractor TagExtractorPtr the extractor to add.
+   * @param tokens_extractor the same extractor if it is a TagExtractorTokensImpl, in
+   *        which case its pattern is also added to tokens_trie_.
+   */
+  void addExtractor(TagExtractorPtr extractor,
+                    const TagExtractorTokensImpl* tokens_extractor = nullptr);
+
+  /**
+   * Adds a tokenized TagExtractor to the collection of tags.
+   * @param name absl::string_view the name of the tag.
+   * @param pattern absl::string_view the tokens pattern, see TagExtractorTokensImpl.
    */
-  void addExtractor(TagExtractorPtr extractor);
+  void addTokensExtractor(absl::string_view name, absl::string_view pattern);
 
   /**
    * Adds all default extractors matching the specified tag name. In this model,
@@ -92,12 +111,22 @@ private:
   void forEachExtractorMatching(absl::string_view stat_name,
                                 std::function<void(const TagExtractorPtr&)> f) const;
 
-  std::vector<TagExtractorPtr> tag_extractors_without_prefix_;
+  /**
+   * @param stat_name the stat name.
+   * @return the extractors whose prefix is the first token of stat_name, or nullptr if
+   *         there are none.
+   */
+  const std::vector<ExtractorEntry>* prefixExtractors(absl::string_view stat_name) const;
+
+  std::vector<ExtractorEntry> tag_extractors_without_prefix_;
 
   // Maps a prefix word extracted out of a regex to a vector of TagExtractors. Note that
   // the storage for the prefix string is owned by the TagExtractor, which, depending on
   // implementation, may need make a copy of the prefix.
-  absl::flat_hash_map<absl::string_view, std::vector<TagExtractorPtr>> tag_extractor_prefix_map_;
+  absl::flat_hash_map<absl::string_view, std::vector<ExtractorEntry>> tag_extractor_prefix_map_;
+
+  // The patterns of all tokenized extractors, which are owned by the collections above.
+  TagExtractorTokensTrie tokens_trie_;
 
   // Keep track of which names have extractors. If an extractor is added and there's
   // already one for that name, we set a bit in the extractor so we can decide whether
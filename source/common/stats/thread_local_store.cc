@@ -531,6 +531,15 @@ StatType& ThreadLocalStoreImpl::ScopeImpl::safeMakeStat(
   return ret;
 }
 
+ThreadLocalStoreImpl::TlsCacheEntry* ThreadLocalStoreImpl::ScopeImpl::tlsCacheEntry() {
+  // The TLS cache might be unavailable if we don't have TLS initialized
+  // currently, or disabled to save memory.
+  if (parent_.shutting_down_ || !parent_.tls_cache_ || !parent_.scope_tls_caches_enabled_) {
+    return nullptr;
+  }
+  return &parent_.tlsCache().insertScope(this->scope_id_);
+}
+
 Counter& ThreadLocalStoreImpl::ScopeImpl::counterFromStatNameWithTags(
     const StatName& name, StatNameTagVectorOptConstRef stat_name_tags) {
   if (parent_.rejectsAll()) {
@@ -546,14 +555,12 @@ Counter& ThreadLocalStoreImpl::ScopeImpl::counterFromStatNameWithTags(
     return parent_.null_counter_;
   }
 
-  // We now find the TLS cache. This might remain null if we don't have TLS
-  // initialized currently.
+  // We now find the TLS cache. This might remain null, see tlsCacheEntry().
   StatRefMap<Counter>* tls_cache = nullptr;
   StatNameHashSet* tls_rejected_stats = nullptr;
-  if (!parent_.shutting_down_ && parent_.tls_cache_) {
-    TlsCacheEntry& entry = parent_.tlsCache().insertScope(this->scope_id_);
-    tls_cache = &entry.counters_;
-    tls_rejected_stats = &entry.rejected_stats_;
+  if (TlsCacheEntry* entry = tlsCacheEntry(); entry != nullptr) {
+    tls_cache = &entry->counters_;
+    tls_rejected_stats = &entry->rejected_stats_;
   }
 
   const CentralCacheEntrySharedPtr& central_cache = centralCacheNoThreadAnalysis();
@@ -607,10 +614,9 @@ Gauge& ThreadLocalStoreImpl::ScopeImpl::gaugeFromStatNameWithTags(
 
   StatRefMap<Gauge>* tls_cache = nullptr;
   StatNameHashSet* tls_rejected_stats = nullptr;
-  if (!parent_.shutting_down_ && parent_.tls_cache_) {
-    TlsCacheEntry& entry = parent_.tlsCache().insertScope(this->scope_id_);
-    tls_cache = &entry.gauges_;
-    tls_rejected_stats = &entry.rejected_stats_;
+  if (TlsCacheEntry* entry = tlsCacheEntry(); entry != nullptr) {
+    tls_cache = &entry->gauges_;
+    tls_rejected_stats = &entry->rejected_stats_;
   }
 
   const CentralCacheEntrySharedPtr& central_cache = centralCacheNoThreadAnalysis();
@@ -646,14 +652,13 @@ Histogram& ThreadLocalStoreImpl::ScopeImpl::histogramFromStatNameWithTags(
 
   StatNameHashMap<ParentHistogramSharedPtr>* tls_cache = nullptr;
   StatNameHashSet* tls_rejected_stats = nullptr;
-  if (!parent_.shutting_down_ && parent_.tls_cache_) {
-    TlsCacheEntry& entry = parent_.tlsCache().insertScope(this->scope_id_);
-    tls_cache = &entry.parent_histograms_;
+  if (TlsCacheEntry* entry = tlsCacheEntry(); entry != nullptr) {
+    tls_cache = &entry->parent_histograms_;
     auto iter = tls_cache->find(final_stat_name);
     if (iter != tls_cache->end()) {
       return *iter->second;
     }
-    tls_rejected_stats = &entry.rejected_stats_;
+    tls_rejected_stats = &entry->rejected_stats_;
     if (tls_rejected_stats->find(final_stat_name) != tls_rejected_stats->end()) {
       return parent_.null_histogram_;
     }
@@ -720,14 +725,12 @@ TextReadout& ThreadLocalStoreImpl::ScopeImpl::textReadoutFromStatNameWithTags(
     return parent_.null_text_readout_;
   }
 
-  // We now find the TLS cache. This might remain null if we don't have TLS
-  // initialized currently.
+  // We now find the TLS cache. This might remain null, see tlsCacheEntry().
   StatRefMap<TextReadout>* tls_cache = nullptr;
   StatNameHashSet* tls_rejected_stats = nullptr;
-  if (!parent_.shutting_down_ && parent_.tls_cache_) {
-    TlsCacheEntry& entry = parent_.tlsCache().insertScope(this->scope_id_);
-    tls_cache = &entry.text_readouts_;
-    tls_rejected_stats = &entry.rejected_stats_;
+  if (TlsCacheEntry* entry = tlsCacheEntry(); entry != nullptr) {
+    tls_cache = &entry->text_readouts_;
+    tls_rejected_stats = &entry->rejected_stats_;
   }
 
   const CentralCacheEntrySharedPtr& central_cache = centralCacheNoThreadAnalysis();
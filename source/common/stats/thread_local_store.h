@@ -225,6 +225,19 @@ public:
   void extractAndAppendTags(absl::string_view name, StatNamePool& pool,
                             StatNameTagVector& tags) override;
 
+  /**
+   * Disables the per-thread caches of each scope's stats, which otherwise hold
+   * an entry per stat looked up through a scope on each thread. Lookups then
+   * take the store's lock and use the central cache, trading lookup speed for
+   * memory. This is suited to deployments with a large number of stats where
+   * request-path code holds direct references to its stats, which remain valid
+   * as long as their scope. Must be called before initializeThreading().
+   */
+  void disableScopeTlsCaches() {
+    ASSERT(!threading_ever_initialized_);
+    scope_tls_caches_enabled_ = false;
+  }
+
 private:
   friend class ThreadLocalStoreTestingPeer;
 
@@ -362,6 +375,10 @@ private:
 
     HistogramOptConstRef findHistogramLockHeld(StatName name) const;
 
+    // Returns this scope's entry in the calling thread's TLS cache, or nullptr
+    // if stats must be looked up in the central cache.
+    TlsCacheEntry* tlsCacheEntry();
+
     template <class StatType>
     using MakeStatFn = std::function<RefcountPtr<StatType>(
         Allocator&, StatName name, StatName tag_extracted_name, const StatNameTagVector& tags)>;
@@ -519,6 +536,7 @@ private:
   std::atomic<bool> threading_ever_initialized_{};
   std::atomic<bool> shutting_down_{};
   std::atomic<bool> merge_in_progress_{};
+  bool scope_tls_caches_enabled_{true};
   OptRef<ThreadLocal::Instance> tls_;
 
   NullCounterImpl null_counter_;
@@ -71,7 +71,7 @@ Config::SharedConfig::SharedConfig(
     const envoy::extensions::filters::network::tcp_proxy::v3::TcpProxy& config,
     Server::Configuration::FactoryContext& context)
     : stats_scope_(context.scope().createScope(fmt::format("tcp.{}", config.stat_prefix()))),
-      stats_(generateStats(*stats_scope_)) {
+      stats_(generateStats(*stats_scope_)), zero_copy_forwarding_(config.zero_copy_forwarding()) {
   if (config.has_idle_timeout()) {
     const uint64_t timeout = DurationUtil::durationToMilliseconds(config.idle_timeout());
     if (timeout > 0) {
@@ -203,6 +203,7 @@ UpstreamDrainManager& Config::drainManager() {
 
 Filter::Filter(ConfigSharedPtr config, Upstream::ClusterManager& cluster_manager)
     : config_(config), cluster_manager_(cluster_manager), downstream_callbacks_(*this),
+      downstream_splice_callbacks_(*this, true), upstream_splice_callbacks_(*this, false),
       upstream_callbacks_(new UpstreamCallbacks(this)) {
   ASSERT(config != nullptr);
 }
@@ -569,6 +570,39 @@ void Filter::onGenericPoolReady(StreamInfo::StreamInfo* info,
   if (info) {
     upstream_info.setUpstreamFilterState(info->filterState());
   }
+  if (config_->zeroCopyForwarding()) {
+    maybeStartSplice();
+  }
+}
+
+void Filter::maybeStartSplice() {
+  // Continuing to read may have closed either connection.
+  if (upstream_ == nullptr || !upstream_->upstreamConnection().has_value()) {
+    return;
+  }
+  Network::Connection& downstream = read_callbacks_->connection();
+  Network::Connection& upstream = *upstream_->upstreamConnection();
+  // Each direction falls back to proxying through the filter chain on its own, for instance when
+  // either connection uses TLS.
+  const bool downstream_spliced = downstream.startSplice(upstream, downstream_splice_callbacks_);
+  const bool upstream_spliced = upstream.startSplice(downstream, upstream_splice_callbacks_);
+  ENVOY_CONN_LOG(debug, "zero copy forwarding: downstream={} upstream={}", downstream,
+                 downstream_spliced, upstream_spliced);
+}
+
+void Filter::SpliceCallbacks::onSplicedData(uint64_t bytes, bool end_stream) {
+  ENVOY_CONN_LOG(trace, "{} connection spliced {} bytes, end_stream={}",
+                 parent_.read_callbacks_->connection(), from_downstream_ ? "downstream" : "upstream",
+                 bytes, end_stream);
+  StreamInfo::StreamInfo& stream_info = parent_.getStreamInfo();
+  if (from_downstream_) {
+    stream_info.getDownstreamBytesMeter()->addWireBytesReceived(bytes);
+    stream_info.getUpstreamBytesMeter()->addWireBytesSent(bytes);
+  } else {
+    stream_info.getUpstreamBytesMeter()->addWireBytesReceived(bytes);
+    stream_info.getDownstreamBytesMeter()->addWireBytesSent(bytes);
+  }
+  parent_.resetIdleTimer();
 }
 
 const Router::MetadataMatchCriteria* Filter::metadataMatchCriteria() {
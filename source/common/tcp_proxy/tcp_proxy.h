@@ -223,6 +223,7 @@ public:
     const TcpProxyStats& stats() { return stats_; }
     const absl::optional<std::chrono::milliseconds>& idleTimeout() { return idle_timeout_; }
     bool flushAccessLogOnConnected() const { return flush_access_log_on_connected_; }
+    bool zeroCopyForwarding() const { return zero_copy_forwarding_; }
     const absl::optional<std::chrono::milliseconds>& maxDownstreamConnectionDuration() const {
       return max_downstream_connection_duration_;
     }
@@ -253,6 +254,7 @@ public:
 
     const TcpProxyStats stats_;
     bool flush_access_log_on_connected_;
+    const bool zero_copy_forwarding_;
     absl::optional<std::chrono::milliseconds> idle_timeout_;
     absl::optional<std::chrono::milliseconds> max_downstream_connection_duration_;
     absl::optional<std::chrono::milliseconds> access_log_flush_interval_;
@@ -311,6 +313,7 @@ public:
   const OnDemandStats& onDemandStats() const { return shared_config_->onDemandConfig()->stats(); }
   Random::RandomGenerator& randomGenerator() { return random_generator_; }
   bool flushAccessLogOnConnected() const { return shared_config_->flushAccessLogOnConnected(); }
+  bool zeroCopyForwarding() const { return shared_config_->zeroCopyForwarding(); }
 
 private:
   struct SimpleRouteImpl : public Route {
@@ -476,6 +479,18 @@ protected:
     bool on_high_watermark_called_{false};
   };
 
+  // Accounts for the data that the connections forward to each other once splicing started.
+  struct SpliceCallbacks : public Network::SpliceCallbacks {
+    SpliceCallbacks(Filter& parent, bool from_downstream)
+        : parent_(parent), from_downstream_(from_downstream) {}
+
+    // Network::SpliceCallbacks
+    void onSplicedData(uint64_t bytes, bool end_stream) override;
+
+    Filter& parent_;
+    const bool from_downstream_;
+  };
+
   enum class UpstreamFailureReason {
     ConnectFailed,
     NoHealthyUpstream,
@@ -504,6 +519,7 @@ protected:
   void onUpstreamData(Buffer::Instance& data, bool end_stream);
   void onUpstreamEvent(Network::ConnectionEvent event);
   void onUpstreamConnection();
+  void maybeStartSplice();
   void onIdleTimeout();
   void resetIdleTimer();
   void disableIdleTimer();
@@ -517,6 +533,8 @@ protected:
   Network::ReadFilterCallbacks* read_callbacks_{};
 
   DownstreamCallbacks downstream_callbacks_;
+  SpliceCallbacks downstream_splice_callbacks_;
+  SpliceCallbacks upstream_splice_callbacks_;
   Event::TimerPtr idle_timer_;
   Event::TimerPtr connection_duration_timer_;
   Event::TimerPtr access_log_flush_timer_;
@@ -56,6 +56,13 @@ Ssl::ConnectionInfoConstSharedPtr TcpUpstream::getUpstreamConnectionSslInfo() {
   return nullptr;
 }
 
+OptRef<Network::Connection> TcpUpstream::upstreamConnection() {
+  if (upstream_conn_data_ != nullptr) {
+    return upstream_conn_data_->connection();
+  }
+  return {};
+}
+
 Tcp::ConnectionPool::ConnectionData*
 TcpUpstream::onDownstreamEvent(Network::ConnectionEvent event) {
   if (event == Network::ConnectionEvent::RemoteClose) {
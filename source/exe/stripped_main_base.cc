@@ -48,7 +48,8 @@ StrippedMainBase::StrippedMainBase(const Server::Options& options, Event::TimeSy
                                    std::unique_ptr<Random::RandomGenerator>&& random_generator,
                                    std::unique_ptr<ProcessContext> process_context)
     : platform_impl_(std::move(platform_impl)), options_(options),
-      component_factory_(component_factory), stats_allocator_(symbol_table_) {
+      component_factory_(component_factory),
+      stats_allocator_(symbol_table_, options.statsCompactStorageEnabled()) {
   // Process the option to disable extensions as early as possible,
   // before we do any configuration loading.
   OptionsImpl::disableExtensions(options.disabledExtensions());
@@ -83,6 +84,9 @@ StrippedMainBase::StrippedMainBase(const Server::Options& options, Event::TimeSy
     std::set_new_handler([]() { PANIC("out of memory"); });
 
     stats_store_ = std::make_unique<Stats::ThreadLocalStoreImpl>(stats_allocator_);
+    if (options_.statsScopeTlsCachesDisabled()) {
+      stats_store_->disableScopeTlsCaches();
+    }
 
     server_ = std::make_unique<Server::InstanceImpl>(
         *init_manager_, options_, time_system, local_address, listener_hooks, *restarter_,
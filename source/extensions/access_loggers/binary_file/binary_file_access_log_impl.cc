@@ -0,0 +1,185 @@
+#include "source/extensions/access_loggers/binary_file/binary_file_access_log_impl.h"
+
+#include "envoy/http/protocol.h"
+
+#include "source/common/common/assert.h"
+#include "source/common/protobuf/utility.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace AccessLoggers {
+namespace BinaryFile {
+
+namespace {
+
+using ProtoConfig = envoy::extensions::access_loggers::binary_file::v3::BinaryFileAccessLog;
+
+constexpr uint32_t DefaultMaxBatchSize = 1024;
+constexpr uint64_t DefaultBatchFlushIntervalMs = 1000;
+
+std::vector<Field> fieldsFromConfig(const ProtoConfig& config) {
+  std::vector<Field> fields;
+  fields.reserve(config.fields_size());
+  for (const int field : config.fields()) {
+    fields.push_back(static_cast<Field>(field));
+  }
+  return fields;
+}
+
+absl::optional<absl::string_view> headerValue(const Http::HeaderEntry* entry) {
+  if (entry == nullptr) {
+    return absl::nullopt;
+  }
+  return entry->value().getStringView();
+}
+
+// The values of the PROTOCOL column are part of the file format documented in binary_file.proto,
+// so they are mapped explicitly rather than derived from the order of Http::Protocol.
+uint64_t protocolValue(const absl::optional<Http::Protocol>& protocol) {
+  if (!protocol.has_value()) {
+    return 0;
+  }
+  switch (protocol.value()) {
+  case Http::Protocol::Http10:
+    return 1;
+  case Http::Protocol::Http11:
+    return 2;
+  case Http::Protocol::Http2:
+    return 3;
+  case Http::Protocol::Http3:
+    return 4;
+  }
+  PANIC_DUE_TO_CORRUPT_ENUM;
+}
+
+uint64_t toMicroseconds(std::chrono::nanoseconds duration) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
+
+} // namespace
+
+BinaryFileAccessLog::ThreadLocalBatch::ThreadLocalBatch(const std::vector<Field>& fields,
+                                                        AccessLog::AccessLogFileSharedPtr log_file,
+                                                        Event::Dispatcher& dispatcher,
+                                                        std::chrono::milliseconds flush_interval)
+    : encoder_(fields), log_file_(std::move(log_file)), flush_interval_(flush_interval),
+      flush_timer_(dispatcher.createTimer([this]() {
+        flush();
+        flush_timer_->enableTimer(flush_interval_);
+      })) {
+  flush_timer_->enableTimer(flush_interval_);
+}
+
+BinaryFileAccessLog::ThreadLocalBatch::~ThreadLocalBatch() { flush(); }
+
+void BinaryFileAccessLog::ThreadLocalBatch::flush() {
+  if (encoder_.recordCount() == 0) {
+    return;
+  }
+  encoded_.clear();
+  encoder_.encode(encoded_);
+  log_file_->write(encoded_);
+}
+
+BinaryFileAccessLog::BinaryFileAccessLog(const ProtoConfig& config, AccessLog::FilterPtr&& filter,
+                                         AccessLog::AccessLogManager& log_manager,
+                                         ThreadLocal::SlotAllocator& tls)
+    : Common::ImplBase(std::move(filter)), fields_(fieldsFromConfig(config)),
+      max_batch_size_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_batch_size, DefaultMaxBatchSize)),
+      tls_slot_(tls) {
+  AccessLog::AccessLogFileSharedPtr log_file = log_manager.createAccessLog(
+      Filesystem::FilePathAndType{Filesystem::DestinationType::File, config.path()});
+  const std::chrono::milliseconds flush_interval(
+      PROTOBUF_GET_MS_OR_DEFAULT(config, batch_flush_interval, DefaultBatchFlushIntervalMs));
+  tls_slot_.set([fields = fields_, log_file, flush_interval](Event::Dispatcher& dispatcher) {
+    return std::make_shared<ThreadLocalBatch>(fields, log_file, dispatcher, flush_interval);
+  });
+}
+
+void BinaryFileAccessLog::emitLog(const Http::RequestHeaderMap& request_headers,
+                                  const Http::ResponseHeaderMap&, const Http::ResponseTrailerMap&,
+                                  const StreamInfo::StreamInfo& stream_info,
+                                  AccessLog::AccessLogType) {
+  ThreadLocalBatch& batch = *tls_slot_;
+  BatchEncoder& encoder = batch.encoder_;
+
+  for (uint32_t column = 0; column < fields_.size(); ++column) {
+    switch (fields_[column]) {
+      PANIC_ON_PROTO_ENUM_SENTINEL_VALUES;
+    case ProtoConfig::START_TIME:
+      encoder.addInt(column, toMicroseconds(stream_info.startTime().time_since_epoch()));
+      break;
+    case ProtoConfig::DURATION:
+      encoder.addInt(column, toMicroseconds(stream_info.requestComplete().value_or(
+                                 std::chrono::nanoseconds::zero())));
+      break;
+    case ProtoConfig::RESPONSE_CODE:
+      encoder.addInt(column, stream_info.responseCode().value_or(0));
+      break;
+    case ProtoConfig::RESPONSE_FLAGS:
+      encoder.addInt(column, stream_info.responseFlags());
+      break;
+    case ProtoConfig::PROTOCOL:
+      encoder.addInt(column, protocolValue(stream_info.protocol()));
+      break;
+    case ProtoConfig::BYTES_RECEIVED:
+      encoder.addInt(column, stream_info.bytesReceived());
+      break;
+    case ProtoConfig::BYTES_SENT:
+      encoder.addInt(column, stream_info.bytesSent());
+      break;
+    case ProtoConfig::REQUEST_METHOD:
+      encoder.addString(column, headerValue(request_headers.Method()));
+      break;
+    case ProtoConfig::AUTHORITY:
+      encoder.addString(column, headerValue(request_headers.Host()));
+      break;
+    case ProtoConfig::PATH:
+      encoder.addString(column, headerValue(request_headers.Path()));
+      break;
+    case ProtoConfig::USER_AGENT:
+      encoder.addString(column, headerValue(request_headers.UserAgent()));
+      break;
+    case ProtoConfig::REQUEST_ID:
+      encoder.addString(column, headerValue(request_headers.RequestId()));
+      break;
+    case ProtoConfig::UPSTREAM_CLUSTER: {
+      const auto cluster_info = stream_info.upstreamClusterInfo();
+      if (cluster_info.has_value() && cluster_info.value() != nullptr) {
+        encoder.addString(column, cluster_info.value()->name());
+      } else {
+        encoder.addString(column, absl::nullopt);
+      }
+      break;
+    }
+    case ProtoConfig::UPSTREAM_HOST: {
+      const auto upstream_info = stream_info.upstreamInfo();
+      if (upstream_info.has_value() && upstream_info->upstreamHost() != nullptr) {
+        encoder.addString(column, upstream_info->upstreamHost()->address()->asStringView());
+      } else {
+        encoder.addString(column, absl::nullopt);
+      }
+      break;
+    }
+    case ProtoConfig::DOWNSTREAM_REMOTE_ADDRESS: {
+      const auto& address = stream_info.downstreamAddressProvider().remoteAddress();
+      if (address != nullptr && address->ip() != nullptr) {
+        encoder.addString(column, address->ip()->addressAsString());
+      } else {
+        encoder.addString(column, absl::nullopt);
+      }
+      break;
+    }
+    }
+  }
+  encoder.finishRecord();
+
+  if (encoder.recordCount() >= max_batch_size_) {
+    batch.flush();
+  }
+}
+
+} // namespace BinaryFile
+} // namespace AccessLoggers
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "envoy/access_log/access_log.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/extensions/access_loggers/binary_file/v3/binary_file.pb.h"
+#include "envoy/thread_local/thread_local.h"
+
+#include "source/extensions/access_loggers/binary_file/binary_format.h"
+#include "source/extensions/access_loggers/common/access_log_base.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace AccessLoggers {
+namespace BinaryFile {
+
+/**
+ * Access log Instance that writes logs to a file in a binary columnar format. Each thread encodes
+ * its log entries into its own batch, which is written to the file once full or when the flush
+ * interval elapses.
+ */
+class BinaryFileAccessLog : public Common::ImplBase {
+public:
+  BinaryFileAccessLog(
+      const envoy::extensions::access_loggers::binary_file::v3::BinaryFileAccessLog& config,
+      AccessLog::FilterPtr&& filter, AccessLog::AccessLogManager& log_manager,
+      ThreadLocal::SlotAllocator& tls);
+
+private:
+  /**
+   * Per-thread batch of log entries.
+   */
+  struct ThreadLocalBatch : public ThreadLocal::ThreadLocalObject {
+    ThreadLocalBatch(const std::vector<Field>& fields, AccessLog::AccessLogFileSharedPtr log_file,
+                     Event::Dispatcher& dispatcher, std::chrono::milliseconds flush_interval);
+    ~ThreadLocalBatch() override;
+
+    void flush();
+
+    BatchEncoder encoder_;
+    std::string encoded_;
+    const AccessLog::AccessLogFileSharedPtr log_file_;
+    const std::chrono::milliseconds flush_interval_;
+    const Event::TimerPtr flush_timer_;
+  };
+
+  // Common::ImplBase
+  void emitLog(const Http::RequestHeaderMap& request_headers,
+               const Http::ResponseHeaderMap& response_headers,
+               const Http::ResponseTrailerMap& response_trailers,
+               const StreamInfo::StreamInfo& stream_info,
+               AccessLog::AccessLogType access_log_type) override;
+
+  const std::vector<Field> fields_;
+  const uint32_t max_batch_size_;
+  ThreadLocal::TypedSlot<ThreadLocalBatch> tls_slot_;
+};
+
+} // namespace BinaryFile
+} // namespace AccessLoggers
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,240 @@
+#include "source/extensions/access_loggers/binary_file/binary_format.h"
+
+#include <cstring>
+#include <limits>
+
+#include "source/common/common/assert.h"
+#include "source/common/common/byte_order.h"
+
+#include "absl/status/status.h"
+#include "absl/strings/match.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace AccessLoggers {
+namespace BinaryFile {
+
+namespace {
+
+using ProtoConfig = envoy::extensions::access_loggers::binary_file::v3::BinaryFileAccessLog;
+
+void appendVarint(std::string& output, uint64_t value) {
+  while (value >= 0x80) {
+    output.push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  output.push_back(static_cast<char>(value));
+}
+
+bool readVarint(absl::string_view& data, uint64_t& value) {
+  value = 0;
+  for (uint32_t shift = 0; shift < 64 && !data.empty(); shift += 7) {
+    const uint8_t byte = data[0];
+    data.remove_prefix(1);
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+uint64_t zigzagEncode(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t zigzagDecode(uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+absl::Status decodeColumn(absl::string_view data, uint64_t record_count, DecodedColumn& column) {
+  if (!isStringField(column.field_)) {
+    column.ints_.reserve(record_count);
+    int64_t previous = 0;
+    for (uint64_t i = 0; i < record_count; ++i) {
+      uint64_t value;
+      if (!readVarint(data, value)) {
+        return absl::DataLossError("truncated integer column");
+      }
+      if (column.field_ == ProtoConfig::START_TIME) {
+        previous += zigzagDecode(value);
+        value = previous;
+      }
+      column.ints_.push_back(value);
+    }
+    return absl::OkStatus();
+  }
+
+  uint64_t dictionary_size;
+  if (!readVarint(data, dictionary_size)) {
+    return absl::DataLossError("truncated string column dictionary");
+  }
+  std::vector<absl::string_view> dictionary;
+  for (uint64_t i = 0; i < dictionary_size; ++i) {
+    uint64_t length;
+    if (!readVarint(data, length) || length > data.size()) {
+      return absl::DataLossError("truncated string column dictionary");
+    }
+    dictionary.push_back(data.substr(0, length));
+    data.remove_prefix(length);
+  }
+  column.strings_.reserve(record_count);
+  for (uint64_t i = 0; i < record_count; ++i) {
+    uint64_t index;
+    if (!readVarint(data, index) || index > dictionary.size()) {
+      return absl::DataLossError("invalid string column index");
+    }
+    if (index == 0) {
+      column.strings_.push_back(absl::nullopt);
+    } else {
+      column.strings_.push_back(std::string(dictionary[index - 1]));
+    }
+  }
+  return absl::OkStatus();
+}
+
+} // namespace
+
+bool isStringField(Field field) {
+  switch (field) {
+    PANIC_ON_PROTO_ENUM_SENTINEL_VALUES;
+  case ProtoConfig::START_TIME:
+  case ProtoConfig::DURATION:
+  case ProtoConfig::RESPONSE_CODE:
+  case ProtoConfig::RESPONSE_FLAGS:
+  case ProtoConfig::PROTOCOL:
+  case ProtoConfig::BYTES_RECEIVED:
+  case ProtoConfig::BYTES_SENT:
+    return false;
+  case ProtoConfig::REQUEST_METHOD:
+  case ProtoConfig::AUTHORITY:
+  case ProtoConfig::PATH:
+  case ProtoConfig::USER_AGENT:
+  case ProtoConfig::REQUEST_ID:
+  case ProtoConfig::UPSTREAM_CLUSTER:
+  case ProtoConfig::UPSTREAM_HOST:
+  case ProtoConfig::DOWNSTREAM_REMOTE_ADDRESS:
+    return true;
+  }
+  PANIC_DUE_TO_CORRUPT_ENUM;
+}
+
+BatchEncoder::BatchEncoder(const std::vector<Field>& fields) {
+  columns_.reserve(fields.size());
+  for (const Field field : fields) {
+    columns_.emplace_back(field);
+  }
+}
+
+void BatchEncoder::addString(uint32_t column, absl::optional<absl::string_view> value) {
+  Column& col = columns_[column];
+  ASSERT(col.is_string_);
+  if (!value.has_value()) {
+    col.values_.push_back(0);
+    return;
+  }
+  auto it = col.dictionary_indexes_.find(value.value());
+  if (it == col.dictionary_indexes_.end()) {
+    col.dictionary_.emplace_back(value.value());
+    it = col.dictionary_indexes_.emplace(col.dictionary_.back(), col.dictionary_.size()).first;
+  }
+  col.values_.push_back(it->second);
+}
+
+void BatchEncoder::encode(std::string& output) {
+  body_.clear();
+  appendVarint(body_, FormatVersion);
+  appendVarint(body_, record_count_);
+  appendVarint(body_, columns_.size());
+
+  for (Column& column : columns_) {
+    ASSERT(column.values_.size() == record_count_);
+    column_data_.clear();
+    if (column.is_string_) {
+      appendVarint(column_data_, column.dictionary_.size());
+      for (const std::string& value : column.dictionary_) {
+        appendVarint(column_data_, value.size());
+        column_data_.append(value);
+      }
+      for (const uint64_t index : column.values_) {
+        appendVarint(column_data_, index);
+      }
+      column.dictionary_.clear();
+      column.dictionary_indexes_.clear();
+    } else if (column.field_ == ProtoConfig::START_TIME) {
+      uint64_t previous = 0;
+      for (const uint64_t value : column.values_) {
+        appendVarint(column_data_, zigzagEncode(static_cast<int64_t>(value - previous)));
+        previous = value;
+      }
+    } else {
+      for (const uint64_t value : column.values_) {
+        appendVarint(column_data_, value);
+      }
+    }
+    column.values_.clear();
+
+    appendVarint(body_, column.field_);
+    appendVarint(body_, column_data_.size());
+    body_.append(column_data_);
+  }
+  record_count_ = 0;
+
+  const uint32_t length =
+      toEndianness<ByteOrder::LittleEndian>(static_cast<uint32_t>(body_.size()));
+  output.append(BatchMagic.data(), BatchMagic.size());
+  output.append(reinterpret_cast<const char*>(&length), sizeof(length));
+  output.append(body_);
+}
+
+absl::StatusOr<DecodedBatch> decodeBatch(absl::string_view& data) {
+  const size_t header_size = BatchMagic.size() + sizeof(uint32_t);
+  if (data.size() < header_size || !absl::StartsWith(data, BatchMagic)) {
+    return absl::DataLossError("missing batch header");
+  }
+  uint32_t body_size;
+  memcpy(&body_size, data.data() + BatchMagic.size(), sizeof(body_size));
+  body_size = fromEndianness<ByteOrder::LittleEndian>(body_size);
+  if (data.size() - header_size < body_size) {
+    return absl::DataLossError("truncated batch");
+  }
+  absl::string_view body = data.substr(header_size, body_size);
+
+  DecodedBatch batch;
+  uint64_t version;
+  uint64_t column_count;
+  if (!readVarint(body, version) || !readVarint(body, batch.record_count_) ||
+      !readVarint(body, column_count)) {
+    return absl::DataLossError("truncated batch header");
+  }
+  if (version != FormatVersion) {
+    return absl::InvalidArgumentError("unsupported batch version");
+  }
+  for (uint64_t i = 0; i < column_count; ++i) {
+    uint64_t field;
+    uint64_t length;
+    if (!readVarint(body, field) || !readVarint(body, length) || length > body.size()) {
+      return absl::DataLossError("truncated column");
+    }
+    const absl::string_view column_data = body.substr(0, length);
+    body.remove_prefix(length);
+    if (field > static_cast<uint64_t>(std::numeric_limits<int>::max()) ||
+        !ProtoConfig::Field_IsValid(static_cast<int>(field))) {
+      continue;
+    }
+    DecodedColumn& column = batch.columns_.emplace_back();
+    column.field_ = static_cast<Field>(field);
+    absl::Status status = decodeColumn(column_data, batch.record_count_, column);
+    if (!status.ok()) {
+      return status;
+    }
+  }
+
+  data.remove_prefix(header_size + body_size);
+  return batch;
+}
+
+} // namespace BinaryFile
+} // namespace AccessLoggers
+} // namespace Extensions
+} // namespace Envoy
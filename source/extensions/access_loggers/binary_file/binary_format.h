@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "envoy/extensions/access_loggers/binary_file/v3/binary_file.pb.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace AccessLoggers {
+namespace BinaryFile {
+
+using Field = envoy::extensions::access_loggers::binary_file::v3::BinaryFileAccessLog::Field;
+
+// Magic bytes at the start of every batch.
+constexpr absl::string_view BatchMagic = "EBAL";
+// Version of the batch body encoding.
+constexpr uint64_t FormatVersion = 1;
+
+/**
+ * @return whether the field is a string column. All the other fields are integer columns.
+ */
+bool isStringField(Field field);
+
+/**
+ * Accumulates records into the columns of a batch, and encodes the batch in the format documented
+ * in binary_file.proto. An encoder is used by a single thread.
+ */
+class BatchEncoder {
+public:
+  explicit BatchEncoder(const std::vector<Field>& fields);
+
+  /**
+   * Set the value of an integer column for the current record.
+   * @param column supplies the index of the column in the fields passed at construction.
+   */
+  void addInt(uint32_t column, uint64_t value) { columns_[column].values_.push_back(value); }
+
+  /**
+   * Set the value of a string column for the current record.
+   * @param column supplies the index of the column in the fields passed at construction.
+   * @param value supplies the value, or absl::nullopt if it is absent.
+   */
+  void addString(uint32_t column, absl::optional<absl::string_view> value);
+
+  /**
+   * Complete the current record. Every column must have been given a value for it.
+   */
+  void finishRecord() { ++record_count_; }
+
+  /**
+   * @return the number of records in the current batch.
+   */
+  uint32_t recordCount() const { return record_count_; }
+
+  /**
+   * Append the current batch to output, and start a new empty batch.
+   */
+  void encode(std::string& output);
+
+private:
+  struct Column {
+    explicit Column(Field field) : field_(field), is_string_(isStringField(field)) {}
+
+    const Field field_;
+    const bool is_string_;
+    // The integer values, or for string columns the 1-based dictionary indexes with 0 for absent
+    // values.
+    std::vector<uint64_t> values_;
+    std::vector<std::string> dictionary_;
+    absl::flat_hash_map<std::string, uint64_t> dictionary_indexes_;
+  };
+
+  std::vector<Column> columns_;
+  uint32_t record_count_{0};
+  // Scratch space reused across batches.
+  std::string body_;
+  std::string column_data_;
+};
+
+/**
+ * A column decoded from a batch. Only one of ints_ and strings_ is filled depending on the type of
+ * the field.
+ */
+struct DecodedColumn {
+  Field field_;
+  std::vector<uint64_t> ints_;
+  std::vector<absl::optional<std::string>> strings_;
+};
+
+struct DecodedBatch {
+  uint64_t record_count_{0};
+  // Columns of fields unknown to this version of the decoder are skipped.
+  std::vector<DecodedColumn> columns_;
+};
+
+/**
+ * Decode the batch at the start of data, and advance data past it.
+ * @return the decoded batch, or an error if data doesn't start with a complete and valid batch.
+ */
+absl::StatusOr<DecodedBatch> decodeBatch(absl::string_view& data);
+
+} // namespace BinaryFile
+} // namespace AccessLoggers
+} // namespace Extensions
+} // namespace Envoy
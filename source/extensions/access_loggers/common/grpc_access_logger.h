@@ -245,7 +245,7 @@ public:
   }
 
   void log(HttpLogProto&& entry) override {
-    if (!canLogMore()) {
+    if (!canLogMore(isHighPriority(entry))) {
       return;
     }
     approximate_message_size_bytes_ += entry.ByteSizeLong();
@@ -256,6 +256,9 @@ public:
   }
 
   void log(TcpLogProto&& entry) override {
+    if (!canLogMore(isHighPriority(entry))) {
+      return;
+    }
     approximate_message_size_bytes_ += entry.ByteSizeLong();
     addEntry(std::move(entry));
     if (approximate_message_size_bytes_ >= max_buffer_size_bytes_) {
@@ -273,6 +276,10 @@ private:
   virtual void addEntry(HttpLogProto&& entry) PURE;
   virtual void addEntry(TcpLogProto&& entry) PURE;
   virtual void clearMessage() { message_.Clear(); }
+  // High priority entries, such as the logs of failed requests, may use the headroom above the
+  // buffer size when the stream is backed up, so that they are dropped after other entries.
+  virtual bool isHighPriority(const HttpLogProto&) { return false; }
+  virtual bool isHighPriority(const TcpLogProto&) { return false; }
 
   void flush() {
     if (isEmpty()) {
@@ -291,13 +298,15 @@ private:
     }
   }
 
-  bool canLogMore() {
+  bool canLogMore(bool high_priority) {
     if (max_buffer_size_bytes_ == 0 || approximate_message_size_bytes_ < max_buffer_size_bytes_) {
       stats_.logs_written_.inc();
       return true;
     }
     flush();
-    if (approximate_message_size_bytes_ < max_buffer_size_bytes_) {
+    const uint64_t limit = high_priority ? max_buffer_size_bytes_ + max_buffer_size_bytes_ / 4
+                                         : max_buffer_size_bytes_;
+    if (approximate_message_size_bytes_ < limit) {
       stats_.logs_written_.inc();
       return true;
     }
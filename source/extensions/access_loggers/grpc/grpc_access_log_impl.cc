@@ -36,6 +36,18 @@ bool GrpcAccessLoggerImpl::isEmpty() {
   return !message_.has_http_logs() && !message_.has_tcp_logs();
 }
 
+bool GrpcAccessLoggerImpl::isHighPriority(
+    const envoy::data::accesslog::v3::HTTPAccessLogEntry& entry) {
+  // Response flags are only set when at least one of them is.
+  return entry.common_properties().has_response_flags() ||
+         (entry.response().has_response_code() && entry.response().response_code().value() >= 500);
+}
+
+bool GrpcAccessLoggerImpl::isHighPriority(
+    const envoy::data::accesslog::v3::TCPAccessLogEntry& entry) {
+  return entry.common_properties().has_response_flags();
+}
+
 void GrpcAccessLoggerImpl::initMessage() {
   auto* identifier = message_.mutable_identifier();
   *identifier->mutable_node() = local_info_.node();
@@ -9,6 +9,7 @@
 #include "source/common/network/dns_resolver/dns_factory_util.h"
 #include "source/common/network/resolver_impl.h"
 #include "source/common/network/utility.h"
+#include "source/server/hot_restart_state.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -33,7 +34,8 @@ DnsCacheImpl::DnsCacheImpl(
       file_system_(context.api().fileSystem()),
       validation_visitor_(context.messageValidationVisitor()),
       host_ttl_(PROTOBUF_GET_MS_OR_DEFAULT(config, host_ttl, 300000)),
-      max_hosts_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_hosts, 1024)) {
+      max_hosts_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_hosts, 1024)),
+      hot_restart_section_name_(fmt::format("dns_cache.{}", config.name())) {
   tls_slot_.set([&](Event::Dispatcher&) { return std::make_shared<ThreadLocalHostInfo>(*this); });
 
   if (static_cast<size_t>(config.preresolve_hostnames().size()) > max_hosts_) {
@@ -43,6 +45,7 @@ DnsCacheImpl::DnsCacheImpl(
   }
 
   loadCacheEntries(config);
+  loadHotRestartState();
 
   // Preresolved hostnames are resolved without a read lock on primary hosts because it is done
   // during object construction.
@@ -503,6 +506,13 @@ void DnsCacheImpl::addCacheEntry(
   if (!key_value_store_) {
     return;
   }
+  key_value_store_->addOrUpdate(host, cacheEntryValue(address, address_list, ttl), absl::nullopt);
+}
+
+std::string DnsCacheImpl::cacheEntryValue(
+    const Network::Address::InstanceConstSharedPtr& address,
+    const std::vector<Network::Address::InstanceConstSharedPtr>& address_list,
+    const std::chrono::seconds ttl) const {
   MonotonicTime now = main_thread_dispatcher_.timeSource().monotonicTime();
   uint64_t seconds_since_epoch =
       std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count();
@@ -515,7 +525,7 @@ void DnsCacheImpl::addCacheEntry(
                             seconds_since_epoch);
     }
   }
-  key_value_store_->addOrUpdate(host, value, absl::nullopt);
+  return value;
 }
 
 void DnsCacheImpl::removeCacheEntry(const std::string& host) {
@@ -569,31 +579,88 @@ void DnsCacheImpl::loadCacheEntries(
   key_value_store_ = factory.createStore(config.key_value_config(), validation_visitor_,
                                          main_thread_dispatcher_, file_system_);
   KeyValueStore::ConstIterateCb load = [this](const std::string& key, const std::string& value) {
-    absl::optional<MonotonicTime> resolution_time;
-    std::list<Network::DnsResponse> responses;
-    const auto addresses = StringUtil::splitToken(value, "\n");
-    for (absl::string_view address_line : addresses) {
-      absl::optional<Network::DnsResponse> response = parseValue(address_line, resolution_time);
-      if (!response.has_value()) {
-        return KeyValueStore::Iterate::Break;
+    return loadCacheEntry(key, value) ? KeyValueStore::Iterate::Continue
+                                      : KeyValueStore::Iterate::Break;
+  };
+  key_value_store_->iterate(load);
+}
+
+bool DnsCacheImpl::loadCacheEntry(const std::string& host, const std::string& value) {
+  absl::optional<MonotonicTime> resolution_time;
+  std::list<Network::DnsResponse> responses;
+  const auto addresses = StringUtil::splitToken(value, "\n");
+  for (absl::string_view address_line : addresses) {
+    absl::optional<Network::DnsResponse> response = parseValue(address_line, resolution_time);
+    if (!response.has_value()) {
+      return false;
+    }
+    responses.emplace_back(response.value());
+  }
+  if (responses.empty()) {
+    return false;
+  }
+  createHost(host, responses.front().addrInfo().address_->ip()->port());
+  ENVOY_LOG_EVENT(
+      debug, "dns_cache_load_finished", "persistent dns cache load complete for host '{}': {}",
+      host, accumulateToString<Network::DnsResponse>(responses, [](const auto& dns_response) {
+        return dns_response.addrInfo().address_->asString();
+      }));
+  finishResolve(host, Network::DnsResolver::ResolutionStatus::Success, std::move(responses),
+                resolution_time);
+  stats_.cache_load_.inc();
+  return true;
+}
+
+void DnsCacheImpl::loadHotRestartState() {
+  Server::HotRestartState* hot_restart_state = Server::HotRestartStateSingleton::getExisting();
+  if (hot_restart_state == nullptr) {
+    return;
+  }
+  hot_restart_exporter_ = hot_restart_state->addExporter(
+      [this](Server::HotRestart::State& state) { exportHotRestartState(state); });
+
+  // Warm the cache with the hosts our hot restart parent had resolved, so that the first requests
+  // of the new process do not all wait on DNS. Hosts already loaded from the key value store are
+  // left alone.
+  const absl::optional<Server::HotRestart::StateSection> section =
+      hot_restart_state->takeParentSection(hot_restart_section_name_);
+  if (!section.has_value()) {
+    return;
+  }
+  for (const auto& [host, value] : section.value()) {
+    {
+      absl::ReaderMutexLock reader_lock{&primary_hosts_lock_};
+      if (primary_hosts_.size() >= max_hosts_) {
+        break;
+      }
+      if (primary_hosts_.contains(host)) {
+        continue;
       }
-      responses.emplace_back(response.value());
     }
-    if (responses.empty()) {
-      return KeyValueStore::Iterate::Break;
+    loadCacheEntry(host, value);
+  }
+}
+
+void DnsCacheImpl::exportHotRestartState(Server::HotRestart::State& state) {
+  ASSERT(main_thread_dispatcher_.isThreadSafe());
+  const MonotonicTime now = main_thread_dispatcher_.timeSource().monotonicTime();
+  Server::HotRestart::StateSection& section = state[hot_restart_section_name_];
+  absl::ReaderMutexLock reader_lock{&primary_hosts_lock_};
+  for (const auto& [host, primary_host] : primary_hosts_) {
+    const DnsHostInfoImplSharedPtr& host_info = primary_host->host_info_;
+    const Network::Address::InstanceConstSharedPtr address = host_info->address();
+    if (host_info->isIpAddress() || address == nullptr) {
+      continue;
     }
-    createHost(key, responses.front().addrInfo().address_->ip()->port());
-    ENVOY_LOG_EVENT(
-        debug, "dns_cache_load_finished", "persistent dns cache load complete for host '{}': {}",
-        key, accumulateToString<Network::DnsResponse>(responses, [](const auto& dns_response) {
-          return dns_response.addrInfo().address_->asString();
-        }));
-    finishResolve(key, Network::DnsResolver::ResolutionStatus::Success, std::move(responses),
-                  resolution_time);
-    stats_.cache_load_.inc();
-    return KeyValueStore::Iterate::Continue;
-  };
-  key_value_store_->iterate(load);
+    // Export the time left until the entry goes stale as its TTL. Entries that are (nearly) stale
+    // will be resolved again by the child anyway.
+    const auto ttl =
+        std::chrono::duration_cast<std::chrono::seconds>(host_info->staleAtTime() - now);
+    if (ttl.count() <= 0) {
+      continue;
+    }
+    section.emplace(host, cacheEntryValue(address, host_info->addressList(), ttl));
+  }
 }
 
 } // namespace DynamicForwardProxy
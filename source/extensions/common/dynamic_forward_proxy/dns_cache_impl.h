@@ -1,11 +1,13 @@
 #pragma once
 
 #include "envoy/common/backoff_strategy.h"
+#include "envoy/common/callback.h"
 #include "envoy/common/key_value_store.h"
 #include "envoy/extensions/common/dynamic_forward_proxy/v3/dns_cache.pb.h"
 #include "envoy/http/filter.h"
 #include "envoy/network/dns.h"
 #include "envoy/server/factory_context.h"
+#include "envoy/server/hot_restart.h"
 #include "envoy/thread_local/thread_local.h"
 
 #include "source/common/common/cleanup.h"
@@ -125,6 +127,7 @@ private:
     void updateStale(MonotonicTime resolution_time, std::chrono::seconds ttl) {
       stale_at_time_ = resolution_time + ttl;
     }
+    MonotonicTime staleAtTime() const { return stale_at_time_; }
     bool isStale() {
       return time_source_.monotonicTime() > static_cast<MonotonicTime>(stale_at_time_);
     }
@@ -218,9 +221,16 @@ private:
                      const Network::Address::InstanceConstSharedPtr& address,
                      const std::vector<Network::Address::InstanceConstSharedPtr>& address_list,
                      const std::chrono::seconds ttl);
+  std::string
+  cacheEntryValue(const Network::Address::InstanceConstSharedPtr& address,
+                  const std::vector<Network::Address::InstanceConstSharedPtr>& address_list,
+                  const std::chrono::seconds ttl) const;
   void removeCacheEntry(const std::string& host);
   void loadCacheEntries(
       const envoy::extensions::common::dynamic_forward_proxy::v3::DnsCacheConfig& config);
+  bool loadCacheEntry(const std::string& host, const std::string& value);
+  void loadHotRestartState();
+  void exportHotRestartState(Server::HotRestart::State& state);
   PrimaryHostInfo* createHost(const std::string& host, uint16_t default_port);
   absl::optional<Network::DnsResponse> parseValue(absl::string_view value,
                                                   absl::optional<MonotonicTime>& resolution_time);
@@ -246,6 +256,8 @@ private:
   ProtobufMessage::ValidationVisitor& validation_visitor_;
   const std::chrono::milliseconds host_ttl_;
   const uint32_t max_hosts_;
+  const std::string hot_restart_section_name_;
+  Envoy::Common::CallbackHandlePtr hot_restart_exporter_;
 };
 
 } // namespace DynamicForwardProxy
@@ -31,6 +31,15 @@ struct CodeCacheEntry {
   MonotonicTime fetch_time;
 };
 
+struct LocalCodeCacheEntry {
+  uint64_t size{};
+  SystemTime modified_time{};
+  std::string code;
+  // VM keys of the code, by VM id and VM configuration.
+  absl::flat_hash_map<std::pair<std::string, std::string>, std::string> vm_keys;
+  MonotonicTime use_time;
+};
+
 class RemoteDataFetcherAdapter : public Config::DataFetcher::RemoteDataFetcherCallback,
                                  public Event::DeferredDeletable {
 public:
@@ -55,6 +64,63 @@ MonotonicTime::duration cache_time_offset_for_testing{};
 std::mutex code_cache_mutex;
 absl::flat_hash_map<std::string, CodeCacheEntry>* code_cache = nullptr;
 
+// Module files by path. Large modules are typically shared by the plugins of many listeners and
+// filter chains, so reading and hashing the module again for each plugin dominates startup.
+std::mutex local_code_cache_mutex;
+absl::flat_hash_map<std::string, LocalCodeCacheEntry>* local_code_cache = nullptr;
+
+// Reads the code of a local data source and computes its VM key. The code of files is cached until
+// the file changes, along with its VM keys.
+void loadLocalCode(const envoy::extensions::wasm::v3::VmConfig& vm_config, Api::Api& api,
+                   MonotonicTime now, std::string& code, std::string& vm_key) {
+  const auto& source = vm_config.code().local();
+  const std::string vm_configuration = MessageUtil::anyToBytes(vm_config.configuration());
+  absl::optional<uint64_t> size;
+  absl::optional<SystemTime> modified_time;
+  if (source.specifier_case() == envoy::config::core::v3::DataSource::SpecifierCase::kFilename) {
+    const Api::IoCallResult<Filesystem::FileInfo> file_info =
+        api.fileSystem().stat(source.filename());
+    if (file_info.ok()) {
+      size = file_info.return_value_.size_;
+      modified_time = file_info.return_value_.time_last_modified_;
+    }
+  }
+  if (!size.has_value() || !modified_time.has_value()) {
+    code = Config::DataSource::read(source, true, api);
+    vm_key = proxy_wasm::makeVmKey(vm_config.vm_id(), vm_configuration, code);
+    return;
+  }
+
+  std::lock_guard<std::mutex> guard(local_code_cache_mutex);
+  if (!local_code_cache) {
+    local_code_cache = new std::remove_reference<decltype(*local_code_cache)>::type;
+  }
+  // Remove entries older than CODE_CACHE_SECONDS_CACHING_TTL except for our target.
+  for (auto it = local_code_cache->begin(); it != local_code_cache->end();) {
+    if (now - it->second.use_time > std::chrono::seconds(CODE_CACHE_SECONDS_CACHING_TTL) &&
+        it->first != source.filename()) {
+      local_code_cache->erase(it++);
+    } else {
+      ++it;
+    }
+  }
+  LocalCodeCacheEntry& entry = (*local_code_cache)[source.filename()];
+  if (entry.code.empty() || entry.size != size.value() ||
+      entry.modified_time != modified_time.value()) {
+    entry.code = Config::DataSource::read(source, true, api);
+    entry.size = size.value();
+    entry.modified_time = modified_time.value();
+    entry.vm_keys.clear();
+  }
+  entry.use_time = now;
+  auto& entry_vm_key = entry.vm_keys[std::make_pair(vm_config.vm_id(), vm_configuration)];
+  if (entry_vm_key.empty()) {
+    entry_vm_key = proxy_wasm::makeVmKey(vm_config.vm_id(), vm_configuration, entry.code);
+  }
+  code = entry.code;
+  vm_key = entry_vm_key;
+}
+
 // Downcast WasmBase to the actual Wasm.
 inline Wasm* getWasm(WasmHandleSharedPtr& base_wasm_handle) {
   return static_cast<Wasm*>(base_wasm_handle->wasm().get());
@@ -241,6 +307,13 @@ void Wasm::onStatsUpdate(const PluginSharedPtr& plugin, Envoy::Stats::MetricSnap
 }
 
 void clearCodeCacheForTesting() {
+  {
+    std::lock_guard<std::mutex> guard(local_code_cache_mutex);
+    if (local_code_cache) {
+      delete local_code_cache;
+      local_code_cache = nullptr;
+    }
+  }
   std::lock_guard<std::mutex> guard(code_cache_mutex);
   if (code_cache) {
     delete code_cache;
@@ -319,7 +392,7 @@ bool createWasm(const PluginSharedPtr& plugin, const Stats::ScopeSharedPtr& scop
                 Config::DataSource::RemoteAsyncDataProviderPtr& remote_data_provider,
                 CreateWasmCallback&& cb, CreateContextFn create_root_context_for_testing) {
   auto& stats_handler = getCreateStatsHandler();
-  std::string source, code;
+  std::string source, code, vm_key;
   auto config = plugin->wasmConfig();
   auto vm_config = config.config().vm_config();
   bool fetch = false;
@@ -377,13 +450,17 @@ bool createWasm(const PluginSharedPtr& plugin, const Stats::ScopeSharedPtr& scop
       stats_handler.onEvent(WasmEvent::RemoteLoadCacheMiss);
     }
   } else if (vm_config.code().has_local()) {
-    code = Config::DataSource::read(vm_config.code().local(), true, api);
+    loadLocalCode(vm_config, api,
+                  dispatcher.timeSource().monotonicTime() + cache_time_offset_for_testing, code,
+                  vm_key);
     source = Config::DataSource::getPath(vm_config.code().local())
                  .value_or(code.empty() ? EMPTY_STRING : INLINE_STRING);
   }
 
-  auto vm_key = proxy_wasm::makeVmKey(vm_config.vm_id(),
-                                      MessageUtil::anyToBytes(vm_config.configuration()), code);
+  if (vm_key.empty()) {
+    vm_key = proxy_wasm::makeVmKey(vm_config.vm_id(),
+                                   MessageUtil::anyToBytes(vm_config.configuration()), code);
+  }
   auto complete_cb = [cb, vm_key, plugin, scope, &api, &cluster_manager, &dispatcher,
                       &lifecycle_notifier, create_root_context_for_testing,
                       &stats_handler](std::string code) -> bool {
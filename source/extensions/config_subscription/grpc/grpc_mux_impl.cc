@@ -3,6 +3,7 @@
 #include "envoy/service/discovery/v3/discovery.pb.h"
 
 #include "source/common/config/decoded_resource_impl.h"
+#include "source/common/config/resource_decode_pool.h"
 #include "source/common/config/utility.h"
 #include "source/common/memory/utils.h"
 #include "source/common/protobuf/protobuf.h"
@@ -299,7 +300,9 @@ void GrpcMuxImpl::onDiscoveryResponse(
     std::vector<DecodedResourcePtr> resources;
     OpaqueResourceDecoder& resource_decoder = *api_state.watches_.front()->resource_decoder_;
 
-    for (const auto& resource : message->resources()) {
+    auto decode_resource = [&message, &type_url](
+                               size_t index, OpaqueResourceDecoder& decoder) -> DecodedResourcePtr {
+      const ProtobufWkt::Any& resource = message->resources()[index];
       // TODO(snowp): Check the underlying type when the resource is a Resource.
       if (!resource.Is<envoy::service::discovery::v3::Resource>() &&
           type_url != resource.type_url()) {
@@ -307,10 +310,21 @@ void GrpcMuxImpl::onDiscoveryResponse(
             fmt::format("{} does not match the message-wide type URL {} in DiscoveryResponse {}",
                         resource.type_url(), type_url, message->DebugString()));
       }
+      return DecodedResourceImpl::fromResource(decoder, resource, message->version_info());
+    };
+    std::vector<DecodedResourcePtr> decoded_resources;
+    if (ResourceDecodePool* decode_pool = ResourceDecodePoolSingleton::getExisting();
+        decode_pool != nullptr) {
+      // The pool rethrows the first error in resource order, as the serial loop below would.
+      decoded_resources =
+          decode_pool->decode(resource_decoder, message->resources().size(), decode_resource);
+    } else {
+      for (int i = 0; i < message->resources().size(); ++i) {
+        decoded_resources.emplace_back(decode_resource(i, resource_decoder));
+      }
+    }
 
-      auto decoded_resource =
-          DecodedResourceImpl::fromResource(resource_decoder, resource, message->version_info());
-
+    for (auto& decoded_resource : decoded_resources) {
       if (!isHeartbeatResource(type_url, *decoded_resource)) {
         resources.emplace_back(std::move(decoded_resource));
       }
@@ -1,5 +1,7 @@
 #include "source/extensions/config_subscription/grpc/new_delta_subscription_state.h"
 
+#include <algorithm>
+
 #include "envoy/event/dispatcher.h"
 #include "envoy/service/discovery/v3/discovery.pb.h"
 
@@ -147,11 +149,33 @@ UpdateAck NewDeltaSubscriptionState::handleResponse(
   TRY_ASSERT_MAIN_THREAD { handleGoodResponse(message); }
   END_TRY
   catch (const EnvoyException& e) {
+    // A rejected chunk ends the chunked update it belongs to.
+    endChunkedUpdate();
     handleBadResponse(e, ack);
   }
   return ack;
 }
 
+void NewDeltaSubscriptionState::markStreamFresh() {
+  any_request_sent_yet_in_current_stream_ = false;
+  // The server starts over on the new stream, so the chunks of an update it split won't follow.
+  endChunkedUpdate();
+}
+
+void NewDeltaSubscriptionState::endChunkedUpdate() {
+  chunked_update_names_.clear();
+  if (!chunked_update_in_progress_) {
+    return;
+  }
+  chunked_update_in_progress_ = false;
+  TRY_ASSERT_MAIN_THREAD { watch_map_.onChunkedConfigUpdateInterrupted(); }
+  END_TRY
+  catch (const EnvoyException& e) {
+    ENVOY_LOG(warn, "delta config for {} rejected: {}", type_url_, e.what());
+    watch_map_.onConfigUpdateFailed(Envoy::Config::ConfigUpdateFailureReason::UpdateRejected, &e);
+  }
+}
+
 bool NewDeltaSubscriptionState::isHeartbeatResponse(
     const envoy::service::discovery::v3::Resource& resource) const {
   if (!supports_heartbeats_) {
@@ -191,6 +215,10 @@ void NewDeltaSubscriptionState::handleGoodResponse(
       throw EnvoyException(
           fmt::format("duplicate name {} found among added/updated resources", resource.name()));
     }
+    if (chunked_update_names_.contains(resource.name())) {
+      throw EnvoyException(fmt::format("duplicate name {} found in an earlier chunk of the update",
+                                       resource.name()));
+    }
     if (isHeartbeatResponse(resource)) {
       continue;
     }
@@ -211,10 +239,19 @@ void NewDeltaSubscriptionState::handleGoodResponse(
       throw EnvoyException(
           fmt::format("duplicate name {} found in the union of added+removed resources", name));
     }
+    if (chunked_update_names_.contains(name)) {
+      throw EnvoyException(
+          fmt::format("duplicate name {} found in an earlier chunk of the update", name));
+    }
   }
 
-  watch_map_.onConfigUpdate(non_heartbeat_resources, message.removed_resources(),
-                            message.system_version_info());
+  if (message.more_chunks() || chunked_update_in_progress_) {
+    watch_map_.onChunkedConfigUpdate(non_heartbeat_resources, message.removed_resources(),
+                                     message.system_version_info(), message.more_chunks());
+  } else {
+    watch_map_.onConfigUpdate(non_heartbeat_resources, message.removed_resources(),
+                              message.system_version_info());
+  }
 
   // Processing point when resources are successfully ingested.
   if (xds_config_tracker_.has_value()) {
@@ -258,8 +295,15 @@ void NewDeltaSubscriptionState::handleGoodResponse(
       wildcard_resource_state_.erase(resource_name);
     }
   }
-  ENVOY_LOG(debug, "Delta config for {} accepted with {} resources added, {} removed", type_url_,
-            message.resources().size(), message.removed_resources().size());
+  if (message.more_chunks()) {
+    chunked_update_names_.merge(names_added_removed);
+  } else {
+    chunked_update_names_.clear();
+  }
+  chunked_update_in_progress_ = message.more_chunks();
+  ENVOY_LOG(debug, "Delta config for {} accepted with {} resources added, {} removed{}", type_url_,
+            message.resources().size(), message.removed_resources().size(),
+            message.more_chunks() ? ", more chunks to follow" : "");
 }
 
 void NewDeltaSubscriptionState::handleBadResponse(const EnvoyException& e, UpdateAck& ack) {
@@ -318,6 +362,11 @@ NewDeltaSubscriptionState::getNextRequestAckless() {
 
   request.set_type_url(type_url_);
   request.mutable_node()->MergeFrom(local_info_.node());
+  // Only this implementation tracks chunked updates, so the feature isn't part of the local node.
+  const auto& features = request.node().client_features();
+  if (std::find(features.begin(), features.end(), DeltaChunksClientFeature) == features.end()) {
+    request.mutable_node()->add_client_features(std::string(DeltaChunksClientFeature));
+  }
   return request;
 }
 
@@ -14,7 +14,9 @@
 #include "source/extensions/config_subscription/grpc/pausable_ack_queue.h"
 #include "source/extensions/config_subscription/grpc/watch_map.h"
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/container/node_hash_map.h"
+#include "absl/strings/string_view.h"
 
 namespace Envoy {
 namespace Config {
@@ -77,6 +79,11 @@ namespace Config {
 // direction, we drop all the resources in "wildcard" and "ambiguous" categories.
 class NewDeltaSubscriptionState : public Logger::Loggable<Logger::Id::config> {
 public:
+  // The client feature set in the node of every request, telling the server that updates may be
+  // split into chunks (see DeltaDiscoveryResponse.more_chunks).
+  static constexpr absl::string_view DeltaChunksClientFeature =
+      "envoy.config.supports-delta-chunks";
+
   NewDeltaSubscriptionState(std::string type_url, UntypedConfigUpdateCallbacks& watch_map,
                             const LocalInfo::LocalInfo& local_info, Event::Dispatcher& dispatcher,
                             XdsConfigTrackerOptRef xds_config_tracker);
@@ -89,7 +96,7 @@ public:
   // Whether there was a change in our subscription interest we have yet to inform the server of.
   bool subscriptionUpdatePending() const;
 
-  void markStreamFresh() { any_request_sent_yet_in_current_stream_ = false; }
+  void markStreamFresh();
 
   UpdateAck handleResponse(const envoy::service::discovery::v3::DeltaDiscoveryResponse& message);
 
@@ -109,6 +116,9 @@ private:
   bool isHeartbeatResponse(const envoy::service::discovery::v3::Resource& resource) const;
   void handleGoodResponse(const envoy::service::discovery::v3::DeltaDiscoveryResponse& message);
   void handleBadResponse(const EnvoyException& e, UpdateAck& ack);
+  // Ends a chunked update before its last chunk, handing the chunks received so far to the
+  // subscriptions still waiting for them.
+  void endChunkedUpdate();
 
   class ResourceState {
   public:
@@ -176,6 +186,13 @@ private:
   // Feel free to change to an unordered container once we figure out how to make it work.
   std::set<std::string> names_added_;
   std::set<std::string> names_removed_;
+
+  // Names of the resources added or removed by the chunks received so far of an update the server
+  // split into several responses (see DeltaDiscoveryResponse.more_chunks). Empty when no chunked
+  // update is in progress.
+  absl::flat_hash_set<std::string> chunked_update_names_;
+  // Whether the last accepted response was a chunk followed by more chunks of the same update.
+  bool chunked_update_in_progress_{false};
 };
 
 } // namespace Config
@@ -117,7 +117,12 @@ void NewGrpcMuxImpl::onDiscoveryResponse(
       ack.error_detail_.code() != Grpc::Status::WellKnownGrpcStatus::Ok) {
     xds_config_tracker_->onConfigRejected(*message, ack.error_detail_.message());
   }
-  kickOffAck(ack);
+  // The server is told that a chunked update was applied by the ACK of its last chunk, so the
+  // chunks before it are only ACKed if they have to be NACKed.
+  if (!message->more_chunks() ||
+      ack.error_detail_.code() != Grpc::Status::WellKnownGrpcStatus::Ok) {
+    kickOffAck(ack);
+  }
   Memory::Utils::tryShrinkHeap();
 }
 
@@ -5,6 +5,7 @@
 #include "source/common/common/cleanup.h"
 #include "source/common/common/utility.h"
 #include "source/common/config/decoded_resource_impl.h"
+#include "source/common/config/resource_decode_pool.h"
 #include "source/common/config/utility.h"
 #include "source/common/config/xds_resource.h"
 
@@ -204,9 +205,15 @@ void WatchMap::onConfigUpdate(const Protobuf::RepeatedPtrField<ProtobufWkt::Any>
   }
 
   std::vector<DecodedResourcePtr> decoded_resources;
-  for (const auto& r : resources) {
-    decoded_resources.emplace_back(
-        DecodedResourceImpl::fromResource((*watches_.begin())->resource_decoder_, r, version_info));
+  OpaqueResourceDecoder& resource_decoder = (*watches_.begin())->resource_decoder_;
+  if (ResourceDecodePool* decode_pool = ResourceDecodePoolSingleton::getExisting();
+      decode_pool != nullptr) {
+    decoded_resources = decode_pool->decode(resource_decoder, resources, version_info);
+  } else {
+    for (const auto& r : resources) {
+      decoded_resources.emplace_back(
+          DecodedResourceImpl::fromResource(resource_decoder, r, version_info));
+    }
   }
 
   onConfigUpdate(decoded_resources, version_info);
@@ -216,6 +223,61 @@ void WatchMap::onConfigUpdate(
     const Protobuf::RepeatedPtrField<envoy::service::discovery::v3::Resource>& added_resources,
     const Protobuf::RepeatedPtrField<std::string>& removed_resources,
     const std::string& system_version_info) {
+  onDeltaConfigUpdate(added_resources, removed_resources, system_version_info, Chunk::None);
+}
+
+void WatchMap::onChunkedConfigUpdate(
+    const Protobuf::RepeatedPtrField<envoy::service::discovery::v3::Resource>& added_resources,
+    const Protobuf::RepeatedPtrField<std::string>& removed_resources,
+    const std::string& system_version_info, bool more_chunks) {
+  onDeltaConfigUpdate(added_resources, removed_resources, system_version_info,
+                      more_chunks ? Chunk::NotLast : Chunk::Last);
+}
+
+void WatchMap::onChunkedConfigUpdateInterrupted() {
+  // The chunks received so far were applied, so the watches holding them get them now.
+  ASSERT(deferred_removed_during_update_ == nullptr);
+  deferred_removed_during_update_ = std::make_unique<absl::flat_hash_set<Watch*>>();
+  Cleanup cleanup([this] { removeDeferredWatches(); });
+  releaseHeldChunks(held_version_info_);
+}
+
+void WatchMap::deliverDeltaUpdate(Watch& watch,
+                                  const std::vector<DecodedResourceRef>& added_resources,
+                                  const Protobuf::RepeatedPtrField<std::string>& removed_resources,
+                                  const std::string& system_version_info) {
+  watch.delta_update_received_ = true;
+  if (watch.held_chunks_ == nullptr) {
+    watch.callbacks_.onConfigUpdate(added_resources, removed_resources, system_version_info);
+    return;
+  }
+  std::unique_ptr<HeldChunks> held = std::move(watch.held_chunks_);
+  held->added_.insert(held->added_.end(), added_resources.begin(), added_resources.end());
+  held->removed_.MergeFrom(removed_resources);
+  watch.callbacks_.onConfigUpdate(held->added_, held->removed_, system_version_info);
+}
+
+void WatchMap::releaseHeldChunks(const std::string& system_version_info) {
+  // Collect the watches first, as a watch's callbacks may add or remove watches.
+  std::vector<Watch*> holding;
+  for (const auto& watch : watches_) {
+    if (watch->held_chunks_ != nullptr) {
+      holding.push_back(watch.get());
+    }
+  }
+  for (Watch* watch : holding) {
+    if (deferred_removed_during_update_->count(watch) > 0) {
+      continue;
+    }
+    deliverDeltaUpdate(*watch, {}, {}, system_version_info);
+  }
+  held_resources_.clear();
+}
+
+void WatchMap::onDeltaConfigUpdate(
+    const Protobuf::RepeatedPtrField<envoy::service::discovery::v3::Resource>& added_resources,
+    const Protobuf::RepeatedPtrField<std::string>& removed_resources,
+    const std::string& system_version_info, Chunk chunk) {
   // Track any removals triggered by earlier watch updates.
   ASSERT(deferred_removed_during_update_ == nullptr);
   deferred_removed_during_update_ = std::make_unique<absl::flat_hash_set<Watch*>>();
@@ -225,17 +287,43 @@ void WatchMap::onConfigUpdate(
   // into the individual onConfigUpdate()s.
   std::vector<DecodedResourcePtr> decoded_resources;
   absl::flat_hash_map<Watch*, std::vector<DecodedResourceRef>> per_watch_added;
-  for (const auto& r : added_resources) {
-    const absl::flat_hash_set<Watch*>& interested_in_r = watchesInterestedIn(r.name());
-    // If there are no watches, then we don't need to decode. If there are watches, they should all
-    // be for the same resource type, so we can just use the callbacks of the first watch to decode.
-    if (interested_in_r.empty()) {
-      continue;
+  ResourceDecodePool* decode_pool = ResourceDecodePoolSingleton::getExisting();
+  if (decode_pool != nullptr && !watches_.empty()) {
+    // The watches are all for the same resource type, so the resources can be decoded up front
+    // with the decoder of any watch.
+    std::vector<const envoy::service::discovery::v3::Resource*> to_decode;
+    std::vector<absl::flat_hash_set<Watch*>> interested;
+    for (const auto& r : added_resources) {
+      absl::flat_hash_set<Watch*> interested_in_r = watchesInterestedIn(r.name());
+      if (!interested_in_r.empty()) {
+        to_decode.push_back(&r);
+        interested.push_back(std::move(interested_in_r));
+      }
     }
-    decoded_resources.emplace_back(
-        new DecodedResourceImpl((*interested_in_r.begin())->resource_decoder_, r));
-    for (const auto& interested_watch : interested_in_r) {
-      per_watch_added[interested_watch].emplace_back(*decoded_resources.back());
+    decoded_resources = decode_pool->decode(
+        (*watches_.begin())->resource_decoder_, to_decode.size(),
+        [&to_decode](size_t index, OpaqueResourceDecoder& decoder) -> DecodedResourcePtr {
+          return std::make_unique<DecodedResourceImpl>(decoder, *to_decode[index]);
+        });
+    for (size_t i = 0; i < decoded_resources.size(); ++i) {
+      for (const auto& interested_watch : interested[i]) {
+        per_watch_added[interested_watch].emplace_back(*decoded_resources[i]);
+      }
+    }
+  } else {
+    for (const auto& r : added_resources) {
+      const absl::flat_hash_set<Watch*>& interested_in_r = watchesInterestedIn(r.name());
+      // If there are no watches, then we don't need to decode. If there are watches, they should
+      // all be for the same resource type, so we can just use the callbacks of the first watch to
+      // decode.
+      if (interested_in_r.empty()) {
+        continue;
+      }
+      decoded_resources.emplace_back(
+          new DecodedResourceImpl((*interested_in_r.begin())->resource_decoder_, r));
+      for (const auto& interested_watch : interested_in_r) {
+        per_watch_added[interested_watch].emplace_back(*decoded_resources.back());
+      }
     }
   }
   absl::flat_hash_map<Watch*, Protobuf::RepeatedPtrField<std::string>> per_watch_removed;
@@ -249,18 +337,34 @@ void WatchMap::onConfigUpdate(
   // Execute external config validators.
   config_validators_.executeValidators(type_url_, decoded_resources, removed_resources);
 
+  // A watch that has yet to receive an update holds the chunks of a chunked update until its last
+  // one, and so does a watch that already holds some. The holds are only committed once all the
+  // watches accepted the chunk, so that a rejected chunk is not delivered later on.
+  absl::flat_hash_map<Watch*, HeldChunks> to_hold;
+  const auto deliver = [&](Watch& watch, std::vector<DecodedResourceRef>&& added,
+                           Protobuf::RepeatedPtrField<std::string>&& removed) {
+    if ((chunk == Chunk::NotLast && !watch.delta_update_received_) ||
+        (chunk != Chunk::Last && watch.held_chunks_ != nullptr)) {
+      HeldChunks& held = to_hold[&watch];
+      held.added_ = std::move(added);
+      held.removed_ = std::move(removed);
+      return;
+    }
+    deliverDeltaUpdate(watch, added, removed, system_version_info);
+  };
+
   // We just bundled up the updates into nice per-watch packages. Now, deliver them.
-  for (const auto& [cur_watch, resource_to_add] : per_watch_added) {
+  for (auto& [cur_watch, resource_to_add] : per_watch_added) {
     if (deferred_removed_during_update_->count(cur_watch) > 0) {
       continue;
     }
     const auto removed = per_watch_removed.find(cur_watch);
     if (removed == per_watch_removed.end()) {
       // additions only, no removals
-      cur_watch->callbacks_.onConfigUpdate(resource_to_add, {}, system_version_info);
+      deliver(*cur_watch, std::move(resource_to_add), {});
     } else {
       // both additions and removals
-      cur_watch->callbacks_.onConfigUpdate(resource_to_add, removed->second, system_version_info);
+      deliver(*cur_watch, std::move(resource_to_add), std::move(removed->second));
       // Drop the removals now, so the final removals-only pass won't use them.
       per_watch_removed.erase(removed);
     }
@@ -270,14 +374,17 @@ void WatchMap::onConfigUpdate(
     if (deferred_removed_during_update_->count(cur_watch) > 0) {
       continue;
     }
-    cur_watch->callbacks_.onConfigUpdate({}, resource_to_remove, system_version_info);
+    deliver(*cur_watch, {}, std::move(resource_to_remove));
   }
   // notify empty update
   if (added_resources.empty() && removed_resources.empty()) {
     for (auto& cur_watch : wildcard_watches_) {
-      cur_watch->callbacks_.onConfigUpdate({}, {}, system_version_info);
+      deliver(*cur_watch, {}, {});
     }
   }
+  if (chunk == Chunk::Last) {
+    releaseHeldChunks(system_version_info);
+  }
 
   if (eds_resources_cache_.has_value()) {
     // Add/update the watched resources to/in the cache.
@@ -291,6 +398,30 @@ void WatchMap::onConfigUpdate(
     // subscriptions are supported, and these resources are removed in the call
     // to updateWatchInterest().
   }
+
+  if (!to_hold.empty()) {
+    absl::flat_hash_set<const DecodedResource*> held_added;
+    for (auto& [watch, chunk_changes] : to_hold) {
+      if (watch->held_chunks_ == nullptr) {
+        watch->held_chunks_ = std::make_unique<HeldChunks>();
+      }
+      HeldChunks& held = *watch->held_chunks_;
+      for (const DecodedResourceRef& resource : chunk_changes.added_) {
+        held_added.insert(&resource.get());
+      }
+      held.added_.insert(held.added_.end(), chunk_changes.added_.begin(),
+                         chunk_changes.added_.end());
+      held.removed_.MergeFrom(chunk_changes.removed_);
+    }
+    // The held changes refer to the decoded resources, so those live until the holds are released.
+    // The resources of the chunk that no watch holds are freed along with the chunk.
+    for (DecodedResourcePtr& resource : decoded_resources) {
+      if (held_added.contains(resource.get())) {
+        held_resources_.push_back(std::move(resource));
+      }
+    }
+    held_version_info_ = system_version_info;
+  }
 }
 
 void WatchMap::onConfigUpdateFailed(ConfigUpdateFailureReason reason, const EnvoyException* e) {
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <memory>
 #include <set>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "envoy/config/custom_config_validators.h"
 #include "envoy/config/eds_resources_cache.h"
@@ -26,6 +28,12 @@ struct AddedRemoved {
   absl::flat_hash_set<std::string> removed_;
 };
 
+// The changes of the chunks of a delta update that a watch holds until the last chunk.
+struct HeldChunks {
+  std::vector<DecodedResourceRef> added_;
+  Protobuf::RepeatedPtrField<std::string> removed_;
+};
+
 struct Watch {
   Watch(SubscriptionCallbacks& callbacks, OpaqueResourceDecoder& resource_decoder)
       : callbacks_(callbacks), resource_decoder_(resource_decoder) {}
@@ -36,6 +44,12 @@ struct Watch {
   // Whether the most recent update contained any resources this watch cares about.
   // If true, a new update that also contains no resources can skip this watch.
   bool state_of_the_world_empty_{true};
+  // Needed only for delta.
+  // Whether the watch received an update. Until then, the chunks of an update that the server split
+  // into several responses are held until its last chunk, so that the watch doesn't complete its
+  // initialization with a part of the update.
+  bool delta_update_received_{false};
+  std::unique_ptr<HeldChunks> held_chunks_;
 };
 
 // NOTE: Users are responsible for eventually calling removeWatch() on the Watch* returned
@@ -109,12 +123,39 @@ public:
       const Protobuf::RepeatedPtrField<envoy::service::discovery::v3::Resource>& added_resources,
       const Protobuf::RepeatedPtrField<std::string>& removed_resources,
       const std::string& system_version_info) override;
+  void onChunkedConfigUpdate(
+      const Protobuf::RepeatedPtrField<envoy::service::discovery::v3::Resource>& added_resources,
+      const Protobuf::RepeatedPtrField<std::string>& removed_resources,
+      const std::string& system_version_info, bool more_chunks) override;
+  void onChunkedConfigUpdateInterrupted() override;
   void onConfigUpdateFailed(ConfigUpdateFailureReason reason, const EnvoyException* e) override;
 
   WatchMap(const WatchMap&) = delete;
   WatchMap& operator=(const WatchMap&) = delete;
 
 private:
+  enum class Chunk {
+    // An update that wasn't split into chunks.
+    None,
+    // A chunk followed by more chunks of the same update.
+    NotLast,
+    // The last chunk of an update.
+    Last,
+  };
+
+  void onDeltaConfigUpdate(
+      const Protobuf::RepeatedPtrField<envoy::service::discovery::v3::Resource>& added_resources,
+      const Protobuf::RepeatedPtrField<std::string>& removed_resources,
+      const std::string& system_version_info, Chunk chunk);
+
+  // Delivers a delta update to a watch, along with the chunks it held.
+  void deliverDeltaUpdate(Watch& watch, const std::vector<DecodedResourceRef>& added_resources,
+                          const Protobuf::RepeatedPtrField<std::string>& removed_resources,
+                          const std::string& system_version_info);
+
+  // Delivers the chunks held by the watches, once the update they belong to ended.
+  void releaseHeldChunks(const std::string& system_version_info);
+
   void removeDeferredWatches();
 
   // Given a list of names that are new to an individual watch, returns those names that are in fact
@@ -145,6 +186,12 @@ private:
   // 2) Enables efficient lookup of all interested watches when a resource has been updated.
   absl::flat_hash_map<std::string, absl::flat_hash_set<Watch*>> watch_interest_;
 
+  // The decoded resources that the watches hold, and the version of the last chunk they came from.
+  // Only watches waiting for their first update hold chunks, so the other resources of a chunk are
+  // freed as soon as it is applied.
+  std::vector<DecodedResourcePtr> held_resources_;
+  std::string held_version_info_;
+
   const bool use_namespace_matching_;
   const std::string type_url_;
   CustomConfigValidators& config_validators_;
@@ -1,5 +1,6 @@
 #include "source/extensions/config_subscription/grpc/xds_mux/sotw_subscription_state.h"
 
+#include "source/common/config/resource_decode_pool.h"
 #include "source/common/config/utility.h"
 #include "source/extensions/config_subscription/grpc/xds_source_id.h"
 
@@ -49,7 +50,9 @@ void SotwSubscriptionState::handleGoodResponse(
 
   {
     const auto scoped_update = ttl_.scopedTtlUpdate();
-    for (const auto& any : message.resources()) {
+    auto decode_resource = [&message](size_t index,
+                                      OpaqueResourceDecoder& decoder) -> DecodedResourcePtr {
+      const ProtobufWkt::Any& any = message.resources()[index];
       if (!any.Is<envoy::service::discovery::v3::Resource>() &&
           any.type_url() != message.type_url()) {
         throw EnvoyException(fmt::format("type URL {} embedded in an individual Any does not match "
@@ -57,9 +60,20 @@ void SotwSubscriptionState::handleGoodResponse(
                                          any.type_url(), message.type_url(),
                                          message.DebugString()));
       }
+      return DecodedResourceImpl::fromResource(decoder, any, message.version_info());
+    };
+    std::vector<DecodedResourcePtr> decoded_resources;
+    if (ResourceDecodePool* decode_pool = ResourceDecodePoolSingleton::getExisting();
+        decode_pool != nullptr) {
+      decoded_resources =
+          decode_pool->decode(*resource_decoder_, message.resources().size(), decode_resource);
+    } else {
+      for (int i = 0; i < message.resources().size(); ++i) {
+        decoded_resources.emplace_back(decode_resource(i, *resource_decoder_));
+      }
+    }
 
-      auto decoded_resource =
-          DecodedResourceImpl::fromResource(*resource_decoder_, any, message.version_info());
+    for (auto& decoded_resource : decoded_resources) {
       setResourceTtl(*decoded_resource);
       if (isHeartbeatResource(*decoded_resource, message.version_info())) {
         continue;
@@ -1,10 +1,15 @@
 #include "source/extensions/filters/http/ip_tagging/ip_tagging_filter.h"
 
+#include "envoy/common/exception.h"
 #include "envoy/config/core/v3/address.pb.h"
 #include "envoy/extensions/filters/http/ip_tagging/v3/ip_tagging.pb.h"
 
+#include "source/common/common/logger.h"
+#include "source/common/common/thread.h"
 #include "source/common/http/header_map_impl.h"
 #include "source/common/http/headers.h"
+#include "source/common/network/lc_trie.h"
+#include "source/common/network/poptrie.h"
 
 #include "absl/strings/str_join.h"
 
@@ -52,7 +57,17 @@ IpTaggingFilterConfig::IpTaggingFilterConfig(
     tag_data.emplace_back(ip_tag.ip_tag_name(), cidr_set);
     stat_name_set_->rememberBuiltin(absl::StrCat(ip_tag.ip_tag_name(), ".hit"));
   }
-  trie_ = std::make_unique<Network::LcTrie::LcTrie<std::string>>(tag_data);
+  // LcTrie rejects tables that need more ranges or internal nodes than it can address. Those are
+  // held in a Poptrie instead, which also takes less memory for them.
+  TRY_ASSERT_MAIN_THREAD {
+    trie_ = std::make_unique<Network::LcTrie::LcTrie<std::string>>(tag_data);
+  }
+  END_TRY
+  catch (const EnvoyException& e) {
+    ENVOY_LOG_MISC(debug, "ip tagging: using a Poptrie as the LC trie can't be built: {}",
+                   e.what());
+    trie_ = std::make_unique<Network::Poptrie::Poptrie<std::string>>(tag_data);
+  }
 }
 
 void IpTaggingFilterConfig::incCounter(Stats::StatName name) {
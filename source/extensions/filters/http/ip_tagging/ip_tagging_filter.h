@@ -13,7 +13,7 @@
 #include "envoy/stats/scope.h"
 
 #include "source/common/network/cidr_range.h"
-#include "source/common/network/lc_trie.h"
+#include "source/common/network/ip_prefix_index.h"
 #include "source/common/stats/symbol_table.h"
 
 namespace Envoy {
@@ -37,7 +37,7 @@ public:
 
   Runtime::Loader& runtime() { return runtime_; }
   FilterRequestType requestType() const { return request_type_; }
-  const Network::LcTrie::LcTrie<std::string>& trie() const { return *trie_; }
+  const Network::IpPrefixIndex<std::string>& trie() const { return *trie_; }
 
   void incHit(absl::string_view tag) {
     incCounter(stat_name_set_->getBuiltin(absl::StrCat(tag, ".hit"), unknown_tag_));
@@ -70,7 +70,7 @@ private:
   const Stats::StatName no_hit_;
   const Stats::StatName total_;
   const Stats::StatName unknown_tag_;
-  std::unique_ptr<Network::LcTrie::LcTrie<std::string>> trie_;
+  Network::IpPrefixIndexPtr<std::string> trie_;
 };
 
 using IpTaggingFilterConfigSharedPtr = std::shared_ptr<IpTaggingFilterConfig>;
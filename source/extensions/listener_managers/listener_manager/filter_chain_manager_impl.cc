@@ -1,5 +1,7 @@
 #include "source/extensions/listener_managers/listener_manager/filter_chain_manager_impl.h"
 
+#include <algorithm>
+
 #include "envoy/config/listener/v3/listener_components.pb.h"
 
 #include "source/common/common/cleanup.h"
@@ -216,6 +218,8 @@ void FilterChainManagerImpl::addFilterChains(
       filter_chains;
   uint32_t new_filter_chain_size = 0;
   FilterChainsByName filter_chains_by_name;
+  std::vector<FilterChainIndexEntry> index_entries;
+  index_entries.reserve(filter_chain_matcher ? 0 : filter_chain_span.size());
 
   for (const auto& filter_chain : filter_chain_span) {
     const auto& filter_chain_match = filter_chain->filter_chain_match();
@@ -241,7 +245,8 @@ void FilterChainManagerImpl::addFilterChains(
     // FilterChainManager maintains the lifetime of FilterChainFactoryContext
     // ListenerImpl maintains the dependencies of FilterChainFactoryContext
     auto filter_chain_impl = findExistingFilterChain(*filter_chain);
-    if (filter_chain_impl == nullptr) {
+    const bool reused = filter_chain_impl != nullptr;
+    if (!reused) {
       filter_chain_impl =
           filter_chain_factory_builder.buildFilterChain(*filter_chain, context_creator);
       ++new_filter_chain_size;
@@ -295,17 +300,18 @@ void FilterChainManagerImpl::addFilterChains(
         server_names.push_back(absl::AsciiStrToLower(server_name));
       }
 
-      addFilterChainForDestinationPorts(
-          destination_ports_map_,
-          PROTOBUF_GET_WRAPPED_OR_DEFAULT(filter_chain_match, destination_port, 0), destination_ips,
-          server_names, filter_chain_match.transport_protocol(),
-          filter_chain_match.application_protocols(), direct_source_ips,
-          filter_chain_match.source_type(), source_ips, filter_chain_match.source_ports(),
-          filter_chain_impl);
+      index_entries.push_back(FilterChainIndexEntry{
+          static_cast<uint16_t>(
+              PROTOBUF_GET_WRAPPED_OR_DEFAULT(filter_chain_match, destination_port, 0)),
+          std::move(destination_ips), std::move(server_names),
+          filter_chain_match.transport_protocol(), filter_chain_match.application_protocols(),
+          std::move(direct_source_ips), filter_chain_match.source_type(), std::move(source_ips),
+          filter_chain_match.source_ports(), filter_chain_impl, reused});
     }
 
     fc_contexts_[*filter_chain] = filter_chain_impl;
   }
+  buildIndex(index_entries);
   convertIPsToTries();
   copyOrRebuildDefaultFilterChain(default_filter_chain, filter_chain_factory_builder,
                                   context_creator);
@@ -355,80 +361,111 @@ void FilterChainManagerImpl::copyOrRebuildDefaultFilterChain(
   }
 }
 
-void FilterChainManagerImpl::addFilterChainForDestinationPorts(
-    DestinationPortsMap& destination_ports_map, uint16_t destination_port,
-    const std::vector<std::string>& destination_ips,
-    const absl::Span<const std::string> server_names, const std::string& transport_protocol,
-    const absl::Span<const std::string* const> application_protocols,
-    const std::vector<std::string>& direct_source_ips,
-    const envoy::config::listener::v3::FilterChainMatch::ConnectionSourceType source_type,
-    const std::vector<std::string>& source_ips,
-    const absl::Span<const Protobuf::uint32> source_ports,
-    const Network::FilterChainSharedPtr& filter_chain) {
-  if (destination_ports_map.find(destination_port) == destination_ports_map.end()) {
-    destination_ports_map[destination_port] =
-        std::make_pair<DestinationIPsMap, DestinationIPsTriePtr>(DestinationIPsMap{}, nullptr);
+void FilterChainManagerImpl::buildIndex(const std::vector<FilterChainIndexEntry>& entries) {
+  // Group the filter chains by the destination port, destination IP and server name they are
+  // indexed under, so that each part of the index below a server name is built, or shared with the
+  // origin filter chain manager, as a whole.
+  using ServerNameGroups =
+      absl::flat_hash_map<std::string, std::vector<const FilterChainIndexEntry*>>;
+  absl::flat_hash_map<uint16_t, absl::flat_hash_map<std::string, ServerNameGroups>> groups;
+  for (const auto& entry : entries) {
+    auto& destination_ip_groups = groups[entry.destination_port_];
+    auto add_to_server_name_groups = [&entry](ServerNameGroups& server_name_groups) {
+      if (entry.server_names_.empty()) {
+        server_name_groups[EMPTY_STRING].push_back(&entry);
+        return;
+      }
+      for (const auto& server_name : entry.server_names_) {
+        // Wildcard domains are indexed without the "*", i.e. ".example.com" for "*.example.com".
+        server_name_groups[isWildcardServerName(server_name) ? server_name.substr(1) : server_name]
+            .push_back(&entry);
+      }
+    };
+    if (entry.destination_ips_.empty()) {
+      add_to_server_name_groups(destination_ip_groups[EMPTY_STRING]);
+    } else {
+      for (const auto& destination_ip : entry.destination_ips_) {
+        add_to_server_name_groups(destination_ip_groups[destination_ip]);
+      }
+    }
   }
-  addFilterChainForDestinationIPs(destination_ports_map[destination_port].first, destination_ips,
-                                  server_names, transport_protocol, application_protocols,
-                                  direct_source_ips, source_type, source_ips, source_ports,
-                                  filter_chain);
-}
 
-void FilterChainManagerImpl::addFilterChainForDestinationIPs(
-    DestinationIPsMap& destination_ips_map, const std::vector<std::string>& destination_ips,
-    const absl::Span<const std::string> server_names, const std::string& transport_protocol,
-    const absl::Span<const std::string* const> application_protocols,
-    const std::vector<std::string>& direct_source_ips,
-    const envoy::config::listener::v3::FilterChainMatch::ConnectionSourceType source_type,
-    const std::vector<std::string>& source_ips,
-    const absl::Span<const Protobuf::uint32> source_ports,
-    const Network::FilterChainSharedPtr& filter_chain) {
-  if (destination_ips.empty()) {
-    addFilterChainForServerNames(destination_ips_map[EMPTY_STRING], server_names,
-                                 transport_protocol, application_protocols, direct_source_ips,
-                                 source_type, source_ips, source_ports, filter_chain);
-  } else {
-    for (const auto& destination_ip : destination_ips) {
-      addFilterChainForServerNames(destination_ips_map[destination_ip], server_names,
-                                   transport_protocol, application_protocols, direct_source_ips,
-                                   source_type, source_ips, source_ports, filter_chain);
+  uint32_t shared_size = 0;
+  for (auto& [destination_port, destination_ip_groups] : groups) {
+    auto& destination_ips_map = destination_ports_map_[destination_port].first;
+    for (auto& [destination_ip, server_name_groups] : destination_ip_groups) {
+      auto server_names_map = std::make_shared<ServerNamesMap>();
+      server_names_map->reserve(server_name_groups.size());
+      for (auto& [server_name, group] : server_name_groups) {
+        std::vector<const Network::FilterChain*> filter_chains;
+        filter_chains.reserve(group.size());
+        for (const FilterChainIndexEntry* entry : group) {
+          filter_chains.push_back(entry->filter_chain_.get());
+        }
+        std::sort(filter_chains.begin(), filter_chains.end());
+
+        ServerNameIndexConstSharedPtr index = findOriginServerNameIndex(
+            destination_port, destination_ip, server_name, group, filter_chains);
+        if (index != nullptr) {
+          ++shared_size;
+        } else {
+          index = buildServerNameIndex(group, std::move(filter_chains));
+        }
+        server_names_map->emplace(server_name, std::move(index));
+      }
+      destination_ips_map[destination_ip] = std::move(server_names_map);
     }
   }
+  ENVOY_LOG(debug, "filter chain index shares {} server name entries with the previous listener",
+            shared_size);
 }
 
-void FilterChainManagerImpl::addFilterChainForServerNames(
-    ServerNamesMapSharedPtr& server_names_map_ptr, const absl::Span<const std::string> server_names,
-    const std::string& transport_protocol,
-    const absl::Span<const std::string* const> application_protocols,
-    const std::vector<std::string>& direct_source_ips,
-    const envoy::config::listener::v3::FilterChainMatch::ConnectionSourceType source_type,
-    const std::vector<std::string>& source_ips,
-    const absl::Span<const Protobuf::uint32> source_ports,
-    const Network::FilterChainSharedPtr& filter_chain) {
-  if (server_names_map_ptr == nullptr) {
-    server_names_map_ptr = std::make_shared<ServerNamesMap>();
+FilterChainManagerImpl::ServerNameIndexConstSharedPtr
+FilterChainManagerImpl::findOriginServerNameIndex(
+    uint16_t destination_port, const std::string& destination_ip, const std::string& server_name,
+    const std::vector<const FilterChainIndexEntry*>& entries,
+    const std::vector<const Network::FilterChain*>& filter_chains) {
+  const auto* origin = getOriginFilterChainManager();
+  if (origin == nullptr) {
+    return nullptr;
   }
-  auto& server_names_map = *server_names_map_ptr;
-
-  if (server_names.empty()) {
-    addFilterChainForApplicationProtocols(server_names_map[EMPTY_STRING][transport_protocol],
-                                          application_protocols, direct_source_ips, source_type,
-                                          source_ips, source_ports, filter_chain);
-  } else {
-    for (const auto& server_name : server_names) {
-      if (isWildcardServerName(server_name)) {
-        // Add mapping for the wildcard domain, i.e. ".example.com" for "*.example.com".
-        addFilterChainForApplicationProtocols(
-            server_names_map[server_name.substr(1)][transport_protocol], application_protocols,
-            direct_source_ips, source_type, source_ips, source_ports, filter_chain);
-      } else {
-        addFilterChainForApplicationProtocols(server_names_map[server_name][transport_protocol],
-                                              application_protocols, direct_source_ips, source_type,
-                                              source_ips, source_ports, filter_chain);
-      }
+  // A filter chain taken over from the origin has the same matching rules there, so it is indexed
+  // below the same server name. If all the filter chains below the server name were taken over and
+  // there are as many in the origin, the index below it is the same.
+  for (const FilterChainIndexEntry* entry : entries) {
+    if (!entry->reused_) {
+      return nullptr;
     }
   }
+  const auto port_it = origin->destination_ports_map_.find(destination_port);
+  if (port_it == origin->destination_ports_map_.end()) {
+    return nullptr;
+  }
+  const auto ip_it = port_it->second.first.find(destination_ip);
+  if (ip_it == port_it->second.first.end()) {
+    return nullptr;
+  }
+  const auto server_name_it = ip_it->second->find(server_name);
+  if (server_name_it == ip_it->second->end() ||
+      server_name_it->second->filter_chains_ != filter_chains) {
+    return nullptr;
+  }
+  return server_name_it->second;
+}
+
+FilterChainManagerImpl::ServerNameIndexConstSharedPtr FilterChainManagerImpl::buildServerNameIndex(
+    const std::vector<const FilterChainIndexEntry*>& entries,
+    std::vector<const Network::FilterChain*>&& filter_chains) {
+  auto index = std::make_shared<ServerNameIndex>();
+  for (const FilterChainIndexEntry* entry : entries) {
+    addFilterChainForApplicationProtocols(
+        index->transport_protocols_map_[entry->transport_protocol_], entry->application_protocols_,
+        entry->direct_source_ips_, entry->source_type_, entry->source_ips_, entry->source_ports_,
+        entry->filter_chain_);
+  }
+  convertIPsToTries(index->transport_protocols_map_);
+  index->filter_chains_ = std::move(filter_chains);
+  return index;
 }
 
 void FilterChainManagerImpl::addFilterChainForApplicationProtocols(
@@ -622,7 +659,8 @@ const Network::FilterChain* FilterChainManagerImpl::findFilterChainForServerName
   // Match on exact server name, i.e. "www.example.com" for "www.example.com".
   const auto server_name_exact_match = server_names_map.find(server_name);
   if (server_name_exact_match != server_names_map.end()) {
-    return findFilterChainForTransportProtocol(server_name_exact_match->second, socket);
+    return findFilterChainForTransportProtocol(
+        server_name_exact_match->second->transport_protocols_map_, socket);
   }
 
   // Match on all wildcard domains, i.e. ".example.com" and ".com" for "www.example.com".
@@ -631,7 +669,8 @@ const Network::FilterChain* FilterChainManagerImpl::findFilterChainForServerName
     const std::string wildcard = server_name.substr(pos);
     const auto server_name_wildcard_match = server_names_map.find(wildcard);
     if (server_name_wildcard_match != server_names_map.end()) {
-      return findFilterChainForTransportProtocol(server_name_wildcard_match->second, socket);
+      return findFilterChainForTransportProtocol(
+          server_name_wildcard_match->second->transport_protocols_map_, socket);
     }
     pos = server_name.find('.', pos + 1);
   }
@@ -639,7 +678,8 @@ const Network::FilterChain* FilterChainManagerImpl::findFilterChainForServerName
   // Match on a filter chain without server name requirements.
   const auto server_name_catchall_match = server_names_map.find(EMPTY_STRING);
   if (server_name_catchall_match != server_names_map.end()) {
-    return findFilterChainForTransportProtocol(server_name_catchall_match->second, socket);
+    return findFilterChainForTransportProtocol(
+        server_name_catchall_match->second->transport_protocols_map_, socket);
   }
 
   return nullptr;
@@ -781,48 +821,43 @@ void FilterChainManagerImpl::convertIPsToTries() {
 
     for (const auto& [destination_ip, server_names_map_ptr] : destination_ips_map) {
       destination_ips_list.push_back(makeCidrListEntry(destination_ip, server_names_map_ptr));
+    }
+
+    destination_ips_trie = std::make_unique<DestinationIPsTrie>(destination_ips_list, true);
+  }
+}
 
-      // This hugely nested for loop greatly pains me, but I'm not sure how to make it better.
-      // We need to get access to all of the source IP strings so that we can convert them into
-      // a trie like we did for the destination IPs above.
-      for (auto& [server_name, transport_protocols_map] : *server_names_map_ptr) {
-        UNREFERENCED_PARAMETER(server_name);
-        for (auto& [transport_protocol, application_protocols_map] : transport_protocols_map) {
-          UNREFERENCED_PARAMETER(transport_protocol);
-          for (auto& [application_protocol, direct_source_ips_pair] : application_protocols_map) {
-            UNREFERENCED_PARAMETER(application_protocol);
-            auto& [direct_source_ips_map, direct_source_ips_trie] = direct_source_ips_pair;
-
-            std::vector<
-                std::pair<SourceTypesArraySharedPtr, std::vector<Network::Address::CidrRange>>>
-                direct_source_ips_list;
-            direct_source_ips_list.reserve(direct_source_ips_map.size());
-
-            for (auto& [direct_source_ip, source_arrays_ptr] : direct_source_ips_map) {
-              direct_source_ips_list.push_back(
-                  makeCidrListEntry(direct_source_ip, source_arrays_ptr));
-
-              for (auto& [source_ips_map, source_ips_trie] : *source_arrays_ptr) {
-                std::vector<
-                    std::pair<SourcePortsMapSharedPtr, std::vector<Network::Address::CidrRange>>>
-                    source_ips_list;
-                source_ips_list.reserve(source_ips_map.size());
-
-                for (auto& [source_ip, source_port_map_ptr] : source_ips_map) {
-                  source_ips_list.push_back(makeCidrListEntry(source_ip, source_port_map_ptr));
-                }
-
-                source_ips_trie = std::make_unique<SourceIPsTrie>(source_ips_list, true);
-              }
-            }
-            direct_source_ips_trie =
-                std::make_unique<DirectSourceIPsTrie>(direct_source_ips_list, true);
+void FilterChainManagerImpl::convertIPsToTries(TransportProtocolsMap& transport_protocols_map) {
+  // This hugely nested for loop greatly pains me, but I'm not sure how to make it better.
+  // We need to get access to all of the source IP strings so that we can convert them into
+  // a trie like we did for the destination IPs.
+  for (auto& [transport_protocol, application_protocols_map] : transport_protocols_map) {
+    UNREFERENCED_PARAMETER(transport_protocol);
+    for (auto& [application_protocol, direct_source_ips_pair] : application_protocols_map) {
+      UNREFERENCED_PARAMETER(application_protocol);
+      auto& [direct_source_ips_map, direct_source_ips_trie] = direct_source_ips_pair;
+
+      std::vector<std::pair<SourceTypesArraySharedPtr, std::vector<Network::Address::CidrRange>>>
+          direct_source_ips_list;
+      direct_source_ips_list.reserve(direct_source_ips_map.size());
+
+      for (auto& [direct_source_ip, source_arrays_ptr] : direct_source_ips_map) {
+        direct_source_ips_list.push_back(makeCidrListEntry(direct_source_ip, source_arrays_ptr));
+
+        for (auto& [source_ips_map, source_ips_trie] : *source_arrays_ptr) {
+          std::vector<std::pair<SourcePortsMapSharedPtr, std::vector<Network::Address::CidrRange>>>
+              source_ips_list;
+          source_ips_list.reserve(source_ips_map.size());
+
+          for (auto& [source_ip, source_port_map_ptr] : source_ips_map) {
+            source_ips_list.push_back(makeCidrListEntry(source_ip, source_port_map_ptr));
           }
+
+          source_ips_trie = std::make_unique<SourceIPsTrie>(source_ips_list, true);
         }
       }
+      direct_source_ips_trie = std::make_unique<DirectSourceIPsTrie>(direct_source_ips_list, true);
     }
-
-    destination_ips_trie = std::make_unique<DestinationIPsTrie>(destination_ips_list, true);
   }
 }
 
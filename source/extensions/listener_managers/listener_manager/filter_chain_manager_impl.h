@@ -226,10 +226,22 @@ private:
 
   using ApplicationProtocolsMap = absl::flat_hash_map<std::string, DirectSourceIPsPair>;
   using TransportProtocolsMap = absl::flat_hash_map<std::string, ApplicationProtocolsMap>;
+
+  // The part of the index below a destination port, destination IP and server name. It is
+  // immutable once built, and the next generation of filter chain manager shares it if the same
+  // filter chains lead to it there. A listener update then only rebuilds the index below the server
+  // names of the filter chains that changed.
+  struct ServerNameIndex {
+    TransportProtocolsMap transport_protocols_map_;
+    // The filter chains indexed below the server name, sorted.
+    std::vector<const Network::FilterChain*> filter_chains_;
+  };
+  using ServerNameIndexConstSharedPtr = std::shared_ptr<const ServerNameIndex>;
+
   // Both exact server names and wildcard domains are part of the same map, in which wildcard
   // domains are prefixed with "." (i.e. ".example.com" for "*.example.com") to differentiate
   // between exact and wildcard entries.
-  using ServerNamesMap = absl::flat_hash_map<std::string, TransportProtocolsMap>;
+  using ServerNamesMap = absl::flat_hash_map<std::string, ServerNameIndexConstSharedPtr>;
   using ServerNamesMapSharedPtr = std::shared_ptr<ServerNamesMap>;
   using DestinationIPsMap = absl::flat_hash_map<std::string, ServerNamesMapSharedPtr>;
   using DestinationIPsTrie = Network::LcTrie::LcTrie<ServerNamesMapSharedPtr>;
@@ -237,34 +249,32 @@ private:
   using DestinationPortsMap =
       absl::flat_hash_map<uint16_t, std::pair<DestinationIPsMap, DestinationIPsTriePtr>>;
 
-  void addFilterChainForDestinationPorts(
-      DestinationPortsMap& destination_ports_map, uint16_t destination_port,
-      const std::vector<std::string>& destination_ips,
-      const absl::Span<const std::string> server_names, const std::string& transport_protocol,
-      const absl::Span<const std::string* const> application_protocols,
-      const std::vector<std::string>& direct_source_ips,
-      const envoy::config::listener::v3::FilterChainMatch::ConnectionSourceType source_type,
-      const std::vector<std::string>& source_ips,
-      const absl::Span<const Protobuf::uint32> source_ports,
-      const Network::FilterChainSharedPtr& filter_chain);
-  void addFilterChainForDestinationIPs(
-      DestinationIPsMap& destination_ips_map, const std::vector<std::string>& destination_ips,
-      const absl::Span<const std::string> server_names, const std::string& transport_protocol,
-      const absl::Span<const std::string* const> application_protocols,
-      const std::vector<std::string>& direct_source_ips,
-      const envoy::config::listener::v3::FilterChainMatch::ConnectionSourceType source_type,
-      const std::vector<std::string>& source_ips,
-      const absl::Span<const Protobuf::uint32> source_ports,
-      const Network::FilterChainSharedPtr& filter_chain);
-  void addFilterChainForServerNames(
-      ServerNamesMapSharedPtr& server_names_map_ptr,
-      const absl::Span<const std::string> server_names, const std::string& transport_protocol,
-      const absl::Span<const std::string* const> application_protocols,
-      const std::vector<std::string>& direct_source_ips,
-      const envoy::config::listener::v3::FilterChainMatch::ConnectionSourceType source_type,
-      const std::vector<std::string>& source_ips,
-      const absl::Span<const Protobuf::uint32> source_ports,
-      const Network::FilterChainSharedPtr& filter_chain);
+  // A filter chain to add to the index, with its matching rules parsed.
+  struct FilterChainIndexEntry {
+    uint16_t destination_port_;
+    std::vector<std::string> destination_ips_;
+    std::vector<std::string> server_names_;
+    const std::string& transport_protocol_;
+    absl::Span<const std::string* const> application_protocols_;
+    std::vector<std::string> direct_source_ips_;
+    envoy::config::listener::v3::FilterChainMatch::ConnectionSourceType source_type_;
+    std::vector<std::string> source_ips_;
+    absl::Span<const Protobuf::uint32> source_ports_;
+    Network::FilterChainSharedPtr filter_chain_;
+    // Whether the filter chain was taken over from the origin filter chain manager.
+    bool reused_;
+  };
+
+  void buildIndex(const std::vector<FilterChainIndexEntry>& entries);
+  ServerNameIndexConstSharedPtr
+  findOriginServerNameIndex(uint16_t destination_port, const std::string& destination_ip,
+                            const std::string& server_name,
+                            const std::vector<const FilterChainIndexEntry*>& entries,
+                            const std::vector<const Network::FilterChain*>& filter_chains);
+  ServerNameIndexConstSharedPtr
+  buildServerNameIndex(const std::vector<const FilterChainIndexEntry*>& entries,
+                       std::vector<const Network::FilterChain*>&& filter_chains);
+  static void convertIPsToTries(TransportProtocolsMap& transport_protocols_map);
   void addFilterChainForApplicationProtocols(
       ApplicationProtocolsMap& application_protocol_map,
       const absl::Span<const std::string* const> application_protocols,
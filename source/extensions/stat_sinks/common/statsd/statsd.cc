@@ -1,5 +1,6 @@
 #include "source/extensions/stat_sinks/common/statsd/statsd.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <string>
@@ -11,17 +12,17 @@
 #include "envoy/stats/scope.h"
 #include "envoy/upstream/cluster_manager.h"
 
-#include "source/common/api/os_sys_calls_impl.h"
 #include "source/common/buffer/buffer_impl.h"
 #include "source/common/common/assert.h"
 #include "source/common/common/fmt.h"
+#include "source/common/common/logger.h"
 #include "source/common/common/utility.h"
 #include "source/common/config/utility.h"
 #include "source/common/network/socket_interface.h"
 #include "source/common/network/utility.h"
 #include "source/common/stats/symbol_table.h"
 
-#include "absl/strings/str_join.h"
+#include "absl/strings/str_cat.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -29,6 +30,54 @@ namespace StatSinks {
 namespace Common {
 namespace Statsd {
 
+void DatagramBuilder::clear() {
+  data_.clear();
+  bounds_.clear();
+  datagrams_.clear();
+  datagram_start_ = 0;
+  line_start_ = 0;
+}
+
+std::string& DatagramBuilder::beginLine() {
+  if (data_.size() > datagram_start_) {
+    // Separate the line from the previous one in the current datagram. If the line turns out not
+    // to fit, the separator is left out of both datagrams.
+    data_.push_back('\n');
+  }
+  line_start_ = data_.size();
+  return data_;
+}
+
+void DatagramBuilder::endLine() {
+  const size_t line_size = data_.size() - line_start_;
+  const bool oversized = line_size >= max_datagram_size_;
+  if (line_start_ > datagram_start_ &&
+      (oversized || data_.size() - datagram_start_ > max_datagram_size_)) {
+    // The line doesn't fit in the current datagram; complete it without the separator.
+    bounds_.emplace_back(datagram_start_, line_start_ - 1);
+    datagram_start_ = line_start_;
+  }
+  if (oversized) {
+    // Send the line in a datagram of its own.
+    bounds_.emplace_back(line_start_, data_.size());
+    datagram_start_ = data_.size();
+  }
+}
+
+absl::Span<const absl::string_view> DatagramBuilder::datagrams() {
+  if (data_.size() > datagram_start_) {
+    bounds_.emplace_back(datagram_start_, data_.size());
+    datagram_start_ = data_.size();
+  }
+  // The views are built last, as appending lines may have reallocated data_.
+  datagrams_.clear();
+  datagrams_.reserve(bounds_.size());
+  for (const auto& [start, end] : bounds_) {
+    datagrams_.emplace_back(data_.data() + start, end - start);
+  }
+  return datagrams_;
+}
+
 UdpStatsdSink::WriterImpl::WriterImpl(UdpStatsdSink& parent)
     : parent_(parent), io_handle_(Network::ioHandleForAddr(Network::Socket::Type::Datagram,
                                                            parent_.server_address_, {})) {}
@@ -40,8 +89,27 @@ void UdpStatsdSink::WriterImpl::write(const std::string& message) {
   Network::Utility::writeToSocket(*io_handle_, &slice, 1, nullptr, *parent_.server_address_);
 }
 
-void UdpStatsdSink::WriterImpl::writeBuffer(Buffer::Instance& data) {
-  Network::Utility::writeToSocket(*io_handle_, data, nullptr, *parent_.server_address_);
+void UdpStatsdSink::WriterImpl::writeDatagrams(absl::Span<const absl::string_view> datagrams) {
+  while (!datagrams.empty()) {
+    const size_t count = std::min(datagrams.size(), DatagramsPerBatch);
+    for (size_t i = 0; i < count; ++i) {
+      slices_[i] = {const_cast<char*>(datagrams[i].data()), datagrams[i].size()};
+    }
+    // The handle sends the batch with a single sendmmsg() where the platform supports it.
+    const Api::IoCallUint64Result result =
+        io_handle_->sendmmsg(slices_.data(), count, 0, *parent_.server_address_);
+    if (!result.ok()) {
+      // As with single writes, failures are not retried. Drop the rest of the flush rather than
+      // spinning on a socket that can't take more data.
+      ENVOY_LOG_MISC(debug, "statsd send failed: {}", result.err_->getErrorDetails());
+      return;
+    }
+    if (result.return_value_ == 0) {
+      return;
+    }
+    // On a partial send, the next call starts from the first datagram that wasn't sent.
+    datagrams.remove_prefix(result.return_value_);
+  }
 }
 
 UdpStatsdSink::UdpStatsdSink(ThreadLocal::SlotAllocator& tls,
@@ -50,59 +118,70 @@ UdpStatsdSink::UdpStatsdSink(ThreadLocal::SlotAllocator& tls,
                              const Statsd::TagFormat& tag_format)
     : tls_(tls.allocateSlot()), server_address_(std::move(address)), use_tag_(use_tag),
       prefix_(prefix.empty() ? Statsd::getDefaultPrefix() : prefix),
-      buffer_size_(buffer_size.value_or(0)), tag_format_(tag_format) {
+      buffer_size_(buffer_size.value_or(0)), tag_format_(tag_format),
+      datagram_builder_(buffer_size_) {
   tls_->set([this](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
     return std::make_shared<WriterImpl>(*this);
   });
 }
 
+void UdpStatsdSink::setFlushSpread(Event::Dispatcher& dispatcher,
+                                   std::chrono::milliseconds flush_spread) {
+  ASSERT(spread_timer_ == nullptr);
+  flush_spread_ = flush_spread;
+  spread_timer_ = dispatcher.createTimer([this]() { sendPendingBatch(); });
+}
+
 void UdpStatsdSink::flush(Stats::MetricSnapshot& snapshot) {
-  Writer& writer = tls_->getTyped<Writer>();
-  Buffer::OwnedImpl buffer;
+  // The pending datagrams of the previous flush point into the builder, so they must be sent
+  // before it is reused.
+  if (!pending_datagrams_.empty()) {
+    spread_timer_->disableTimer();
+    tls_->getTyped<Writer>().writeDatagrams(pending_datagrams_);
+    pending_datagrams_ = {};
+  }
 
+  datagram_builder_.clear();
   for (const auto& counter : snapshot.counters()) {
     if (counter.counter_.get().used()) {
-      const std::string counter_str = buildMessage(counter.counter_.get(), counter.delta_, "|c");
-      writeBuffer(buffer, writer, counter_str);
+      appendMessage(datagram_builder_.beginLine(), counter.counter_.get(), counter.delta_, "|c");
+      datagram_builder_.endLine();
     }
   }
 
   for (const auto& gauge : snapshot.gauges()) {
     if (gauge.get().used()) {
-      const std::string gauge_str = buildMessage(gauge.get(), gauge.get().value(), "|g");
-      writeBuffer(buffer, writer, gauge_str);
+      appendMessage(datagram_builder_.beginLine(), gauge.get(), gauge.get().value(), "|g");
+      datagram_builder_.endLine();
     }
   }
-
-  flushBuffer(buffer, writer);
   // TODO(efimki): Add support of text readouts stats.
-}
 
-void UdpStatsdSink::writeBuffer(Buffer::OwnedImpl& buffer, Writer& writer,
-                                const std::string& statsd_metric) const {
-  if (statsd_metric.length() >= buffer_size_) {
-    // Our statsd_metric is too large to fit into the buffer, skip buffering and write directly
-    writer.write(statsd_metric);
-  } else {
-    if ((buffer.length() + statsd_metric.length() + 1) > buffer_size_) {
-      // If we add the new statsd_metric, we'll overflow our buffer. Flush the buffer to make
-      // room for the new statsd_metric.
-      flushBuffer(buffer, writer);
-    } else if (buffer.length() > 0) {
-      // We have room and have metrics already in the buffer, add a newline to separate
-      // metric entries.
-      buffer.add("\n");
-    }
-    buffer.add(statsd_metric);
+  pending_datagrams_ = datagram_builder_.datagrams();
+  datagrams_per_batch_ = pending_datagrams_.size();
+  if (spread_timer_ != nullptr && pending_datagrams_.size() > DatagramsPerBatch) {
+    // Send at most one batch per millisecond, of at least DatagramsPerBatch datagrams, so that
+    // small flushes don't turn into a stream of tiny timer callbacks.
+    const size_t max_batches = std::max<size_t>(1, flush_spread_.count());
+    datagrams_per_batch_ =
+        std::max(DatagramsPerBatch, (pending_datagrams_.size() + max_batches - 1) / max_batches);
+    const size_t batches = (pending_datagrams_.size() + datagrams_per_batch_ - 1) /
+                           datagrams_per_batch_;
+    batch_interval_ = flush_spread_ / batches;
   }
+  sendPendingBatch();
 }
 
-void UdpStatsdSink::flushBuffer(Buffer::OwnedImpl& buffer, Writer& writer) const {
-  if (buffer.length() == 0) {
+void UdpStatsdSink::sendPendingBatch() {
+  if (pending_datagrams_.empty()) {
     return;
   }
-  writer.writeBuffer(buffer);
-  buffer.drain(buffer.length());
+  const size_t count = std::min(datagrams_per_batch_, pending_datagrams_.size());
+  tls_->getTyped<Writer>().writeDatagrams(pending_datagrams_.first(count));
+  pending_datagrams_.remove_prefix(count);
+  if (!pending_datagrams_.empty()) {
+    spread_timer_->enableTimer(batch_interval_);
+  }
 }
 
 void UdpStatsdSink::onHistogramComplete(const Stats::Histogram& histogram, uint64_t value) {
@@ -119,61 +198,53 @@ void UdpStatsdSink::onHistogramComplete(const Stats::Histogram& histogram, uint6
     constexpr float divisor = Stats::Histogram::PercentScale;
     const float float_value = value;
     const float scaled = float_value / divisor;
-    message = buildMessage(histogram, scaled, "|h");
+    appendMessage(message, histogram, scaled, "|h");
   } else {
-    message = buildMessage(histogram, std::chrono::milliseconds(value).count(), "|ms");
+    appendMessage(message, histogram, std::chrono::milliseconds(value).count(), "|ms");
   }
   tls_->getTyped<Writer>().write(message);
 }
 
 template <typename ValueType>
-const std::string UdpStatsdSink::buildMessage(const Stats::Metric& metric, ValueType value,
-                                              const std::string& type) const {
+void UdpStatsdSink::appendMessage(std::string& out, const Stats::Metric& metric, ValueType value,
+                                  absl::string_view type) const {
+  // metric name
+  out.append(prefix_);
+  out.push_back('.');
+  metric.constSymbolTable().appendTo(use_tag_ ? metric.tagExtractedStatName() : metric.statName(),
+                                     out);
+
   switch (tag_format_.tag_position) {
-  case Statsd::TagPosition::TagAfterValue: {
-    const std::string message = absl::StrCat(
-        // metric name
-        prefix_, ".", getName(metric),
-        // value and type
-        ":", value, type,
-        // tags
-        buildTagStr(metric.tags()));
-    return message;
-  }
+  case Statsd::TagPosition::TagAfterValue:
+    // value and type, then tags
+    absl::StrAppend(&out, ":", value, type);
+    appendTags(out, metric);
+    return;
 
-  case Statsd::TagPosition::TagAfterName: {
-    const std::string message = absl::StrCat(
-        // metric name
-        prefix_, ".", getName(metric),
-        // tags
-        buildTagStr(metric.tags()),
-        // value and type
-        ":", value, type);
-    return message;
-  }
+  case Statsd::TagPosition::TagAfterName:
+    // tags, then value and type
+    appendTags(out, metric);
+    absl::StrAppend(&out, ":", value, type);
+    return;
   }
   PANIC_DUE_TO_CORRUPT_ENUM;
 }
 
-const std::string UdpStatsdSink::getName(const Stats::Metric& metric) const {
-  if (use_tag_) {
-    return metric.tagExtractedName();
-  } else {
-    return metric.name();
-  }
-}
-
-const std::string UdpStatsdSink::buildTagStr(const std::vector<Stats::Tag>& tags) const {
-  if (!use_tag_ || tags.empty()) {
-    return "";
+void UdpStatsdSink::appendTags(std::string& out, const Stats::Metric& metric) const {
+  if (!use_tag_) {
+    return;
   }
 
-  std::vector<std::string> tag_strings;
-  tag_strings.reserve(tags.size());
-  for (const Stats::Tag& tag : tags) {
-    tag_strings.emplace_back(tag.name_ + tag_format_.assign + tag.value_);
-  }
-  return tag_format_.start + absl::StrJoin(tag_strings, tag_format_.separator);
+  const Stats::SymbolTable& symbol_table = metric.constSymbolTable();
+  bool first = true;
+  metric.iterateTagStatNames([&](Stats::StatName name, Stats::StatName value) -> bool {
+    out.append(first ? tag_format_.start : tag_format_.separator);
+    first = false;
+    symbol_table.appendTo(name, out);
+    out.append(tag_format_.assign);
+    symbol_table.appendTo(value, out);
+    return true;
+  });
 }
 
 TcpStatsdSink::TcpStatsdSink(const LocalInfo::LocalInfo& local_info,
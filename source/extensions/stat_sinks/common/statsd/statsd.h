@@ -1,7 +1,15 @@
 #pragma once
 
+#include <array>
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "envoy/buffer/buffer.h"
 #include "envoy/common/platform.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
 #include "envoy/local_info/local_info.h"
 #include "envoy/network/connection.h"
 #include "envoy/stats/histogram.h"
@@ -17,7 +25,9 @@
 #include "source/common/network/io_socket_handle_impl.h"
 #include "source/extensions/stat_sinks/common/statsd/tag_formats.h"
 
+#include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
+#include "absl/types/span.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -27,18 +37,72 @@ namespace Statsd {
 
 static const std::string& getDefaultPrefix() { CONSTRUCT_ON_FIRST_USE(std::string, "envoy"); }
 
+/**
+ * Packs newline-separated statsd lines into datagrams. Lines are formatted directly into a single
+ * string that is reused across flushes, so building the datagrams of a flush doesn't allocate once
+ * the string has grown to fit the flushed stats.
+ */
+class DatagramBuilder {
+public:
+  /**
+   * @param max_datagram_size the max size of a datagram. A line that doesn't fit in a datagram by
+   *        itself is sent in a datagram of its own, so zero sends each line in its own datagram.
+   */
+  explicit DatagramBuilder(uint64_t max_datagram_size) : max_datagram_size_(max_datagram_size) {}
+
+  /**
+   * Discards all lines and datagrams, keeping the allocated memory.
+   */
+  void clear();
+
+  /**
+   * Starts a new line. The content of the line must be appended to the returned string before
+   * calling endLine().
+   */
+  std::string& beginLine();
+
+  /**
+   * Ends the line started by beginLine(), adding it to the current datagram if it fits.
+   */
+  void endLine();
+
+  /**
+   * Completes the current datagram.
+   * @return the datagrams built since the last clear(). The views are valid until the next call to
+   *         any other method of the builder.
+   */
+  absl::Span<const absl::string_view> datagrams();
+
+private:
+  const uint64_t max_datagram_size_;
+  std::string data_;
+  // The [start, end) offsets into data_ of the completed datagrams.
+  std::vector<std::pair<size_t, size_t>> bounds_;
+  std::vector<absl::string_view> datagrams_;
+  size_t datagram_start_{0};
+  size_t line_start_{0};
+};
+
 /**
  * Implementation of Sink that writes to a UDP statsd address.
  */
 class UdpStatsdSink : public Stats::Sink {
 public:
+  // The number of datagrams sent by a single sendmmsg() call, and the minimum number of datagrams
+  // sent at once when spreading a flush.
+  static constexpr size_t DatagramsPerBatch = 64;
+
   /**
    * Base interface for writing UDP datagrams.
    */
   class Writer : public ThreadLocal::ThreadLocalObject {
   public:
     virtual void write(const std::string& message) PURE;
-    virtual void writeBuffer(Buffer::Instance& data) PURE;
+
+    /**
+     * Sends each of the given datagrams, batching the system calls where supported.
+     */
+    virtual void writeDatagrams(absl::Span<const absl::string_view> datagrams) PURE;
   };
 
   UdpStatsdSink(ThreadLocal::SlotAllocator& tls, Network::Address::InstanceConstSharedPtr address,
@@ -52,7 +116,8 @@ public:
                 const Statsd::TagFormat& tag_format = Statsd::getDefaultTagFormat())
       : tls_(tls.allocateSlot()), use_tag_(use_tag),
         prefix_(prefix.empty() ? getDefaultPrefix() : prefix),
-        buffer_size_(buffer_size.value_or(0)), tag_format_(tag_format) {
+        buffer_size_(buffer_size.value_or(0)), tag_format_(tag_format),
+        datagram_builder_(buffer_size_) {
     tls_->set(
         [writer](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr { return writer; });
   }
@@ -60,6 +125,16 @@ public:
   // Stats::Sink
   void flush(Stats::MetricSnapshot& snapshot) override;
   void onHistogramComplete(const Stats::Histogram& histogram, uint64_t value) override;
+  bool supportsChangedMetricsOnly() const override { return true; }
+
+  /**
+   * Spreads the datagrams of each flush evenly over the given duration, rather than sending them
+   * all at once. Datagrams still pending when the next flush starts are sent right away. Must be
+   * called before the first flush.
+   * @param dispatcher the dispatcher of the thread that flushes the sink.
+   * @param flush_spread the duration to spread each flush over.
+   */
+  void setFlushSpread(Event::Dispatcher& dispatcher, std::chrono::milliseconds flush_spread);
 
   bool getUseTagForTest() { return use_tag_; }
   uint64_t getBufferSizeForTest() { return buffer_size_; }
@@ -75,21 +150,21 @@ private:
 
     // Writer
     void write(const std::string& message) override;
-    void writeBuffer(Buffer::Instance& data) override;
+    void writeDatagrams(absl::Span<const absl::string_view> datagrams) override;
 
   private:
     UdpStatsdSink& parent_;
     const Network::IoHandlePtr io_handle_;
+    // Scratch space for sending a batch of datagrams.
+    std::array<Buffer::RawSlice, DatagramsPerBatch> slices_;
   };
 
-  void flushBuffer(Buffer::OwnedImpl& buffer, Writer& writer) const;
-  void writeBuffer(Buffer::OwnedImpl& buffer, Writer& writer, const std::string& data) const;
+  void sendPendingBatch();
 
   template <typename ValueType>
-  const std::string buildMessage(const Stats::Metric& metric, ValueType value,
-                                 const std::string& type) const;
-  const std::string getName(const Stats::Metric& metric) const;
-  const std::string buildTagStr(const std::vector<Stats::Tag>& tags) const;
+  void appendMessage(std::string& out, const Stats::Metric& metric, ValueType value,
+                     absl::string_view type) const;
+  void appendTags(std::string& out, const Stats::Metric& metric) const;
 
   const ThreadLocal::SlotPtr tls_;
   const Network::Address::InstanceConstSharedPtr server_address_;
@@ -98,6 +173,14 @@ private:
   const std::string prefix_;
   const uint64_t buffer_size_;
   const Statsd::TagFormat tag_format_;
+  // Only used by flush(), on the main thread.
+  DatagramBuilder datagram_builder_;
+  // Flush spreading state, only used when setFlushSpread() was called.
+  Event::TimerPtr spread_timer_;
+  std::chrono::milliseconds flush_spread_{};
+  std::chrono::milliseconds batch_interval_{};
+  size_t datagrams_per_batch_{};
+  absl::Span<const absl::string_view> pending_datagrams_;
 };
 
 /**
@@ -112,6 +195,7 @@ public:
   // Stats::Sink
   void flush(Stats::MetricSnapshot& snapshot) override;
   void onHistogramComplete(const Stats::Histogram& histogram, uint64_t value) override;
+  bool supportsChangedMetricsOnly() const override { return true; }
 
   const std::string& getPrefix() { return prefix_; }
 
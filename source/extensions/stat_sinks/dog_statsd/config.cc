@@ -1,5 +1,6 @@
 #include "source/extensions/stat_sinks/dog_statsd/config.h"
 
+#include <chrono>
 #include <memory>
 
 #include "envoy/config/metrics/v3/stats.pb.h"
@@ -7,6 +8,7 @@
 #include "envoy/registry/registry.h"
 
 #include "source/common/network/resolver_impl.h"
+#include "source/common/protobuf/utility.h"
 #include "source/extensions/stat_sinks/common/statsd/statsd.h"
 
 #include "absl/types/optional.h"
@@ -29,8 +31,14 @@ DogStatsdSinkFactory::createStatsSink(const Protobuf::Message& config,
   if (sink_config.has_max_bytes_per_datagram()) {
     max_bytes = sink_config.max_bytes_per_datagram().value();
   }
-  return std::make_unique<Common::Statsd::UdpStatsdSink>(server.threadLocal(), std::move(address),
-                                                         true, sink_config.prefix(), max_bytes);
+  auto sink = std::make_unique<Common::Statsd::UdpStatsdSink>(
+      server.threadLocal(), std::move(address), true, sink_config.prefix(), max_bytes);
+  if (sink_config.has_flush_spread()) {
+    sink->setFlushSpread(
+        server.mainThreadDispatcher(),
+        std::chrono::milliseconds(PROTOBUF_GET_MS_OR_DEFAULT(sink_config, flush_spread, 0)));
+  }
+  return sink;
 }
 
 ProtobufTypes::MessagePtr DogStatsdSinkFactory::createEmptyConfigProto() {
@@ -142,6 +142,7 @@ public:
     grpc_metrics_streamer_->send(flusher_.flush(snapshot));
   }
   void onHistogramComplete(const Stats::Histogram&, uint64_t) override {}
+  bool supportsChangedMetricsOnly() const override { return true; }
 
 private:
   const MetricsFlusher flusher_;
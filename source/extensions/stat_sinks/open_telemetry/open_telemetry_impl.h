@@ -154,6 +154,7 @@ public:
   }
 
   void onHistogramComplete(const Stats::Histogram&, uint64_t) override {}
+  bool supportsChangedMetricsOnly() const override { return true; }
 
 private:
   const OtlpMetricsFlusherSharedPtr metrics_flusher_;
@@ -1,5 +1,6 @@
 #include "source/extensions/stat_sinks/statsd/config.h"
 
+#include <chrono>
 #include <memory>
 
 #include "envoy/config/metrics/v3/stats.pb.h"
@@ -7,8 +8,11 @@
 #include "envoy/registry/registry.h"
 
 #include "source/common/network/resolver_impl.h"
+#include "source/common/protobuf/utility.h"
 #include "source/extensions/stat_sinks/common/statsd/statsd.h"
 
+#include "absl/types/optional.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace StatSinks {
@@ -26,8 +30,18 @@ StatsdSinkFactory::createStatsSink(const Protobuf::Message& config,
     Network::Address::InstanceConstSharedPtr address =
         Network::Address::resolveProtoAddress(statsd_sink.address());
     ENVOY_LOG(debug, "statsd UDP ip address: {}", address->asString());
-    return std::make_unique<Common::Statsd::UdpStatsdSink>(server.threadLocal(), std::move(address),
-                                                           false, statsd_sink.prefix());
+    absl::optional<uint64_t> max_bytes;
+    if (statsd_sink.has_max_bytes_per_datagram()) {
+      max_bytes = statsd_sink.max_bytes_per_datagram().value();
+    }
+    auto sink = std::make_unique<Common::Statsd::UdpStatsdSink>(
+        server.threadLocal(), std::move(address), false, statsd_sink.prefix(), max_bytes);
+    if (statsd_sink.has_flush_spread()) {
+      sink->setFlushSpread(server.mainThreadDispatcher(),
+                           std::chrono::milliseconds(
+                               PROTOBUF_GET_MS_OR_DEFAULT(statsd_sink, flush_spread, 0)));
+    }
+    return sink;
   }
   case envoy::config::metrics::v3::StatsdSink::StatsdSpecifierCase::kTcpClusterName:
     ENVOY_LOG(debug, "statsd TCP cluster: {}", statsd_sink.tcp_cluster_name());
@@ -186,7 +186,8 @@ ContextConfigImpl::ContextConfigImpl(
                                                 default_max_protocol_version)),
       factory_context_(factory_context), tls_keylog_path_(config.key_log().path()),
       tls_keylog_local_(config.key_log().local_address_range()),
-      tls_keylog_remote_(config.key_log().remote_address_range()) {
+      tls_keylog_remote_(config.key_log().remote_address_range()),
+      kernel_tls_offload_(config.kernel_tls_offload()) {
   if (certificate_validation_context_provider_ != nullptr) {
     if (default_cvc_) {
       // We need to validate combined certificate validation context.
@@ -76,6 +76,12 @@ public:
 
   SslStats& stats() { return stats_; }
 
+  /**
+   * @return true if connections using this context should attempt to offload record encryption
+   * and decryption to the kernel once the handshake completes.
+   */
+  bool kernelTlsOffload() const { return kernel_tls_offload_; }
+
   /**
    * The global SSL-library index used for storing a pointer to the SslExtendedSocketInfo
    * class in the SSL instance, for retrieval in callbacks.
@@ -153,6 +159,7 @@ protected:
   const Ssl::HandshakerCapabilities capabilities_;
   const Network::Address::IpList tls_keylog_local_;
   const Network::Address::IpList tls_keylog_remote_;
+  const bool kernel_tls_offload_;
   AccessLog::AccessLogFileSharedPtr tls_keylog_file_;
 };
 
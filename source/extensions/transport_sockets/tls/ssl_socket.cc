@@ -2,6 +2,7 @@
 
 #include "envoy/stats/scope.h"
 
+#include "source/common/api/os_sys_calls_impl.h"
 #include "source/common/common/assert.h"
 #include "source/common/common/empty_string.h"
 #include "source/common/common/hex.h"
@@ -13,8 +14,24 @@
 
 #include "absl/strings/str_replace.h"
 #include "openssl/err.h"
+#include "openssl/mem.h"
 #include "openssl/x509v3.h"
 
+#if defined(__linux__) && __has_include(<linux/tls.h>)
+#include <endian.h>
+#include <linux/tls.h>
+#include <netinet/tcp.h>
+
+#define ENVOY_KERNEL_TLS 1
+
+#ifndef SOL_TLS
+#define SOL_TLS 282
+#endif
+#ifndef TCP_ULP
+#define TCP_ULP 31
+#endif
+#endif
+
 using Envoy::Network::PostIoAction;
 
 namespace Envoy {
@@ -45,6 +62,38 @@ public:
   void configureInitialCongestionWindow(uint64_t, std::chrono::microseconds) override {}
 };
 
+#ifdef ENVOY_KERNEL_TLS
+// Size of the implicit part of the AES-GCM nonce, which is the client_write_IV or server_write_IV
+// of the TLS 1.2 key block.
+constexpr size_t KernelTlsSaltLength = 4;
+
+// Installs the key material of one direction of a TLS 1.2 AES-GCM connection in the kernel.
+// CryptoInfo is the tls12_crypto_info_* struct of the negotiated cipher.
+template <class CryptoInfo>
+bool setKernelTlsCryptoInfo(Network::IoHandle& io_handle, int direction, uint16_t cipher_type,
+                            const uint8_t* key, const uint8_t* salt, uint64_t sequence) {
+  static_assert(sizeof(CryptoInfo::salt) == KernelTlsSaltLength);
+  static_assert(sizeof(CryptoInfo::iv) == sizeof(uint64_t));
+  static_assert(sizeof(CryptoInfo::rec_seq) == sizeof(uint64_t));
+  CryptoInfo crypto_info;
+  memset(&crypto_info, 0, sizeof(crypto_info));
+  crypto_info.info.version = TLS_1_2_VERSION;
+  crypto_info.info.cipher_type = cipher_type;
+  memcpy(crypto_info.key, key, sizeof(crypto_info.key));
+  memcpy(crypto_info.salt, salt, sizeof(crypto_info.salt));
+  // BoringSSL uses the record sequence number as the explicit part of the nonce, and the kernel
+  // increments both together for each record.
+  const uint64_t sequence_be = htobe64(sequence);
+  memcpy(crypto_info.iv, &sequence_be, sizeof(crypto_info.iv));
+  memcpy(crypto_info.rec_seq, &sequence_be, sizeof(crypto_info.rec_seq));
+  const bool result =
+      io_handle.setOption(SOL_TLS, direction, &crypto_info, sizeof(crypto_info)).return_value_ ==
+      0;
+  OPENSSL_cleanse(&crypto_info, sizeof(crypto_info));
+  return result;
+}
+#endif
+
 } // namespace
 
 SslSocket::SslSocket(Envoy::Ssl::ContextSharedPtr ctx, InitialState state,
@@ -110,6 +159,10 @@ Network::IoResult SslSocket::doRead(Buffer::Instance& read_buffer) {
     }
   }
 
+  if (kernel_tls_) {
+    return doKernelTlsRead(read_buffer);
+  }
+
   bool keep_reading = true;
   bool end_stream = false;
   PostIoAction action = PostIoAction::KeepOpen;
@@ -184,6 +237,11 @@ Network::Connection& SslSocket::connection() const { return callbacks_->connecti
 
 void SslSocket::onSuccess(SSL* ssl) {
   ctx_->logHandshake(ssl);
+  if (ctx_->kernelTlsOffload() && !enableKernelTls()) {
+    callbacks_->connection().close(Network::ConnectionCloseType::NoFlush,
+                                   "kernel_tls_offload_failed");
+    return;
+  }
   if (callbacks_->connection().streamInfo().upstreamInfo()) {
     callbacks_->connection()
         .streamInfo()
@@ -201,6 +259,197 @@ void SslSocket::onFailure(bool syscall_error_occurred) { drainErrorQueue(syscall
 
 PostIoAction SslSocket::doHandshake() { return info_->doHandshake(); }
 
+bool SslSocket::enableKernelTls() {
+  ASSERT(!kernel_tls_);
+#ifdef ENVOY_KERNEL_TLS
+  SSL* ssl = rawSsl();
+  const SSL_CIPHER* cipher = SSL_get_current_cipher(ssl);
+  // Only TLS 1.2 is offloaded. The TLS 1.3 traffic secrets are available from
+  // SSL_get_traffic_secrets(), but a TLS 1.3 peer can send post-handshake messages at any time,
+  // such as NewSessionTicket and KeyUpdate. The kernel would return them as decrypted handshake
+  // records, which BoringSSL has no way to process, and a KeyUpdate requires rekeying both
+  // directions in step with the peer. Records that BoringSSL has already read from the socket
+  // would be lost to the kernel, so those connections are not offloaded either.
+  if (SSL_version(ssl) != TLS1_2_VERSION || cipher == nullptr || SSL_has_pending(ssl)) {
+    ENVOY_CONN_LOG(debug, "kernel TLS offload is not possible for this connection",
+                   callbacks_->connection());
+    ctx_->stats().kernel_tls_offload_failed_.inc();
+    return true;
+  }
+
+  const int cipher_nid = SSL_CIPHER_get_cipher_nid(cipher);
+  size_t key_length;
+  if (cipher_nid == NID_aes_128_gcm) {
+    key_length = TLS_CIPHER_AES_GCM_128_KEY_SIZE;
+#ifdef TLS_CIPHER_AES_GCM_256
+  } else if (cipher_nid == NID_aes_256_gcm) {
+    key_length = TLS_CIPHER_AES_GCM_256_KEY_SIZE;
+#endif
+  } else {
+    ENVOY_CONN_LOG(debug, "kernel TLS offload is not supported for cipher {}",
+                   callbacks_->connection(), SSL_CIPHER_get_name(cipher));
+    ctx_->stats().kernel_tls_offload_failed_.inc();
+    return true;
+  }
+
+  // For AEAD ciphers the key block holds the client and server write keys, followed by the client
+  // and server implicit nonces.
+  std::vector<uint8_t> key_block(SSL_get_key_block_len(ssl));
+  if (key_block.size() != 2 * (key_length + KernelTlsSaltLength) ||
+      !SSL_generate_key_block(ssl, key_block.data(), key_block.size())) {
+    ctx_->stats().kernel_tls_offload_failed_.inc();
+    return true;
+  }
+  const uint8_t* client_key = key_block.data();
+  const uint8_t* server_key = client_key + key_length;
+  const uint8_t* client_salt = server_key + key_length;
+  const uint8_t* server_salt = client_salt + KernelTlsSaltLength;
+  const bool is_server = SSL_is_server(ssl);
+
+  Network::IoHandle& io_handle = callbacks_->ioHandle();
+  if (io_handle.setOption(IPPROTO_TCP, TCP_ULP, "tls", sizeof("tls")).return_value_ != 0) {
+    ENVOY_CONN_LOG(debug, "kernel TLS is not available", callbacks_->connection());
+    OPENSSL_cleanse(key_block.data(), key_block.size());
+    ctx_->stats().kernel_tls_offload_failed_.inc();
+    return true;
+  }
+
+  // Both directions have to be offloaded: with only one of them in the kernel, BoringSSL would
+  // still send alerts with its own, stale, write sequence number, or miss the records it has to
+  // read. Decryption is offloaded first as it needs a more recent kernel, and failing to offload it
+  // leaves only the pass-through ULP behind, so the connection can keep using BoringSSL.
+  const auto set_crypto_info = [&](int direction, const uint8_t* key, const uint8_t* salt,
+                                   uint64_t sequence) {
+    if (key_length == TLS_CIPHER_AES_GCM_128_KEY_SIZE) {
+      return setKernelTlsCryptoInfo<tls12_crypto_info_aes_gcm_128>(
+          io_handle, direction, TLS_CIPHER_AES_GCM_128, key, salt, sequence);
+    }
+#ifdef TLS_CIPHER_AES_GCM_256
+    return setKernelTlsCryptoInfo<tls12_crypto_info_aes_gcm_256>(
+        io_handle, direction, TLS_CIPHER_AES_GCM_256, key, salt, sequence);
+#else
+    return false;
+#endif
+  };
+  const bool rx = set_crypto_info(TLS_RX, is_server ? client_key : server_key,
+                                  is_server ? client_salt : server_salt,
+                                  SSL_get_read_sequence(ssl));
+  const bool tx = rx && set_crypto_info(TLS_TX, is_server ? server_key : client_key,
+                                        is_server ? server_salt : client_salt,
+                                        SSL_get_write_sequence(ssl));
+  OPENSSL_cleanse(key_block.data(), key_block.size());
+
+  ENVOY_CONN_LOG(debug, "kernel TLS offload: tx={} rx={}", callbacks_->connection(), tx, rx);
+  if (!tx) {
+    ctx_->stats().kernel_tls_offload_failed_.inc();
+    // Decryption can't be handed back to BoringSSL once the kernel has it.
+    return !rx;
+  }
+  kernel_tls_ = true;
+  ctx_->stats().kernel_tls_offloaded_.inc();
+  return true;
+#else
+  ctx_->stats().kernel_tls_offload_failed_.inc();
+  return true;
+#endif
+}
+
+Network::IoResult SslSocket::doKernelTlsRead(Buffer::Instance& read_buffer) {
+  PostIoAction action = PostIoAction::KeepOpen;
+  uint64_t bytes_read = 0;
+  bool end_stream = false;
+  do {
+    Api::IoCallUint64Result result = callbacks_->ioHandle().read(read_buffer, absl::nullopt);
+
+    if (result.ok()) {
+      ENVOY_CONN_LOG(trace, "ktls read returns: {}", callbacks_->connection(),
+                     result.return_value_);
+      if (result.return_value_ == 0) {
+        // Non-graceful shutdown by closing the underlying socket.
+        end_stream = true;
+        break;
+      }
+      bytes_read += result.return_value_;
+      if (callbacks_->shouldDrainReadBuffer()) {
+        callbacks_->setTransportSocketIsReadable();
+        break;
+      }
+    } else {
+      ENVOY_CONN_LOG(trace, "ktls read error: {}", callbacks_->connection(),
+                     result.err_->getErrorDetails());
+      if (result.err_->getErrorCode() == Api::IoError::IoErrorCode::Again) {
+        break;
+      }
+      // The kernel fails plain reads with EIO when the next record isn't application data. A
+      // close_notify alert is a graceful shutdown, anything else closes the connection.
+      if (result.err_->getSystemErrorCode() == EIO && receiveKernelTlsCloseNotify()) {
+        end_stream = true;
+        break;
+      }
+      action = PostIoAction::Close;
+      break;
+    }
+  } while (true);
+
+  return {action, bytes_read, end_stream};
+}
+
+bool SslSocket::receiveKernelTlsCloseNotify() {
+#ifdef ENVOY_KERNEL_TLS
+  // An alert record is two bytes, its level and description. The record type is only returned as
+  // ancillary data.
+  uint8_t alert[2];
+  char control[CMSG_SPACE(sizeof(uint8_t))];
+  iovec iov;
+  iov.iov_base = alert;
+  iov.iov_len = sizeof(alert);
+  msghdr message;
+  memset(&message, 0, sizeof(message));
+  message.msg_iov = &iov;
+  message.msg_iovlen = 1;
+  message.msg_control = control;
+  message.msg_controllen = sizeof(control);
+  const Api::SysCallSizeResult result = Api::OsSysCallsSingleton::get().recvmsg(
+      callbacks_->ioHandle().fdDoNotUse(), &message, 0);
+  if (result.return_value_ != static_cast<ssize_t>(sizeof(alert))) {
+    return false;
+  }
+  const cmsghdr* cmsg = CMSG_FIRSTHDR(&message);
+  return cmsg != nullptr && cmsg->cmsg_level == SOL_TLS &&
+         cmsg->cmsg_type == TLS_GET_RECORD_TYPE && *CMSG_DATA(cmsg) == SSL3_RT_ALERT &&
+         alert[1] == SSL_AD_CLOSE_NOTIFY;
+#else
+  return false;
+#endif
+}
+
+void SslSocket::sendKernelTlsCloseNotify() {
+#ifdef ENVOY_KERNEL_TLS
+  uint8_t alert[2] = {SSL3_AL_WARNING, SSL_AD_CLOSE_NOTIFY};
+  char control[CMSG_SPACE(sizeof(uint8_t))];
+  memset(control, 0, sizeof(control));
+  iovec iov;
+  iov.iov_base = alert;
+  iov.iov_len = sizeof(alert);
+  msghdr message;
+  memset(&message, 0, sizeof(message));
+  message.msg_iov = &iov;
+  message.msg_iovlen = 1;
+  message.msg_control = control;
+  message.msg_controllen = sizeof(control);
+  cmsghdr* cmsg = CMSG_FIRSTHDR(&message);
+  cmsg->cmsg_level = SOL_TLS;
+  cmsg->cmsg_type = TLS_SET_RECORD_TYPE;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(uint8_t));
+  *CMSG_DATA(cmsg) = SSL3_RT_ALERT;
+  // Like SSL_shutdown(), this is best effort and the result is ignored.
+  const Api::SysCallSizeResult result = Api::OsSysCallsSingleton::get().sendmsg(
+      callbacks_->ioHandle().fdDoNotUse(), &message, 0);
+  ENVOY_CONN_LOG(debug, "ktls close_notify: rc={}", callbacks_->connection(),
+                 result.return_value_);
+#endif
+}
+
 void SslSocket::drainErrorQueue(bool syscall_error_occurred) {
   bool saw_error = false;
   bool saw_counted_error = false;
@@ -261,6 +510,10 @@ Network::IoResult SslSocket::doWrite(Buffer::Instance& write_buffer, bool end_st
     }
   }
 
+  if (kernel_tls_) {
+    return doKernelTlsWrite(write_buffer, end_stream);
+  }
+
   uint64_t bytes_to_write;
   if (bytes_to_retry_) {
     bytes_to_write = bytes_to_retry_;
@@ -311,6 +564,30 @@ Network::IoResult SslSocket::doWrite(Buffer::Instance& write_buffer, bool end_st
   return {PostIoAction::KeepOpen, total_bytes_written, false};
 }
 
+Network::IoResult SslSocket::doKernelTlsWrite(Buffer::Instance& write_buffer, bool end_stream) {
+  uint64_t total_bytes_written = 0;
+  while (write_buffer.length() > 0) {
+    Api::IoCallUint64Result result = callbacks_->ioHandle().write(write_buffer);
+    if (!result.ok()) {
+      ENVOY_CONN_LOG(trace, "ktls write error: {}", callbacks_->connection(),
+                     result.err_->getErrorDetails());
+      if (result.err_->getErrorCode() == Api::IoError::IoErrorCode::Again) {
+        break;
+      }
+      return {PostIoAction::Close, total_bytes_written, false};
+    }
+    ENVOY_CONN_LOG(trace, "ktls write returns: {}", callbacks_->connection(),
+                   result.return_value_);
+    total_bytes_written += result.return_value_;
+  }
+
+  if (write_buffer.length() == 0 && end_stream) {
+    shutdownSsl();
+  }
+
+  return {PostIoAction::KeepOpen, total_bytes_written, false};
+}
+
 void SslSocket::onConnected() { ASSERT(info_->state() == Ssl::SocketState::PreHandshake); }
 
 Ssl::ConnectionInfoConstSharedPtr SslSocket::ssl() const { return info_; }
@@ -319,6 +596,12 @@ void SslSocket::shutdownSsl() {
   ASSERT(info_->state() != Ssl::SocketState::PreHandshake);
   if (info_->state() != Ssl::SocketState::ShutdownSent &&
       callbacks_->connection().state() != Network::Connection::State::Closed) {
+    if (kernel_tls_) {
+      // BoringSSL's write state is stale once encryption is done by the kernel.
+      sendKernelTlsCloseNotify();
+      info_->setState(Ssl::SocketState::ShutdownSent);
+      return;
+    }
     int rc = SSL_shutdown(rawSsl());
     if constexpr (Event::PlatformDefaultTriggerType == Event::FileTriggerType::EmulatedEdge) {
       // Windows operate under `EmulatedEdge`. These are level events that are artificially
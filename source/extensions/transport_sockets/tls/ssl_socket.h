@@ -86,6 +86,12 @@ private:
   ReadResult sslReadIntoSlice(Buffer::RawSlice& slice);
 
   Network::PostIoAction doHandshake();
+  // Returns false if the connection can neither be offloaded nor keep using BoringSSL.
+  bool enableKernelTls();
+  Network::IoResult doKernelTlsRead(Buffer::Instance& read_buffer);
+  Network::IoResult doKernelTlsWrite(Buffer::Instance& write_buffer, bool end_stream);
+  bool receiveKernelTlsCloseNotify();
+  void sendKernelTlsCloseNotify();
   void drainErrorQueue(bool syscall_error_occurred = false);
   void shutdownSsl();
   void shutdownBasic();
@@ -96,6 +102,9 @@ private:
   ContextImplSharedPtr ctx_;
   uint64_t bytes_to_retry_{};
   std::string failure_reason_;
+  // Set when record encryption and decryption have been offloaded to the kernel, in which case
+  // reads and writes bypass BoringSSL and use the socket directly.
+  bool kernel_tls_{false};
 
   SslHandshakerImplSharedPtr info_;
 };
@@ -1,12 +1,21 @@
 #include "source/server/admin/prometheus_stats.h"
 
-#include "source/common/common/empty_string.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 #include "source/common/common/macros.h"
 #include "source/common/common/regex.h"
+#include "source/common/protobuf/protobuf.h"
 #include "source/common/stats/histogram_impl.h"
+#include "source/common/stats/symbol_table.h"
 
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
-#include "absl/strings/str_replace.h"
+#include "absl/strings/str_split.h"
+#include "absl/types/span.h"
+#include "io/prometheus/client/metrics.pb.h"
 
 namespace Envoy {
 namespace Server {
@@ -24,23 +33,38 @@ std::string sanitizeName(const absl::string_view name) {
   // The name must match the regex [a-zA-Z_][a-zA-Z0-9_]* as required by
   // prometheus. Refer to https://prometheus.io/docs/concepts/data_model/.
   // The initial [a-zA-Z_] constraint is always satisfied by the namespace prefix.
+  if (std::all_of(name.begin(), name.end(),
+                  [](char c) { return absl::ascii_isalnum(c) || c == '_'; })) {
+    return std::string(name);
+  }
   return promRegex().replaceAll(name, "_");
 }
 
 /**
  * Take tag values and sanitize it for text serialization, according to
- * Prometheus conventions.
+ * Prometheus conventions, appending the result to out.
  */
-std::string sanitizeValue(const absl::string_view value) {
+void appendSanitizedValue(const absl::string_view value, std::string& out) {
   // Removes problematic characters from Prometheus tag values to prevent
   // text serialization issues. This matches the prometheus text formatting code:
   // https://github.com/prometheus/common/blob/88f1636b699ae4fb949d292ffb904c205bf542c9/expfmt/text_create.go#L419-L420.
   // The goal is to replace '\' with "\\", newline with "\n", and '"' with "\"".
-  return absl::StrReplaceAll(value, {
-                                        {R"(\)", R"(\\)"},
-                                        {"\n", R"(\n)"},
-                                        {R"(")", R"(\")"},
-                                    });
+  for (const char c : value) {
+    switch (c) {
+    case '\\':
+      out.append(R"(\\)");
+      break;
+    case '\n':
+      out.append(R"(\n)");
+      break;
+    case '"':
+      out.append(R"(\")");
+      break;
+    default:
+      out.push_back(c);
+      break;
+    }
+  }
 }
 
 /**
@@ -71,172 +95,382 @@ static bool shouldShowMetric(const StatType& metric, const StatsParams& params)
   return true;
 }
 
-/*
- * Comparator for Stats::Metric that does not require a string representation
- * to make the comparison, for memory efficiency.
+// Prometheus native histograms use exponential buckets: with schema s, bucket i holds the values
+// in (2^((i-1)/2^s), 2^(i/2^s)]. Schema 3 has 8 buckets per power of two, each about 9% wide,
+// which is in line with the precision of the log-linear buckets of circllhist.
+constexpr int32_t NativeHistogramSchema = 3;
+
+// Accumulated text output is moved into the response once it reaches this size, so that
+// families with many metrics don't grow the scratch string without bound.
+constexpr uint64_t TextFlushThreshold = 64 * 1024;
+
+absl::string_view typeName(const Stats::Counter&) { return "counter"; }
+absl::string_view typeName(const Stats::Gauge&) { return "gauge"; }
+// TextReadout stats are returned in gauge format, so "gauge" type is set intentionally.
+absl::string_view typeName(const Stats::TextReadout&) { return "gauge"; }
+absl::string_view typeName(const Stats::ParentHistogram&) { return "histogram"; }
+
+io::prometheus::client::MetricType protoType(const Stats::Counter&) {
+  return io::prometheus::client::COUNTER;
+}
+io::prometheus::client::MetricType protoType(const Stats::Gauge&) {
+  return io::prometheus::client::GAUGE;
+}
+io::prometheus::client::MetricType protoType(const Stats::TextReadout&) {
+  return io::prometheus::client::GAUGE;
+}
+io::prometheus::client::MetricType protoType(const Stats::ParentHistogram&) {
+  return io::prometheus::client::HISTOGRAM;
+}
+
+/**
+ * Populates the native histogram fields of a histogram proto from the detailed buckets of the
+ * histogram. Each detailed bucket is assigned, by its midpoint, to the exponential bucket covering
+ * it. The populated buckets are encoded as spans of consecutive indices, and their counts as
+ * deltas from the previous bucket, as specified by io.prometheus.client.Histogram.
  */
-struct MetricLessThan {
-  bool operator()(const Stats::Metric* a, const Stats::Metric* b) const {
-    ASSERT(&a->constSymbolTable() == &b->constSymbolTable());
-    return a->constSymbolTable().lessThan(a->statName(), b->statName());
+void addNativeBuckets(const Stats::ParentHistogram& histogram,
+                      io::prometheus::client::Histogram& proto) {
+  std::vector<std::pair<int32_t, uint64_t>> buckets;
+  uint64_t zero_count = 0;
+  for (const Stats::ParentHistogram::Bucket& bucket : histogram.detailedTotalBuckets()) {
+    const double value = bucket.lower_bound_ + bucket.width_ / 2;
+    if (value <= 0) {
+      zero_count += bucket.count_;
+      continue;
+    }
+    const int32_t index =
+        static_cast<int32_t>(std::ceil(std::log2(value) * (1 << NativeHistogramSchema)));
+    buckets.emplace_back(index, bucket.count_);
   }
-};
+  std::sort(buckets.begin(), buckets.end());
+
+  proto.set_schema(NativeHistogramSchema);
+  proto.set_zero_threshold(0);
+  proto.set_zero_count(zero_count);
+  io::prometheus::client::BucketSpan* span = nullptr;
+  int32_t next_index = 0;
+  int64_t prev_count = 0;
+  for (size_t i = 0; i < buckets.size();) {
+    const int32_t index = buckets[i].first;
+    uint64_t count = 0;
+    for (; i < buckets.size() && buckets[i].first == index; ++i) {
+      count += buckets[i].second;
+    }
+    if (span == nullptr || index != next_index) {
+      // The offset of the first span is the index of its first bucket, and the offset of the
+      // following spans is the number of empty buckets since the previous span.
+      const int32_t offset = span == nullptr ? index : index - next_index;
+      span = proto.add_positive_span();
+      span->set_offset(offset);
+    }
+    span->set_length(span->length() + 1);
+    proto.add_positive_delta(static_cast<int64_t>(count) - prev_count);
+    prev_count = count;
+    next_index = index + 1;
+  }
+}
+
+} // namespace
 
 /**
- * Processes a stat type (counter, gauge, histogram) by generating all output lines, sorting
- * them by tag-extracted metric name, and then outputting them in the correct sorted order into
- * response.
- *
- * @param response The buffer to put the output into.
- * @param used_only Whether to only output stats that are used.
- * @param regex A filter on which stats to output.
- * @param metrics The metrics to output stats for. This must contain all stats of the given type
- *        to be included in the same output.
- * @param generate_output A function which returns the output text for this metric.
- * @param type The name of the prometheus metric type for used in TYPE annotations.
+ * Renders groups of metrics sharing a tag-extracted name as Prometheus metric families, in either
+ * the text exposition format or as length-delimited io.prometheus.client.MetricFamily protobufs.
+ * The scratch buffers and the protobuf are reused across families to avoid allocating for every
+ * line of output.
  */
-template <class StatType>
-uint64_t outputStatType(
-    Buffer::Instance& response, const StatsParams& params,
-    const std::vector<Stats::RefcountPtr<StatType>>& metrics,
-    const std::function<std::string(
-        const StatType& metric, const std::string& prefixed_tag_extracted_name)>& generate_output,
-    absl::string_view type, const Stats::CustomStatNamespaces& custom_namespaces) {
-
-  /*
-   * From
-   * https:*github.com/prometheus/docs/blob/master/content/docs/instrumenting/exposition_formats.md#grouping-and-sorting:
+class PrometheusFamilyRenderer {
+public:
+  PrometheusFamilyRenderer(const StatsParams& params,
+                           const Stats::CustomStatNamespaces& custom_namespaces)
+      : params_(params), custom_namespaces_(custom_namespaces) {}
+
+  /**
+   * Renders a metric family.
    *
-   * All lines for a given metric must be provided as one single group, with the optional HELP and
-   * TYPE lines first (in no particular order). Beyond that, reproducible sorting in repeated
-   * expositions is preferred but not required, i.e. do not sort if the computational cost is
-   * prohibitive.
+   * @param family the metrics of the family, all sharing the same tag-extracted name.
+   * @param response the buffer to append the rendered family to.
+   * @return false if the family has no valid Prometheus name, in which case nothing is rendered.
    */
+  template <class MetricPtr>
+  bool render(absl::Span<const MetricPtr> family, Buffer::Instance& response) {
+    const Stats::Metric& first = *family.front();
+    const absl::optional<std::string> name = PrometheusStatsFormatter::metricName(
+        first.constSymbolTable().toString(first.tagExtractedStatName()), custom_namespaces_);
+    if (!name.has_value()) {
+      return false;
+    }
 
-  // This is an unsorted collection of dumb-pointers (no need to increment then decrement every
-  // refcount; ownership is held throughout by `metrics`). It is unsorted for efficiency, but will
-  // be sorted before producing the final output to satisfy the "preferred" ordering from the
-  // prometheus spec: metrics will be sorted by their tags' textual representation, which will be
-  // consistent across calls.
-  using StatTypeUnsortedCollection = std::vector<const StatType*>;
+    text_.clear();
+    if (params_.prometheus_protobuf_) {
+      family_.Clear();
+      family_.set_name(name.value());
+      family_.set_type(protoType(*family.front()));
+      for (const MetricPtr& metric : family) {
+        io::prometheus::client::Metric& proto = *family_.add_metric();
+        addLabels(*metric, proto);
+        renderProto(*metric, proto);
+      }
+      {
+        Protobuf::io::StringOutputStream stream(&text_);
+        Protobuf::io::CodedOutputStream coded_stream(&stream);
+        coded_stream.WriteVarint32(static_cast<uint32_t>(family_.ByteSizeLong()));
+        family_.SerializeWithCachedSizes(&coded_stream);
+      }
+    } else {
+      fmt::format_to(std::back_inserter(text_), "# TYPE {0} {1}\n", name.value(),
+                     typeName(*family.front()));
+      for (const MetricPtr& metric : family) {
+        tags_.clear();
+        appendTags(*metric, tags_);
+        renderText(*metric, name.value());
+        if (text_.size() >= TextFlushThreshold) {
+          response.add(text_);
+          text_.clear();
+        }
+      }
+    }
+    response.add(text_);
+    return true;
+  }
 
-  // Return early to avoid crashing when getting the symbol table from the first metric.
-  if (metrics.empty()) {
-    return 0;
+  /**
+   * Drops the cached tag names, which refer to the storage of the metrics they were found in.
+   * This must be called before those metrics are released.
+   */
+  void clearCache() { tag_names_.clear(); }
+
+private:
+  // Returns the sanitized form of a tag name. Tag names are shared by many metrics, so they are
+  // decoded and sanitized once.
+  const std::string& tagName(const Stats::SymbolTable& symbol_table, Stats::StatName tag_name) {
+    auto iter = tag_names_.find(tag_name);
+    if (iter == tag_names_.end()) {
+      iter = tag_names_.emplace(tag_name, sanitizeName(symbol_table.toString(tag_name))).first;
+    }
+    return iter->second;
   }
 
-  // There should only be one symbol table for all of the stats in the admin
-  // interface. If this assumption changes, the name comparisons in this function
-  // will have to change to compare to convert all StatNames to strings before
-  // comparison.
-  const Stats::SymbolTable& global_symbol_table = metrics.front()->constSymbolTable();
+  // Appends the tags of a metric as a comma-separated list of <tag_name>="<tag_value>" pairs.
+  void appendTags(const Stats::Metric& metric, std::string& out) {
+    const Stats::SymbolTable& symbol_table = metric.constSymbolTable();
+    metric.iterateTagStatNames(
+        [this, &symbol_table, &out](Stats::StatName name, Stats::StatName value) -> bool {
+          if (!out.empty()) {
+            out.push_back(',');
+          }
+          absl::StrAppend(&out, tagName(symbol_table, name), "=\"");
+          appendSanitizedValue(symbol_table.toString(value), out);
+          out.push_back('"');
+          return true;
+        });
+  }
 
-  // Sorted collection of metrics sorted by their tagExtractedName, to satisfy the requirements
-  // of the exposition format.
-  std::map<Stats::StatName, StatTypeUnsortedCollection, Stats::StatNameLessThan> groups(
-      global_symbol_table);
+  void addLabels(const Stats::Metric& metric, io::prometheus::client::Metric& proto) {
+    const Stats::SymbolTable& symbol_table = metric.constSymbolTable();
+    metric.iterateTagStatNames(
+        [this, &symbol_table, &proto](Stats::StatName name, Stats::StatName value) -> bool {
+          io::prometheus::client::LabelPair& label = *proto.add_label();
+          label.set_name(tagName(symbol_table, name));
+          label.set_value(symbol_table.toString(value));
+          return true;
+        });
+  }
 
-  for (const auto& metric : metrics) {
-    ASSERT(&global_symbol_table == &metric->constSymbolTable());
-    if (!shouldShowMetric(*metric, params)) {
-      continue;
+  void renderText(const Stats::Counter& counter, absl::string_view name) {
+    fmt::format_to(std::back_inserter(text_), "{0}{{{1}}} {2}\n", name, tags_, counter.value());
+  }
+
+  void renderText(const Stats::Gauge& gauge, absl::string_view name) {
+    fmt::format_to(std::back_inserter(text_), "{0}{{{1}}} {2}\n", name, tags_, gauge.value());
+  }
+
+  // TextReadouts are rendered as gauges, as Prometheus only stores numeric metrics. The gauge is
+  // named after the text readout and always has the value 0. It has all the tags of the text
+  // readout, plus a "text_value" tag holding its value.
+  void renderText(const Stats::TextReadout& text_readout, absl::string_view name) {
+    if (!tags_.empty()) {
+      tags_.push_back(',');
     }
-    groups[metric->tagExtractedStatName()].push_back(metric.get());
+    tags_.append("text_value=\"");
+    appendSanitizedValue(text_readout.value(), tags_);
+    tags_.push_back('"');
+    fmt::format_to(std::back_inserter(text_), "{0}{{{1}}} 0\n", name, tags_);
   }
 
-  auto result = groups.size();
-  for (auto& group : groups) {
-    const absl::optional<std::string> prefixed_tag_extracted_name =
-        PrometheusStatsFormatter::metricName(global_symbol_table.toString(group.first),
-                                             custom_namespaces);
-    if (!prefixed_tag_extracted_name.has_value()) {
-      --result;
-      continue;
+  // Renders the individual bucket counts and sum/count of a histogram.
+  void renderText(const Stats::ParentHistogram& histogram, absl::string_view name) {
+    const absl::string_view separator = tags_.empty() ? absl::string_view() : ",";
+    const Stats::HistogramStatistics& stats = histogram.cumulativeStatistics();
+    Stats::ConstSupportedBuckets& supported_buckets = stats.supportedBuckets();
+    const std::vector<uint64_t>& computed_buckets = stats.computedBuckets();
+    auto out = std::back_inserter(text_);
+    for (size_t i = 0; i < supported_buckets.size(); ++i) {
+      // We want to print the bucket in a fixed point (non-scientific) format. The fmt library
+      // doesn't have a specific modifier to format as a fixed-point value only so we use the
+      // 'g' operator which prints the number in general fixed point format or scientific format
+      // with precision 50 to round the number up to 32 significant digits in fixed point format
+      // which should cover pretty much all cases
+      fmt::format_to(out, "{0}_bucket{{{1}{2}le=\"{3:.32g}\"}} {4}\n", name, tags_, separator,
+                     supported_buckets[i], computed_buckets[i]);
     }
-    response.add(fmt::format("# TYPE {0} {1}\n", prefixed_tag_extracted_name.value(), type));
+    fmt::format_to(out, "{0}_bucket{{{1}{2}le=\"+Inf\"}} {3}\n", name, tags_, separator,
+                   stats.sampleCount());
+    fmt::format_to(out, "{0}_sum{{{1}}} {2:.32g}\n", name, tags_, stats.sampleSum());
+    fmt::format_to(out, "{0}_count{{{1}}} {2}\n", name, tags_, stats.sampleCount());
+  }
 
-    // Sort before producing the final output to satisfy the "preferred" ordering from the
-    // prometheus spec: metrics will be sorted by their tags' textual representation, which will
-    // be consistent across calls.
-    std::sort(group.second.begin(), group.second.end(), MetricLessThan());
+  void renderProto(const Stats::Counter& counter, io::prometheus::client::Metric& proto) {
+    proto.mutable_counter()->set_value(counter.value());
+  }
 
-    for (const auto& metric : group.second) {
-      response.add(generate_output(*metric, prefixed_tag_extracted_name.value()));
+  void renderProto(const Stats::Gauge& gauge, io::prometheus::client::Metric& proto) {
+    proto.mutable_gauge()->set_value(gauge.value());
+  }
+
+  void renderProto(const Stats::TextReadout& text_readout, io::prometheus::client::Metric& proto) {
+    io::prometheus::client::LabelPair& label = *proto.add_label();
+    label.set_name("text_value");
+    label.set_value(text_readout.value());
+    proto.mutable_gauge()->set_value(0);
+  }
+
+  // Histograms carry both the classic buckets and the native buckets, and the scraper picks the
+  // ones it is configured for. The +Inf bucket is implied by the sample count.
+  void renderProto(const Stats::ParentHistogram& histogram,
+                   io::prometheus::client::Metric& proto) {
+    const Stats::HistogramStatistics& stats = histogram.cumulativeStatistics();
+    Stats::ConstSupportedBuckets& supported_buckets = stats.supportedBuckets();
+    const std::vector<uint64_t>& computed_buckets = stats.computedBuckets();
+    io::prometheus::client::Histogram& histogram_proto = *proto.mutable_histogram();
+    histogram_proto.set_sample_count(stats.sampleCount());
+    histogram_proto.set_sample_sum(stats.sampleSum());
+    for (size_t i = 0; i < supported_buckets.size(); ++i) {
+      io::prometheus::client::Bucket& bucket = *histogram_proto.add_bucket();
+      bucket.set_upper_bound(supported_buckets[i]);
+      bucket.set_cumulative_count(computed_buckets[i]);
     }
+    addNativeBuckets(histogram, histogram_proto);
   }
-  return result;
-}
 
-/*
- * Return the prometheus output for a numeric Stat (Counter or Gauge).
+  const StatsParams& params_;
+  const Stats::CustomStatNamespaces& custom_namespaces_;
+  Stats::StatNameHashMap<std::string> tag_names_;
+  // Output accumulated for the family being rendered.
+  std::string text_;
+  // Tags of the metric being rendered.
+  std::string tags_;
+  io::prometheus::client::MetricFamily family_;
+};
+
+namespace {
+
+/**
+ * Sorts metrics by tag-extracted name, so that the metrics of each family are contiguous, and
+ * then by name. Besides satisfying the exposition format, which requires all the lines of a
+ * metric family to be rendered together, this gives a consistent order across scrapes.
  */
-template <class StatType>
-std::string generateNumericOutput(const StatType& metric,
-                                  const std::string& prefixed_tag_extracted_name) {
-  const std::string tags = PrometheusStatsFormatter::formattedTags(metric.tags());
-  return fmt::format("{0}{{{1}}} {2}\n", prefixed_tag_extracted_name, tags, metric.value());
+template <class MetricPtr> void sortByFamily(std::vector<MetricPtr>& metrics) {
+  if (metrics.empty()) {
+    return;
+  }
+  // There should only be one symbol table for all of the stats in the admin interface.
+  const Stats::SymbolTable& symbol_table = metrics.front()->constSymbolTable();
+  std::sort(metrics.begin(), metrics.end(),
+            [&symbol_table](const MetricPtr& a, const MetricPtr& b) -> bool {
+              ASSERT(&a->constSymbolTable() == &symbol_table);
+              const Stats::StatName a_family = a->tagExtractedStatName();
+              const Stats::StatName b_family = b->tagExtractedStatName();
+              if (a_family != b_family) {
+                if (symbol_table.lessThan(a_family, b_family)) {
+                  return true;
+                }
+                if (symbol_table.lessThan(b_family, a_family)) {
+                  return false;
+                }
+              }
+              return symbol_table.lessThan(a->statName(), b->statName());
+            });
 }
 
-/*
- * Returns the prometheus output for a TextReadout in gauge format.
- * It is a workaround of a limitation of prometheus which stores only numeric metrics.
- * The output is a gauge named the same as a given text-readout. The value of returned gauge is
- * always equal to 0. Returned gauge contains all tags of a given text-readout and one additional
- * tag {"text_value":"textReadout.value"}.
+/**
+ * Renders the families of metrics sorted by sortByFamily, starting at the metric at index next,
+ * until all the metrics are rendered or the response holds at least chunk_size bytes.
+ *
+ * @return the index of the first metric left to render.
  */
-std::string generateTextReadoutOutput(const Stats::TextReadout& text_readout,
-                                      const std::string& prefixed_tag_extracted_name) {
-  auto tags = text_readout.tags();
-  tags.push_back(Stats::Tag{"text_value", text_readout.value()});
-  const std::string formattedTags = PrometheusStatsFormatter::formattedTags(tags);
-  return fmt::format("{0}{{{1}}} 0\n", prefixed_tag_extracted_name, formattedTags);
+template <class MetricPtr>
+size_t renderFamilies(PrometheusFamilyRenderer& renderer, const std::vector<MetricPtr>& metrics,
+                      size_t next, uint64_t chunk_size, Buffer::Instance& response,
+                      uint64_t& family_count) {
+  while (next < metrics.size() && response.length() < chunk_size) {
+    const Stats::SymbolTable& symbol_table = metrics[next]->constSymbolTable();
+    const Stats::StatName family_name = metrics[next]->tagExtractedStatName();
+    size_t end = next + 1;
+    // Equal names normally have the same encoding, but a symbolic and a dynamic encoding of the
+    // same name only compare equal by value. As the metrics are sorted, the name can only be
+    // equal or greater.
+    while (end < metrics.size() &&
+           (metrics[end]->tagExtractedStatName() == family_name ||
+            !symbol_table.lessThan(family_name, metrics[end]->tagExtractedStatName()))) {
+      ++end;
+    }
+    if (renderer.render(absl::MakeConstSpan(&metrics[next], end - next), response)) {
+      ++family_count;
+    }
+    next = end;
+  }
+  return next;
 }
 
-/*
- * Returns the prometheus output for a histogram. The output is a multi-line string (with embedded
- * newlines) that contains all the individual bucket counts and sum/count for a single histogram
- * (metric_name plus all tags).
+/**
+ * Renders all the metrics of a stat type that pass the query filters.
  */
-std::string generateHistogramOutput(const Stats::ParentHistogram& histogram,
-                                    const std::string& prefixed_tag_extracted_name) {
-  const std::string tags = PrometheusStatsFormatter::formattedTags(histogram.tags());
-  const std::string hist_tags = histogram.tags().empty() ? EMPTY_STRING : (tags + ",");
-
-  const Stats::HistogramStatistics& stats = histogram.cumulativeStatistics();
-  Stats::ConstSupportedBuckets& supported_buckets = stats.supportedBuckets();
-  const std::vector<uint64_t>& computed_buckets = stats.computedBuckets();
-  std::string output;
-  for (size_t i = 0; i < supported_buckets.size(); ++i) {
-    double bucket = supported_buckets[i];
-    uint64_t value = computed_buckets[i];
-    // We want to print the bucket in a fixed point (non-scientific) format. The fmt library
-    // doesn't have a specific modifier to format as a fixed-point value only so we use the
-    // 'g' operator which prints the number in general fixed point format or scientific format
-    // with precision 50 to round the number up to 32 significant digits in fixed point format
-    // which should cover pretty much all cases
-    output.append(fmt::format("{0}_bucket{{{1}le=\"{2:.32g}\"}} {3}\n", prefixed_tag_extracted_name,
-                              hist_tags, bucket, value));
+template <class StatType>
+void renderStatType(PrometheusFamilyRenderer& renderer,
+                    const std::vector<Stats::RefcountPtr<StatType>>& metrics,
+                    const StatsParams& params, Buffer::Instance& response, uint64_t& family_count) {
+  // Ownership is held throughout by `metrics`, so there is no need to reference count the
+  // pointers to be sorted.
+  std::vector<const StatType*> shown;
+  for (const auto& metric : metrics) {
+    if (shouldShowMetric(*metric, params)) {
+      shown.push_back(metric.get());
+    }
   }
+  sortByFamily(shown);
+  renderFamilies(renderer, shown, 0, std::numeric_limits<uint64_t>::max(), response,
+                 family_count);
+}
 
-  output.append(fmt::format("{0}_bucket{{{1}le=\"+Inf\"}} {2}\n", prefixed_tag_extracted_name,
-                            hist_tags, stats.sampleCount()));
-  output.append(fmt::format("{0}_sum{{{1}}} {2:.32g}\n", prefixed_tag_extracted_name, tags,
-                            stats.sampleSum()));
-  output.append(fmt::format("{0}_count{{{1}}} {2}\n", prefixed_tag_extracted_name, tags,
-                            stats.sampleCount()));
+template <class StatType>
+Stats::SizeFn reserveFn(std::vector<Stats::RefcountPtr<StatType>>& metrics) {
+  return [&metrics](size_t size) { metrics.reserve(size); };
+}
 
-  return output;
-};
+template <class StatType>
+Stats::StatFn<StatType> collectFn(std::vector<Stats::RefcountPtr<StatType>>& metrics,
+                                  const StatsParams& params) {
+  return [&metrics, &params](StatType& metric) {
+    if (shouldShowMetric(metric, params)) {
+      metrics.emplace_back(&metric);
+    }
+  };
+}
 
 } // namespace
 
 std::string PrometheusStatsFormatter::formattedTags(const std::vector<Stats::Tag>& tags) {
-  std::vector<std::string> buf;
-  buf.reserve(tags.size());
+  std::string formatted;
   for (const Stats::Tag& tag : tags) {
-    buf.push_back(fmt::format("{}=\"{}\"", sanitizeName(tag.name_), sanitizeValue(tag.value_)));
+    if (!formatted.empty()) {
+      formatted.push_back(',');
+    }
+    absl::StrAppend(&formatted, sanitizeName(tag.name_), "=\"");
+    appendSanitizedValue(tag.value_, formatted);
+    formatted.push_back('"');
   }
-  return absl::StrJoin(buf, ",");
+  return formatted;
 }
 
 absl::optional<std::string>
@@ -265,29 +499,134 @@ PrometheusStatsFormatter::metricName(const std::string& extracted_name,
   return absl::StrCat("envoy_", sanitizeName(extracted_name));
 }
 
+bool PrometheusStatsFormatter::acceptsProtobuf(absl::string_view accept) {
+  // Prometheus lists the protobuf format first in the Accept header when it can ingest it, e.g.
+  // when native histograms are enabled. Any acceptable media range asking for delimited
+  // MetricFamily messages selects it.
+  for (absl::string_view media_range : absl::StrSplit(accept, ',')) {
+    bool protobuf = false;
+    bool metric_family = false;
+    bool delimited = false;
+    bool rejected = false;
+    for (absl::string_view param : absl::StrSplit(media_range, ';')) {
+      param = absl::StripAsciiWhitespace(param);
+      if (absl::EqualsIgnoreCase(param, "application/vnd.google.protobuf")) {
+        protobuf = true;
+      } else if (param == "proto=io.prometheus.client.MetricFamily") {
+        metric_family = true;
+      } else if (param == "encoding=delimited") {
+        delimited = true;
+      } else if (param == "q=0" || param == "q=0.0") {
+        rejected = true;
+      }
+    }
+    if (protobuf && metric_family && delimited && !rejected) {
+      return true;
+    }
+  }
+  return false;
+}
+
 uint64_t PrometheusStatsFormatter::statsAsPrometheus(
     const std::vector<Stats::CounterSharedPtr>& counters,
     const std::vector<Stats::GaugeSharedPtr>& gauges,
     const std::vector<Stats::ParentHistogramSharedPtr>& histograms,
     const std::vector<Stats::TextReadoutSharedPtr>& text_readouts, Buffer::Instance& response,
     const StatsParams& params, const Stats::CustomStatNamespaces& custom_namespaces) {
-
+  PrometheusFamilyRenderer renderer(params, custom_namespaces);
   uint64_t metric_name_count = 0;
-  metric_name_count += outputStatType<Stats::Counter>(response, params, counters,
-                                                      generateNumericOutput<Stats::Counter>,
-                                                      "counter", custom_namespaces);
+  renderStatType<Stats::Counter>(renderer, counters, params, response, metric_name_count);
+  renderStatType<Stats::Gauge>(renderer, gauges, params, response, metric_name_count);
+  renderStatType<Stats::TextReadout>(renderer, text_readouts, params, response,
+                                     metric_name_count);
+  renderStatType<Stats::ParentHistogram>(renderer, histograms, params, response,
+                                         metric_name_count);
+  return metric_name_count;
+}
+
+PrometheusStatsRequest::PrometheusStatsRequest(Stats::Store& stats, const StatsParams& params,
+                                               const Stats::CustomStatNamespaces& custom_namespaces)
+    : stats_(stats), params_(params),
+      renderer_(std::make_unique<PrometheusFamilyRenderer>(params_, custom_namespaces)) {}
 
-  metric_name_count += outputStatType<Stats::Gauge>(
-      response, params, gauges, generateNumericOutput<Stats::Gauge>, "gauge", custom_namespaces);
+PrometheusStatsRequest::~PrometheusStatsRequest() = default;
 
-  // TextReadout stats are returned in gauge format, so "gauge" type is set intentionally.
-  metric_name_count += outputStatType<Stats::TextReadout>(
-      response, params, text_readouts, generateTextReadoutOutput, "gauge", custom_namespaces);
+Http::Code PrometheusStatsRequest::start(Http::ResponseHeaderMap& response_headers) {
+  if (params_.prometheus_protobuf_) {
+    response_headers.setContentType(PrometheusStatsFormatter::ProtobufContentType);
+  }
+  startPhase();
+  return Http::Code::OK;
+}
 
-  metric_name_count += outputStatType<Stats::ParentHistogram>(
-      response, params, histograms, generateHistogramOutput, "histogram", custom_namespaces);
+bool PrometheusStatsRequest::nextChunk(Buffer::Instance& response) {
+  while (true) {
+    switch (phase_) {
+    case Phase::Counters:
+      if (renderPhase(counters_, response)) {
+        return true;
+      }
+      phase_ = Phase::Gauges;
+      break;
+    case Phase::Gauges:
+      if (renderPhase(gauges_, response)) {
+        return true;
+      }
+      phase_ = params_.prometheus_text_readouts_ ? Phase::TextReadouts : Phase::Histograms;
+      break;
+    case Phase::TextReadouts:
+      if (renderPhase(text_readouts_, response)) {
+        return true;
+      }
+      phase_ = Phase::Histograms;
+      break;
+    case Phase::Histograms:
+      if (renderPhase(histograms_, response)) {
+        return true;
+      }
+      phase_ = Phase::Done;
+      break;
+    case Phase::Done:
+      return false;
+    }
+    startPhase();
+  }
+}
 
-  return metric_name_count;
+void PrometheusStatsRequest::startPhase() {
+  next_ = 0;
+  switch (phase_) {
+  case Phase::Counters:
+    stats_.forEachCounter(reserveFn(counters_), collectFn(counters_, params_));
+    sortByFamily(counters_);
+    break;
+  case Phase::Gauges:
+    stats_.forEachGauge(reserveFn(gauges_), collectFn(gauges_, params_));
+    sortByFamily(gauges_);
+    break;
+  case Phase::TextReadouts:
+    stats_.forEachTextReadout(reserveFn(text_readouts_), collectFn(text_readouts_, params_));
+    sortByFamily(text_readouts_);
+    break;
+  case Phase::Histograms:
+    stats_.forEachHistogram(reserveFn(histograms_), collectFn(histograms_, params_));
+    sortByFamily(histograms_);
+    break;
+  case Phase::Done:
+    break;
+  }
+}
+
+template <class StatType>
+bool PrometheusStatsRequest::renderPhase(MetricVec<StatType>& metrics, Buffer::Instance& response) {
+  next_ = renderFamilies(*renderer_, metrics, next_, chunk_size_, response, family_count_);
+  if (next_ < metrics.size()) {
+    return true;
+  }
+  // Release the rendered metrics, and the memory of the index along with them.
+  renderer_->clearCache();
+  MetricVec<StatType>().swap(metrics);
+  return false;
 }
 
 } // namespace Server
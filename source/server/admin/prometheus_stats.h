@@ -4,9 +4,11 @@
 #include <string>
 
 #include "envoy/buffer/buffer.h"
+#include "envoy/server/admin.h"
 #include "envoy/stats/custom_stat_namespaces.h"
 #include "envoy/stats/histogram.h"
 #include "envoy/stats/stats.h"
+#include "envoy/stats/store.h"
 
 #include "source/server/admin/stats_params.h"
 
@@ -45,6 +47,78 @@ public:
   static absl::optional<std::string>
   metricName(const std::string& extracted_name,
              const Stats::CustomStatNamespaces& custom_namespace_factory);
+
+  /**
+   * @return true if the value of an Accept request header asks for the protobuf exposition format,
+   *         i.e. length-delimited io.prometheus.client.MetricFamily messages.
+   */
+  static bool acceptsProtobuf(absl::string_view accept);
+
+  // Content-Type of responses in the protobuf exposition format.
+  static constexpr absl::string_view ProtobufContentType =
+      "application/vnd.google.protobuf; proto=io.prometheus.client.MetricFamily; "
+      "encoding=delimited";
+};
+
+// Renders groups of metrics sharing a tag-extracted name as Prometheus metric families. Defined in
+// prometheus_stats.cc.
+class PrometheusFamilyRenderer;
+
+/**
+ * Streams the stats of a store in the Prometheus exposition format.
+ *
+ * Prometheus requires all the metrics of a family, i.e. sharing a tag-extracted name, to be
+ * rendered together. Tag extraction can remove any part of a stat name, including the scope
+ * prefixes that StatsRequest walks in order, so metrics of the same family can live in scopes that
+ * are far apart. Rather than building a map of families holding every stat of the store, each
+ * stat type is collected in turn into a flat vector sorted by tag-extracted name, and then
+ * rendered a chunk of families at a time. Only the index of one stat type is held at once, and the
+ * rendered output is bounded by the chunk size.
+ */
+class PrometheusStatsRequest : public Admin::Request {
+public:
+  static constexpr uint64_t DefaultChunkSize = 2 * 1000 * 1000;
+
+  PrometheusStatsRequest(Stats::Store& stats, const StatsParams& params,
+                         const Stats::CustomStatNamespaces& custom_namespaces);
+  ~PrometheusStatsRequest() override;
+
+  // Admin::Request
+  Http::Code start(Http::ResponseHeaderMap& response_headers) override;
+  bool nextChunk(Buffer::Instance& response) override;
+
+  /**
+   * Sets the chunk size, in bytes, after which nextChunk() returns.
+   */
+  void setChunkSize(uint64_t chunk_size) { chunk_size_ = chunk_size; }
+
+  /**
+   * @return the number of metric families rendered so far.
+   */
+  uint64_t familyCount() const { return family_count_; }
+
+private:
+  // Stat types are rendered in the same order as PrometheusStatsFormatter::statsAsPrometheus.
+  enum class Phase { Counters, Gauges, TextReadouts, Histograms, Done };
+
+  template <class StatType> using MetricVec = std::vector<Stats::RefcountPtr<StatType>>;
+
+  void startPhase();
+  template <class StatType>
+  bool renderPhase(MetricVec<StatType>& metrics, Buffer::Instance& response);
+
+  Stats::Store& stats_;
+  const StatsParams params_;
+  std::unique_ptr<PrometheusFamilyRenderer> renderer_;
+  Phase phase_{Phase::Counters};
+  // Index of the next metric to render in the vector of the current phase.
+  size_t next_{0};
+  uint64_t family_count_{0};
+  uint64_t chunk_size_{DefaultChunkSize};
+  MetricVec<Stats::Counter> counters_;
+  MetricVec<Stats::Gauge> gauges_;
+  MetricVec<Stats::TextReadout> text_readouts_;
+  MetricVec<Stats::ParentHistogram> histograms_;
 };
 
 } // namespace Server
@@ -80,16 +80,7 @@ Admin::RequestPtr StatsHandler::makeRequest(AdminStream& admin_stream) {
   }
 
   if (params.format_ == StatsFormat::Prometheus) {
-    // TODO(#16139): modify streaming algorithm to cover Prometheus.
-    //
-    // This may be easiest to accomplish by populating the set
-    // with tagExtractedName(), and allowing for vectors of
-    // stats as multiples will have the same tag-extracted names.
-    // Ideally we'd find a way to do this without slowing down
-    // the non-Prometheus implementations.
-    Buffer::OwnedImpl response;
-    prometheusFlushAndRender(params, response);
-    return Admin::makeStaticTextRequest(response, code);
+    return makePrometheusRequest(params, admin_stream);
   }
 
   if (server_.statsConfig().flushOnAdmin()) {
@@ -112,44 +103,24 @@ Admin::RequestPtr StatsHandler::makeRequest(Stats::Store& stats, const StatsPara
   return std::make_unique<StatsRequest>(stats, params, url_handler_fn);
 }
 
-Http::Code StatsHandler::handlerPrometheusStats(Http::ResponseHeaderMap&,
-                                                Buffer::Instance& response,
-                                                AdminStream& admin_stream) {
-  return prometheusStats(admin_stream.getRequestHeaders().getPathValue(), response);
-}
-
-Http::Code StatsHandler::prometheusStats(absl::string_view path_and_query,
-                                         Buffer::Instance& response) {
-  StatsParams params;
-  Http::Code code = params.parse(path_and_query, response);
-  if (code != Http::Code::OK) {
-    return code;
-  }
+Admin::RequestPtr StatsHandler::makePrometheusRequest(StatsParams& params,
+                                                     AdminStream& admin_stream) {
+  const auto accept = admin_stream.getRequestHeaders().get(Http::CustomHeaders::get().Accept);
+  params.prometheus_protobuf_ =
+      !accept.empty() &&
+      PrometheusStatsFormatter::acceptsProtobuf(accept[0]->value().getStringView());
 
   if (server_.statsConfig().flushOnAdmin()) {
     server_.flushStats();
   }
-
-  prometheusFlushAndRender(params, response);
-  return Http::Code::OK;
+  return makePrometheusRequest(server_.stats(), server_.api().customStatNamespaces(), params);
 }
 
-void StatsHandler::prometheusFlushAndRender(const StatsParams& params, Buffer::Instance& response) {
-  if (server_.statsConfig().flushOnAdmin()) {
-    server_.flushStats();
-  }
-  prometheusRender(server_.stats(), server_.api().customStatNamespaces(), params, response);
-}
-
-void StatsHandler::prometheusRender(Stats::Store& stats,
+Admin::RequestPtr
+StatsHandler::makePrometheusRequest(Stats::Store& stats,
                                     const Stats::CustomStatNamespaces& custom_namespaces,
-                                    const StatsParams& params, Buffer::Instance& response) {
-  const std::vector<Stats::TextReadoutSharedPtr>& text_readouts_vec =
-      params.prometheus_text_readouts_ ? stats.textReadouts()
-                                       : std::vector<Stats::TextReadoutSharedPtr>();
-  PrometheusStatsFormatter::statsAsPrometheus(stats.counters(), stats.gauges(), stats.histograms(),
-                                              text_readouts_vec, response, params,
-                                              custom_namespaces);
+                                    const StatsParams& params) {
+  return std::make_unique<PrometheusStatsRequest>(stats, params, custom_namespaces);
 }
 
 Http::Code StatsHandler::handlerContention(Http::ResponseHeaderMap& response_headers,
@@ -208,5 +179,30 @@ Admin::UrlHandler StatsHandler::statsHandler(bool active_mode) {
       params};
 }
 
+Admin::UrlHandler StatsHandler::prometheusStatsHandler() {
+  return {"/stats/prometheus",
+          "print server stats in prometheus format",
+          [this](AdminStream& admin_stream) -> Admin::RequestPtr {
+            StatsParams params;
+            Buffer::OwnedImpl response;
+            const Http::Code code =
+                params.parse(admin_stream.getRequestHeaders().getPathValue(), response);
+            if (code != Http::Code::OK) {
+              return Admin::makeStaticTextRequest(response, code);
+            }
+            params.format_ = StatsFormat::Prometheus;
+            return makePrometheusRequest(params, admin_stream);
+          },
+          false,
+          false,
+          {{Admin::ParamDescriptor::Type::Boolean, "usedonly",
+            "Only include stats that have been written by system since restart"},
+           {Admin::ParamDescriptor::Type::Boolean, "text_readouts",
+            "Render text_readouts as new gaugues with value 0 (increases Prometheus "
+            "data size)"},
+           {Admin::ParamDescriptor::Type::String, "filter",
+            "Regular expression (Google re2) for filtering stats"}}};
+}
+
 } // namespace Server
 } // namespace Envoy
@@ -8,6 +8,7 @@
 #include "envoy/http/header_map.h"
 #include "envoy/server/admin.h"
 #include "envoy/server/instance.h"
+#include "envoy/stats/custom_stat_namespaces.h"
 
 #include "source/server/admin/handler_ctx.h"
 #include "source/server/admin/stats_request.h"
@@ -33,41 +34,20 @@ public:
                                               Buffer::Instance& response, AdminStream&);
   Http::Code handlerStatsRecentLookupsEnable(Http::ResponseHeaderMap& response_headers,
                                              Buffer::Instance& response, AdminStream&);
-  Http::Code handlerPrometheusStats(Http::ResponseHeaderMap& response_headers,
-                                    Buffer::Instance& response, AdminStream&);
 
   /**
-   * Parses and executes a prometheus stats request.
-   *
-   * @param path_and_query the URL path and query
-   * @param response buffer into which to write response
-   * @return http response code
-   */
-  Http::Code prometheusStats(absl::string_view path_and_query, Buffer::Instance& response);
-
-  /**
-   * Checks the server_ to see if a flush is needed, and then renders the
-   * prometheus stats request.
-   *
-   * @params params the already-parsed parameters.
-   * @param response buffer into which to write response
-   */
-  void prometheusFlushAndRender(const StatsParams& params, Buffer::Instance& response);
-
-  /**
-   * Renders the stats as prometheus. This is broken out as a separately
-   * callable API to facilitate the benchmark
-   * (test/server/admin/stats_handler_speed_test.cc) which does not have a
-   * server object.
+   * Creates a streaming request rendering the stats in the Prometheus exposition format. This is
+   * broken out as a separately callable API to facilitate the benchmark
+   * (test/server/admin/stats_handler_speed_test.cc) which does not have a server object.
    *
    * @params stats the stats store to read
    * @param custom_namespaces namespace mappings used for prometheus
    * @params params the already-parsed parameters.
-   * @param response buffer into which to write response
+   * @return the request.
    */
-  static void prometheusRender(Stats::Store& stats,
-                               const Stats::CustomStatNamespaces& custom_namespaces,
-                               const StatsParams& params, Buffer::Instance& response);
+  static Admin::RequestPtr
+  makePrometheusRequest(Stats::Store& stats, const Stats::CustomStatNamespaces& custom_namespaces,
+                        const StatsParams& params);
 
   Http::Code handlerContention(Http::ResponseHeaderMap& response_headers,
                                Buffer::Instance& response, AdminStream&);
@@ -86,14 +66,21 @@ public:
    */
   Admin::UrlHandler statsHandler(bool active_mode);
 
+  /**
+   * @return a URL handler for /stats/prometheus.
+   */
+  Admin::UrlHandler prometheusStatsHandler();
+
   static Admin::RequestPtr makeRequest(Stats::Store& stats, const StatsParams& params,
                                        StatsRequest::UrlHandlerFn url_handler_fn = nullptr);
   Admin::RequestPtr makeRequest(AdminStream&);
 
 private:
-  static Http::Code prometheusStats(absl::string_view path_and_query, Buffer::Instance& response,
-                                    Stats::Store& stats,
-                                    Stats::CustomStatNamespaces& custom_namespaces);
+  /**
+   * Flushes the stats if needed, and creates a streaming Prometheus request. The exposition
+   * format is negotiated with the Accept header of the request.
+   */
+  Admin::RequestPtr makePrometheusRequest(StatsParams& params, AdminStream& admin_stream);
 };
 
 } // namespace Server
@@ -63,6 +63,9 @@ struct StatsParams {
   StatsType type_{StatsType::All};
   bool used_only_{false};
   bool prometheus_text_readouts_{false};
+  // Set from the Accept request header rather than the query, as Prometheus negotiates the
+  // exposition format.
+  bool prometheus_protobuf_{false};
   bool pretty_{false};
   StatsFormat format_{StatsFormat::Text};
   HiddenFlag hidden_{HiddenFlag::Exclude};
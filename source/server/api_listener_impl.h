@@ -166,6 +166,7 @@ protected:
         IS_ENVOY_BUG("Unexpected function call");
         return false;
       }
+      bool startSplice(Network::Connection&, Network::SpliceCallbacks&) override { return false; }
       absl::optional<std::chrono::milliseconds> lastRoundTripTime() const override { return {}; }
       void configureInitialCongestionWindow(uint64_t, std::chrono::microseconds) override {}
       absl::optional<uint64_t> congestionWindowInBytes() const override { return {}; }
@@ -80,6 +80,11 @@ StatsConfigImpl::StatsConfigImpl(const envoy::config::bootstrap::v3::Bootstrap&
   if (bootstrap.stats_flush_case() == envoy::config::bootstrap::v3::Bootstrap::kStatsFlushOnAdmin) {
     flush_on_admin_ = bootstrap.stats_flush_on_admin();
   }
+
+  if (bootstrap.has_changed_stats_flush()) {
+    full_flush_interval_ = std::chrono::milliseconds(
+        PROTOBUF_GET_MS_OR_DEFAULT(bootstrap.changed_stats_flush(), full_flush_interval, 60000));
+  }
 }
 
 void MainImpl::initialize(const envoy::config::bootstrap::v3::Bootstrap& bootstrap,
@@ -141,6 +141,8 @@ HotRestartImpl::mergeParentStatsIfAny(Stats::StoreRoot& stats_store) {
   return response;
 }
 
+HotRestart::State HotRestartImpl::getParentState() { return as_child_.getParentState(); }
+
 void HotRestartImpl::shutdown() { as_parent_.shutdown(); }
 
 uint32_t HotRestartImpl::baseId() { return base_id_; }
@@ -107,6 +107,7 @@ public:
   absl::optional<AdminShutdownResponse> sendParentAdminShutdownRequest() override;
   void sendParentTerminateRequest() override;
   ServerStatsFromParent mergeParentStatsIfAny(Stats::StoreRoot& stats_store) override;
+  State getParentState() override;
   void shutdown() override;
   uint32_t baseId() override;
   std::string version() override;
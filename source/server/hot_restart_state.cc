@@ -0,0 +1,22 @@
+#include "source/server/hot_restart_state.h"
+
+namespace Envoy {
+namespace Server {
+
+HotRestart::State HotRestartState::exportState() {
+  HotRestart::State state;
+  exporters_.runCallbacks(state);
+  return state;
+}
+
+absl::optional<HotRestart::StateSection>
+HotRestartState::takeParentSection(absl::string_view name) {
+  auto node = parent_state_.extract(name);
+  if (node.empty()) {
+    return absl::nullopt;
+  }
+  return std::move(node.mapped());
+}
+
+} // namespace Server
+} // namespace Envoy
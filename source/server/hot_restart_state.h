@@ -0,0 +1,67 @@
+#pragma once
+
+#include <functional>
+#include <string>
+
+#include "envoy/common/callback.h"
+#include "envoy/server/hot_restart.h"
+
+#include "source/common/common/callback_impl.h"
+#include "source/common/singleton/threadsafe_singleton.h"
+
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Server {
+
+/**
+ * Registry of the state that is handed from a hot restart parent to its child. Components that
+ * keep state worth preserving across a hot restart (e.g. DNS caches) register an exporter that is
+ * run in the parent when the child asks for the state, and take their section of the parent's
+ * state in the child when they are created. Only used on the main thread.
+ */
+class HotRestartState {
+public:
+  using ExportCb = std::function<void(HotRestart::State&)>;
+
+  /**
+   * Register a callback that adds the component's sections to the state exported to the child.
+   * @param cb supplies the callback.
+   * @return a handle whose destruction unregisters the callback.
+   */
+  ABSL_MUST_USE_RESULT Common::CallbackHandlePtr addExporter(ExportCb cb) {
+    return exporters_.add(std::move(cb));
+  }
+
+  /**
+   * @return the state of all registered components, to be sent to the hot restart child.
+   */
+  HotRestart::State exportState();
+
+  /**
+   * Set the state received from the hot restart parent.
+   */
+  void setParentState(HotRestart::State&& state) { parent_state_ = std::move(state); }
+
+  /**
+   * Remove a section from the state received from the hot restart parent. Each section is only
+   * handed out once, so that a component created again later does not load stale state.
+   * @param name supplies the name of the section.
+   * @return the section, or absl::nullopt if the parent did not export it.
+   */
+  absl::optional<HotRestart::StateSection> takeParentSection(absl::string_view name);
+
+private:
+  Common::CallbackManager<HotRestart::State&> exporters_;
+  HotRestart::State parent_state_;
+};
+
+/**
+ * Present in servers that can be hot restarted; HotRestartStateSingleton::getExisting() returns
+ * nullptr otherwise.
+ */
+using HotRestartStateSingleton = InjectableSingleton<HotRestartState>;
+
+} // namespace Server
+} // namespace Envoy
@@ -102,6 +102,31 @@ void HotRestartingChild::sendParentTerminateRequest() {
   stat_merger_.reset();
 }
 
+HotRestart::State HotRestartingChild::getParentState() {
+  HotRestart::State state;
+  if (restart_epoch_ == 0 || parent_terminated_) {
+    return state;
+  }
+
+  HotRestartMessage wrapped_request;
+  wrapped_request.mutable_request()->mutable_state();
+  sendHotRestartMessage(parent_address_, wrapped_request);
+
+  std::unique_ptr<HotRestartMessage> wrapped_reply = receiveHotRestartMessage(Blocking::Yes);
+  // A parent running an older version replies that it didn't recognize the request; start cold.
+  if (!replyIsExpectedType(wrapped_reply.get(), HotRestartMessage::Reply::kState)) {
+    ENVOY_LOG(warn, "hot restart parent did not return its state; starting without it.");
+    return state;
+  }
+  for (const auto& [name, section_proto] : wrapped_reply->reply().state().sections()) {
+    HotRestart::StateSection& section = state[name];
+    for (const auto& [key, value] : section_proto.entries()) {
+      section.emplace(key, value);
+    }
+  }
+  return state;
+}
+
 void HotRestartingChild::mergeParentStats(Stats::Store& stats_store,
                                           const HotRestartMessage::Reply::Stats& stats_proto) {
   if (!stat_merger_) {
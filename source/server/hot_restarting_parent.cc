@@ -7,6 +7,7 @@
 #include "source/common/stats/stat_merger.h"
 #include "source/common/stats/symbol_table.h"
 #include "source/common/stats/utility.h"
+#include "source/server/hot_restart_state.h"
 
 namespace Envoy {
 namespace Server {
@@ -60,6 +61,13 @@ void HotRestartingParent::onSocketEvent() {
       break;
     }
 
+    case HotRestartMessage::Request::kState: {
+      HotRestartMessage wrapped_reply;
+      internal_->exportStateToChild(wrapped_reply.mutable_reply()->mutable_state());
+      sendHotRestartMessage(child_address_, wrapped_reply);
+      break;
+    }
+
     case HotRestartMessage::Request::kDrainListeners: {
       internal_->drainListeners();
       break;
@@ -186,5 +194,18 @@ void HotRestartingParent::Internal::recordDynamics(HotRestartMessage::Reply::Sta
 
 void HotRestartingParent::Internal::drainListeners() { server_->drainListeners(); }
 
+void HotRestartingParent::Internal::exportStateToChild(HotRestartMessage::Reply::State* state) {
+  HotRestartState* hot_restart_state = HotRestartStateSingleton::getExisting();
+  if (hot_restart_state == nullptr) {
+    return;
+  }
+  for (auto& [name, section] : hot_restart_state->exportState()) {
+    auto* entries = (*state->mutable_sections())[name].mutable_entries();
+    for (auto& [key, value] : section) {
+      (*entries)[key] = std::move(value);
+    }
+  }
+}
+
 } // namespace Server
 } // namespace Envoy
@@ -33,6 +33,8 @@ public:
     void recordDynamics(envoy::HotRestartMessage::Reply::Stats* stats, const std::string& name,
                         Stats::StatName stat_name);
     void drainListeners();
+    // 'state' is a field in the reply protobuf to be sent to the child, which we should populate.
+    void exportStateToChild(envoy::HotRestartMessage::Reply::State* state);
 
   private:
     Server::Instance* const server_{};
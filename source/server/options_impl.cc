@@ -160,6 +160,13 @@ OptionsImpl::OptionsImpl(std::vector<std::string> args,
       "set multiple universal tags. Multiple values for the same tag name are not allowed.",
       false, "string", cmd);
 
+  TCLAP::SwitchArg stats_compact_storage(
+      "", "stats-compact-storage",
+      "Store counters and gauges in fixed-size slab records with inline names", cmd, false);
+  TCLAP::SwitchArg disable_stats_scope_tls_caches(
+      "", "disable-stats-scope-tls-caches",
+      "Disable the per-worker stat caches kept by each stats scope", cmd, false);
+
   cmd.setExceptionHandling(false);
 
   std::function failure_function = [&](TCLAP::ArgException& e) {
@@ -183,6 +190,8 @@ OptionsImpl::OptionsImpl(std::vector<std::string> args,
   hot_restart_disabled_ = disable_hot_restart.getValue();
   mutex_tracing_enabled_ = enable_mutex_tracing.getValue();
   core_dump_enabled_ = enable_core_dump.getValue();
+  stats_compact_storage_ = stats_compact_storage.getValue();
+  stats_scope_tls_caches_disabled_ = disable_stats_scope_tls_caches.getValue();
 
   cpuset_threads_ = cpuset_threads.getValue();
 
@@ -436,6 +445,8 @@ Server::CommandLineOptionsPtr OptionsImpl::toCommandLineOptions() const {
   for (const auto& tag : statsTags()) {
     command_line_options->add_stats_tag(fmt::format("{}:{}", tag.name_, tag.value_));
   }
+  command_line_options->set_stats_compact_storage(statsCompactStorageEnabled());
+  command_line_options->set_disable_stats_scope_tls_caches(statsScopeTlsCachesDisabled());
   return command_line_options;
 }
 
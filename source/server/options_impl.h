@@ -116,6 +116,14 @@ public:
 
   void setStatsTags(const Stats::TagVector& stats_tags) { stats_tags_ = stats_tags; }
 
+  void setStatsCompactStorage(bool stats_compact_storage) {
+    stats_compact_storage_ = stats_compact_storage;
+  }
+
+  void setStatsScopeTlsCachesDisabled(bool stats_scope_tls_caches_disabled) {
+    stats_scope_tls_caches_disabled_ = stats_scope_tls_caches_disabled;
+  }
+
   // Server::Options
   uint64_t baseId() const override { return base_id_; }
   bool useDynamicBaseId() const override { return use_dynamic_base_id_; }
@@ -160,6 +168,8 @@ public:
   bool mutexTracingEnabled() const override { return mutex_tracing_enabled_; }
   bool coreDumpEnabled() const override { return core_dump_enabled_; }
   const Stats::TagVector& statsTags() const override { return stats_tags_; }
+  bool statsCompactStorageEnabled() const override { return stats_compact_storage_; }
+  bool statsScopeTlsCachesDisabled() const override { return stats_scope_tls_caches_disabled_; }
   Server::CommandLineOptionsPtr toCommandLineOptions() const override;
   void parseComponentLogLevels(const std::string& component_log_levels);
   bool cpusetThreadsEnabled() const override { return cpuset_threads_; }
@@ -224,6 +234,8 @@ private:
   bool cpuset_threads_{false};
   std::vector<std::string> disabled_extensions_;
   Stats::TagVector stats_tags_;
+  bool stats_compact_storage_{false};
+  bool stats_scope_tls_caches_disabled_{false};
   uint32_t count_{0};
 
   // Initialization added here to avoid integration_admin_test failure caused by uninitialized
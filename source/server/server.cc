@@ -1,5 +1,6 @@
 #include "source/server/server.h"
 
+#include <algorithm>
 #include <csignal>
 #include <cstdint>
 #include <ctime>
@@ -195,60 +196,123 @@ void InstanceImpl::failHealthcheck(bool fail) {
   server_stats_->live_.set(live_.load());
 }
 
-MetricSnapshotImpl::MetricSnapshotImpl(Stats::Store& store, TimeSource& time_source) {
+MetricSnapshotImpl::MetricSnapshotImpl(Stats::Store& store, TimeSource& time_source,
+                                       StatsFlushMode mode, bool all_metrics) {
+  ASSERT(all_metrics || mode == StatsFlushMode::ChangedOnly);
+  const bool latch_changes = mode != StatsFlushMode::Full;
+  const bool collect_changes = mode == StatsFlushMode::ChangedOnly;
+
   store.forEachSinkedCounter(
-      [this](std::size_t size) {
-        snapped_counters_.reserve(size);
-        counters_.reserve(size);
+      [this, all_metrics](std::size_t size) {
+        if (all_metrics) {
+          snapped_counters_.reserve(size);
+          counters_.reserve(size);
+        }
       },
-      [this](Stats::Counter& counter) {
-        snapped_counters_.push_back(Stats::CounterSharedPtr(&counter));
-        counters_.push_back({counter.latch(), counter});
+      [this, all_metrics, collect_changes](Stats::Counter& counter) {
+        // Counters are latched whether or not they are collected, as the hot restart code relies on
+        // it. See InstanceUtil::flushMetricsToSinks.
+        const uint64_t delta = counter.latch();
+        const bool changed = collect_changes && delta > 0;
+        if (all_metrics || changed) {
+          snapped_counters_.push_back(Stats::CounterSharedPtr(&counter));
+        }
+        if (all_metrics) {
+          counters_.push_back({delta, counter});
+        }
+        if (changed) {
+          changed_.counters_.push_back({delta, counter});
+        }
       });
 
   store.forEachSinkedGauge(
-      [this](std::size_t size) {
-        snapped_gauges_.reserve(size);
-        gauges_.reserve(size);
+      [this, all_metrics](std::size_t size) {
+        if (all_metrics) {
+          snapped_gauges_.reserve(size);
+          gauges_.reserve(size);
+        }
       },
-      [this](Stats::Gauge& gauge) {
+      [this, all_metrics, latch_changes, collect_changes](Stats::Gauge& gauge) {
         ASSERT(gauge.importMode() != Stats::Gauge::ImportMode::Uninitialized);
-        snapped_gauges_.push_back(Stats::GaugeSharedPtr(&gauge));
-        gauges_.push_back(gauge);
+        const bool changed = latch_changes && gauge.latchChanged() && collect_changes;
+        if (all_metrics || changed) {
+          snapped_gauges_.push_back(Stats::GaugeSharedPtr(&gauge));
+        }
+        if (all_metrics) {
+          gauges_.push_back(gauge);
+        }
+        if (changed) {
+          changed_.gauges_.push_back(gauge);
+        }
       });
 
   store.forEachSinkedHistogram(
-      [this](std::size_t size) {
-        snapped_histograms_.reserve(size);
-        histograms_.reserve(size);
+      [this, all_metrics](std::size_t size) {
+        if (all_metrics) {
+          snapped_histograms_.reserve(size);
+          histograms_.reserve(size);
+        }
       },
-      [this](Stats::ParentHistogram& histogram) {
-        snapped_histograms_.push_back(Stats::ParentHistogramSharedPtr(&histogram));
-        histograms_.push_back(histogram);
+      [this, all_metrics, collect_changes](Stats::ParentHistogram& histogram) {
+        // Histograms are merged right before each flush, so the interval statistics hold the
+        // samples recorded since the previous flush.
+        const bool changed =
+            collect_changes && histogram.intervalStatistics().sampleCount() > 0;
+        if (all_metrics || changed) {
+          snapped_histograms_.push_back(Stats::ParentHistogramSharedPtr(&histogram));
+        }
+        if (all_metrics) {
+          histograms_.push_back(histogram);
+        }
+        if (changed) {
+          changed_.histograms_.push_back(histogram);
+        }
       });
 
   store.forEachSinkedTextReadout(
-      [this](std::size_t size) {
-        snapped_text_readouts_.reserve(size);
-        text_readouts_.reserve(size);
+      [this, all_metrics](std::size_t size) {
+        if (all_metrics) {
+          snapped_text_readouts_.reserve(size);
+          text_readouts_.reserve(size);
+        }
       },
-      [this](Stats::TextReadout& text_readout) {
-        snapped_text_readouts_.push_back(Stats::TextReadoutSharedPtr(&text_readout));
-        text_readouts_.push_back(text_readout);
+      [this, all_metrics, latch_changes, collect_changes](Stats::TextReadout& text_readout) {
+        const bool changed = latch_changes && text_readout.latchChanged() && collect_changes;
+        if (all_metrics || changed) {
+          snapped_text_readouts_.push_back(Stats::TextReadoutSharedPtr(&text_readout));
+        }
+        if (all_metrics) {
+          text_readouts_.push_back(text_readout);
+        }
+        if (changed) {
+          changed_.text_readouts_.push_back(text_readout);
+        }
       });
 
   snapshot_time_ = time_source.systemTime();
 }
 
 void InstanceUtil::flushMetricsToSinks(const std::list<Stats::SinkPtr>& sinks, Stats::Store& store,
-                                       TimeSource& time_source) {
+                                       TimeSource& time_source, StatsFlushMode mode) {
+  const bool changed_only = mode == StatsFlushMode::ChangedOnly;
+  // Only collect all metrics if a sink needs them, which avoids touching the reference counts of
+  // the metrics that didn't change.
+  const bool all_metrics =
+      !changed_only || std::any_of(sinks.begin(), sinks.end(), [](const Stats::SinkPtr& sink) {
+        return !sink->supportsChangedMetricsOnly();
+      });
+
   // Create a snapshot and flush to all sinks.
   // NOTE: Even if there are no sinks, creating the snapshot has the important property that it
   //       latches all counters on a periodic basis. The hot restart code assumes this is being
   //       done so this should not be removed.
-  MetricSnapshotImpl snapshot(store, time_source);
+  MetricSnapshotImpl snapshot(store, time_source, mode, all_metrics);
   for (const auto& sink : sinks) {
-    sink->flush(snapshot);
+    if (changed_only && sink->supportsChangedMetricsOnly()) {
+      sink->flush(snapshot.changedMetrics());
+    } else {
+      sink->flush(snapshot);
+    }
   }
 }
 
@@ -305,7 +369,18 @@ void InstanceImpl::updateServerStats() {
 void InstanceImpl::flushStatsInternal() {
   updateServerStats();
   auto& stats_config = config_.statsConfig();
-  InstanceUtil::flushMetricsToSinks(stats_config.sinks(), stats_store_, timeSource());
+  StatsFlushMode mode = StatsFlushMode::Full;
+  if (const auto full_flush_interval = stats_config.fullFlushInterval();
+      full_flush_interval.has_value()) {
+    const MonotonicTime now = timeSource().monotonicTime();
+    if (now >= next_full_stats_flush_) {
+      mode = StatsFlushMode::FullResync;
+      next_full_stats_flush_ = now + full_flush_interval.value();
+    } else {
+      mode = StatsFlushMode::ChangedOnly;
+    }
+  }
+  InstanceUtil::flushMetricsToSinks(stats_config.sinks(), stats_store_, timeSource(), mode);
   // TODO(ramaraochavali): consider adding different flush interval for histograms.
   if (stat_flush_timer_ != nullptr) {
     stat_flush_timer_->enableTimer(stats_config.flushInterval());
@@ -479,6 +554,13 @@ void InstanceImpl::initialize(Network::Address::InstanceConstSharedPtr local_add
   regex_engine_ = createRegexEngine(
       bootstrap_, messageValidationContext().staticValidationVisitor(), serverFactoryContext());
 
+  // Create the xDS decode pool before any xDS subscription is started.
+  if (PROTOBUF_GET_WRAPPED_OR_DEFAULT(bootstrap_, xds_decode_threads, 0) > 0) {
+    xds_decode_pool_ = std::make_unique<ScopedInjectableLoader<Config::ResourceDecodePool>>(
+        std::make_unique<Config::ResourceDecodePool>(api_->threadFactory(),
+                                                     bootstrap_.xds_decode_threads().value()));
+  }
+
   // Needs to happen as early as possible in the instantiation to preempt the objects that require
   // stats.
   stats_store_.setTagProducer(Config::Utility::createTagProducer(bootstrap_, options_.statsTags()));
@@ -576,6 +658,13 @@ void InstanceImpl::initialize(Network::Address::InstanceConstSharedPtr local_add
         parent_admin_shutdown_response.value().enable_reuse_port_default_ ? true : false;
   }
 
+  // Take over the state exported by our parent before any component that may load it is created.
+  if (!options_.hotRestartDisabled()) {
+    hot_restart_state_ = std::make_unique<ScopedInjectableLoader<HotRestartState>>(
+        std::make_unique<HotRestartState>());
+    hot_restart_state_->instance().setParentState(restarter_.getParentState());
+  }
+
   OptRef<Server::ConfigTracker> config_tracker;
 #ifdef ENVOY_ADMIN_FUNCTIONALITY
   admin_ = std::make_unique<AdminImpl>(initial_config.admin().profilePath(), *this,
@@ -28,6 +28,7 @@
 #include "source/common/common/cleanup.h"
 #include "source/common/common/logger_delegates.h"
 #include "source/common/common/perf_tracing.h"
+#include "source/common/config/resource_decode_pool.h"
 #include "source/common/grpc/async_client_manager_impl.h"
 #include "source/common/grpc/context_impl.h"
 #include "source/common/http/context_impl.h"
@@ -44,6 +45,7 @@
 #include "source/server/admin/admin.h"
 #endif
 #include "source/server/configuration_impl.h"
+#include "source/server/hot_restart_state.h"
 #include "source/server/listener_hooks.h"
 #include "source/server/overload_manager_impl.h"
 #include "source/server/worker_impl.h"
@@ -115,6 +117,19 @@ public:
   virtual Runtime::LoaderPtr createRuntime(Instance& server, Configuration::Initial& config) PURE;
 };
 
+/**
+ * Which metrics a stats flush hands to the sinks.
+ */
+enum class StatsFlushMode {
+  // Every sink is flushed all metrics, and changes are not tracked.
+  Full,
+  // Every sink is flushed all metrics, and the changed state of the metrics is cleared so that the
+  // next flush only sees the metrics that changed after this one.
+  FullResync,
+  // Sinks that support it are only flushed the metrics that changed since the previous flush.
+  ChangedOnly,
+};
+
 /**
  * Helpers used during server creation.
  */
@@ -131,9 +146,11 @@ public:
    * flush() on each sink.
    * @param sinks supplies the list of sinks.
    * @param store provides the store being flushed.
+   * @param mode supplies which metrics are flushed to the sinks.
    */
   static void flushMetricsToSinks(const std::list<Stats::SinkPtr>& sinks, Stats::Store& store,
-                                  TimeSource& time_source);
+                                  TimeSource& time_source,
+                                  StatsFlushMode mode = StatsFlushMode::Full);
 
   /**
    * Load a bootstrap config and perform validation.
@@ -375,6 +392,8 @@ private:
   Configuration::MainImpl config_;
   Network::DnsResolverSharedPtr dns_resolver_;
   Event::TimerPtr stat_flush_timer_;
+  // When changed-only stats flushes are enabled, the time at which the next full flush is due.
+  MonotonicTime next_full_stats_flush_{};
   DrainManagerPtr drain_manager_;
   std::unique_ptr<Upstream::ClusterManagerFactory> cluster_manager_factory_;
   std::unique_ptr<Server::GuardDog> main_thread_guard_dog_;
@@ -402,6 +421,8 @@ private:
   ServerFactoryContextImpl server_contexts_;
   bool enable_reuse_port_default_;
   Regex::EnginePtr regex_engine_;
+  std::unique_ptr<ScopedInjectableLoader<Config::ResourceDecodePool>> xds_decode_pool_;
+  std::unique_ptr<ScopedInjectableLoader<HotRestartState>> hot_restart_state_;
 
   bool stats_flush_in_progress_ : 1;
 
@@ -427,7 +448,16 @@ private:
 //                     copying and probably be a cleaner API in general.
 class MetricSnapshotImpl : public Stats::MetricSnapshot {
 public:
-  explicit MetricSnapshotImpl(Stats::Store& store, TimeSource& time_source);
+  /**
+   * @param store provides the store being snapshotted. Counters are always latched.
+   * @param time_source supplies the time of the snapshot.
+   * @param mode supplies whether the changed state of the metrics is latched, and whether the
+   *        metrics that changed are collected into changedMetrics().
+   * @param all_metrics supplies whether all metrics are collected into this snapshot. If false,
+   *        only changedMetrics() is populated. Only ChangedOnly snapshots may omit them.
+   */
+  explicit MetricSnapshotImpl(Stats::Store& store, TimeSource& time_source,
+                              StatsFlushMode mode = StatsFlushMode::Full, bool all_metrics = true);
 
   // Stats::MetricSnapshot
   const std::vector<CounterSnapshot>& counters() override { return counters_; }
@@ -442,7 +472,43 @@ public:
   }
   SystemTime snapshotTime() const override { return snapshot_time_; }
 
+  /**
+   * @return a snapshot of the metrics that changed since the previous flush. Only populated for
+   *         StatsFlushMode::ChangedOnly snapshots.
+   */
+  Stats::MetricSnapshot& changedMetrics() { return changed_; }
+
 private:
+  // The metrics of a snapshot that changed since the previous flush. The metrics are kept alive by
+  // the snapped_* vectors of the parent snapshot.
+  class ChangedMetricSnapshot : public Stats::MetricSnapshot {
+  public:
+    explicit ChangedMetricSnapshot(const MetricSnapshotImpl& parent) : parent_(parent) {}
+
+    // Stats::MetricSnapshot
+    const std::vector<CounterSnapshot>& counters() override { return counters_; }
+    const std::vector<std::reference_wrapper<const Stats::Gauge>>& gauges() override {
+      return gauges_;
+    }
+    const std::vector<std::reference_wrapper<const Stats::ParentHistogram>>&
+    histograms() override {
+      return histograms_;
+    }
+    const std::vector<std::reference_wrapper<const Stats::TextReadout>>& textReadouts() override {
+      return text_readouts_;
+    }
+    SystemTime snapshotTime() const override { return parent_.snapshot_time_; }
+
+  private:
+    friend class MetricSnapshotImpl;
+
+    const MetricSnapshotImpl& parent_;
+    std::vector<CounterSnapshot> counters_;
+    std::vector<std::reference_wrapper<const Stats::Gauge>> gauges_;
+    std::vector<std::reference_wrapper<const Stats::ParentHistogram>> histograms_;
+    std::vector<std::reference_wrapper<const Stats::TextReadout>> text_readouts_;
+  };
+
   std::vector<Stats::CounterSharedPtr> snapped_counters_;
   std::vector<CounterSnapshot> counters_;
   std::vector<Stats::GaugeSharedPtr> snapped_gauges_;
@@ -451,6 +517,7 @@ private:
   std::vector<std::reference_wrapper<const Stats::ParentHistogram>> histograms_;
   std::vector<Stats::TextReadoutSharedPtr> snapped_text_readouts_;
   std::vector<std::reference_wrapper<const Stats::TextReadout>> text_readouts_;
+  ChangedMetricSnapshot changed_{*this};
   SystemTime snapshot_time_;
 };
 
@@ -1,4 +1,6 @@
+#include <atomic>
 #include <memory>
+#include <vector>
 
 #include "source/common/access_log/access_log_manager_impl.h"
 #include "source/common/filesystem/file_shared_impl.h"
@@ -8,9 +10,11 @@
 #include "test/mocks/api/mocks.h"
 #include "test/mocks/event/mocks.h"
 #include "test/mocks/filesystem/mocks.h"
+#include "test/test_common/test_runtime.h"
 #include "test/test_common/test_time.h"
 #include "test/test_common/utility.h"
 
+#include "absl/synchronization/notification.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
@@ -419,6 +423,247 @@ TEST_F(AccessLogManagerImplTest, BigDataChunkShouldBeFlushedWithoutTimer) {
   EXPECT_CALL(*file_, close_()).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
 }
 
+// Test that writes from many threads to per-thread buffers are all flushed.
+TEST_F(AccessLogManagerImplTest, ShardedWritesFromMultipleThreads) {
+  TestScopedRuntime scoped_runtime;
+  scoped_runtime.mergeValues({{"envoy.reloadable_features.sharded_access_log_writes", "true"}});
+  EXPECT_CALL(*file_, open_(_)).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  AccessLogFileSharedPtr log_file = access_log_manager_.createAccessLog(
+      Filesystem::FilePathAndType{Filesystem::DestinationType::File, "foo"});
+
+  std::atomic<uint64_t> bytes_written{0};
+  EXPECT_CALL(*file_, write_(_))
+      .WillRepeatedly(Invoke([&](absl::string_view data) -> Api::IoCallSizeResult {
+        bytes_written += data.length();
+        return Filesystem::resultSuccess<ssize_t>(static_cast<ssize_t>(data.length()));
+      }));
+
+  const std::string entry = "0123456789";
+  const uint32_t num_threads = 8;
+  const uint32_t writes_per_thread = 1000;
+  std::vector<Thread::ThreadPtr> threads;
+  for (uint32_t i = 0; i < num_threads; ++i) {
+    threads.push_back(thread_factory_.createThread([&]() {
+      for (uint32_t j = 0; j < writes_per_thread; ++j) {
+        log_file->write(entry);
+      }
+    }));
+  }
+  for (Thread::ThreadPtr& thread : threads) {
+    thread->join();
+  }
+
+  log_file->flush();
+  EXPECT_EQ(num_threads * writes_per_thread * entry.size(), bytes_written);
+  EXPECT_EQ(num_threads * writes_per_thread, store_.counter("filesystem.write_buffered").value());
+  // The buffers of the threads are written together rather than one write call each.
+  EXPECT_LT(file_->num_writevs_, file_->num_writes_);
+  EXPECT_EQ(0UL, store_.counter("filesystem.write_dropped").value());
+  waitForGaugeEq("filesystem.write_total_buffered", 0);
+
+  EXPECT_CALL(*file_, close_()).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+}
+
+// Test that writes to per-thread buffers are dropped rather than buffered without bound when the
+// flush thread can't keep up.
+TEST_F(AccessLogManagerImplTest, ShardedWritesDroppedWhenFlushIsStalled) {
+  TestScopedRuntime scoped_runtime;
+  scoped_runtime.mergeValues({{"envoy.reloadable_features.sharded_access_log_writes", "true"}});
+  EXPECT_CALL(*file_, open_(_)).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  AccessLogFileSharedPtr log_file = access_log_manager_.createAccessLog(
+      Filesystem::FilePathAndType{Filesystem::DestinationType::File, "foo"});
+
+  // Stall the flush thread while it writes the first entry.
+  absl::Notification write_started;
+  absl::Notification unblock_write;
+  EXPECT_CALL(*file_, write_(_))
+      .WillOnce(Invoke([&](absl::string_view data) -> Api::IoCallSizeResult {
+        EXPECT_EQ("stall", data);
+        write_started.Notify();
+        unblock_write.WaitForNotification();
+        return Filesystem::resultSuccess<ssize_t>(static_cast<ssize_t>(data.length()));
+      }))
+      .WillRepeatedly(Invoke([](absl::string_view data) -> Api::IoCallSizeResult {
+        return Filesystem::resultSuccess<ssize_t>(static_cast<ssize_t>(data.length()));
+      }));
+  log_file->write("stall");
+  write_started.WaitForNotification();
+
+  // Fill up the buffer of this thread, which holds up to 16MiB.
+  const std::string chunk(1024 * 1024, 'a');
+  for (uint32_t i = 0; i < 16; ++i) {
+    log_file->write(chunk);
+  }
+  EXPECT_EQ(0UL, store_.counter("filesystem.write_dropped").value());
+
+  log_file->write(chunk);
+  log_file->write("b");
+  EXPECT_EQ(2UL, store_.counter("filesystem.write_dropped").value());
+  EXPECT_EQ(17UL, store_.counter("filesystem.write_buffered").value());
+
+  unblock_write.Notify();
+  log_file->flush();
+  waitForGaugeEq("filesystem.write_total_buffered", 0);
+  EXPECT_EQ(0UL, store_.counter("filesystem.write_failed").value());
+
+  EXPECT_CALL(*file_, close_()).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+}
+
+// Test that the files of a manager are flushed by a single thread with per-thread buffers, and that
+// a reopen is performed by that thread.
+TEST_F(AccessLogManagerImplTest, ShardedWritesShareOneFlushThread) {
+  TestScopedRuntime scoped_runtime;
+  scoped_runtime.mergeValues({{"envoy.reloadable_features.sharded_access_log_writes", "true"}});
+
+  // Counts the threads created, and creates them with the thread factory of the test.
+  class CountingThreadFactory : public Thread::ThreadFactory {
+  public:
+    explicit CountingThreadFactory(Thread::ThreadFactory& parent) : parent_(parent) {}
+
+    Thread::ThreadPtr createThread(std::function<void()> thread_routine,
+                                   Thread::OptionsOptConstRef options) override {
+      ++threads_created_;
+      return parent_.createThread(std::move(thread_routine), options);
+    }
+    Thread::ThreadId currentThreadId() override { return parent_.currentThreadId(); }
+
+    Thread::ThreadFactory& parent_;
+    std::atomic<uint32_t> threads_created_{0};
+  };
+  CountingThreadFactory thread_factory(thread_factory_);
+  EXPECT_CALL(api_, threadFactory()).WillRepeatedly(ReturnRef(thread_factory));
+
+  NiceMock<Filesystem::MockFile>* other_file = new NiceMock<Filesystem::MockFile>;
+  EXPECT_CALL(*other_file, path()).WillRepeatedly(Return("bar"));
+  EXPECT_CALL(file_system_, createFile(testing::Matcher<const Envoy::Filesystem::FilePathAndType&>(
+                                Filesystem::FilePathAndType{Filesystem::DestinationType::File,
+                                                            "bar"})))
+      .WillOnce(Return(ByMove(std::unique_ptr<NiceMock<Filesystem::MockFile>>(other_file))));
+  EXPECT_CALL(*file_, open_(_)).WillRepeatedly(Invoke([](Filesystem::FlagSet) {
+    return Filesystem::resultSuccess<bool>(true);
+  }));
+  EXPECT_CALL(*other_file, open_(_))
+      .WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  EXPECT_CALL(*file_, close_()).WillRepeatedly(Invoke([]() -> Api::IoCallBoolResult {
+    return Filesystem::resultSuccess<bool>(true);
+  }));
+  AccessLogFileSharedPtr log_file = access_log_manager_.createAccessLog(
+      Filesystem::FilePathAndType{Filesystem::DestinationType::File, "foo"});
+  AccessLogFileSharedPtr other_log_file = access_log_manager_.createAccessLog(
+      Filesystem::FilePathAndType{Filesystem::DestinationType::File, "bar"});
+
+  EXPECT_CALL(*file_, write_(_))
+      .WillRepeatedly(Invoke([](absl::string_view data) -> Api::IoCallSizeResult {
+        return Filesystem::resultSuccess<ssize_t>(static_cast<ssize_t>(data.length()));
+      }));
+  EXPECT_CALL(*other_file, write_(_))
+      .WillOnce(Invoke([](absl::string_view data) -> Api::IoCallSizeResult {
+        EXPECT_EQ("other", data);
+        return Filesystem::resultSuccess<ssize_t>(static_cast<ssize_t>(data.length()));
+      }));
+  log_file->write("foo");
+  other_log_file->write("other");
+  EXPECT_TRUE(file_->waitForEventCount(file_->num_writes_, 1));
+  EXPECT_TRUE(other_file->waitForEventCount(other_file->num_writes_, 1));
+  EXPECT_EQ(1, thread_factory.threads_created_);
+
+  log_file->reopen();
+  EXPECT_TRUE(file_->waitForEventCount(file_->num_opens_, 2));
+  EXPECT_EQ(1, thread_factory.threads_created_);
+
+  EXPECT_CALL(*other_file, close_())
+      .WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+}
+
+// Test that writes are never dropped by default, however far behind the flush thread is.
+TEST_F(AccessLogManagerImplTest, WritesNotDroppedWhenFlushIsStalled) {
+  EXPECT_CALL(*file_, open_(_)).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  AccessLogFileSharedPtr log_file = access_log_manager_.createAccessLog(
+      Filesystem::FilePathAndType{Filesystem::DestinationType::File, "foo"});
+
+  absl::Notification write_started;
+  absl::Notification unblock_write;
+  uint64_t bytes_written = 0;
+  EXPECT_CALL(*file_, write_(_))
+      .WillOnce(Invoke([&](absl::string_view data) -> Api::IoCallSizeResult {
+        EXPECT_EQ("stall", data);
+        write_started.Notify();
+        unblock_write.WaitForNotification();
+        return Filesystem::resultSuccess<ssize_t>(static_cast<ssize_t>(data.length()));
+      }))
+      .WillRepeatedly(Invoke([&](absl::string_view data) -> Api::IoCallSizeResult {
+        bytes_written += data.length();
+        return Filesystem::resultSuccess<ssize_t>(static_cast<ssize_t>(data.length()));
+      }));
+  log_file->write("stall");
+  write_started.WaitForNotification();
+
+  const std::string chunk(1024 * 1024, 'a');
+  for (uint32_t i = 0; i < 17; ++i) {
+    log_file->write(chunk);
+  }
+  EXPECT_EQ(0UL, store_.counter("filesystem.write_dropped").value());
+  EXPECT_EQ(18UL, store_.counter("filesystem.write_buffered").value());
+
+  unblock_write.Notify();
+  log_file->flush();
+  waitForGaugeEq("filesystem.write_total_buffered", 0);
+  EXPECT_EQ(17 * chunk.size(), bytes_written);
+
+  EXPECT_CALL(*file_, close_()).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+}
+
+// Test that each file is flushed by its own thread, so that a file stuck reopening doesn't hold
+// up the writes of other files.
+TEST_F(AccessLogManagerImplTest, StalledFileDoesNotStallOtherFiles) {
+  NiceMock<Filesystem::MockFile>* other_file = new NiceMock<Filesystem::MockFile>;
+  EXPECT_CALL(*other_file, path()).WillRepeatedly(Return("bar"));
+  EXPECT_CALL(file_system_, createFile(testing::Matcher<const Envoy::Filesystem::FilePathAndType&>(
+                                Filesystem::FilePathAndType{Filesystem::DestinationType::File,
+                                                            "bar"})))
+      .WillOnce(Return(ByMove(std::unique_ptr<NiceMock<Filesystem::MockFile>>(other_file))));
+
+  absl::Notification reopen_started;
+  absl::Notification unblock_reopen;
+  EXPECT_CALL(*file_, open_(_))
+      .WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))))
+      .WillOnce(Invoke([&](Filesystem::FlagSet) -> Api::IoCallBoolResult {
+        reopen_started.Notify();
+        unblock_reopen.WaitForNotification();
+        return Filesystem::resultSuccess<bool>(true);
+      }));
+  EXPECT_CALL(*other_file, open_(_))
+      .WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  AccessLogFileSharedPtr log_file = access_log_manager_.createAccessLog(
+      Filesystem::FilePathAndType{Filesystem::DestinationType::File, "foo"});
+  AccessLogFileSharedPtr other_log_file = access_log_manager_.createAccessLog(
+      Filesystem::FilePathAndType{Filesystem::DestinationType::File, "bar"});
+
+  EXPECT_CALL(*file_, write_(_))
+      .WillRepeatedly(Invoke([](absl::string_view data) -> Api::IoCallSizeResult {
+        return Filesystem::resultSuccess<ssize_t>(static_cast<ssize_t>(data.length()));
+      }));
+  EXPECT_CALL(*file_, close_()).WillRepeatedly(Invoke([]() -> Api::IoCallBoolResult {
+    return Filesystem::resultSuccess<bool>(true);
+  }));
+  log_file->write("before");
+  EXPECT_TRUE(file_->waitForEventCount(file_->num_writes_, 1));
+  log_file->reopen();
+  reopen_started.WaitForNotification();
+
+  EXPECT_CALL(*other_file, write_(_))
+      .WillOnce(Invoke([](absl::string_view data) -> Api::IoCallSizeResult {
+        EXPECT_EQ("other", data);
+        return Filesystem::resultSuccess<ssize_t>(static_cast<ssize_t>(data.length()));
+      }));
+  other_log_file->write("other");
+  EXPECT_TRUE(other_file->waitForEventCount(other_file->num_writes_, 1));
+
+  unblock_reopen.Notify();
+  EXPECT_CALL(*other_file, close_())
+      .WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+}
+
 TEST_F(AccessLogManagerImplTest, ReopenAllFiles) {
   EXPECT_CALL(dispatcher_, createTimer_(_)).WillRepeatedly(ReturnNew<NiceMock<Event::MockTimer>>());
 
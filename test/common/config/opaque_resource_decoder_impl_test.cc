@@ -77,6 +77,39 @@ TEST_F(OpaqueResourceDecoderImplTest, Success) {
   EXPECT_EQ("foo", result.second);
 }
 
+// Concurrent decoding decodes and validates like decodeResource().
+TEST_F(OpaqueResourceDecoderImplTest, DecodeConcurrently) {
+  envoy::config::endpoint::v3::ClusterLoadAssignment cluster_resource;
+  cluster_resource.set_cluster_name("foo");
+  ProtobufWkt::Any opaque_resource;
+  opaque_resource.PackFrom(cluster_resource);
+  EXPECT_THAT(*resource_decoder_.decodeResourceConcurrently(opaque_resource),
+              ProtoEq(cluster_resource));
+
+  envoy::config::endpoint::v3::ClusterLoadAssignment invalid_resource;
+  opaque_resource.PackFrom(invalid_resource);
+  EXPECT_THROW(resource_decoder_.decodeResourceConcurrently(opaque_resource),
+               ProtoValidationException);
+}
+
+// Unknown fields are left to decodeResource() on the main thread, which counts or rejects them.
+TEST_F(OpaqueResourceDecoderImplTest, DecodeConcurrentlyUnknownField) {
+  envoy::config::endpoint::v3::ClusterLoadAssignment strange_resource;
+  strange_resource.set_cluster_name("fare");
+  strange_resource.GetReflection()->MutableUnknownFields(&strange_resource)->AddFixed32(1000, 1);
+  ProtobufWkt::Any opaque_resource;
+  opaque_resource.PackFrom(strange_resource);
+  EXPECT_THROW(resource_decoder_.decodeResourceConcurrently(opaque_resource),
+               ProtobufMessage::UnknownProtoFieldException);
+
+  // Unless validation is skipped.
+  ProtobufMessage::NullValidationVisitorImpl validation_visitor;
+  OpaqueResourceDecoderImpl<envoy::config::endpoint::v3::ClusterLoadAssignment> resource_decoder{
+      validation_visitor, "cluster_name"};
+  EXPECT_THAT(*resource_decoder.decodeResourceConcurrently(opaque_resource),
+              ProtoEq(strange_resource));
+}
+
 } // namespace
 } // namespace Config
 } // namespace Envoy
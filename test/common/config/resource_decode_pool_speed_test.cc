@@ -0,0 +1,61 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include "envoy/config/endpoint/v3/endpoint.pb.h"
+#include "envoy/config/endpoint/v3/endpoint.pb.validate.h"
+
+#include "source/common/config/decoded_resource_impl.h"
+#include "source/common/config/opaque_resource_decoder_impl.h"
+#include "source/common/config/resource_decode_pool.h"
+#include "source/common/protobuf/message_validator_impl.h"
+
+#include "test/test_common/thread_factory_for_test.h"
+
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Config {
+
+// Builds an EDS response with num_resources ClusterLoadAssignments of a few endpoints each.
+static Protobuf::RepeatedPtrField<ProtobufWkt::Any> makeResources(int num_resources) {
+  Protobuf::RepeatedPtrField<ProtobufWkt::Any> resources;
+  for (int i = 0; i < num_resources; ++i) {
+    envoy::config::endpoint::v3::ClusterLoadAssignment cla;
+    cla.set_cluster_name(absl::StrCat("cluster_", i));
+    auto* locality_endpoints = cla.add_endpoints();
+    locality_endpoints->mutable_locality()->set_zone(absl::StrCat("zone_", i % 3));
+    for (int j = 0; j < 4; ++j) {
+      auto* socket_address = locality_endpoints->add_lb_endpoints()
+                                 ->mutable_endpoint()
+                                 ->mutable_address()
+                                 ->mutable_socket_address();
+      socket_address->set_address(absl::StrCat("10.0.", i % 256, ".", j));
+      socket_address->set_port_value(8000 + j);
+    }
+    resources.Add()->PackFrom(cla);
+  }
+  return resources;
+}
+
+// Decodes a response of state.range(0) resources on state.range(1) pool threads plus the calling
+// thread. Wall time is what the main thread is blocked for.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_DecodeClusterLoadAssignments(benchmark::State& state) {
+  const Protobuf::RepeatedPtrField<ProtobufWkt::Any> resources = makeResources(state.range(0));
+  ProtobufMessage::StrictValidationVisitorImpl validation_visitor;
+  OpaqueResourceDecoderImpl<envoy::config::endpoint::v3::ClusterLoadAssignment> resource_decoder(
+      validation_visitor, "cluster_name");
+  ResourceDecodePool decode_pool(Thread::threadFactoryForTest(), state.range(1));
+  for (auto _ : state) { // NOLINT
+    benchmark::DoNotOptimize(decode_pool.decode(resource_decoder, resources, "1"));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DecodeClusterLoadAssignments)
+    ->ArgsProduct({{1000, 20000}, {0, 1, 3, 7}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+} // namespace Config
+} // namespace Envoy
@@ -0,0 +1,141 @@
+#include "envoy/config/cluster/v3/cluster.pb.h"
+#include "envoy/config/cluster/v3/cluster.pb.validate.h"
+
+#include "source/common/config/decoded_resource_impl.h"
+#include "source/common/config/opaque_resource_decoder_impl.h"
+#include "source/common/config/resource_decode_pool.h"
+
+#include "test/mocks/protobuf/mocks.h"
+#include "test/test_common/thread_factory_for_test.h"
+#include "test/test_common/utility.h"
+
+#include "absl/strings/str_cat.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Config {
+namespace {
+
+class ResourceDecodePoolTest : public testing::Test {
+public:
+  Protobuf::RepeatedPtrField<ProtobufWkt::Any> makeResources(size_t count) {
+    Protobuf::RepeatedPtrField<ProtobufWkt::Any> resources;
+    for (size_t i = 0; i < count; ++i) {
+      envoy::config::cluster::v3::Cluster cluster;
+      cluster.set_name(absl::StrCat("cluster_", i));
+      cluster.mutable_connect_timeout()->set_seconds(i);
+      resources.Add()->PackFrom(cluster);
+    }
+    return resources;
+  }
+
+  void expectNames(const std::vector<DecodedResourcePtr>& decoded, size_t count) {
+    ASSERT_EQ(count, decoded.size());
+    for (size_t i = 0; i < count; ++i) {
+      EXPECT_EQ(absl::StrCat("cluster_", i), decoded[i]->name());
+      EXPECT_EQ(i, dynamic_cast<const envoy::config::cluster::v3::Cluster&>(decoded[i]->resource())
+                       .connect_timeout()
+                       .seconds());
+      EXPECT_EQ("1", decoded[i]->version());
+    }
+  }
+
+  NiceMock<ProtobufMessage::MockValidationVisitor> validation_visitor_;
+  OpaqueResourceDecoderImpl<envoy::config::cluster::v3::Cluster> resource_decoder_{
+      validation_visitor_, "name"};
+  ResourceDecodePool decode_pool_{Thread::threadFactoryForTest(), 3};
+};
+
+TEST_F(ResourceDecodePoolTest, DecodesInOrder) {
+  EXPECT_EQ(3, decode_pool_.numThreads());
+  EXPECT_CALL(validation_visitor_, onDeprecatedField(_, _)).Times(0);
+  EXPECT_CALL(validation_visitor_, onUnknownField(_)).Times(0);
+  // Run several responses through the pool, of sizes around the serial decode threshold.
+  for (size_t count : {size_t(0), size_t(1), ResourceDecodePool::MinResourcesPerDecode - 1,
+                       ResourceDecodePool::MinResourcesPerDecode, size_t(1000)}) {
+    expectNames(decode_pool_.decode(resource_decoder_, makeResources(count), "1"), count);
+  }
+  for (int i = 0; i < 100; ++i) {
+    expectNames(decode_pool_.decode(resource_decoder_, makeResources(64), "1"), 64);
+  }
+}
+
+// Resources with deprecated fields are decoded on the calling thread with the decoder's own
+// validation visitor, so the deprecation is reported once per resource.
+TEST_F(ResourceDecodePoolTest, DeprecatedFieldsDecodedOnCallingThread) {
+  Protobuf::RepeatedPtrField<ProtobufWkt::Any> resources = makeResources(100);
+  for (int i : {3, 50, 99}) {
+    envoy::config::cluster::v3::Cluster cluster;
+    resources[i].UnpackTo(&cluster);
+    cluster.mutable_max_requests_per_connection()->set_value(1);
+    resources[i].PackFrom(cluster);
+  }
+
+  const Thread::ThreadId calling_thread = Thread::threadFactoryForTest().currentThreadId();
+  EXPECT_CALL(validation_visitor_, onDeprecatedField(_, _))
+      .Times(3)
+      .WillRepeatedly(Invoke([&](absl::string_view, bool) {
+        EXPECT_EQ(calling_thread, Thread::threadFactoryForTest().currentThreadId());
+      }));
+  const std::vector<DecodedResourcePtr> decoded =
+      decode_pool_.decode(resource_decoder_, resources, "1");
+  expectNames(decoded, 100);
+  EXPECT_EQ(1, dynamic_cast<const envoy::config::cluster::v3::Cluster&>(decoded[50]->resource())
+                   .max_requests_per_connection()
+                   .value());
+}
+
+// The error of the first resource that fails to decode is thrown, as for a serial decode.
+TEST_F(ResourceDecodePoolTest, ThrowsFirstError) {
+  const Protobuf::RepeatedPtrField<ProtobufWkt::Any> resources = makeResources(200);
+  const Thread::ThreadId calling_thread = Thread::threadFactoryForTest().currentThreadId();
+  std::atomic<uint32_t> calling_thread_decodes{};
+  auto decode_fn = [&](size_t index, OpaqueResourceDecoder& decoder) -> DecodedResourcePtr {
+    if (calling_thread == Thread::threadFactoryForTest().currentThreadId() &&
+        &decoder == &resource_decoder_) {
+      ++calling_thread_decodes;
+    }
+    if (index == 150 || index == 20) {
+      throw EnvoyException(absl::StrCat("bad resource ", index));
+    }
+    return DecodedResourceImpl::fromResource(decoder, resources[index], "1");
+  };
+  EXPECT_THROW_WITH_MESSAGE(decode_pool_.decode(resource_decoder_, resources.size(), decode_fn),
+                            EnvoyException, "bad resource 20");
+  // Only the failed resource was decoded again before the error was thrown.
+  EXPECT_EQ(1, calling_thread_decodes);
+
+  // Invalid resources are rejected with the validation error.
+  Protobuf::RepeatedPtrField<ProtobufWkt::Any> invalid_resources = makeResources(100);
+  invalid_resources[70].PackFrom(envoy::config::cluster::v3::Cluster());
+  EXPECT_THROW_WITH_REGEX(decode_pool_.decode(resource_decoder_, invalid_resources, "1"),
+                          ProtoValidationException, "ClusterValidationError.Name");
+}
+
+// Small responses and pools without threads decode on the calling thread only.
+TEST_F(ResourceDecodePoolTest, SerialDecode) {
+  ResourceDecodePool serial_pool(Thread::threadFactoryForTest(), 0);
+  uint32_t decodes = 0;
+  const Protobuf::RepeatedPtrField<ProtobufWkt::Any> resources = makeResources(100);
+  auto decode_fn = [&](size_t index, OpaqueResourceDecoder& decoder) -> DecodedResourcePtr {
+    EXPECT_EQ(&resource_decoder_, &decoder);
+    ++decodes;
+    return DecodedResourceImpl::fromResource(decoder, resources[index], "1");
+  };
+  expectNames(serial_pool.decode(resource_decoder_, resources.size(), decode_fn), 100);
+  EXPECT_EQ(100, decodes);
+
+  decodes = 0;
+  const size_t small = ResourceDecodePool::MinResourcesPerDecode - 1;
+  expectNames(decode_pool_.decode(resource_decoder_, small, decode_fn), small);
+  EXPECT_EQ(small, decodes);
+}
+
+} // namespace
+} // namespace Config
+} // namespace Envoy
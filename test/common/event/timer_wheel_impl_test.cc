@@ -0,0 +1,284 @@
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "envoy/event/timer.h"
+
+#include "source/common/event/dispatcher_impl.h"
+#include "source/common/event/timer_wheel_impl.h"
+
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/test_runtime.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Event {
+namespace {
+
+using testing::MockFunction;
+
+class TimerWheelImplTest : public testing::Test, public TestUsingSimulatedTime {
+public:
+  TimerWheelImplTest()
+      : api_(Api::createApiForTest()), dispatcher_(api_->allocateDispatcher("test_thread")) {}
+
+  // Records the simulated times at which the timer fired.
+  struct TrackedTimer {
+    TrackedTimer(TimerWheelImpl& wheel, TimeSystem& time_system)
+        : timer(wheel.createTimer([this, &time_system] {
+            trigger_times.push_back(time_system.monotonicTime());
+          })) {}
+    std::vector<MonotonicTime> trigger_times;
+    TimerPtr timer;
+  };
+
+  void advance(std::chrono::milliseconds duration) {
+    simTime().advanceTimeAndRun(duration, *dispatcher_, Dispatcher::RunType::NonBlock);
+  }
+
+  Api::ApiPtr api_;
+  DispatcherPtr dispatcher_;
+};
+
+TEST_F(TimerWheelImplTest, CreateAndDestroy) {
+  TimerWheelImpl wheel(*dispatcher_);
+  auto timer = wheel.createTimer([] {});
+  EXPECT_FALSE(timer->enabled());
+  EXPECT_EQ(0, wheel.size());
+}
+
+TEST_F(TimerWheelImplTest, TimersOutliveWheel) {
+  MockFunction<TimerCb> callback;
+  auto wheel = std::make_unique<TimerWheelImpl>(*dispatcher_);
+  auto enabled = wheel->createTimer(callback.AsStdFunction());
+  auto disabled = wheel->createTimer(callback.AsStdFunction());
+  auto long_timeout = wheel->createTimer(callback.AsStdFunction());
+  enabled->enableTimer(std::chrono::milliseconds(100));
+  long_timeout->enableTimer(std::chrono::hours(1));
+  EXPECT_EQ(2, wheel->size());
+
+  // Destroying the wheel disables its timers, and they can no longer be enabled.
+  wheel.reset();
+  EXPECT_FALSE(enabled->enabled());
+  EXPECT_FALSE(long_timeout->enabled());
+  disabled->enableTimer(std::chrono::milliseconds(100));
+  EXPECT_FALSE(disabled->enabled());
+
+  EXPECT_CALL(callback, Call()).Times(0);
+  advance(std::chrono::seconds(1));
+  enabled->disableTimer();
+  enabled.reset();
+  long_timeout.reset();
+}
+
+TEST_F(TimerWheelImplTest, FiresNotBeforeDurationAndWithinResolution) {
+  TimerWheelImpl wheel(*dispatcher_, std::chrono::milliseconds(10));
+  TrackedTimer timer(wheel, simTime());
+
+  const MonotonicTime start = simTime().monotonicTime();
+  timer.timer->enableTimer(std::chrono::milliseconds(95));
+  EXPECT_TRUE(timer.timer->enabled());
+  EXPECT_EQ(1, wheel.size());
+
+  for (int i = 0; i < 200; ++i) {
+    advance(std::chrono::milliseconds(1));
+  }
+  ASSERT_EQ(1, timer.trigger_times.size());
+  EXPECT_GE(timer.trigger_times[0] - start, std::chrono::milliseconds(95));
+  EXPECT_LE(timer.trigger_times[0] - start, std::chrono::milliseconds(105));
+  EXPECT_FALSE(timer.timer->enabled());
+  EXPECT_EQ(0, wheel.size());
+}
+
+TEST_F(TimerWheelImplTest, DisableTimer) {
+  TimerWheelImpl wheel(*dispatcher_);
+  MockFunction<TimerCb> callback;
+  auto timer = wheel.createTimer(callback.AsStdFunction());
+
+  timer->enableTimer(std::chrono::seconds(1));
+  timer->disableTimer();
+  EXPECT_FALSE(timer->enabled());
+  EXPECT_EQ(0, wheel.size());
+
+  EXPECT_CALL(callback, Call()).Times(0);
+  advance(std::chrono::seconds(2));
+}
+
+TEST_F(TimerWheelImplTest, ReenableTimerPushesDeadline) {
+  TimerWheelImpl wheel(*dispatcher_);
+  TrackedTimer timer(wheel, simTime());
+
+  const MonotonicTime start = simTime().monotonicTime();
+  timer.timer->enableTimer(std::chrono::seconds(1));
+  // Keep resetting the timer, as an idle timeout would on stream activity.
+  for (int i = 0; i < 10; ++i) {
+    advance(std::chrono::milliseconds(500));
+    timer.timer->enableTimer(std::chrono::seconds(1));
+  }
+  EXPECT_TRUE(timer.trigger_times.empty());
+
+  advance(std::chrono::milliseconds(1100));
+  ASSERT_EQ(1, timer.trigger_times.size());
+  EXPECT_GE(timer.trigger_times[0] - start, std::chrono::seconds(6));
+}
+
+TEST_F(TimerWheelImplTest, EnableEarlierTimer) {
+  TimerWheelImpl wheel(*dispatcher_);
+  TrackedTimer late(wheel, simTime());
+  TrackedTimer early(wheel, simTime());
+
+  late.timer->enableTimer(std::chrono::seconds(10));
+  early.timer->enableTimer(std::chrono::milliseconds(100));
+
+  advance(std::chrono::milliseconds(200));
+  EXPECT_EQ(1, early.trigger_times.size());
+  EXPECT_TRUE(late.trigger_times.empty());
+
+  advance(std::chrono::seconds(10));
+  EXPECT_EQ(1, late.trigger_times.size());
+}
+
+TEST_F(TimerWheelImplTest, ZeroDuration) {
+  TimerWheelImpl wheel(*dispatcher_);
+  MockFunction<TimerCb> callback;
+  auto timer = wheel.createTimer(callback.AsStdFunction());
+  timer->enableTimer(std::chrono::milliseconds::zero());
+
+  EXPECT_CALL(callback, Call());
+  advance(TimerWheelImpl::DefaultResolution);
+}
+
+// Timeouts spanning every level of the wheel, including beyond the top level, are cascaded down
+// and fire within one tick of their deadline.
+TEST_F(TimerWheelImplTest, LongTimeouts) {
+  const std::chrono::milliseconds resolution(10);
+  TimerWheelImpl wheel(*dispatcher_, resolution);
+  const std::vector<std::chrono::milliseconds> timeouts = {
+      std::chrono::milliseconds(2555), std::chrono::milliseconds(2600), std::chrono::minutes(5),
+      std::chrono::minutes(11), std::chrono::hours(2), std::chrono::hours(50)};
+
+  std::vector<std::unique_ptr<TrackedTimer>> timers;
+  const MonotonicTime start = simTime().monotonicTime();
+  for (const auto timeout : timeouts) {
+    timers.push_back(std::make_unique<TrackedTimer>(wheel, simTime()));
+    timers.back()->timer->enableTimer(timeout);
+  }
+
+  // Advance in steps shorter than the resolution near each deadline.
+  MonotonicTime now = start;
+  for (size_t i = 0; i < timeouts.size(); ++i) {
+    const MonotonicTime deadline = start + timeouts[i];
+    advance(std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now) -
+            std::chrono::milliseconds(1));
+    EXPECT_TRUE(timers[i]->trigger_times.empty()) << i;
+    advance(std::chrono::milliseconds(1) + resolution);
+    now = simTime().monotonicTime();
+    ASSERT_EQ(1, timers[i]->trigger_times.size()) << i;
+    EXPECT_GE(timers[i]->trigger_times[0], deadline) << i;
+    EXPECT_LE(timers[i]->trigger_times[0], deadline + resolution) << i;
+  }
+  EXPECT_EQ(0, wheel.size());
+}
+
+TEST_F(TimerWheelImplTest, EnableFromCallback) {
+  TimerWheelImpl wheel(*dispatcher_);
+  int fired = 0;
+  TimerPtr timer;
+  timer = wheel.createTimer([&] {
+    if (++fired < 3) {
+      timer->enableTimer(std::chrono::milliseconds(100));
+    }
+  });
+  timer->enableTimer(std::chrono::milliseconds(100));
+
+  for (int i = 0; i < 10; ++i) {
+    advance(std::chrono::milliseconds(50));
+  }
+  EXPECT_EQ(3, fired);
+  EXPECT_FALSE(timer->enabled());
+}
+
+TEST_F(TimerWheelImplTest, DisableAndDestroyFromCallback) {
+  TimerWheelImpl wheel(*dispatcher_);
+  MockFunction<TimerCb> callback;
+  TimerPtr other = wheel.createTimer(callback.AsStdFunction());
+  TimerPtr destroyed = wheel.createTimer(callback.AsStdFunction());
+  TimerPtr timer = wheel.createTimer([&] {
+    other->disableTimer();
+    destroyed.reset();
+  });
+
+  // All three timers expire in the same tick.
+  timer->enableTimer(std::chrono::milliseconds(100));
+  other->enableTimer(std::chrono::milliseconds(100));
+  destroyed->enableTimer(std::chrono::milliseconds(100));
+
+  // Depending on the order in which the expired timers run, the other timers may fire before
+  // being disabled.
+  EXPECT_CALL(callback, Call()).Times(testing::AtMost(2));
+  advance(std::chrono::milliseconds(200));
+  EXPECT_FALSE(timer->enabled());
+  EXPECT_FALSE(other->enabled());
+  EXPECT_EQ(0, wheel.size());
+}
+
+TEST_F(TimerWheelImplTest, ManyTimers) {
+  TimerWheelImpl wheel(*dispatcher_);
+  int fired = 0;
+  std::vector<TimerPtr> timers;
+  for (int i = 0; i < 10000; ++i) {
+    timers.push_back(wheel.createTimer([&fired] { ++fired; }));
+    timers.back()->enableTimer(std::chrono::milliseconds(i));
+  }
+  EXPECT_EQ(10000, wheel.size());
+
+  // Disable every other timer.
+  for (int i = 0; i < 10000; i += 2) {
+    timers[i]->disableTimer();
+  }
+  EXPECT_EQ(5000, wheel.size());
+
+  for (int i = 0; i < 20; ++i) {
+    advance(std::chrono::milliseconds(600));
+  }
+  EXPECT_EQ(5000, fired);
+  EXPECT_EQ(0, wheel.size());
+}
+
+class DispatcherCoarseTimerTest : public TimerWheelImplTest {};
+
+TEST_F(DispatcherCoarseTimerTest, CoarseTimerWheelEnabled) {
+  TestScopedRuntime scoped_runtime;
+  scoped_runtime.mergeValues({{"envoy.reloadable_features.coarse_timer_wheel", "true"}});
+
+  MockFunction<TimerCb> callback;
+  auto timer = dispatcher_->createCoarseTimer(callback.AsStdFunction());
+  timer->enableTimer(std::chrono::seconds(1));
+  EXPECT_TRUE(timer->enabled());
+
+  advance(std::chrono::milliseconds(900));
+  EXPECT_CALL(callback, Call());
+  advance(std::chrono::milliseconds(200));
+  EXPECT_FALSE(timer->enabled());
+}
+
+TEST_F(DispatcherCoarseTimerTest, CoarseTimerWheelDisabled) {
+  TestScopedRuntime scoped_runtime;
+  scoped_runtime.mergeValues({{"envoy.reloadable_features.coarse_timer_wheel", "false"}});
+
+  MockFunction<TimerCb> callback;
+  auto timer = dispatcher_->createCoarseTimer(callback.AsStdFunction());
+  timer->enableTimer(std::chrono::seconds(1));
+
+  advance(std::chrono::milliseconds(999));
+  EXPECT_CALL(callback, Call());
+  advance(std::chrono::milliseconds(1));
+  EXPECT_FALSE(timer->enabled());
+}
+
+} // namespace
+} // namespace Event
+} // namespace Envoy
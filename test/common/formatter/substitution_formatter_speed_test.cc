@@ -1,5 +1,6 @@
 #include "source/common/formatter/substitution_formatter.h"
 #include "source/common/network/address_impl.h"
+#include "source/common/protobuf/utility.h"
 
 #include "test/common/stream_info/test_util.h"
 #include "test/mocks/http/mocks.h"
@@ -186,6 +187,32 @@ static void BM_TypedJsonAccessLogFormatter(benchmark::State& state) {
 }
 BENCHMARK(BM_TypedJsonAccessLogFormatter);
 
+// Serializes through a Struct, as JsonFormatterImpl used to, for comparison with
+// BM_TypedJsonAccessLogFormatter.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_TypedJsonViaStructAccessLogFormatter(benchmark::State& state) {
+  MockTimeSystem time_system;
+  std::unique_ptr<Envoy::TestStreamInfo> stream_info = makeStreamInfo(time_system);
+  std::unique_ptr<Envoy::Formatter::StructFormatter> typed_struct_formatter =
+      makeStructFormatter(true);
+
+  size_t output_bytes = 0;
+  Http::TestRequestHeaderMapImpl request_headers;
+  Http::TestResponseHeaderMapImpl response_headers;
+  Http::TestResponseTrailerMapImpl response_trailers;
+  std::string body;
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    output_bytes +=
+        MessageUtil::getJsonStringFromMessageOrError(
+            typed_struct_formatter->format(request_headers, response_headers, response_trailers,
+                                           *stream_info, body, AccessLog::AccessLogType::NotSet),
+            false, true)
+            .length();
+  }
+  benchmark::DoNotOptimize(output_bytes);
+}
+BENCHMARK(BM_TypedJsonViaStructAccessLogFormatter);
+
 // NOLINTNEXTLINE(readability-identifier-naming)
 static void BM_FormatterCommandParsing(benchmark::State& state) {
   const std::string token = "Listener:namespace:key";
@@ -4373,6 +4373,129 @@ TEST(SubstitutionFormatterTest, JsonFormatterTest) {
   EXPECT_TRUE(TestUtility::jsonStringEqual(out_json, expected));
 }
 
+// The JSON output is written directly rather than through a Struct. Keys are sorted, there is no
+// whitespace and numbers are printed like the protobuf JSON printer. Strings are escaped with
+// Json::sanitize, which unlike protobuf leaves '<' and '>' alone and octal-escapes invalid UTF-8
+// instead of failing.
+TEST(SubstitutionFormatterTest, JsonFormatterExactOutputTest) {
+  NiceMock<StreamInfo::MockStreamInfo> stream_info;
+  Http::TestRequestHeaderMapImpl request_header{{"user-agent", "a \"quoted\"\\agent\t"}};
+  Http::TestResponseHeaderMapImpl response_header;
+  Http::TestResponseTrailerMapImpl response_trailer;
+  std::string body;
+
+  absl::optional<uint32_t> response_code{200};
+  EXPECT_CALL(stream_info, responseCode()).WillRepeatedly(Return(response_code));
+
+  ProtobufWkt::Struct key_mapping;
+  TestUtility::loadFromYaml(R"EOF(
+    user_agent: '%REQ(USER-AGENT)%'
+    code: '%RESPONSE_CODE%'
+    code_multi: 'code=%RESPONSE_CODE% agent=%REQ(USER-AGENT)%'
+    missing: '%REQ(MISSING)%'
+    number: 1.5
+    list:
+    - 'plain'
+    - '%RESPONSE_CODE%'
+    nested:
+      a_key: "with \"quotes\""
+  )EOF",
+                            key_mapping);
+
+  {
+    JsonFormatterImpl formatter(key_mapping, false, false);
+    EXPECT_EQ(
+        R"({"code":"200","code_multi":"code=200 agent=a \"quoted\"\\agent\t","list":["plain","200"],)"
+        R"("missing":"-","nested":{"a_key":"with \"quotes\""},"number":"1.5",)"
+        R"("user_agent":"a \"quoted\"\\agent\t"})"
+        "\n",
+        formatter.format(request_header, response_header, response_trailer, stream_info, body,
+                         AccessLog::AccessLogType::NotSet));
+  }
+  {
+    JsonFormatterImpl formatter(key_mapping, true, false);
+    EXPECT_EQ(
+        R"({"code":200,"code_multi":"code=200 agent=a \"quoted\"\\agent\t","list":["plain",200],)"
+        R"("missing":null,"nested":{"a_key":"with \"quotes\""},"number":1.5,)"
+        R"("user_agent":"a \"quoted\"\\agent\t"})"
+        "\n",
+        formatter.format(request_header, response_header, response_trailer, stream_info, body,
+                         AccessLog::AccessLogType::NotSet));
+  }
+}
+
+TEST(SubstitutionFormatterTest, JsonFormatterExactOutputSanitizeTest) {
+  NiceMock<StreamInfo::MockStreamInfo> stream_info;
+  Http::TestRequestHeaderMapImpl request_header{{"user-agent", "<b>\xce</b>"},
+                                                {"x-utf8", "\xc3\xa9t\xc3\xa9"},
+                                                {"x-surrogate", "\xed\xa0\x80\"\\"}};
+  Http::TestResponseHeaderMapImpl response_header;
+  Http::TestResponseTrailerMapImpl response_trailer;
+  std::string body;
+
+  ProtobufWkt::Struct key_mapping;
+  TestUtility::loadFromYaml(R"EOF(
+    agent: '%REQ(USER-AGENT)%'
+    utf8: '%REQ(X-UTF8)%'
+    surrogate: '%REQ(X-SURROGATE)%'
+    big: 1000000000000000.0
+    small: 0.1
+    third: 0.3333333333333333
+  )EOF",
+                            key_mapping);
+
+  // Invalid UTF-8 is replaced byte by byte with U+FFFD, so that the line is still valid JSON.
+  JsonFormatterImpl formatter(key_mapping, true, false);
+  const std::string output = formatter.format(request_header, response_header, response_trailer,
+                                              stream_info, body, AccessLog::AccessLogType::NotSet);
+  EXPECT_EQ(R"({"agent":"<b>\ufffd</b>","big":1e+15,"small":0.1,)"
+            R"("surrogate":"\ufffd\ufffd\ufffd\"\\","third":0.33333333333333331,)"
+            "\"utf8\":\"\xc3\xa9t\xc3\xa9\"}\n",
+            output);
+  const ProtobufWkt::Struct parsed = TestUtility::jsonToStruct(output);
+  EXPECT_EQ("<b>\xef\xbf\xbd</b>", parsed.fields().at("agent").string_value());
+  EXPECT_EQ("\xc3\xa9t\xc3\xa9", parsed.fields().at("utf8").string_value());
+}
+
+TEST(SubstitutionFormatterTest, JsonFormatterOmitEmptyTest) {
+  NiceMock<StreamInfo::MockStreamInfo> stream_info;
+  Http::TestRequestHeaderMapImpl request_header;
+  Http::TestResponseHeaderMapImpl response_header;
+  Http::TestResponseTrailerMapImpl response_trailer;
+  std::string body;
+
+  ProtobufWkt::Struct key_mapping;
+  TestUtility::loadFromYaml(R"EOF(
+    a_missing: '%REQ(MISSING)%'
+    b_nested:
+      missing: '%RESP(MISSING)%'
+      nested_again:
+        missing: '%REQ(MISSING)%'
+    c_list:
+    - '%REQ(MISSING)%'
+    d_present: 'value'
+    e_missing: '%TRAILER(MISSING)%'
+  )EOF",
+                            key_mapping);
+
+  for (const bool preserve_types : {false, true}) {
+    JsonFormatterImpl formatter(key_mapping, preserve_types, true);
+    EXPECT_EQ(R"({"c_list":[],"d_present":"value"})"
+              "\n",
+              formatter.format(request_header, response_header, response_trailer, stream_info,
+                               body, AccessLog::AccessLogType::NotSet));
+  }
+
+  ProtobufWkt::Struct empty_mapping;
+  TestUtility::loadFromYaml(R"EOF(
+    missing: '%REQ(MISSING)%'
+  )EOF",
+                            empty_mapping);
+  JsonFormatterImpl formatter(empty_mapping, false, true);
+  EXPECT_EQ("{}\n", formatter.format(request_header, response_header, response_trailer,
+                                     stream_info, body, AccessLog::AccessLogType::NotSet));
+}
+
 TEST(SubstitutionFormatterTest, CompositeFormatterSuccess) {
   Http::TestRequestHeaderMapImpl request_header{{"first", "GET"}, {":path", "/"}};
   Http::TestResponseHeaderMapImpl response_header{{"second", "PUT"}, {"test", "test"}};
@@ -1031,6 +1031,206 @@ TEST_P(ConnectionImplTest, HalfCloseNoEarlyCloseDetection) {
   server_connection_->close(ConnectionCloseType::NoFlush);
 }
 
+#ifdef __linux__
+class MockSpliceCallbacks : public SpliceCallbacks {
+public:
+  MOCK_METHOD(void, onSplicedData, (uint64_t bytes, bool end_stream));
+};
+
+// Splices the data read by the server connection to the client connection, with the splice system
+// calls mocked. Splicing from the server socket into the pipe calls on_splice_read_, and splicing
+// from the pipe into the client socket is done for real unless a test expects otherwise.
+class ConnectionImplSpliceTest : public ConnectionImplTest {
+protected:
+  void SetUp() override {
+    ON_CALL(os_sys_calls_, pipe2(_, _)).WillByDefault(Invoke([this](int fds[2], int flags) {
+      const Api::SysCallIntResult result = os_sys_calls_.LinuxOsSysCallsImpl::pipe2(fds, flags);
+      pipe_read_fd_ = fds[0];
+      pipe_write_fd_ = fds[1];
+      return result;
+    }));
+    ON_CALL(os_sys_calls_, splice(_, _, _, _))
+        .WillByDefault(Invoke([this](os_fd_t fd_in, os_fd_t fd_out, size_t len,
+                                     unsigned int flags) -> Api::SysCallSizeResult {
+          if (fd_out == pipe_write_fd_) {
+            return on_splice_read_();
+          }
+          return os_sys_calls_.LinuxOsSysCallsImpl::splice(fd_in, fd_out, len, flags);
+        }));
+    EXPECT_CALL(os_sys_calls_, splice(_, _, _, _)).Times(AnyNumber());
+    setUpBasicConnection();
+    connect();
+  }
+
+  // Makes the first splice from the server socket pretend to have read 5 bytes into the pipe, and
+  // the next ones find no more data.
+  void spliceFiveBytes() {
+    on_splice_read_ = [spliced = false]() mutable -> Api::SysCallSizeResult {
+      if (spliced) {
+        return {-1, SOCKET_ERROR_AGAIN};
+      }
+      spliced = true;
+      return {5, 0};
+    };
+  }
+
+  // Waits for the server, and then the client, to see the other end close.
+  void waitForRemoteCloses() {
+    EXPECT_CALL(server_callbacks_, onEvent(ConnectionEvent::RemoteClose));
+    EXPECT_CALL(client_callbacks_, onEvent(ConnectionEvent::RemoteClose))
+        .WillOnce(InvokeWithoutArgs([this]() -> void { dispatcher_->exit(); }));
+    dispatcher_->run(Event::Dispatcher::RunType::Block);
+  }
+
+  std::function<Api::SysCallSizeResult()> on_splice_read_ = []() -> Api::SysCallSizeResult {
+    return {-1, SOCKET_ERROR_AGAIN};
+  };
+  NiceMock<Api::MockLinuxOsSysCalls> os_sys_calls_;
+  TestThreadsafeSingletonInjector<Api::LinuxOsSysCallsImpl> os_calls_{&os_sys_calls_};
+  StrictMock<MockSpliceCallbacks> splice_callbacks_;
+  os_fd_t pipe_read_fd_{-1};
+  os_fd_t pipe_write_fd_{-1};
+};
+
+INSTANTIATE_TEST_SUITE_P(IpVersions, ConnectionImplSpliceTest,
+                         testing::ValuesIn(TestEnvironment::getIpVersionsForTest()),
+                         TestUtility::ipTestParamsToString);
+
+// Test that the data keeps being delivered to the read filters when the pipe can't be created.
+TEST_P(ConnectionImplSpliceTest, PipeFailure) {
+  EXPECT_CALL(os_sys_calls_, pipe2(_, _)).WillOnce(Return(Api::SysCallIntResult{-1, EMFILE}));
+  EXPECT_FALSE(server_connection_->startSplice(*client_connection_, splice_callbacks_));
+
+  EXPECT_CALL(os_sys_calls_, splice(_, _, _, _)).Times(0);
+  EXPECT_CALL(*read_filter_, onData(BufferStringEqual("hello"), false))
+      .WillOnce(Invoke([&](Buffer::Instance& buffer, bool) -> FilterStatus {
+        buffer.drain(buffer.length());
+        dispatcher_->exit();
+        return FilterStatus::StopIteration;
+      }));
+  Buffer::OwnedImpl buffer("hello");
+  client_connection_->write(buffer, false);
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+
+  disconnect(true);
+}
+
+// Test that data isn't spliced past a read filter of the source other than the one starting the
+// splice, or past a write filter of the sink.
+TEST_P(ConnectionImplSpliceTest, OtherFilters) {
+  EXPECT_CALL(os_sys_calls_, pipe2(_, _)).Times(0);
+
+  server_connection_->addReadFilter(std::make_shared<NiceMock<MockReadFilter>>());
+  EXPECT_FALSE(server_connection_->startSplice(*client_connection_, splice_callbacks_));
+
+  client_connection_->addReadFilter(std::make_shared<NiceMock<MockReadFilter>>());
+  server_connection_->addWriteFilter(std::make_shared<NiceMock<MockWriteFilter>>());
+  EXPECT_FALSE(client_connection_->startSplice(*server_connection_, splice_callbacks_));
+
+  disconnect(true);
+}
+
+// Test that the source waits for more data when its socket has none, without notifying anyone.
+TEST_P(ConnectionImplSpliceTest, ReadAgain) {
+  EXPECT_TRUE(server_connection_->startSplice(*client_connection_, splice_callbacks_));
+
+  EXPECT_CALL(*read_filter_, onData(_, _)).Times(0);
+  on_splice_read_ = [this]() -> Api::SysCallSizeResult {
+    dispatcher_->exit();
+    return {-1, SOCKET_ERROR_AGAIN};
+  };
+  Buffer::OwnedImpl buffer("hello");
+  client_connection_->write(buffer, false);
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+  EXPECT_EQ(Connection::State::Open, server_connection_->state());
+
+  // Once the sink is closed, the source reads the data through its filter chain.
+  EXPECT_CALL(*read_filter_, onData(_, _)).Times(AnyNumber());
+  disconnect(true);
+}
+
+// Test that the data in the pipe is written to the sink once its socket is writable again.
+TEST_P(ConnectionImplSpliceTest, WriteAgain) {
+  EXPECT_TRUE(server_connection_->startSplice(*client_connection_, splice_callbacks_));
+  ASSERT_EQ(5, ::write(pipe_write_fd_, "hello", 5));
+  spliceFiveBytes();
+
+  EXPECT_CALL(splice_callbacks_, onSplicedData(5, false));
+  EXPECT_CALL(os_sys_calls_, splice(pipe_read_fd_, _, 5, _))
+      .WillOnce(Return(Api::SysCallSizeResult{-1, SOCKET_ERROR_AGAIN}))
+      .WillOnce(Invoke([this](os_fd_t fd_in, os_fd_t fd_out, size_t len, unsigned int flags) {
+        const Api::SysCallSizeResult result =
+            os_sys_calls_.LinuxOsSysCallsImpl::splice(fd_in, fd_out, len, flags);
+        EXPECT_EQ(5, result.return_value_);
+        dispatcher_->exit();
+        return result;
+      }));
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+  EXPECT_EQ(Connection::State::Open, client_connection_->state());
+
+  EXPECT_CALL(*read_filter_, onData(_, _)).Times(AnyNumber());
+  disconnect(true);
+}
+
+// Test that the sink is closed when writing to its socket fails, and that the source then falls
+// back to its filter chain.
+TEST_P(ConnectionImplSpliceTest, WriteError) {
+  EXPECT_TRUE(server_connection_->startSplice(*client_connection_, splice_callbacks_));
+  spliceFiveBytes();
+
+  EXPECT_CALL(splice_callbacks_, onSplicedData(5, false));
+  EXPECT_CALL(os_sys_calls_, splice(pipe_read_fd_, _, 5, _))
+      .WillOnce(Return(Api::SysCallSizeResult{-1, EPIPE}));
+  EXPECT_CALL(client_callbacks_, onEvent(ConnectionEvent::RemoteClose));
+  EXPECT_CALL(server_callbacks_, onEvent(ConnectionEvent::RemoteClose))
+      .WillOnce(InvokeWithoutArgs([this]() -> void { dispatcher_->exit(); }));
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+}
+
+// Test that the source is closed when reading from its socket fails.
+TEST_P(ConnectionImplSpliceTest, ReadError) {
+  EXPECT_TRUE(server_connection_->startSplice(*client_connection_, splice_callbacks_));
+
+  on_splice_read_ = []() -> Api::SysCallSizeResult { return {-1, ECONNRESET}; };
+  waitForRemoteCloses();
+}
+
+// Test that the source is closed when its peer closes, as half close is disabled.
+TEST_P(ConnectionImplSpliceTest, ReadEndOfStream) {
+  EXPECT_TRUE(server_connection_->startSplice(*client_connection_, splice_callbacks_));
+
+  on_splice_read_ = []() -> Api::SysCallSizeResult { return {0, 0}; };
+  waitForRemoteCloses();
+}
+
+// Test that a half close of the source is reported, and leaves both connections open.
+TEST_P(ConnectionImplSpliceTest, ReadEndOfStreamHalfClose) {
+  server_connection_->enableHalfClose(true);
+  client_connection_->enableHalfClose(true);
+  EXPECT_TRUE(server_connection_->startSplice(*client_connection_, splice_callbacks_));
+
+  on_splice_read_ = []() -> Api::SysCallSizeResult { return {0, 0}; };
+  EXPECT_CALL(splice_callbacks_, onSplicedData(0, true))
+      .WillOnce(InvokeWithoutArgs([this]() -> void { dispatcher_->exit(); }));
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+  EXPECT_EQ(Connection::State::Open, server_connection_->state());
+  EXPECT_EQ(Connection::State::Open, client_connection_->state());
+
+  EXPECT_CALL(server_callbacks_, onEvent(ConnectionEvent::LocalClose));
+  server_connection_->close(ConnectionCloseType::NoFlush);
+  disconnect(false);
+}
+
+// Test that closing the sink stops the splice, so that the source reads through its filter chain.
+TEST_P(ConnectionImplSpliceTest, SinkClose) {
+  EXPECT_TRUE(server_connection_->startSplice(*client_connection_, splice_callbacks_));
+  dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+
+  EXPECT_CALL(os_sys_calls_, splice(_, _, _, _)).Times(0);
+  disconnect(true);
+}
+#endif
+
 // Test that as watermark levels are changed, the appropriate callbacks are triggered.
 TEST_P(ConnectionImplTest, WriteWatermarks) {
   useMockBuffer();
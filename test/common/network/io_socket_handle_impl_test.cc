@@ -152,6 +152,111 @@ TEST(IoSocketHandleImpl, NullptrIfaddrs) {
   EXPECT_FALSE(maybe_interface_name.has_value());
 }
 
+TEST(IoSocketHandleImpl, SendmmsgSendsDatagramsInOneCall) {
+  NiceMock<Api::MockOsSysCalls> os_sys_calls;
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+
+  IoSocketHandleImpl io_handle;
+  Address::Ipv4Instance peer_address("127.0.0.1", 8125);
+  char data[] = "foobar";
+  Buffer::RawSlice datagrams[] = {{data, 3}, {data + 3, 2}, {data + 5, 1}};
+
+  EXPECT_CALL(os_sys_calls, supportsMmsg()).WillRepeatedly(Return(true));
+  EXPECT_CALL(os_sys_calls, sendmsg(_, _, _)).Times(0);
+  EXPECT_CALL(os_sys_calls, sendmmsg(_, _, 3, 0))
+      .WillOnce(Invoke([&](os_fd_t, struct mmsghdr* msgvec, unsigned int vlen,
+                           int) -> Api::SysCallIntResult {
+        for (unsigned int i = 0; i < vlen; ++i) {
+          EXPECT_EQ(peer_address.sockAddrLen(), msgvec[i].msg_hdr.msg_namelen);
+          EXPECT_EQ(1, msgvec[i].msg_hdr.msg_iovlen);
+          EXPECT_EQ(datagrams[i].mem_, msgvec[i].msg_hdr.msg_iov->iov_base);
+          EXPECT_EQ(datagrams[i].len_, msgvec[i].msg_hdr.msg_iov->iov_len);
+        }
+        return {3, 0};
+      }));
+  Api::IoCallUint64Result result = io_handle.sendmmsg(datagrams, 3, 0, peer_address);
+  ASSERT_TRUE(result.ok());
+  EXPECT_EQ(3, result.return_value_);
+
+  // Nothing is sent for an empty batch.
+  EXPECT_CALL(os_sys_calls, sendmmsg(_, _, _, _)).Times(0);
+  result = io_handle.sendmmsg(datagrams, 0, 0, peer_address);
+  ASSERT_TRUE(result.ok());
+  EXPECT_EQ(0, result.return_value_);
+}
+
+TEST(IoSocketHandleImpl, SendmmsgPartialSend) {
+  NiceMock<Api::MockOsSysCalls> os_sys_calls;
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+
+  IoSocketHandleImpl io_handle;
+  Address::Ipv4Instance peer_address("127.0.0.1", 8125);
+  char data[] = "foobar";
+  Buffer::RawSlice datagrams[] = {{data, 3}, {data + 3, 3}};
+
+  EXPECT_CALL(os_sys_calls, supportsMmsg()).WillRepeatedly(Return(true));
+  EXPECT_CALL(os_sys_calls, sendmmsg(_, _, 2, 0)).WillOnce(Return(Api::SysCallIntResult{1, 0}));
+  const Api::IoCallUint64Result result = io_handle.sendmmsg(datagrams, 2, 0, peer_address);
+  ASSERT_TRUE(result.ok());
+  EXPECT_EQ(1, result.return_value_);
+}
+
+TEST(IoSocketHandleImpl, SendmmsgError) {
+  NiceMock<Api::MockOsSysCalls> os_sys_calls;
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+
+  IoSocketHandleImpl io_handle;
+  Address::Ipv4Instance peer_address("127.0.0.1", 8125);
+  char data[] = "foobar";
+  Buffer::RawSlice datagrams[] = {{data, 3}, {data + 3, 3}};
+
+  EXPECT_CALL(os_sys_calls, supportsMmsg()).WillRepeatedly(Return(true));
+  EXPECT_CALL(os_sys_calls, sendmmsg(_, _, 2, 0))
+      .WillOnce(Return(Api::SysCallIntResult{-1, SOCKET_ERROR_AGAIN}));
+  const Api::IoCallUint64Result result = io_handle.sendmmsg(datagrams, 2, 0, peer_address);
+  ASSERT_FALSE(result.ok());
+  EXPECT_EQ(Api::IoError::IoErrorCode::Again, result.err_->getErrorCode());
+}
+
+TEST(IoSocketHandleImpl, SendmmsgFallsBackToSendmsg) {
+  NiceMock<Api::MockOsSysCalls> os_sys_calls;
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+
+  IoSocketHandleImpl io_handle;
+  Address::Ipv4Instance peer_address("127.0.0.1", 8125);
+  char data[] = "foobar";
+  Buffer::RawSlice datagrams[] = {{data, 3}, {data + 3, 2}, {data + 5, 1}};
+
+  EXPECT_CALL(os_sys_calls, supportsMmsg()).WillRepeatedly(Return(false));
+  EXPECT_CALL(os_sys_calls, sendmmsg(_, _, _, _)).Times(0);
+
+  // Each datagram is sent with its own sendmsg(), stopping at the first one that fails.
+  {
+    testing::InSequence s;
+    EXPECT_CALL(os_sys_calls, sendmsg(_, _, 0))
+        .WillOnce(Invoke([&](os_fd_t, const msghdr* msg, int) -> Api::SysCallSizeResult {
+          EXPECT_EQ(1, msg->msg_iovlen);
+          EXPECT_EQ(datagrams[0].mem_, msg->msg_iov[0].iov_base);
+          return {3, 0};
+        }));
+    EXPECT_CALL(os_sys_calls, sendmsg(_, _, 0))
+        .WillOnce(Invoke([&](os_fd_t, const msghdr* msg, int) -> Api::SysCallSizeResult {
+          EXPECT_EQ(datagrams[1].mem_, msg->msg_iov[0].iov_base);
+          return {-1, SOCKET_ERROR_AGAIN};
+        }));
+  }
+  Api::IoCallUint64Result result = io_handle.sendmmsg(datagrams, 3, 0, peer_address);
+  ASSERT_TRUE(result.ok());
+  EXPECT_EQ(1, result.return_value_);
+
+  // A failure on the first datagram is returned as the error of the whole call.
+  EXPECT_CALL(os_sys_calls, sendmsg(_, _, 0))
+      .WillOnce(Return(Api::SysCallSizeResult{-1, SOCKET_ERROR_AGAIN}));
+  result = io_handle.sendmmsg(datagrams, 3, 0, peer_address);
+  ASSERT_FALSE(result.ok());
+  EXPECT_EQ(Api::IoError::IoErrorCode::Again, result.err_->getErrorCode());
+}
+
 class IoSocketHandleImplTest : public testing::TestWithParam<Network::Address::IpVersion> {};
 INSTANTIATE_TEST_SUITE_P(IpVersions, IoSocketHandleImplTest,
                          testing::ValuesIn(TestEnvironment::getIpVersionsForTest()),
@@ -1,6 +1,13 @@
+#include <random>
+
+#include "source/common/memory/stats.h"
 #include "source/common/network/lc_trie.h"
+#include "source/common/network/poptrie.h"
 #include "source/common/network/utility.h"
 
+#include "test/benchmark/main.h"
+
+#include "absl/container/flat_hash_map.h"
 #include "benchmark/benchmark.h"
 
 namespace {
@@ -50,6 +57,55 @@ struct CidrInputs {
       tag_data_minimal_;
 };
 
+// Tables the size of threat intelligence feeds: mostly /32 and /24 IPv4 ranges with some wider
+// ones, spread over the address space and tagged with one of a few tags. Tables are cached, as
+// creating millions of CidrRanges takes longer than building the index from them.
+const std::vector<std::pair<std::string, std::vector<Envoy::Network::Address::CidrRange>>>&
+largeTagData(size_t num_prefixes) {
+  static auto* tables = new absl::flat_hash_map<
+      size_t,
+      std::vector<std::pair<std::string, std::vector<Envoy::Network::Address::CidrRange>>>>();
+  auto& tag_data = (*tables)[num_prefixes];
+  if (tag_data.empty()) {
+    std::mt19937 random(num_prefixes);
+    tag_data.resize(8);
+    for (size_t i = 0; i < tag_data.size(); i++) {
+      tag_data[i].first = fmt::format("tag_{}", i);
+      tag_data[i].second.reserve(num_prefixes / tag_data.size() + 1);
+    }
+    for (size_t i = 0; i < num_prefixes; i++) {
+      const uint32_t kind = random() % 20;
+      const uint32_t length = kind < 10 ? 32 : kind < 17 ? 24 : 12 + random() % 12;
+      const uint32_t address = random();
+      tag_data[i % tag_data.size()].second.push_back(Envoy::Network::Address::CidrRange::create(
+          fmt::format("{}.{}.{}.{}/{}", address >> 24, address >> 16 & 0xff, address >> 8 & 0xff,
+                      address & 0xff, length)));
+    }
+  }
+  return tag_data;
+}
+
+// Addresses within and outside the ranges of largeTagData().
+std::vector<Envoy::Network::Address::InstanceConstSharedPtr>
+largeTableAddresses(size_t num_prefixes) {
+  const auto& tag_data = largeTagData(num_prefixes);
+  std::mt19937 random(0);
+  std::vector<Envoy::Network::Address::InstanceConstSharedPtr> addresses;
+  for (size_t i = 0; i < 1024; i++) {
+    if (i % 2 == 0) {
+      const auto& ranges = tag_data[random() % tag_data.size()].second;
+      addresses.push_back(std::make_shared<Envoy::Network::Address::Ipv4Instance>(
+          ranges[random() % ranges.size()].ip()->addressAsString()));
+    } else {
+      const uint32_t address = random();
+      addresses.push_back(std::make_shared<Envoy::Network::Address::Ipv4Instance>(
+          fmt::format("{}.{}.{}.{}", address >> 24, address >> 16 & 0xff, address >> 8 & 0xff,
+                      address & 0xff)));
+    }
+  }
+  return addresses;
+}
+
 } // namespace
 
 namespace Envoy {
@@ -146,4 +202,57 @@ static void lcTrieLookupMinimal(benchmark::State& state) {
 
 BENCHMARK(lcTrieLookupMinimal);
 
+// Builds an IP prefix index of state.range(0) CIDR ranges. The "bytes" counter is the memory the
+// index takes, when built with tcmalloc.
+template <class Index> static void ipPrefixIndexConstructLarge(benchmark::State& state) {
+  if (benchmark::skipExpensiveBenchmarks() && state.range(0) > 100000) {
+    state.SkipWithError("Skipping expensive benchmark");
+    return;
+  }
+  const auto& tag_data = largeTagData(state.range(0));
+
+  uint64_t bytes = 0;
+  for (auto _ : state) {
+    const uint64_t allocated = Memory::Stats::totalCurrentlyAllocated();
+    auto index = std::make_unique<Index>(tag_data);
+    bytes = Memory::Stats::totalCurrentlyAllocated() - allocated;
+    benchmark::DoNotOptimize(index);
+  }
+  state.counters["bytes"] = bytes;
+}
+
+// LcTrie can't hold more than 262,144 CIDR ranges with the default fill factor.
+BENCHMARK_TEMPLATE(ipPrefixIndexConstructLarge, Network::LcTrie::LcTrie<std::string>)
+    ->Arg(100000)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(ipPrefixIndexConstructLarge, Network::Poptrie::Poptrie<std::string>)
+    ->Arg(100000)
+    ->Arg(1000000)
+    ->Arg(5000000)
+    ->Unit(benchmark::kMillisecond);
+
+template <class Index> static void ipPrefixIndexLookupLarge(benchmark::State& state) {
+  if (benchmark::skipExpensiveBenchmarks() && state.range(0) > 100000) {
+    state.SkipWithError("Skipping expensive benchmark");
+    return;
+  }
+  const Index index(largeTagData(state.range(0)));
+  const auto addresses = largeTableAddresses(state.range(0));
+
+  size_t output_tags = 0;
+  for (auto _ : state) {
+    for (const auto& address : addresses) {
+      output_tags += index.getData(address).size();
+    }
+  }
+  benchmark::DoNotOptimize(output_tags);
+  state.SetItemsProcessed(state.iterations() * addresses.size());
+}
+
+BENCHMARK_TEMPLATE(ipPrefixIndexLookupLarge, Network::LcTrie::LcTrie<std::string>)->Arg(100000);
+BENCHMARK_TEMPLATE(ipPrefixIndexLookupLarge, Network::Poptrie::Poptrie<std::string>)
+    ->Arg(100000)
+    ->Arg(1000000)
+    ->Arg(5000000);
+
 } // namespace Envoy
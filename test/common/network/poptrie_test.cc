@@ -0,0 +1,180 @@
+#include <memory>
+#include <random>
+
+#include "source/common/network/address_impl.h"
+#include "source/common/network/cidr_range.h"
+#include "source/common/network/lc_trie.h"
+#include "source/common/network/poptrie.h"
+#include "source/common/network/utility.h"
+
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Network {
+namespace Poptrie {
+
+class PoptrieTest : public testing::Test {
+public:
+  static std::vector<std::pair<std::string, std::vector<Address::CidrRange>>>
+  makeData(const std::vector<std::vector<std::string>>& cidr_range_strings) {
+    std::vector<std::pair<std::string, std::vector<Address::CidrRange>>> data;
+    for (size_t i = 0; i < cidr_range_strings.size(); i++) {
+      std::pair<std::string, std::vector<Address::CidrRange>> ip_tags;
+      ip_tags.first = fmt::format("tag_{0}", i);
+      for (const auto& j : cidr_range_strings[i]) {
+        ip_tags.second.push_back(Address::CidrRange::create(j));
+      }
+      data.push_back(ip_tags);
+    }
+    return data;
+  }
+
+  void setup(const std::vector<std::vector<std::string>>& cidr_range_strings,
+             bool exclusive = false, uint32_t root_bits = 16) {
+    trie_ = std::make_unique<Poptrie<std::string>>(makeData(cidr_range_strings), exclusive,
+                                                   root_bits);
+  }
+
+  static std::vector<std::string> sorted(std::vector<std::string> tags) {
+    std::sort(tags.begin(), tags.end());
+    return tags;
+  }
+
+  void expectIPAndTags(
+      const std::vector<std::pair<std::string, std::vector<std::string>>>& test_output) {
+    for (const auto& kv : test_output) {
+      EXPECT_EQ(sorted(kv.second), sorted(trie_->getData(Utility::parseInternetAddress(kv.first))))
+          << kv.first;
+    }
+  }
+
+  std::unique_ptr<Poptrie<std::string>> trie_;
+};
+
+TEST_F(PoptrieTest, IPv4NestedPrefixes) {
+  for (uint32_t root_bits : {1, 8, 16}) {
+    setup(
+        {
+            {"0.0.0.0/0"},                    // tag_0
+            {"10.0.0.0/8"},                   // tag_1
+            {"10.1.0.0/16", "10.2.0.0/16"},   // tag_2
+            {"10.1.2.0/24"},                  // tag_3
+            {"10.1.2.3/32", "10.1.2.128/25"}, // tag_4
+            {"10.1.0.0/16"},                  // tag_5
+        },
+        false, root_bits);
+    expectIPAndTags({
+        {"1.2.3.4", {"tag_0"}},
+        {"10.0.0.1", {"tag_0", "tag_1"}},
+        {"10.2.200.1", {"tag_0", "tag_1", "tag_2"}},
+        {"10.1.3.1", {"tag_0", "tag_1", "tag_2", "tag_5"}},
+        {"10.1.2.1", {"tag_0", "tag_1", "tag_2", "tag_3", "tag_5"}},
+        {"10.1.2.3", {"tag_0", "tag_1", "tag_2", "tag_3", "tag_4", "tag_5"}},
+        {"10.1.2.200", {"tag_0", "tag_1", "tag_2", "tag_3", "tag_4", "tag_5"}},
+        {"10.1.2.4", {"tag_0", "tag_1", "tag_2", "tag_3", "tag_5"}},
+        {"255.255.255.255", {"tag_0"}},
+        {"::1", {}},
+    });
+  }
+}
+
+TEST_F(PoptrieTest, IPv4Exclusive) {
+  setup(
+      {
+          {"0.0.0.0/0"},   // tag_0
+          {"10.0.0.0/8"},  // tag_1
+          {"10.1.2.3/32"}, // tag_2
+          {"10.1.2.3/32"}, // tag_3
+      },
+      true);
+  expectIPAndTags({
+      {"1.2.3.4", {"tag_0"}},
+      {"10.0.0.1", {"tag_1"}},
+      {"10.1.2.3", {"tag_2", "tag_3"}},
+      {"10.1.2.4", {"tag_1"}},
+  });
+}
+
+TEST_F(PoptrieTest, IPv6) {
+  setup({
+      {"::/0"},                 // tag_0
+      {"2001:db8::/32"},        // tag_1
+      {"2001:db8:0:1::/64"},    // tag_2
+      {"2001:db8:0:1::1/128"},  // tag_3
+      {"2001:db8:ffff::/48"},   // tag_4
+      {"10.0.0.0/8", "::1/128"} // tag_5
+  });
+  expectIPAndTags({
+      {"::1", {"tag_0", "tag_5"}},
+      {"2001:db9::1", {"tag_0"}},
+      {"2001:db8::1", {"tag_0", "tag_1"}},
+      {"2001:db8:0:1::2", {"tag_0", "tag_1", "tag_2"}},
+      {"2001:db8:0:1::1", {"tag_0", "tag_1", "tag_2", "tag_3"}},
+      {"2001:db8:ffff:1::1", {"tag_0", "tag_1", "tag_4"}},
+      {"10.1.1.1", {"tag_5"}},
+      {"11.1.1.1", {}},
+  });
+}
+
+TEST_F(PoptrieTest, Empty) {
+  setup({});
+  expectIPAndTags({{"1.2.3.4", {}}, {"2001:db8::1", {}}});
+}
+
+// Random tables give the same data as LcTrie, for both nested and exclusive matching.
+TEST_F(PoptrieTest, MatchesLcTrie) {
+  std::mt19937 random(1234);
+  for (const bool exclusive : {false, true}) {
+    std::vector<std::vector<std::string>> cidr_range_strings(8);
+    for (int i = 0; i < 2000; ++i) {
+      // Keep the addresses within a few /8s so that ranges nest often.
+      const uint32_t address = (random() % 4) << 24 | (random() & 0xffffff);
+      const uint32_t length = random() % 33;
+      cidr_range_strings[random() % cidr_range_strings.size()].push_back(
+          fmt::format("{}.{}.{}.{}/{}", address >> 24, address >> 16 & 0xff, address >> 8 & 0xff,
+                      address & 0xff, length));
+      const uint32_t ipv6_length = random() % 129;
+      cidr_range_strings[random() % cidr_range_strings.size()].push_back(
+          fmt::format("2001:db8:{:x}:{:x}::{:x}/{}", random() % 4, random() & 0xffff,
+                      random() & 0xffff, ipv6_length));
+    }
+    const auto data = makeData(cidr_range_strings);
+    const Poptrie<std::string> poptrie(data, exclusive);
+    const LcTrie::LcTrie<std::string> lc_trie(data, exclusive);
+
+    std::vector<Address::InstanceConstSharedPtr> addresses;
+    for (int i = 0; i < 5000; ++i) {
+      const uint32_t address = (random() % 4) << 24 | (random() & 0xffffff);
+      addresses.push_back(std::make_shared<Address::Ipv4Instance>(
+          fmt::format("{}.{}.{}.{}", address >> 24, address >> 16 & 0xff, address >> 8 & 0xff,
+                      address & 0xff)));
+      addresses.push_back(std::make_shared<Address::Ipv6Instance>(fmt::format(
+          "2001:db8:{:x}:{:x}::{:x}", random() % 4, random() & 0xffff, random() & 0xffff)));
+    }
+    for (const auto& address : addresses) {
+      EXPECT_EQ(sorted(lc_trie.getData(address)), sorted(poptrie.getData(address)))
+          << address->asString();
+    }
+  }
+}
+
+// Poptrie holds more CIDR ranges than LcTrie can.
+TEST_F(PoptrieTest, MoreRangesThanLcTrie) {
+  std::vector<std::pair<std::string, std::vector<Address::CidrRange>>> data(1);
+  data[0].first = "tag";
+  for (uint32_t i = 0; i < 300000; ++i) {
+    data[0].second.push_back(Address::CidrRange::create(
+        fmt::format("10.{}.{}.{}/32", i >> 16 & 0xff, i >> 8 & 0xff, i & 0xff)));
+  }
+  EXPECT_THROW(LcTrie::LcTrie<std::string>{data}, EnvoyException);
+  const Poptrie<std::string> poptrie(data);
+  EXPECT_EQ(std::vector<std::string>{"tag"},
+            poptrie.getData(Utility::parseInternetAddress("10.4.147.223")));
+  EXPECT_TRUE(poptrie.getData(Utility::parseInternetAddress("10.4.147.224")).empty());
+}
+
+} // namespace Poptrie
+} // namespace Network
+} // namespace Envoy
@@ -28,8 +28,11 @@
 
 #include "gtest/gtest.h"
 
+using testing::_;
 using testing::DoAll;
 using testing::Eq;
+using testing::Invoke;
+using testing::NiceMock;
 using testing::Return;
 
 namespace Envoy {
@@ -784,6 +787,105 @@ TEST(ResolvedUdpSocketConfig, Warning) {
       ResolvedUdpSocketConfig resolved_config(envoy::config::core::v3::UdpSocketConfig(), true));
 }
 
+// GRO reads are split into gso_size segments that remain valid after the read returns.
+TEST(NetworkUtility, ReadFromSocketGroSegments) {
+  const std::string payload = "aaaabbbbcc";
+  auto address = Network::Test::getCanonicalLoopbackAddress(Address::IpVersion::v4);
+  NiceMock<MockIoHandle> handle;
+  EXPECT_CALL(handle, recvmsg(_, 1, _, _))
+      .WillOnce(Invoke([&](Buffer::RawSlice* slices, const uint64_t, uint32_t,
+                           IoHandle::RecvMsgOutput& output) {
+        EXPECT_GE(slices[0].len_, payload.size());
+        memcpy(slices[0].mem_, payload.data(), payload.size());
+        output.msg_[0].local_address_ = address;
+        output.msg_[0].peer_address_ = address;
+        output.msg_[0].msg_len_ = payload.size();
+        output.msg_[0].gso_size_ = 4;
+        return Api::IoCallUint64Result(payload.size(),
+                                       Api::IoErrorPtr(nullptr, [](Api::IoError*) {}));
+      }));
+
+  NiceMock<MockUdpPacketProcessor> processor;
+  ON_CALL(processor, maxDatagramSize()).WillByDefault(Return(1500));
+  std::vector<Buffer::InstancePtr> segments;
+  EXPECT_CALL(processor, processPacket(_, _, _, _))
+      .Times(3)
+      .WillRepeatedly(Invoke([&](Address::InstanceConstSharedPtr, Address::InstanceConstSharedPtr,
+                                 Buffer::InstancePtr buffer,
+                                 MonotonicTime) { segments.push_back(std::move(buffer)); }));
+
+  uint32_t packets_dropped = 0;
+  auto result = Utility::readFromSocket(handle, *address, processor,
+                                        MonotonicTime(std::chrono::seconds(0)), true,
+                                        &packets_dropped);
+  EXPECT_TRUE(result.ok());
+
+  ASSERT_EQ(3, segments.size());
+  EXPECT_EQ("aaaa", segments[0]->toString());
+  EXPECT_EQ("bbbb", segments[1]->toString());
+  EXPECT_EQ("cc", segments[2]->toString());
+
+  // Segments below GRO_SEGMENT_COPY_THRESHOLD are copied out of the receive buffer.
+  segments[1].reset();
+  EXPECT_EQ("aaaa", segments[0]->toString());
+  segments[0].reset();
+  EXPECT_EQ("cc", segments[2]->toString());
+}
+
+TEST(NetworkUtility, ReadFromSocketGroLargeSegmentsReferenceReceiveBuffer) {
+  const uint64_t gso_size = GRO_SEGMENT_COPY_THRESHOLD;
+  const std::string payload =
+      std::string(gso_size, 'a') + std::string(gso_size, 'b') + std::string(10, 'c');
+  auto address = Network::Test::getCanonicalLoopbackAddress(Address::IpVersion::v4);
+  NiceMock<MockIoHandle> handle;
+  EXPECT_CALL(handle, recvmsg(_, 1, _, _))
+      .WillOnce(Invoke([&](Buffer::RawSlice* slices, const uint64_t, uint32_t,
+                           IoHandle::RecvMsgOutput& output) {
+        EXPECT_GE(slices[0].len_, payload.size());
+        memcpy(slices[0].mem_, payload.data(), payload.size());
+        output.msg_[0].local_address_ = address;
+        output.msg_[0].peer_address_ = address;
+        output.msg_[0].msg_len_ = payload.size();
+        output.msg_[0].gso_size_ = gso_size;
+        return Api::IoCallUint64Result(payload.size(),
+                                       Api::IoErrorPtr(nullptr, [](Api::IoError*) {}));
+      }));
+
+  NiceMock<MockUdpPacketProcessor> processor;
+  ON_CALL(processor, maxDatagramSize()).WillByDefault(Return(1500));
+  std::vector<Buffer::InstancePtr> segments;
+  EXPECT_CALL(processor, processPacket(_, _, _, _))
+      .Times(3)
+      .WillRepeatedly(Invoke([&](Address::InstanceConstSharedPtr, Address::InstanceConstSharedPtr,
+                                 Buffer::InstancePtr buffer,
+                                 MonotonicTime) { segments.push_back(std::move(buffer)); }));
+
+  uint32_t packets_dropped = 0;
+  auto result = Utility::readFromSocket(handle, *address, processor,
+                                        MonotonicTime(std::chrono::seconds(0)), true,
+                                        &packets_dropped);
+  EXPECT_TRUE(result.ok());
+
+  ASSERT_EQ(3, segments.size());
+  EXPECT_EQ(std::string(gso_size, 'a'), segments[0]->toString());
+  EXPECT_EQ(std::string(gso_size, 'b'), segments[1]->toString());
+  EXPECT_EQ(std::string(10, 'c'), segments[2]->toString());
+
+  // The full sized segments are adjacent views into the same receive buffer, while the short
+  // trailing segment is a copy.
+  const auto* first = static_cast<const uint8_t*>(segments[0]->frontSlice().mem_);
+  const auto* second = static_cast<const uint8_t*>(segments[1]->frontSlice().mem_);
+  const auto* third = static_cast<const uint8_t*>(segments[2]->frontSlice().mem_);
+  EXPECT_EQ(first + gso_size, second);
+  EXPECT_NE(second + gso_size, third);
+
+  // Segments may be released in any order.
+  segments[1].reset();
+  EXPECT_EQ(std::string(gso_size, 'a'), segments[0]->toString());
+  segments[2].reset();
+  EXPECT_EQ(std::string(gso_size, 'a'), segments[0]->toString());
+}
+
 #ifndef WIN32
 TEST(PacketLoss, LossTest) {
   // Create and bind a UDP socket.
@@ -0,0 +1,119 @@
+#include "envoy/config/cluster/v3/cluster.pb.h"
+
+#include "source/common/protobuf/deterministic_hash.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace DeterministicProtoHash {
+namespace {
+
+envoy::config::cluster::v3::Cluster makeCluster() {
+  envoy::config::cluster::v3::Cluster cluster;
+  cluster.set_name("cluster");
+  cluster.mutable_connect_timeout()->set_seconds(5);
+  cluster.set_lb_policy(envoy::config::cluster::v3::Cluster::RING_HASH);
+  cluster.mutable_per_connection_buffer_limit_bytes()->set_value(1024);
+  cluster.add_dns_resolvers()->mutable_socket_address()->set_address("1.2.3.4");
+  cluster.add_dns_resolvers()->mutable_socket_address()->set_address("5.6.7.8");
+  return cluster;
+}
+
+TEST(DeterministicHashTest, EqualMessagesHashEqual) {
+  EXPECT_EQ(hash(makeCluster()), hash(makeCluster()));
+  EXPECT_EQ(hash(envoy::config::cluster::v3::Cluster()),
+            hash(envoy::config::cluster::v3::Cluster()));
+}
+
+TEST(DeterministicHashTest, FieldChangesChangeHash) {
+  const uint64_t base = hash(makeCluster());
+
+  envoy::config::cluster::v3::Cluster cluster = makeCluster();
+  cluster.set_name("other");
+  EXPECT_NE(base, hash(cluster));
+
+  cluster = makeCluster();
+  cluster.mutable_connect_timeout()->set_seconds(6);
+  EXPECT_NE(base, hash(cluster));
+
+  cluster = makeCluster();
+  cluster.set_lb_policy(envoy::config::cluster::v3::Cluster::MAGLEV);
+  EXPECT_NE(base, hash(cluster));
+
+  cluster = makeCluster();
+  cluster.mutable_per_connection_buffer_limit_bytes()->set_value(0);
+  EXPECT_NE(base, hash(cluster));
+
+  cluster = makeCluster();
+  cluster.set_respect_dns_ttl(true);
+  EXPECT_NE(base, hash(cluster));
+
+  // Repeated fields are ordered.
+  cluster = makeCluster();
+  cluster.mutable_dns_resolvers()->SwapElements(0, 1);
+  EXPECT_NE(base, hash(cluster));
+
+  // Different message types with the same contents differ.
+  EXPECT_NE(hash(ProtobufWkt::UInt32Value()), hash(ProtobufWkt::UInt64Value()));
+}
+
+TEST(DeterministicHashTest, DefaultScalarsAreUnset) {
+  // Setting a proto3 scalar to its default is indistinguishable from not setting it.
+  envoy::config::cluster::v3::Cluster cluster = makeCluster();
+  cluster.set_alt_stat_name("");
+  EXPECT_EQ(hash(makeCluster()), hash(cluster));
+}
+
+TEST(DeterministicHashTest, MapOrderDoesNotMatter) {
+  ProtobufWkt::Struct s1;
+  (*s1.mutable_fields())["a"].set_string_value("x");
+  (*s1.mutable_fields())["b"].set_number_value(1);
+  (*s1.mutable_fields())["c"].set_bool_value(true);
+
+  ProtobufWkt::Struct s2;
+  (*s2.mutable_fields())["c"].set_bool_value(true);
+  (*s2.mutable_fields())["b"].set_number_value(1);
+  (*s2.mutable_fields())["a"].set_string_value("x");
+  EXPECT_EQ(hash(s1), hash(s2));
+
+  (*s2.mutable_fields())["a"].set_string_value("y");
+  EXPECT_NE(hash(s1), hash(s2));
+}
+
+TEST(DeterministicHashTest, AnyIsHashedByContents) {
+  ProtobufWkt::Struct s;
+  (*s.mutable_fields())["ab"].set_string_value("fgh");
+  (*s.mutable_fields())["cde"].set_string_value("ij");
+
+  ProtobufWkt::Any a1;
+  a1.PackFrom(s);
+  // Two serializations of the same Struct, with the map entries in either order.
+  ProtobufWkt::Any a2 = a1;
+  a2.set_value("\n\v\n\x03" "cde\x12\x04\x1a\x02ij\n\v\n\x02" "ab\x12\x05\x1a\x03" "fgh");
+  ProtobufWkt::Any a3 = a1;
+  a3.set_value("\n\v\n\x02" "ab\x12\x05\x1a\x03" "fgh\n\v\n\x03" "cde\x12\x04\x1a\x02ij");
+  EXPECT_EQ(hash(a1), hash(a2));
+  EXPECT_EQ(hash(a1), hash(a3));
+  EXPECT_NE(hash(s), hash(a1));
+
+  // Anys nested in messages are unpacked too.
+  envoy::config::cluster::v3::Cluster c1 = makeCluster();
+  (*c1.mutable_typed_extension_protocol_options())["ext"] = a1;
+  envoy::config::cluster::v3::Cluster c2 = makeCluster();
+  (*c2.mutable_typed_extension_protocol_options())["ext"] = a2;
+  EXPECT_EQ(hash(c1), hash(c2));
+}
+
+TEST(DeterministicHashTest, UnknownAnyIsHashedByBytes) {
+  ProtobufWkt::Any a1;
+  a1.set_type_url("type.googleapis.com/unknown.Type");
+  a1.set_value("abc");
+  ProtobufWkt::Any a2 = a1;
+  EXPECT_EQ(hash(a1), hash(a2));
+  a2.set_value("abd");
+  EXPECT_NE(hash(a1), hash(a2));
+}
+
+} // namespace
+} // namespace DeterministicProtoHash
+} // namespace Envoy
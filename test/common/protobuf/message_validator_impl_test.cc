@@ -56,6 +56,18 @@ TEST(StrictValidationVisitorImpl, UnknownField) {
                             "Protobuf message (foo) has unknown fields");
 }
 
+// The concurrent validation visitor throws on anything that needs the main thread.
+TEST(ConcurrentValidationVisitorImpl, ThrowsOnFieldsNeedingMainThread) {
+  ConcurrentValidationVisitorImpl concurrent_validation_visitor(false);
+  EXPECT_FALSE(concurrent_validation_visitor.skipValidation());
+  EXPECT_FALSE(concurrent_validation_visitor.runtime().has_value());
+  EXPECT_THROW(concurrent_validation_visitor.onUnknownField("foo"), UnknownProtoFieldException);
+  EXPECT_THROW(concurrent_validation_visitor.onDeprecatedField("foo", true),
+               DeprecatedProtoFieldException);
+  EXPECT_THROW(concurrent_validation_visitor.onWorkInProgress("foo"), EnvoyException);
+  EXPECT_TRUE(ConcurrentValidationVisitorImpl(true).skipValidation());
+}
+
 } // namespace
 } // namespace ProtobufMessage
 } // namespace Envoy
@@ -0,0 +1,67 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include "envoy/config/listener/v3/listener.pb.h"
+
+#include "source/common/protobuf/deterministic_hash.h"
+#include "source/common/protobuf/utility.h"
+
+#include "test/test_common/test_runtime.h"
+
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+
+// Builds a listener resembling a large LDS resource: num_chains filter chains,
+// each matching on a few server names and holding a filter whose typed config
+// is an Any with a map-valued payload.
+static envoy::config::listener::v3::Listener makeListener(int num_chains) {
+  envoy::config::listener::v3::Listener listener;
+  listener.set_name("listener");
+  listener.mutable_address()->mutable_socket_address()->set_address("0.0.0.0");
+  listener.mutable_address()->mutable_socket_address()->set_port_value(443);
+  for (int i = 0; i < num_chains; ++i) {
+    auto* chain = listener.add_filter_chains();
+    chain->set_name(absl::StrCat("chain_", i));
+    auto* match = chain->mutable_filter_chain_match();
+    match->mutable_destination_port()->set_value(8000 + i);
+    for (int j = 0; j < 4; ++j) {
+      match->add_server_names(absl::StrCat("host", i, "-", j, ".example.com"));
+    }
+    ProtobufWkt::Struct config;
+    for (int j = 0; j < 8; ++j) {
+      (*config.mutable_fields())[absl::StrCat("key", j)].set_string_value(
+          absl::StrCat("value", i, "-", j));
+    }
+    auto* filter = chain->add_filters();
+    filter->set_name("envoy.filters.network.test");
+    filter->mutable_typed_config()->PackFrom(config);
+  }
+  return listener;
+}
+
+// Hashes with the TextFormat-based implementation of MessageUtil::hash().
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_MessageUtilHashTextFormat(benchmark::State& state) {
+  TestScopedRuntime scoped_runtime;
+  scoped_runtime.mergeValues({{"envoy.restart_features.use_fast_protobuf_hash", "false"}});
+  const envoy::config::listener::v3::Listener listener = makeListener(state.range(0));
+  for (auto _ : state) { // NOLINT
+    benchmark::DoNotOptimize(MessageUtil::hash(listener));
+  }
+}
+BENCHMARK(BM_MessageUtilHashTextFormat)->Arg(10)->Arg(1000)->Unit(benchmark::kMicrosecond);
+
+// Hashes with DeterministicProtoHash::hash(), the default implementation of
+// MessageUtil::hash().
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_DeterministicProtoHash(benchmark::State& state) {
+  const envoy::config::listener::v3::Listener listener = makeListener(state.range(0));
+  for (auto _ : state) { // NOLINT
+    benchmark::DoNotOptimize(DeterministicProtoHash::hash(listener));
+  }
+}
+BENCHMARK(BM_DeterministicProtoHash)->Arg(10)->Arg(1000)->Unit(benchmark::kMicrosecond);
+
+} // namespace Envoy
@@ -5,6 +5,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "envoy/common/hashable.h"
@@ -35,6 +36,7 @@
 #include "test/test_common/printers.h"
 #include "test/test_common/registry.h"
 #include "test/test_common/test_runtime.h"
+#include "test/test_common/thread_factory_for_test.h"
 #include "test/test_common/utility.h"
 
 #include "gmock/gmock.h"
@@ -5198,6 +5200,193 @@ virtual_hosts:
       "route foo");
 }
 
+TEST_F(RouteMatcherTest, LazyVirtualHostCompilation) {
+  const std::string yaml = R"EOF(
+name: foo
+lazy_virtual_host_compilation: {}
+virtual_hosts:
+- name: www
+  domains: ["www.lyft.com"]
+  routes:
+  - match: { prefix: "/" }
+    route: { cluster: www }
+- name: wildcard
+  domains: ["*.lyft.com"]
+  routes:
+  - match: { prefix: "/" }
+    route: { cluster: wildcard }
+- name: default
+  domains: ["*"]
+  routes:
+  - match: { prefix: "/" }
+    route: { cluster: default }
+  )EOF";
+
+  TestConfigImpl config(parseRouteConfigurationFromYaml(yaml), factory_context_, false);
+  const RouteConstSharedPtr route = config.route(genHeaders("www.lyft.com", "/", "GET"), 0);
+  EXPECT_EQ("www", route->routeEntry()->clusterName());
+  EXPECT_EQ("wildcard",
+            config.route(genHeaders("api.lyft.com", "/", "GET"), 0)->routeEntry()->clusterName());
+  EXPECT_EQ("default",
+            config.route(genHeaders("envoyproxy.io", "/", "GET"), 0)->routeEntry()->clusterName());
+  // The compiled virtual host is reused by later requests.
+  EXPECT_EQ(route, config.route(genHeaders("www.lyft.com", "/", "GET"), 0));
+}
+
+TEST_F(RouteMatcherTest, LazyVirtualHostCompilationEvictsVirtualHosts) {
+  const std::string yaml = R"EOF(
+name: foo
+lazy_virtual_host_compilation:
+  max_compiled_virtual_hosts: 1
+virtual_hosts:
+- name: www
+  domains: ["www.lyft.com"]
+  routes:
+  - match: { prefix: "/" }
+    route: { cluster: www }
+- name: api
+  domains: ["api.lyft.com"]
+  routes:
+  - match: { prefix: "/" }
+    route: { cluster: api }
+  )EOF";
+
+  TestConfigImpl config(parseRouteConfigurationFromYaml(yaml), factory_context_, false);
+  const RouteConstSharedPtr route = config.route(genHeaders("www.lyft.com", "/", "GET"), 0);
+  EXPECT_EQ("www", route->routeEntry()->clusterName());
+  EXPECT_EQ("api",
+            config.route(genHeaders("api.lyft.com", "/", "GET"), 0)->routeEntry()->clusterName());
+  // Compiling the api virtual host evicted the www one, so it's compiled again. Routes of evicted
+  // virtual hosts stay usable.
+  const RouteConstSharedPtr recompiled_route =
+      config.route(genHeaders("www.lyft.com", "/", "GET"), 0);
+  EXPECT_NE(route, recompiled_route);
+  EXPECT_EQ("www", recompiled_route->routeEntry()->clusterName());
+  EXPECT_EQ("www", route->routeEntry()->clusterName());
+}
+
+TEST_F(RouteMatcherTest, LazyVirtualHostCompilationFailure) {
+  const std::string yaml = R"EOF(
+name: foo
+lazy_virtual_host_compilation: {}
+virtual_hosts:
+- name: www
+  domains: ["www.lyft.com"]
+  routes:
+  - match: { prefix: "/" }
+    route: { cluster: www }
+- name: invalid
+  domains: ["api.lyft.com"]
+  routes:
+  - match: { safe_regex: { regex: "(+invalid regex)" } }
+    route: { cluster: api }
+  )EOF";
+
+  // Lazily compiled virtual hosts are still validated with the route table, so the invalid one
+  // rejects it rather than getting no route.
+  EXPECT_THROW_WITH_REGEX(
+      TestConfigImpl(parseRouteConfigurationFromYaml(yaml), factory_context_, false),
+      EnvoyException, "no argument for repetition operator");
+
+  // Virtual hosts are compiled with the route table when clusters are validated.
+  factory_context_.cluster_manager_.initializeClusters({"www", "api"}, {});
+  EXPECT_THROW_WITH_REGEX(
+      TestConfigImpl(parseRouteConfigurationFromYaml(yaml), factory_context_, true), EnvoyException,
+      "no argument for repetition operator");
+}
+
+TEST_F(RouteMatcherTest, LazyVirtualHostCompilationExcludesExtensions) {
+  const auto can_compile_lazily = [](const std::string& yaml) {
+    envoy::config::route::v3::VirtualHost virtual_host;
+    TestUtility::loadFromYaml(
+        absl::StrReplaceAll(
+            yaml, {{"{ name: envoy.test }", "{ name: envoy.extension, typed_config: "
+                                 "{ '@type': type.googleapis.com/google.protobuf.Struct } }"}}),
+        virtual_host);
+    return LazyVirtualHostCompiler::canCompileLazily(virtual_host);
+  };
+
+  EXPECT_TRUE(can_compile_lazily(R"EOF(
+name: www
+domains: ["www.lyft.com"]
+retry_policy: { retry_on: "5xx" }
+routes:
+- match: { prefix: "/" }
+  route: { cluster: www, retry_policy: { retry_on: "5xx" } }
+  )EOF"));
+
+  // Virtual hosts creating extensions other than per filter configs are compiled with the route
+  // table, on the main thread.
+  EXPECT_FALSE(can_compile_lazily(R"EOF(
+name: www
+domains: ["www.lyft.com"]
+retry_policy: { retry_host_predicate: [{ name: envoy.test }] }
+  )EOF"));
+  EXPECT_FALSE(can_compile_lazily(R"EOF(
+name: www
+domains: ["www.lyft.com"]
+retry_policy: { retry_priority: { name: envoy.test } }
+  )EOF"));
+  EXPECT_FALSE(can_compile_lazily(R"EOF(
+name: www
+domains: ["www.lyft.com"]
+routes:
+- match: { prefix: "/" }
+  route: { cluster: www, retry_policy: { retry_options_predicates: [{ name: envoy.test }] } }
+  )EOF"));
+  EXPECT_FALSE(can_compile_lazily(R"EOF(
+name: www
+domains: ["www.lyft.com"]
+routes:
+- match: { prefix: "/" }
+  route: { cluster: www, internal_redirect_policy: { predicates: [{ name: envoy.test }] } }
+  )EOF"));
+  EXPECT_FALSE(can_compile_lazily(R"EOF(
+name: www
+domains: ["www.lyft.com"]
+routes:
+- match: { prefix: "/" }
+  route: { cluster: www, early_data_policy: { name: envoy.test } }
+  )EOF"));
+  EXPECT_FALSE(can_compile_lazily(R"EOF(
+name: www
+domains: ["www.lyft.com"]
+routes:
+- match: { path_match_policy: { name: envoy.test } }
+  route: { cluster: www }
+  )EOF"));
+  EXPECT_FALSE(can_compile_lazily(R"EOF(
+name: www
+domains: ["www.lyft.com"]
+routes:
+- match: { prefix: "/" }
+  route: { cluster: www, path_rewrite_policy: { name: envoy.test } }
+  )EOF"));
+}
+
+TEST_F(RouteMatcherTest, LazyVirtualHostCompilationPerFilterConfigFailure) {
+  const std::string yaml = R"EOF(
+name: foo
+lazy_virtual_host_compilation: {}
+virtual_hosts:
+- name: www
+  domains: ["www.lyft.com"]
+  routes:
+  - match: { prefix: "/" }
+    route: { cluster: www }
+    typed_per_filter_config:
+      filter.unknown:
+        "@type": type.googleapis.com/google.protobuf.BoolValue
+  )EOF";
+
+  // Per filter configs are created with the route table, so their errors reject it.
+  EXPECT_THROW_WITH_MESSAGE(
+      TestConfigImpl(parseRouteConfigurationFromYaml(yaml), factory_context_, false),
+      EnvoyException,
+      "Didn't find a registered implementation for 'filter.unknown' with type URL: "
+      "'google.protobuf.BoolValue'");
+}
+
 TEST_F(RouteMatcherTest, TestDuplicateWildcardDomainConfig) {
   const std::string yaml = R"EOF(
 name: foo
@@ -10163,6 +10352,7 @@ public:
 
   struct DerivedFilterConfig : public RouteSpecificFilterConfig {
     ProtobufWkt::Timestamp config_;
+    ThreadLocal::SlotPtr slot_;
   };
   class TestFilterConfig : public Extensions::HttpFilters::Common::EmptyHttpFilterConfig {
   public:
@@ -10182,12 +10372,18 @@ public:
     std::set<std::string> configTypes() override { return {"google.protobuf.Timestamp"}; }
     Router::RouteSpecificFilterConfigConstSharedPtr
     createRouteSpecificFilterConfig(const Protobuf::Message& message,
-                                    Server::Configuration::ServerFactoryContext&,
+                                    Server::Configuration::ServerFactoryContext& context,
                                     ProtobufMessage::ValidationVisitor&) override {
+      created_on_.push_back(std::this_thread::get_id());
       auto obj = std::make_shared<DerivedFilterConfig>();
       obj->config_.MergeFrom(message);
+      // Like the configs of filters such as Lua, allocate a thread local slot, which is only
+      // possible on the main thread.
+      obj->slot_ = context.threadLocal().allocateSlot();
       return obj;
     }
+
+    std::vector<std::thread::id> created_on_;
   };
   class DefaultTestFilterConfig : public Extensions::HttpFilters::Common::EmptyHttpFilterConfig {
   public:
@@ -10597,6 +10793,67 @@ virtual_hosts:
   checkEach(yaml, 123, expected_traveled_config, "test.filter");
 }
 
+TEST_F(PerFilterConfigsTest, LazyVirtualHostCompilationCreatesConfigsOnMainThread) {
+  const std::string yaml = R"EOF(
+lazy_virtual_host_compilation:
+  max_compiled_virtual_hosts: 1
+virtual_hosts:
+  - name: bar
+    domains: ["www.foo.com"]
+    routes:
+      - match: { prefix: "/" }
+        route:
+          weighted_clusters:
+            clusters:
+              - name: baz
+                weight: 100
+                typed_per_filter_config:
+                  test.filter:
+                    "@type": type.googleapis.com/google.protobuf.Timestamp
+                    value:
+                      seconds: 789
+        typed_per_filter_config:
+          test.filter:
+            "@type": type.googleapis.com/google.protobuf.Timestamp
+            value:
+              seconds: 123
+    typed_per_filter_config:
+      test.filter:
+        "@type": type.googleapis.com/google.protobuf.Timestamp
+        value:
+          seconds: 456
+  - name: qux
+    domains: ["www.qux.com"]
+    routes:
+      - match: { prefix: "/" }
+        route: { cluster: qux }
+)EOF";
+
+  // The per filter configs are created with the route table, on the main thread.
+  const TestConfigImpl config(parseRouteConfigurationFromYaml(yaml), factory_context_, false);
+  EXPECT_THAT(factory_.created_on_, testing::ElementsAre(std::this_thread::get_id(),
+                                                         std::this_thread::get_id(),
+                                                         std::this_thread::get_id()));
+
+  // Compiling the virtual host on a worker thread, including after it's evicted, reuses them.
+  Thread::ThreadPtr worker = Thread::threadFactoryForTest().createThread([&]() {
+    for (int i = 0; i < 2; ++i) {
+      const auto route = config.route(genHeaders("www.foo.com", "/", "GET"), 0);
+      absl::InlinedVector<uint32_t, 3> traveled_cfg;
+      route->traversePerFilterConfig(
+          "test.filter", [&](const Router::RouteSpecificFilterConfig& cfg) {
+            traveled_cfg.push_back(dynamic_cast<const DerivedFilterConfig&>(cfg).config_.seconds());
+          });
+      EXPECT_EQ((absl::InlinedVector<uint32_t, 3>{456, 123, 789}), traveled_cfg);
+      EXPECT_EQ("qux", config.route(genHeaders("www.qux.com", "/", "GET"), 0)
+                           ->routeEntry()
+                           ->clusterName());
+    }
+  });
+  worker->join();
+  EXPECT_EQ(3, factory_.created_on_.size());
+}
+
 TEST_F(PerFilterConfigsTest, RouteLocalTypedConfigWithDirectResponse) {
   const std::string yaml = R"EOF(
 typed_per_filter_config:
@@ -542,6 +542,73 @@ TEST_F(StaticLoaderImplTest, All) {
   testNewOverrides(*loader_, store_);
 }
 
+TEST_F(StaticLoaderImplTest, InternedKeys) {
+  base_ = TestUtility::parseYaml<ProtobufWkt::Struct>(R"EOF(
+    interned.integer: 2
+    interned.double: 4.2
+    interned.boolean: false
+    interned.percent:
+      numerator: 20
+      denominator: HUNDRED
+  )EOF");
+  const InternedKey integer_key = internKey("interned.integer");
+  const InternedKey double_key = internKey("interned.double");
+  const InternedKey boolean_key = internKey("interned.boolean");
+  const InternedKey percent_key = internKey("interned.percent");
+  const InternedKey missing_key = internKey("interned.missing");
+  EXPECT_EQ(integer_key.index(), internKey("interned.integer").index());
+  EXPECT_NE(integer_key.index(), double_key.index());
+  setup();
+
+  const Snapshot& snapshot = loader_->snapshot();
+  EXPECT_EQ(2, snapshot.getInteger(integer_key, 1));
+  EXPECT_EQ(1, snapshot.getInteger(missing_key, 1));
+  EXPECT_EQ(4.2, snapshot.getDouble(double_key, 1.1));
+  EXPECT_FALSE(snapshot.getBoolean(boolean_key, true));
+  EXPECT_TRUE(snapshot.getBoolean(missing_key, true));
+  EXPECT_TRUE(snapshot.featureEnabled(integer_key, 50, 1));
+  EXPECT_FALSE(snapshot.featureEnabled(integer_key, 50, 2));
+  envoy::type::v3::FractionalPercent default_percent;
+  EXPECT_TRUE(snapshot.featureEnabled(percent_key, default_percent, 19));
+  EXPECT_FALSE(snapshot.featureEnabled(percent_key, default_percent, 20));
+
+  // Keys interned after the snapshot was created are looked up by name until the next snapshot.
+  const InternedKey late_key = internKey("interned.late");
+  EXPECT_EQ(1, loader_->snapshot().getInteger(late_key, 1));
+  loader_->mergeValues({{"interned.late", "3"}});
+  EXPECT_EQ(3, loader_->snapshot().getInteger(late_key, 1));
+  loader_->mergeValues({{"interned.integer", "5"}});
+  EXPECT_EQ(5, loader_->snapshot().getInteger(integer_key, 1));
+}
+
+TEST_F(StaticLoaderImplTest, InternedKeysAreReleased) {
+  base_ = TestUtility::parseYaml<ProtobufWkt::Struct>(R"EOF(
+    released.first: 1
+    released.second: 2
+  )EOF");
+  auto first_key = std::make_unique<InternedKey>(internKey("released.first"));
+  const uint32_t first_index = first_key->index();
+  setup();
+  const SnapshotConstSharedPtr snapshot = loader_->threadsafeSnapshot();
+  EXPECT_EQ(1, snapshot->getInteger(*first_key, 0));
+
+  // Once released, the key is no longer interned and its index is reused by the next key.
+  first_key.reset();
+  for (const InternedKeySlot& slot : *internedKeys()) {
+    EXPECT_NE("released.first", slot.name_);
+  }
+  const InternedKey second_key = internKey("released.second");
+  EXPECT_EQ(first_index, second_key.index());
+
+  // Snapshots created while the index belonged to the released key don't confuse the two keys.
+  EXPECT_EQ(2, snapshot->getInteger(second_key, 0));
+  loader_->mergeValues({{"released.second", "3"}});
+  EXPECT_EQ(3, loader_->snapshot().getInteger(second_key, 0));
+
+  // The same view of the keys is shared until they change.
+  EXPECT_EQ(internedKeys(), internedKeys());
+}
+
 #ifdef ENVOY_ENABLE_QUIC
 TEST_F(StaticLoaderImplTest, QuicheReloadableFlags) {
   // Test that Quiche flags can be overwritten via Envoy runtime config.
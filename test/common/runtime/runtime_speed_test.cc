@@ -0,0 +1,124 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include "source/common/common/random_generator.h"
+#include "source/common/runtime/runtime_features.h"
+#include "source/common/runtime/runtime_impl.h"
+#include "source/common/stats/isolated_store_impl.h"
+
+#include "test/benchmark/main.h"
+
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Runtime {
+
+class RuntimeSpeedTest {
+public:
+  explicit RuntimeSpeedTest(uint64_t num_keys)
+      : stats_{ALL_RUNTIME_STATS(POOL_COUNTER_PREFIX(store_, "runtime."),
+                                 POOL_GAUGE_PREFIX(store_, "runtime."))} {
+    ProtobufWkt::Struct values;
+    for (uint64_t i = 0; i < num_keys; ++i) {
+      const std::string key = absl::StrCat("envoy.benchmark.runtime_speed_test.key_", i);
+      (*values.mutable_fields())[key].set_number_value(i % 100);
+      keys_.push_back(key);
+      interned_keys_.push_back(internKey(key));
+    }
+    std::vector<Snapshot::OverrideLayerConstPtr> layers;
+    layers.push_back(std::make_unique<ProtoLayer>("base", values));
+    snapshot_ = std::make_unique<SnapshotImpl>(generator_, stats_, std::move(layers));
+  }
+
+  Stats::IsolatedStoreImpl store_;
+  RuntimeStats stats_;
+  Random::RandomGeneratorImpl generator_;
+  std::vector<std::string> keys_;
+  std::vector<InternedKey> interned_keys_;
+  std::unique_ptr<SnapshotImpl> snapshot_;
+};
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void bmFeatureEnabledByName(benchmark::State& state) {
+  if (benchmark::skipExpensiveBenchmarks() && state.range(0) > 1000) {
+    state.SkipWithError("Skipping expensive benchmark");
+    return;
+  }
+
+  RuntimeSpeedTest context(state.range(0));
+  const Snapshot& snapshot = *context.snapshot_;
+  uint64_t i = 0, enabled = 0;
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    enabled += snapshot.featureEnabled(context.keys_[i % context.keys_.size()], 50, i);
+    ++i;
+  }
+  benchmark::DoNotOptimize(enabled);
+}
+BENCHMARK(bmFeatureEnabledByName)->Arg(10)->Arg(1000)->Arg(100000);
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void bmFeatureEnabledByInternedKey(benchmark::State& state) {
+  if (benchmark::skipExpensiveBenchmarks() && state.range(0) > 1000) {
+    state.SkipWithError("Skipping expensive benchmark");
+    return;
+  }
+
+  RuntimeSpeedTest context(state.range(0));
+  const Snapshot& snapshot = *context.snapshot_;
+  uint64_t i = 0, enabled = 0;
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    enabled +=
+        snapshot.featureEnabled(context.interned_keys_[i % context.interned_keys_.size()], 50, i);
+    ++i;
+  }
+  benchmark::DoNotOptimize(enabled);
+}
+BENCHMARK(bmFeatureEnabledByInternedKey)->Arg(10)->Arg(1000)->Arg(100000);
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void bmGetIntegerByName(benchmark::State& state) {
+  if (benchmark::skipExpensiveBenchmarks() && state.range(0) > 1000) {
+    state.SkipWithError("Skipping expensive benchmark");
+    return;
+  }
+
+  RuntimeSpeedTest context(state.range(0));
+  const Snapshot& snapshot = *context.snapshot_;
+  uint64_t i = 0, sum = 0;
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    sum += snapshot.getInteger(context.keys_[i++ % context.keys_.size()], 0);
+  }
+  benchmark::DoNotOptimize(sum);
+}
+BENCHMARK(bmGetIntegerByName)->Arg(10)->Arg(1000)->Arg(100000);
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void bmGetIntegerByInternedKey(benchmark::State& state) {
+  if (benchmark::skipExpensiveBenchmarks() && state.range(0) > 1000) {
+    state.SkipWithError("Skipping expensive benchmark");
+    return;
+  }
+
+  RuntimeSpeedTest context(state.range(0));
+  const Snapshot& snapshot = *context.snapshot_;
+  uint64_t i = 0, sum = 0;
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    sum += snapshot.getInteger(context.interned_keys_[i++ % context.interned_keys_.size()], 0);
+  }
+  benchmark::DoNotOptimize(sum);
+}
+BENCHMARK(bmGetIntegerByInternedKey)->Arg(10)->Arg(1000)->Arg(100000);
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void bmRuntimeFeatureEnabled(benchmark::State& state) {
+  uint64_t enabled = 0;
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    enabled += runtimeFeatureEnabled("envoy.reloadable_features.test_feature_true");
+  }
+  benchmark::DoNotOptimize(enabled);
+}
+BENCHMARK(bmRuntimeFeatureEnabled);
+
+} // namespace Runtime
+} // namespace Envoy
@@ -5,6 +5,7 @@
 #include "envoy/stats/sink.h"
 
 #include "source/common/stats/allocator_impl.h"
+#include "source/common/stats/slab_allocator.h"
 
 #include "test/common/stats/stat_test_utility.h"
 #include "test/test_common/logging.h"
@@ -86,6 +87,91 @@ TEST_F(AllocatorImplTest, GaugesWithSameName) {
   EXPECT_EQ(0, g2->value());
 }
 
+TEST_F(AllocatorImplTest, GaugeLatchChanged) {
+  GaugeSharedPtr gauge =
+      alloc_.makeGauge(makeStat("gauge.name"), StatName(), {}, Gauge::ImportMode::Accumulate);
+  EXPECT_FALSE(gauge->latchChanged());
+
+  gauge->set(5);
+  EXPECT_TRUE(gauge->latchChanged());
+  EXPECT_FALSE(gauge->latchChanged());
+
+  // Setting the value the gauge already has, or adding 0, is not a change.
+  gauge->set(5);
+  gauge->add(0);
+  EXPECT_FALSE(gauge->latchChanged());
+  EXPECT_TRUE(gauge->used());
+
+  gauge->inc();
+  EXPECT_TRUE(gauge->latchChanged());
+  gauge->dec();
+  EXPECT_TRUE(gauge->latchChanged());
+  gauge->setParentValue(3);
+  EXPECT_TRUE(gauge->latchChanged());
+  gauge->setParentValue(3);
+  EXPECT_FALSE(gauge->latchChanged());
+  EXPECT_EQ(8, gauge->value());
+}
+
+// In compact storage mode, counters and gauges hold their names and tags inline
+// in a slab record, and behave just like heap-allocated stats.
+TEST_F(AllocatorImplTest, CompactStorage) {
+  AllocatorImpl alloc(symbol_table_, true);
+  const SlabAllocator& slabs = alloc.slabAllocator();
+  const StatNameTagVector tags{{makeStat("tag1"), makeStat("value1")},
+                               {makeStat("tag2"), makeStat("value2")}};
+
+  CounterSharedPtr counter =
+      alloc.makeCounter(makeStat("counter.value1.value2"), makeStat("counter"), tags);
+  EXPECT_EQ(counter.get(),
+            alloc.makeCounter(makeStat("counter.value1.value2"), makeStat("counter"), tags).get());
+  EXPECT_EQ("counter.value1.value2", counter->name());
+  EXPECT_EQ("counter", counter->tagExtractedName());
+  EXPECT_EQ((TagVector{{"tag1", "value1"}, {"tag2", "value2"}}), counter->tags());
+  counter->add(5);
+  EXPECT_TRUE(counter->used());
+  EXPECT_EQ(5, counter->value());
+  EXPECT_EQ(5, counter->latch());
+
+  GaugeSharedPtr gauge =
+      alloc.makeGauge(makeStat("gauge.value1"), makeStat("gauge"), {tags[0]},
+                      Gauge::ImportMode::HiddenAccumulate);
+  EXPECT_EQ("gauge.value1", gauge->name());
+  EXPECT_EQ("gauge", gauge->tagExtractedName());
+  EXPECT_EQ((TagVector{{"tag1", "value1"}}), gauge->tags());
+  EXPECT_EQ(Gauge::ImportMode::HiddenAccumulate, gauge->importMode());
+  EXPECT_TRUE(gauge->hidden());
+  gauge->set(7);
+  EXPECT_EQ(7, gauge->value());
+  EXPECT_GT(slabs.bytesAllocated(), 0);
+
+  // A stat that does not fit in a slab slot falls back to the heap.
+  const std::string long_name(2 * SlabAllocator::MaxSlotSize, 'x');
+  const uint64_t slab_bytes_before_long = slabs.bytesAllocated();
+  CounterSharedPtr long_counter = alloc.makeCounter(makeStat(long_name), StatName(), {});
+  EXPECT_EQ(long_name, long_counter->name());
+  EXPECT_EQ(slab_bytes_before_long, slabs.bytesAllocated());
+
+  // Freeing the stats returns their slots, and their symbols.
+  counter.reset();
+  gauge.reset();
+  long_counter.reset();
+  EXPECT_EQ(0, slabs.bytesAllocated());
+}
+
+TEST_F(AllocatorImplTest, TextReadoutLatchChanged) {
+  TextReadoutSharedPtr text_readout = alloc_.makeTextReadout(makeStat("text.name"), StatName(), {});
+  EXPECT_FALSE(text_readout->latchChanged());
+
+  text_readout->set("hello");
+  EXPECT_TRUE(text_readout->latchChanged());
+  EXPECT_FALSE(text_readout->latchChanged());
+  text_readout->set("hello");
+  EXPECT_FALSE(text_readout->latchChanged());
+  text_readout->set("world");
+  EXPECT_TRUE(text_readout->latchChanged());
+}
+
 // Test for a race-condition where we may decrement the ref-count of a stat to
 // zero at the same time as we are allocating another instance of that
 // stat. This test reproduces that race organically by having a 12 threads each
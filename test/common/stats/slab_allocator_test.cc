@@ -0,0 +1,126 @@
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "source/common/stats/slab_allocator.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Stats {
+namespace {
+
+uintptr_t slabOf(void* slot) {
+  return reinterpret_cast<uintptr_t>(slot) & ~static_cast<uintptr_t>(SlabAllocator::SlabSize - 1);
+}
+
+TEST(SlabAllocatorTest, AllocateAndReuse) {
+  SlabAllocator slabs;
+  EXPECT_EQ(0, slabs.bytesReserved());
+
+  void* slot1 = slabs.allocate(20);
+  void* slot2 = slabs.allocate(24);
+  EXPECT_NE(slot1, slot2);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(slot1) % SlabAllocator::SlotAlignment);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(slot2) % SlabAllocator::SlotAlignment);
+  // Both sizes round up to the same 24-byte slot, carved from the same slab.
+  EXPECT_EQ(48, slabs.bytesAllocated());
+  EXPECT_EQ(SlabAllocator::SlabSize, slabs.bytesReserved());
+  memset(slot1, 0xff, 20);
+  memset(slot2, 0xff, 24);
+
+  SlabAllocator::deallocate(slot1);
+  EXPECT_EQ(24, slabs.bytesAllocated());
+  // A freed slot is handed out again for the next allocation of its size.
+  EXPECT_EQ(slot1, slabs.allocate(17));
+
+  // Another size gets a slab of its own.
+  void* slot3 = slabs.allocate(100);
+  EXPECT_NE(slabOf(slot1), slabOf(slot3));
+  EXPECT_EQ(2 * SlabAllocator::SlabSize, slabs.bytesReserved());
+
+  SlabAllocator::deallocate(slot1);
+  SlabAllocator::deallocate(slot2);
+  SlabAllocator::deallocate(slot3);
+  EXPECT_EQ(0, slabs.bytesAllocated());
+}
+
+// Slabs whose slots have all been freed are returned to the system, except for
+// one empty slab per size.
+TEST(SlabAllocatorTest, FreeEmptySlabs) {
+  SlabAllocator slabs;
+
+  // Enough slots of the largest size to need several slabs.
+  const uint32_t num_slots = 4 * SlabAllocator::SlabSize / SlabAllocator::MaxSlotSize;
+  absl::flat_hash_set<void*> distinct;
+  std::vector<uintptr_t> slab_order;
+  absl::flat_hash_map<uintptr_t, std::vector<void*>> slots_by_slab;
+  for (uint32_t i = 0; i < num_slots; ++i) {
+    void* slot = slabs.allocate(SlabAllocator::MaxSlotSize);
+    memset(slot, 0, SlabAllocator::MaxSlotSize);
+    distinct.insert(slot);
+    std::vector<void*>& slab_slots = slots_by_slab[slabOf(slot)];
+    if (slab_slots.empty()) {
+      slab_order.push_back(slabOf(slot));
+    }
+    slab_slots.push_back(slot);
+  }
+  EXPECT_EQ(num_slots, distinct.size());
+  EXPECT_EQ(num_slots * SlabAllocator::MaxSlotSize, slabs.bytesAllocated());
+  const uint64_t num_slabs = slab_order.size();
+  ASSERT_GE(num_slabs, 5);
+  EXPECT_EQ(num_slabs * SlabAllocator::SlabSize, slabs.bytesReserved());
+
+  // Emptying a slab keeps it, to be reused before allocating a new slab.
+  for (void* slot : slots_by_slab[slab_order[0]]) {
+    SlabAllocator::deallocate(slot);
+  }
+  EXPECT_EQ(num_slabs * SlabAllocator::SlabSize, slabs.bytesReserved());
+
+  // As an empty slab is already kept, emptying another one frees it.
+  for (void* slot : slots_by_slab[slab_order[1]]) {
+    SlabAllocator::deallocate(slot);
+  }
+  EXPECT_EQ((num_slabs - 1) * SlabAllocator::SlabSize, slabs.bytesReserved());
+
+  for (size_t i = 2; i < slab_order.size(); ++i) {
+    for (void* slot : slots_by_slab[slab_order[i]]) {
+      SlabAllocator::deallocate(slot);
+    }
+  }
+  EXPECT_EQ(0, slabs.bytesAllocated());
+  EXPECT_EQ(SlabAllocator::SlabSize, slabs.bytesReserved());
+
+  // The next allocation is served from the kept slab.
+  void* slot = slabs.allocate(SlabAllocator::MaxSlotSize);
+  EXPECT_EQ(slab_order[0], slabOf(slot));
+  EXPECT_EQ(SlabAllocator::SlabSize, slabs.bytesReserved());
+  SlabAllocator::deallocate(slot);
+}
+
+// A slot freed from a full slab makes the slab available again.
+TEST(SlabAllocatorTest, ReuseSlotOfFullSlab) {
+  SlabAllocator slabs;
+  std::vector<void*> slots{slabs.allocate(SlabAllocator::MaxSlotSize)};
+  while (slabOf(slots.back()) == slabOf(slots.front())) {
+    slots.push_back(slabs.allocate(SlabAllocator::MaxSlotSize));
+  }
+  EXPECT_EQ(2 * SlabAllocator::SlabSize, slabs.bytesReserved());
+
+  SlabAllocator::deallocate(slots.front());
+  // Either slab may serve the allocation, but no new slab is needed.
+  slots.front() = slabs.allocate(SlabAllocator::MaxSlotSize);
+  EXPECT_EQ(2 * SlabAllocator::SlabSize, slabs.bytesReserved());
+
+  for (void* slot : slots) {
+    SlabAllocator::deallocate(slot);
+  }
+  EXPECT_EQ(0, slabs.bytesAllocated());
+  EXPECT_EQ(SlabAllocator::SlabSize, slabs.bytesReserved());
+}
+
+} // namespace
+} // namespace Stats
+} // namespace Envoy
@@ -10,6 +10,7 @@
 #include "test/test_common/utility.h"
 
 #include "absl/hash/hash_testing.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/synchronization/blocking_counter.h"
 #include "gtest/gtest.h"
@@ -100,6 +101,22 @@ TEST_F(StatNameTest, TestArbitrarySymbolRoundtrip) {
   }
 }
 
+TEST_F(StatNameTest, AppendTo) {
+  const std::vector<std::string> stat_names = {"", "x", ".x", "x.", "a..b", "hello.world"};
+  for (auto& stat_name : stat_names) {
+    std::string out = "prefix:";
+    table_.appendTo(makeStat(stat_name), out);
+    EXPECT_EQ(absl::StrCat("prefix:", stat_name), out);
+  }
+
+  // Dynamic segments are decoded in place as well.
+  StatNameDynamicPool dynamic(table_);
+  SymbolTable::StoragePtr joined = table_.join({makeStat("a"), dynamic.add("b.c")});
+  std::string out;
+  table_.appendTo(StatName(joined.get()), out);
+  EXPECT_EQ("a.b.c", out);
+}
+
 TEST_F(StatNameTest, TestEmpty) {
   EXPECT_TRUE(makeStat("").empty());
   EXPECT_FALSE(makeStat("x").empty());
@@ -231,7 +248,6 @@ TEST_F(StatNameTest, TestSuccessfulDecode) {
 class StatNameDeathTest : public StatNameTest {
 public:
   void decodeSymbolVec(const SymbolVec& symbol_vec) {
-    Thread::LockGuard lock(table_.lock_);
     for (Symbol symbol : symbol_vec) {
       table_.fromSymbol(symbol);
     }
@@ -531,20 +547,14 @@ TEST_F(StatNameTest, RacingSymbolCreation) {
   access.setReady();
   accesses.Wait();
 
-  // In a perfect world, we could use reader-locks in the SymbolTable
-  // implementation, and there should be zero additional contentions
-  // after latching 'create_contentions' above. And we can definitely
-  // have this world, but this slows down BM_CreateRace in
-  // symbol_table_speed_test.cc, even on a 72-core machine.
-  //
-  // Thus it is better to avoid symbol-table contention by refactoring
-  // all stat-creation code to symbolize all stat string elements at
-  // construction, as composition does not require a lock.
-  //
-  // See this commit
-  // https://github.com/envoyproxy/envoy/pull/5321/commits/ef712d0f5a11ff49831c1935e8a2ef8a0a935bc9
-  // for a working reader-lock implementation, which would pass this EXPECT:
-  //     EXPECT_EQ(create_contentions, mutex_tracer.numContentions());
+  // Encoding tokens that are already in the SymbolTable only takes the
+  // lock of their shard in shared mode, so the symbol table itself should
+  // not add contentions after latching 'create_contentions' above. We
+  // don't check this, as the ConditionalInitializers that the threads wait
+  // on may themselves be contended. It is still better to avoid touching
+  // the symbol table at all by refactoring stat-creation code to symbolize
+  // all stat string elements at construction, as composition does not
+  // require a lock.
   //
   // Note also that we cannot guarantee there *will* be contentions
   // as a machine or OS is free to run all threads serially.
@@ -599,20 +609,14 @@ TEST_F(StatNameTest, MutexContentionOnExistingSymbols) {
   access.setReady();
   accesses.Wait();
 
-  // In a perfect world, we could use reader-locks in the SymbolTable
-  // implementation, and there should be zero additional contentions
-  // after latching 'create_contentions' above. And we can definitely
-  // have this world, but this slows down BM_CreateRace in
-  // symbol_table_speed_test.cc, even on a 72-core machine.
-  //
-  // Thus it is better to avoid symbol-table contention by refactoring
-  // all stat-creation code to symbolize all stat string elements at
-  // construction, as composition does not require a lock.
-  //
-  // See this commit
-  // https://github.com/envoyproxy/envoy/pull/5321/commits/ef712d0f5a11ff49831c1935e8a2ef8a0a935bc9
-  // for a working reader-lock implementation, which would pass this EXPECT:
-  //     EXPECT_EQ(create_contentions, mutex_tracer.numContentions());
+  // Encoding tokens that are already in the SymbolTable only takes the
+  // lock of their shard in shared mode, so the symbol table itself should
+  // not add contentions after latching 'create_contentions' above. We
+  // don't check this, as the ConditionalInitializers that the threads wait
+  // on may themselves be contended. It is still better to avoid touching
+  // the symbol table at all by refactoring stat-creation code to symbolize
+  // all stat string elements at construction, as composition does not
+  // require a lock.
   //
   // Note also that we cannot guarantee there *will* be contentions
   // as a machine or OS is free to run all threads serially.
@@ -623,6 +627,34 @@ TEST_F(StatNameTest, MutexContentionOnExistingSymbols) {
   }
 }
 
+// Races the removal of symbols dropping their last reference against their
+// re-creation and re-use in other threads.
+TEST_F(StatNameTest, RacingEncodeAndFree) {
+  Thread::ThreadFactory& thread_factory = Thread::threadFactoryForTest();
+  constexpr int num_threads = 16;
+  std::vector<Thread::ThreadPtr> threads;
+  threads.reserve(num_threads);
+  ConditionalInitializer start;
+  for (int i = 0; i < num_threads; ++i) {
+    threads.push_back(thread_factory.createThread([this, i, &start]() {
+      start.wait();
+      for (int count = 0; count < 1000; ++count) {
+        const std::string name = absl::StrCat("cluster", count % 10, ".rq_", (i + count) % 3);
+        StatNameStorage storage(name, table_);
+        StatNameStorage copy(storage.statName(), table_);
+        EXPECT_EQ(name, table_.toString(copy.statName()));
+        storage.free(table_);
+        copy.free(table_);
+      }
+    }));
+  }
+  start.setReady();
+  for (auto& thread : threads) {
+    thread->join();
+  }
+  EXPECT_EQ(0, table_.numSymbols());
+}
+
 TEST_F(StatNameTest, SharedStatNameStorageSetInsertAndFind) {
   StatNameStorageSet set;
   const int iters = 10;
@@ -13,6 +13,7 @@
 #include "test/common/stats/make_elements_helper.h"
 #include "test/test_common/utility.h"
 
+#include "absl/strings/str_cat.h"
 #include "absl/synchronization/blocking_counter.h"
 #include "benchmark/benchmark.h"
 
@@ -62,6 +63,49 @@ static void bmCreateRace(benchmark::State& state) {
 }
 BENCHMARK(bmCreateRace)->Unit(::benchmark::kMillisecond);
 
+// Shared by the threads of bmEncodeParallel, and set up by its first thread.
+static Envoy::Stats::SymbolTableImpl* parallel_table;
+static Envoy::Stats::StatNamePool* parallel_pool;
+
+// Encodes and frees names made of tokens that are already in the table from
+// several threads at once, as workers creating dynamic stats would. range(0) is
+// the number of distinct tokens in the first element of the names.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void bmEncodeParallel(benchmark::State& state) {
+  const uint32_t num_tokens = state.range(0);
+  if (state.thread_index() == 0) {
+    parallel_table = new Envoy::Stats::SymbolTableImpl;
+    parallel_pool = new Envoy::Stats::StatNamePool(*parallel_table);
+    for (uint32_t i = 0; i < num_tokens; ++i) {
+      parallel_pool->add(absl::StrCat("cluster_", i, ".upstream_rq_total"));
+    }
+  }
+
+  std::vector<std::string> names;
+  names.reserve(num_tokens);
+  for (uint32_t i = 0; i < num_tokens; ++i) {
+    names.push_back(absl::StrCat("cluster_", (i + state.thread_index() * 7) % num_tokens,
+                                 ".upstream_rq_total"));
+  }
+
+  uint32_t index = 0;
+  for (auto _ : state) {
+    UNREFERENCED_PARAMETER(_);
+    Envoy::Stats::StatNameStorage storage(names[index], *parallel_table);
+    storage.free(*parallel_table);
+    if (++index == num_tokens) {
+      index = 0;
+    }
+  }
+
+  if (state.thread_index() == 0) {
+    parallel_pool->clear();
+    delete parallel_pool;
+    delete parallel_table;
+  }
+}
+BENCHMARK(bmEncodeParallel)->Arg(1)->Arg(1000)->ThreadRange(1, 16)->UseRealTime();
+
 // NOLINTNEXTLINE(readability-identifier-naming)
 static void bmJoinStatNames(benchmark::State& state) {
   Envoy::Stats::SymbolTableImpl symbol_table;
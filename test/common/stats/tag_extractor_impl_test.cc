@@ -490,9 +490,30 @@ protected:
     } else {
       tag_extracted_name_.clear();
     }
+
+    // Matching the pattern with a TagExtractorTokensTrie must find the same match.
+    TagExtractorTokensTrie trie;
+    trie.add(tokens);
+    TagExtractorTokensTrie::Matches matches;
+    trie.match(tag_extraction_context.tokens(), matches);
+    EXPECT_EQ(extracted, TagExtractorTokensTrie::findMatch(matches, &tokens) != nullptr);
+    if (extracted) {
+      EXPECT_EQ(tag_extracted_name_, trieExtractedName(stat_name, tokens, matches[0]));
+    }
     return extracted;
   }
 
+  std::string trieExtractedName(absl::string_view stat_name, const TagExtractorTokensImpl& tokens,
+                                const TagExtractorTokensTrie::Match& match) {
+    TagExtractionContext tag_extraction_context(stat_name);
+    IntervalSetImpl<size_t> remove_characters;
+    std::vector<Tag> tags;
+    tokens.addMatchedTag(tag_extraction_context.tokens(), match.match_input_index_, match.start_,
+                         tags, remove_characters);
+    EXPECT_EQ(tags, tags_);
+    return StringUtil::removeCharacters(stat_name, remove_characters);
+  }
+
   std::vector<Tag> tags_;
   std::string tag_extracted_name_;
 };
@@ -587,5 +608,45 @@ TEST_F(TagExtractorTokensTest, TokensMismatchPatternTooLong) {
   EXPECT_FALSE(extract("article", "now.$.the.time.to", "now.is.the.time"));
 }
 
+TEST_F(TagExtractorTokensTest, TrieMatchesSharedPrefixes) {
+  TagExtractorTokensImpl service("service", "cluster.*.grpc.$.**");
+  TagExtractorTokensImpl method("method", "cluster.*.grpc.*.$.**");
+  TagExtractorTokensImpl cluster("cluster", "cluster.$.**");
+  TagExtractorTokensImpl user_agent("user_agent", "http.*.user_agent.$.**");
+  TagExtractorTokensImpl any_prefix("any_prefix", "$.grpc.**");
+  TagExtractorTokensImpl suffix("suffix", "cluster.**.$.success");
+  TagExtractorTokensTrie trie;
+  EXPECT_TRUE(trie.empty());
+  for (const TagExtractorTokensImpl* extractor :
+       {&service, &method, &cluster, &user_agent, &any_prefix, &suffix}) {
+    trie.add(*extractor);
+  }
+  EXPECT_FALSE(trie.empty());
+
+  TagExtractionContext tag_extraction_context("cluster.grpc.grpc.svc.method.success");
+  TagExtractorTokensTrie::Matches matches;
+  trie.match(tag_extraction_context.tokens(), matches);
+  EXPECT_EQ(5, matches.size());
+  EXPECT_EQ(nullptr, TagExtractorTokensTrie::findMatch(matches, &user_agent));
+
+  const auto expect_match = [&](const TagExtractorTokensImpl& extractor,
+                                absl::string_view expected_value) {
+    const TagExtractorTokensTrie::Match* match =
+        TagExtractorTokensTrie::findMatch(matches, &extractor);
+    ASSERT_NE(nullptr, match) << extractor.name();
+    EXPECT_EQ(expected_value, tag_extraction_context.tokens()[match->match_input_index_]);
+    // The trie finds the same match as the extractor on its own.
+    TagVector tags;
+    IntervalSetImpl<size_t> remove_characters;
+    ASSERT_TRUE(extractor.extractTag(tag_extraction_context, tags, remove_characters));
+    EXPECT_THAT(tags, ElementsAre(Tag{std::string(extractor.name()), std::string(expected_value)}));
+  };
+  expect_match(service, "svc");
+  expect_match(method, "method");
+  expect_match(cluster, "grpc");
+  expect_match(any_prefix, "cluster");
+  expect_match(suffix, "method");
+}
+
 } // namespace Stats
 } // namespace Envoy
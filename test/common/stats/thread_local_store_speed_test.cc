@@ -6,7 +6,9 @@
 #include "source/common/common/logger.h"
 #include "source/common/common/thread.h"
 #include "source/common/event/dispatcher_impl.h"
+#include "source/common/memory/stats.h"
 #include "source/common/stats/allocator_impl.h"
+#include "source/common/stats/slab_allocator.h"
 #include "source/common/stats/stats_matcher_impl.h"
 #include "source/common/stats/symbol_table.h"
 #include "source/common/stats/tag_producer_impl.h"
@@ -24,8 +26,8 @@ namespace Envoy {
 
 class ThreadLocalStorePerf {
 public:
-  ThreadLocalStorePerf()
-      : heap_alloc_(symbol_table_), store_(heap_alloc_),
+  explicit ThreadLocalStorePerf(bool compact_storage = false)
+      : heap_alloc_(symbol_table_, compact_storage), store_(heap_alloc_),
         api_(Api::createApiForTest(store_, time_system_)) {
     store_.setTagProducer(std::make_unique<Stats::TagProducerImpl>(stats_config_));
 
@@ -54,6 +56,19 @@ public:
     }
   }
 
+  void accessGauges() {
+    Stats::Scope& scope = *store_.rootScope();
+    for (auto& stat_name_storage : stat_names_) {
+      scope.gaugeFromStatName(stat_name_storage->statName(), Stats::Gauge::ImportMode::Accumulate);
+    }
+  }
+
+  uint64_t numStats() const { return stat_names_.size(); }
+
+  void disableScopeTlsCaches() { store_.disableScopeTlsCaches(); }
+
+  const Stats::SlabAllocator& slabs() const { return heap_alloc_.slabAllocator(); }
+
   void initThreading() {
     if (!Envoy::Event::Libevent::Global::initialized()) {
       Envoy::Event::Libevent::Global::initialize();
@@ -134,5 +149,42 @@ static void BM_StatsWithTlsAndRejectionsWithoutDot(benchmark::State& state) {
 }
 BENCHMARK(BM_StatsWithTlsAndRejectionsWithoutDot);
 
+// Reports the memory used per stat for counters and gauges, with the default
+// heap storage or the compact slab storage (first argument), and with or
+// without the per-thread scope caches (second argument). The stat names are
+// allocated before measuring, so only the stats and the store's bookkeeping are
+// counted. Memory is only measured when built with tcmalloc.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_StatsMemory(benchmark::State& state) {
+  const bool compact_storage = state.range(0) != 0;
+  const bool scope_tls_caches = state.range(1) != 0;
+
+  for (auto _ : state) { // NOLINT
+    Envoy::ThreadLocalStorePerf context(compact_storage);
+    if (!scope_tls_caches) {
+      context.disableScopeTlsCaches();
+    }
+    context.initThreading();
+
+    // Count the slots actually handed out rather than whole slabs, whose
+    // unused tails would dominate at this number of stats.
+    const Envoy::Stats::SlabAllocator& slabs = context.slabs();
+    const uint64_t start_heap = Envoy::Memory::Stats::totalCurrentlyAllocated();
+    const uint64_t start_reserved = slabs.bytesReserved();
+    const uint64_t start_allocated = slabs.bytesAllocated();
+    context.accessCounters();
+    context.accessGauges();
+    const uint64_t bytes = Envoy::Memory::Stats::totalCurrentlyAllocated() - start_heap -
+                           (slabs.bytesReserved() - start_reserved) +
+                           (slabs.bytesAllocated() - start_allocated);
+
+    state.counters["bytes_per_stat"] = static_cast<double>(bytes) / (2 * context.numStats());
+  }
+}
+BENCHMARK(BM_StatsMemory)
+    ->ArgsProduct({{0, 1}, {0, 1}})
+    ->Iterations(1)
+    ->Unit(::benchmark::kMillisecond);
+
 // TODO(jmarantz): add multi-threaded variant of this test, that aggressively
 // looks up stats in multiple threads to try to trigger contention issues.
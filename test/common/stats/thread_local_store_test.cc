@@ -360,6 +360,33 @@ TEST_F(StatsThreadLocalStoreTest, Tls) {
   EXPECT_EQ(2L, store_->textReadouts().front().use_count());
 }
 
+// With the per-thread scope caches disabled, lookups go to the central cache
+// and still return the same stats.
+TEST_F(StatsThreadLocalStoreTest, ScopeTlsCachesDisabled) {
+  InSequence s;
+  store_->disableScopeTlsCaches();
+  store_->initializeThreading(main_thread_dispatcher_, tls_);
+
+  ScopeSharedPtr scope1 = scope_.createScope("scope1.");
+  Counter& c1 = scope1->counterFromString("c1");
+  EXPECT_EQ(&c1, &scope1->counterFromString("c1"));
+  EXPECT_EQ("scope1.c1", c1.name());
+  Gauge& g1 = scope1->gaugeFromString("g1", Gauge::ImportMode::Accumulate);
+  EXPECT_EQ(&g1, &scope1->gaugeFromString("g1", Gauge::ImportMode::Accumulate));
+  Histogram& h1 = scope1->histogramFromString("h1", Histogram::Unit::Unspecified);
+  EXPECT_EQ(&h1, &scope1->histogramFromString("h1", Histogram::Unit::Unspecified));
+  TextReadout& t1 = scope1->textReadoutFromString("t1");
+  EXPECT_EQ(&t1, &scope1->textReadoutFromString("t1"));
+
+  c1.add(5);
+  EXPECT_EQ(5, TestUtility::findCounter(*store_, "scope1.c1")->value());
+  EXPECT_EQ(2L, TestUtility::findCounter(*store_, "scope1.c1").use_count());
+
+  tls_.shutdownGlobalThreading();
+  store_->shutdownThreading();
+  tls_.shutdownThread();
+}
+
 TEST_F(StatsThreadLocalStoreTest, BasicScope) {
   InSequence s;
   store_->initializeThreading(main_thread_dispatcher_, tls_);
@@ -0,0 +1,75 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/extensions/access_loggers/binary_file/v3/binary_file.pb.h"
+
+#include "source/common/network/address_impl.h"
+#include "source/extensions/access_loggers/binary_file/binary_file_access_log_impl.h"
+
+#include "test/common/stream_info/test_util.h"
+#include "test/mocks/access_log/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace AccessLoggers {
+namespace BinaryFile {
+
+using ProtoConfig = envoy::extensions::access_loggers::binary_file::v3::BinaryFileAccessLog;
+
+// Logs requests with every field of the schema on a single thread, as a worker would, including
+// the encoding of full batches. The items per second counter is the number of records logged per
+// second. range(0) is the batch size.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_BinaryFileAccessLog(benchmark::State& state) {
+  NiceMock<AccessLog::MockAccessLogManager> log_manager;
+  NiceMock<ThreadLocal::MockInstance> tls;
+  ProtoConfig config;
+  config.set_path("/dev/null");
+  for (int field = ProtoConfig::Field_MIN; field <= ProtoConfig::Field_MAX; ++field) {
+    config.add_fields(static_cast<ProtoConfig::Field>(field));
+  }
+  config.mutable_max_batch_size()->set_value(state.range(0));
+  BinaryFileAccessLog logger(config, nullptr, log_manager, tls);
+
+  MockTimeSystem time_system;
+  TestStreamInfo stream_info(time_system);
+  stream_info.downstream_connection_info_provider_->setRemoteAddress(
+      std::make_shared<Network::Address::Ipv4Instance>("203.0.113.1"));
+  stream_info.protocol(Http::Protocol::Http2);
+  stream_info.setResponseCode(200);
+  stream_info.addBytesReceived(128);
+  stream_info.addBytesSent(1024);
+
+  // Distinct paths and request ids exercise the per-batch string dictionaries.
+  std::vector<Http::TestRequestHeaderMapImpl> requests;
+  requests.reserve(64);
+  for (int i = 0; i < 64; ++i) {
+    requests.push_back(Http::TestRequestHeaderMapImpl{
+        {":method", "GET"},
+        {":authority", "www.example.com"},
+        {":path", absl::StrCat("/some/path/of/typical/length/", i)},
+        {"user-agent", "curl/8.0.1"},
+        {"x-request-id", absl::StrCat("9b2a6c1e-2f0c-4c0e-8a36-3a4f5e6d", i)}});
+  }
+
+  uint64_t i = 0;
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    logger.log(&requests[++i % requests.size()], nullptr, nullptr, stream_info,
+               AccessLog::AccessLogType::NotSet);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BinaryFileAccessLog)->Arg(64)->Arg(1024)->Arg(8192)->Unit(benchmark::kNanosecond);
+
+} // namespace BinaryFile
+} // namespace AccessLoggers
+} // namespace Extensions
+} // namespace Envoy
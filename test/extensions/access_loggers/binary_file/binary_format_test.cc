@@ -0,0 +1,136 @@
+#include <string>
+#include <vector>
+
+#include "source/extensions/access_loggers/binary_file/binary_format.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace AccessLoggers {
+namespace BinaryFile {
+namespace {
+
+using ProtoConfig = envoy::extensions::access_loggers::binary_file::v3::BinaryFileAccessLog;
+
+TEST(BinaryFormatTest, RoundTrip) {
+  BatchEncoder encoder({ProtoConfig::START_TIME, ProtoConfig::RESPONSE_CODE, ProtoConfig::PATH});
+
+  // Start times are delta encoded, and may go backwards.
+  const std::vector<uint64_t> start_times = {1700000000000000, 1700000000000100, 1699999999999000};
+  const std::vector<uint64_t> codes = {200, 503, 0};
+  const std::vector<absl::optional<absl::string_view>> paths = {"/foo", absl::nullopt, "/foo"};
+  for (uint32_t i = 0; i < 3; ++i) {
+    encoder.addInt(0, start_times[i]);
+    encoder.addInt(1, codes[i]);
+    encoder.addString(2, paths[i]);
+    encoder.finishRecord();
+  }
+  EXPECT_EQ(3, encoder.recordCount());
+
+  std::string encoded;
+  encoder.encode(encoded);
+  EXPECT_EQ(0, encoder.recordCount());
+  EXPECT_TRUE(absl::StartsWith(encoded, BatchMagic));
+
+  absl::string_view data = encoded;
+  absl::StatusOr<DecodedBatch> batch = decodeBatch(data);
+  ASSERT_TRUE(batch.ok()) << batch.status();
+  EXPECT_TRUE(data.empty());
+  EXPECT_EQ(3, batch->record_count_);
+  ASSERT_EQ(3, batch->columns_.size());
+
+  EXPECT_EQ(ProtoConfig::START_TIME, batch->columns_[0].field_);
+  EXPECT_EQ(start_times, batch->columns_[0].ints_);
+  EXPECT_EQ(ProtoConfig::RESPONSE_CODE, batch->columns_[1].field_);
+  EXPECT_EQ(codes, batch->columns_[1].ints_);
+  EXPECT_EQ(ProtoConfig::PATH, batch->columns_[2].field_);
+  const std::vector<absl::optional<std::string>> expected_paths = {"/foo", absl::nullopt, "/foo"};
+  EXPECT_EQ(expected_paths, batch->columns_[2].strings_);
+}
+
+// Batches are self-describing and can be decoded one after the other.
+TEST(BinaryFormatTest, ConsecutiveBatches) {
+  BatchEncoder encoder({ProtoConfig::REQUEST_METHOD});
+  std::string encoded;
+  encoder.addString(0, "GET");
+  encoder.finishRecord();
+  encoder.encode(encoded);
+  encoder.addString(0, "POST");
+  encoder.finishRecord();
+  encoder.addString(0, "GET");
+  encoder.finishRecord();
+  encoder.encode(encoded);
+
+  absl::string_view data = encoded;
+  absl::StatusOr<DecodedBatch> first = decodeBatch(data);
+  ASSERT_TRUE(first.ok());
+  EXPECT_EQ(1, first->record_count_);
+  EXPECT_EQ("GET", first->columns_[0].strings_[0]);
+
+  absl::StatusOr<DecodedBatch> second = decodeBatch(data);
+  ASSERT_TRUE(second.ok());
+  EXPECT_EQ(2, second->record_count_);
+  EXPECT_EQ("POST", second->columns_[0].strings_[0]);
+  EXPECT_EQ("GET", second->columns_[0].strings_[1]);
+  EXPECT_TRUE(data.empty());
+}
+
+// Repeated strings are only stored once per batch.
+TEST(BinaryFormatTest, DictionaryEncoding) {
+  BatchEncoder encoder({ProtoConfig::AUTHORITY});
+  const std::string authority(100, 'a');
+  for (uint32_t i = 0; i < 100; ++i) {
+    encoder.addString(0, authority);
+    encoder.finishRecord();
+  }
+  std::string encoded;
+  encoder.encode(encoded);
+  EXPECT_LT(encoded.size(), 2 * authority.size());
+}
+
+TEST(BinaryFormatTest, TruncatedBatch) {
+  BatchEncoder encoder({ProtoConfig::PATH, ProtoConfig::BYTES_SENT});
+  encoder.addString(0, "/foo");
+  encoder.addInt(1, 1000);
+  encoder.finishRecord();
+  std::string encoded;
+  encoder.encode(encoded);
+
+  for (size_t size = 0; size < encoded.size(); ++size) {
+    absl::string_view data(encoded.data(), size);
+    EXPECT_FALSE(decodeBatch(data).ok()) << size;
+    EXPECT_EQ(size, data.size());
+  }
+}
+
+TEST(BinaryFormatTest, BadMagic) {
+  absl::string_view data = "ABCD\x00\x00\x00\x00";
+  EXPECT_FALSE(decodeBatch(data).ok());
+}
+
+TEST(BinaryFormatTest, UnknownFieldIsSkipped) {
+  BatchEncoder encoder({ProtoConfig::BYTES_RECEIVED});
+  encoder.addInt(0, 10);
+  encoder.finishRecord();
+  std::string encoded;
+  encoder.encode(encoded);
+
+  // Rewrite the field of the only column to a value that isn't defined. The field is the fourth
+  // varint of the body, after the version, the record count and the column count.
+  const size_t field_offset = BatchMagic.size() + sizeof(uint32_t) + 3;
+  ASSERT_EQ(ProtoConfig::BYTES_RECEIVED, encoded[field_offset]);
+  encoded[field_offset] = 100;
+
+  absl::string_view data = encoded;
+  absl::StatusOr<DecodedBatch> batch = decodeBatch(data);
+  ASSERT_TRUE(batch.ok());
+  EXPECT_EQ(1, batch->record_count_);
+  EXPECT_TRUE(batch->columns_.empty());
+}
+
+} // namespace
+} // namespace BinaryFile
+} // namespace AccessLoggers
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,166 @@
+#include "envoy/config/accesslog/v3/accesslog.pb.h"
+#include "envoy/extensions/access_loggers/binary_file/v3/binary_file.pb.h"
+
+#include "source/common/access_log/access_log_impl.h"
+#include "source/extensions/access_loggers/binary_file/binary_format.h"
+#include "source/extensions/access_loggers/binary_file/config.h"
+
+#include "test/mocks/access_log/mocks.h"
+#include "test/mocks/server/factory_context.h"
+#include "test/mocks/stream_info/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Extensions {
+namespace AccessLoggers {
+namespace BinaryFile {
+namespace {
+
+using ProtoConfig = envoy::extensions::access_loggers::binary_file::v3::BinaryFileAccessLog;
+
+TEST(BinaryFileAccessLogNegativeTest, ValidateFail) {
+  NiceMock<Server::Configuration::MockServerFactoryContext> context;
+
+  EXPECT_THROW(BinaryFileAccessLogFactory().createAccessLogInstance(ProtoConfig(), nullptr, context),
+               ProtoValidationException);
+}
+
+class BinaryFileAccessLogTest : public testing::Test {
+public:
+  AccessLog::InstanceSharedPtr createLogger(const std::string& yaml) {
+    ProtoConfig proto_config;
+    TestUtility::loadFromYaml(yaml, proto_config);
+    envoy::config::accesslog::v3::AccessLog config;
+    config.set_name("envoy.access_loggers.binary_file");
+    config.mutable_typed_config()->PackFrom(proto_config);
+
+    Filesystem::FilePathAndType file_info{Filesystem::DestinationType::File, "/foo"};
+    EXPECT_CALL(context_.access_log_manager_, createAccessLog(file_info)).WillOnce(Return(file_));
+    EXPECT_CALL(*file_, write(_)).WillRepeatedly(Invoke([this](absl::string_view data) {
+      written_.append(data.data(), data.size());
+    }));
+    return AccessLog::AccessLogFactory::fromProto(config, context_);
+  }
+
+  void log(AccessLog::Instance& logger, const std::string& path, uint32_t response_code) {
+    Http::TestRequestHeaderMapImpl request_headers{{":method", "GET"}, {":path", path}};
+    stream_info_.response_code_ = response_code;
+    logger.log(&request_headers, nullptr, nullptr, stream_info_, AccessLog::AccessLogType::NotSet);
+  }
+
+  std::vector<DecodedBatch> decodeWritten() {
+    std::vector<DecodedBatch> batches;
+    absl::string_view data = written_;
+    while (!data.empty()) {
+      absl::StatusOr<DecodedBatch> batch = decodeBatch(data);
+      EXPECT_TRUE(batch.ok()) << batch.status();
+      if (!batch.ok()) {
+        break;
+      }
+      batches.push_back(std::move(batch.value()));
+    }
+    return batches;
+  }
+
+  std::shared_ptr<AccessLog::MockAccessLogFile> file_{
+      std::make_shared<AccessLog::MockAccessLogFile>()};
+  std::string written_;
+  NiceMock<StreamInfo::MockStreamInfo> stream_info_;
+  NiceMock<Server::Configuration::MockServerFactoryContext> context_;
+};
+
+TEST_F(BinaryFileAccessLogTest, WritesFullBatches) {
+  AccessLog::InstanceSharedPtr logger = createLogger(R"EOF(
+path: "/foo"
+fields: [START_TIME, RESPONSE_CODE, REQUEST_METHOD, PATH, USER_AGENT]
+max_batch_size: 2
+)EOF");
+
+  stream_info_.start_time_ = SystemTime(std::chrono::microseconds(1000));
+  log(*logger, "/a", 200);
+  EXPECT_TRUE(written_.empty());
+  log(*logger, "/b", 404);
+
+  std::vector<DecodedBatch> batches = decodeWritten();
+  ASSERT_EQ(1, batches.size());
+  EXPECT_EQ(2, batches[0].record_count_);
+  ASSERT_EQ(5, batches[0].columns_.size());
+  EXPECT_EQ(ProtoConfig::START_TIME, batches[0].columns_[0].field_);
+  EXPECT_EQ(std::vector<uint64_t>({1000, 1000}), batches[0].columns_[0].ints_);
+  EXPECT_EQ(std::vector<uint64_t>({200, 404}), batches[0].columns_[1].ints_);
+  EXPECT_EQ("GET", batches[0].columns_[2].strings_[0]);
+  EXPECT_EQ("GET", batches[0].columns_[2].strings_[1]);
+  EXPECT_EQ("/a", batches[0].columns_[3].strings_[0]);
+  EXPECT_EQ("/b", batches[0].columns_[3].strings_[1]);
+  EXPECT_EQ(absl::nullopt, batches[0].columns_[4].strings_[0]);
+
+  // A partial batch is written out when the logger goes away.
+  log(*logger, "/c", 503);
+  written_.clear();
+  logger.reset();
+  batches = decodeWritten();
+  ASSERT_EQ(1, batches.size());
+  EXPECT_EQ(1, batches[0].record_count_);
+  EXPECT_EQ("/c", batches[0].columns_[3].strings_[0]);
+}
+
+TEST_F(BinaryFileAccessLogTest, ProtocolValues) {
+  AccessLog::InstanceSharedPtr logger = createLogger(R"EOF(
+path: "/foo"
+fields: [PROTOCOL]
+max_batch_size: 5
+)EOF");
+
+  stream_info_.protocol_ = absl::nullopt;
+  log(*logger, "/", 200);
+  for (const Http::Protocol protocol : {Http::Protocol::Http10, Http::Protocol::Http11,
+                                        Http::Protocol::Http2, Http::Protocol::Http3}) {
+    stream_info_.protocol_ = protocol;
+    log(*logger, "/", 200);
+  }
+
+  // The values are those documented in binary_file.proto.
+  std::vector<DecodedBatch> batches = decodeWritten();
+  ASSERT_EQ(1, batches.size());
+  EXPECT_EQ(std::vector<uint64_t>({0, 1, 2, 3, 4}), batches[0].columns_[0].ints_);
+}
+
+TEST_F(BinaryFileAccessLogTest, FlushTimer) {
+  // The thread local batch is created on the thread local dispatcher, which creates the timer.
+  Event::MockTimer* timer = new NiceMock<Event::MockTimer>(&context_.thread_local_.dispatcher_);
+  EXPECT_CALL(*timer, enableTimer(std::chrono::milliseconds(500), _));
+  AccessLog::InstanceSharedPtr logger = createLogger(R"EOF(
+path: "/foo"
+fields: [RESPONSE_CODE]
+batch_flush_interval: 0.5s
+)EOF");
+
+  log(*logger, "/a", 200);
+  EXPECT_TRUE(written_.empty());
+
+  EXPECT_CALL(*timer, enableTimer(std::chrono::milliseconds(500), _));
+  timer->invokeCallback();
+  std::vector<DecodedBatch> batches = decodeWritten();
+  ASSERT_EQ(1, batches.size());
+  EXPECT_EQ(std::vector<uint64_t>({200}), batches[0].columns_[0].ints_);
+
+  // Nothing is written when the batch is empty.
+  written_.clear();
+  EXPECT_CALL(*timer, enableTimer(std::chrono::milliseconds(500), _));
+  timer->invokeCallback();
+  EXPECT_TRUE(written_.empty());
+}
+
+} // namespace
+} // namespace BinaryFile
+} // namespace AccessLoggers
+} // namespace Extensions
+} // namespace Envoy
@@ -32,6 +32,8 @@ namespace {
 constexpr std::chrono::milliseconds FlushInterval(10);
 constexpr char MOCK_HTTP_LOG_FIELD_NAME[] = "http_log_entry";
 constexpr char MOCK_TCP_LOG_FIELD_NAME[] = "tcp_log_entry";
+// Same length as the key of mockHttpEntry(), so that both entries have the same size.
+constexpr char MOCK_HIGH_PRIORITY_KEY[] = "priority";
 
 const Protobuf::MethodDescriptor& mockMethodDescriptor() {
   // The mock logger doesn't have its own API, but we only care about the method descriptor so we
@@ -87,6 +89,10 @@ private:
 
   bool isEmpty() override { return message_.fields().empty(); }
 
+  bool isHighPriority(const ProtobufWkt::Struct& entry) override {
+    return entry.fields().contains(MOCK_HIGH_PRIORITY_KEY);
+  }
+
   void initMessage() override { ++num_inits_; }
 
   void clearMessage() override {
@@ -175,8 +181,7 @@ TEST_F(StreamingGrpcAccessLogTest, BasicFlow) {
   expectFlushedLogEntriesCount(stream, MOCK_TCP_LOG_FIELD_NAME, 1);
   logger_->log(ProtobufWkt::Empty());
   EXPECT_EQ(2, logger_->numClears());
-  // TCP logging doesn't change the logs_written counter.
-  EXPECT_EQ(1,
+  EXPECT_EQ(2,
             TestUtility::findCounter(stats_store_, "mock_access_log_prefix.logs_written")->value());
 
   // Verify that sending an empty response message doesn't do anything bad.
@@ -194,7 +199,7 @@ TEST_F(StreamingGrpcAccessLogTest, BasicFlow) {
   EXPECT_EQ(3, logger_->numClears());
   EXPECT_EQ(0,
             TestUtility::findCounter(stats_store_, "mock_access_log_prefix.logs_dropped")->value());
-  EXPECT_EQ(2,
+  EXPECT_EQ(3,
             TestUtility::findCounter(stats_store_, "mock_access_log_prefix.logs_written")->value());
 }
 
@@ -245,6 +250,66 @@ TEST_F(StreamingGrpcAccessLogTest, WatermarksOverrun) {
             TestUtility::findCounter(stats_store_, "mock_access_log_prefix.logs_dropped")->value());
 }
 
+// TCP entries are bounded by the buffer size like HTTP entries.
+TEST_F(StreamingGrpcAccessLogTest, TcpWatermarksOverrun) {
+  InSequence s;
+  initLogger(FlushInterval, 1);
+
+  MockAccessLogStream stream;
+  AccessLogCallbacks* callbacks;
+  expectStreamStart(stream, &callbacks);
+
+  EXPECT_CALL(stream, isAboveWriteBufferHighWatermark()).WillOnce(Return(true));
+  EXPECT_CALL(stream, sendMessageRaw_(_, _)).Times(0);
+  logger_->log(mockHttpEntry());
+
+  EXPECT_CALL(stream, isAboveWriteBufferHighWatermark()).WillOnce(Return(true));
+  logger_->log(ProtobufWkt::Empty());
+  EXPECT_EQ(1,
+            TestUtility::findCounter(stats_store_, "mock_access_log_prefix.logs_written")->value());
+  EXPECT_EQ(1,
+            TestUtility::findCounter(stats_store_, "mock_access_log_prefix.logs_dropped")->value());
+}
+
+// High priority entries can use the headroom above the buffer size while the stream is backed up.
+TEST_F(StreamingGrpcAccessLogTest, HighPriorityHeadroom) {
+  const uint64_t entry_size = mockHttpEntry().ByteSizeLong();
+  initLogger(FlushInterval, 4 * entry_size);
+
+  MockAccessLogStream stream;
+  AccessLogCallbacks* callbacks;
+  expectStreamStart(stream, &callbacks);
+  EXPECT_CALL(stream, isAboveWriteBufferHighWatermark()).WillRepeatedly(Return(true));
+  EXPECT_CALL(stream, sendMessageRaw_(_, _)).Times(0);
+
+  // Fill the buffer while the stream is backed up.
+  for (int i = 0; i < 4; ++i) {
+    logger_->log(mockHttpEntry());
+  }
+
+  // Regular entries are dropped.
+  logger_->log(mockHttpEntry());
+  EXPECT_EQ(1,
+            TestUtility::findCounter(stats_store_, "mock_access_log_prefix.logs_dropped")->value());
+
+  // A high priority entry still fits in the headroom.
+  ProtobufWkt::Struct high_priority_entry;
+  high_priority_entry.mutable_fields()->insert({MOCK_HIGH_PRIORITY_KEY, ProtobufWkt::Value()});
+  ASSERT_EQ(entry_size, high_priority_entry.ByteSizeLong());
+  logger_->log(ProtobufWkt::Struct(high_priority_entry));
+  EXPECT_EQ(5,
+            TestUtility::findCounter(stats_store_, "mock_access_log_prefix.logs_written")->value());
+  EXPECT_EQ(1,
+            TestUtility::findCounter(stats_store_, "mock_access_log_prefix.logs_dropped")->value());
+
+  // Once the headroom is used up, high priority entries are dropped too.
+  logger_->log(ProtobufWkt::Struct(high_priority_entry));
+  EXPECT_EQ(5,
+            TestUtility::findCounter(stats_store_, "mock_access_log_prefix.logs_written")->value());
+  EXPECT_EQ(2,
+            TestUtility::findCounter(stats_store_, "mock_access_log_prefix.logs_dropped")->value());
+}
+
 // Test that stream failure is handled correctly.
 TEST_F(StreamingGrpcAccessLogTest, StreamFailure) {
   initLogger(FlushInterval, 0);
@@ -398,8 +463,7 @@ TEST_F(UnaryGrpcAccessLogTest, BasicFlow) {
   // Message should be initialized and cleared every time a request is sent.
   EXPECT_EQ(2, logger_->numInits());
   EXPECT_EQ(2, logger_->numClears());
-  // TCP logging doesn't change the logs_written counter.
-  EXPECT_EQ(1,
+  EXPECT_EQ(2,
             TestUtility::findCounter(stats_store_, "mock_access_log_prefix.logs_written")->value());
   // No dropped logs expected.
   EXPECT_EQ(0,
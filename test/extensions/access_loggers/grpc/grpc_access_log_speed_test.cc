@@ -0,0 +1,87 @@
+#include <chrono>
+#include <memory>
+
+#include "envoy/data/accesslog/v3/accesslog.pb.h"
+#include "envoy/extensions/access_loggers/grpc/v3/als.pb.h"
+
+#include "source/extensions/access_loggers/grpc/grpc_access_log_impl.h"
+
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/grpc/mocks.h"
+#include "test/mocks/local_info/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+using testing::_;
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Extensions {
+namespace AccessLoggers {
+namespace GrpcCommon {
+
+namespace {
+
+envoy::data::accesslog::v3::HTTPAccessLogEntry makeEntry(bool failed) {
+  envoy::data::accesslog::v3::HTTPAccessLogEntry entry;
+  entry.mutable_common_properties()->mutable_start_time()->set_seconds(1700000000);
+  entry.mutable_request()->set_authority("www.example.com");
+  entry.mutable_request()->set_path("/some/path/of/typical/length?with=query");
+  entry.mutable_request()->set_user_agent("curl/8.0.1");
+  entry.mutable_request()->set_request_id("9b2a6c1e-2f0c-4c0e-8a36-3a4f5e6d7c8b");
+  entry.mutable_response()->mutable_response_code()->set_value(failed ? 503 : 200);
+  entry.mutable_response()->set_response_body_bytes(1024);
+  if (failed) {
+    entry.mutable_common_properties()->mutable_response_flags()->set_upstream_overflow(true);
+  }
+  return entry;
+}
+
+} // namespace
+
+// Logs HTTP entries through a streaming logger whose stream either keeps up or stays backed up.
+// range(0) is the buffer size in bytes, range(1) whether the stream is above its high watermark.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_GrpcAccessLoggerLog(benchmark::State& state) {
+  const uint64_t buffer_size_bytes = state.range(0);
+  const bool backed_up = state.range(1) != 0;
+
+  NiceMock<Event::MockDispatcher> dispatcher;
+  new NiceMock<Event::MockTimer>(&dispatcher);
+  NiceMock<LocalInfo::MockLocalInfo> local_info;
+  Stats::IsolatedStoreImpl stats_store;
+  NiceMock<Grpc::MockAsyncStream> stream;
+  auto* async_client = new NiceMock<Grpc::MockAsyncClient>;
+  ON_CALL(*async_client, startRaw(_, _, _, _)).WillByDefault(Return(&stream));
+  ON_CALL(stream, isAboveWriteBufferHighWatermark()).WillByDefault(Return(backed_up));
+
+  envoy::extensions::access_loggers::grpc::v3::CommonGrpcAccessLogConfig config;
+  config.set_log_name("benchmark");
+  config.mutable_buffer_size_bytes()->set_value(buffer_size_bytes);
+  GrpcAccessLoggerImpl logger(Grpc::RawAsyncClientPtr{async_client}, config, dispatcher,
+                              local_info, *stats_store.rootScope());
+
+  const envoy::data::accesslog::v3::HTTPAccessLogEntry entry = makeEntry(false);
+  const envoy::data::accesslog::v3::HTTPAccessLogEntry failed_entry = makeEntry(true);
+  uint64_t i = 0;
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    // One in sixteen requests failed.
+    logger.log(envoy::data::accesslog::v3::HTTPAccessLogEntry((++i % 16) == 0 ? failed_entry
+                                                                               : entry));
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters["dropped"] =
+      TestUtility::findCounter(stats_store, "access_logs.grpc_access_log.logs_dropped")->value();
+}
+// A buffer size of 0 flushes every entry, and would buffer without bound on a backed up stream.
+BENCHMARK(BM_GrpcAccessLoggerLog)
+    ->Args({0, 0})
+    ->ArgsProduct({{16384, 1 << 20}, {0, 1}})
+    ->Unit(benchmark::kNanosecond);
+
+} // namespace GrpcCommon
+} // namespace AccessLoggers
+} // namespace Extensions
+} // namespace Envoy
@@ -8,6 +8,7 @@
 #include "source/extensions/common/dynamic_forward_proxy/dns_cache_impl.h"
 #include "source/extensions/common/dynamic_forward_proxy/dns_cache_manager_impl.h"
 #include "source/server/factory_context_base_impl.h"
+#include "source/server/hot_restart_state.h"
 
 #include "test/extensions/common/dynamic_forward_proxy/mocks.h"
 #include "test/mocks/filesystem/mocks.h"
@@ -1525,6 +1526,37 @@ TEST_F(DnsCacheImplTest, CacheLoad) {
   }
 }
 
+// The hosts resolved by the hot restart parent are loaded into the cache, and the resolved hosts
+// are exported for a hot restart child.
+TEST_F(DnsCacheImplTest, HotRestartState) {
+  ScopedInjectableLoader<Server::HotRestartState> loader(
+      std::make_unique<Server::HotRestartState>());
+  Server::HotRestart::State parent_state;
+  parent_state["dns_cache.foo"]["foo.com:80"] = "10.0.0.2:80|40|0";
+  parent_state["dns_cache.foo"]["bar.com:80"] = "bar";
+  parent_state["dns_cache.other"]["baz.com:80"] = "10.0.0.3:80|40|0";
+  loader.instance().setParentState(std::move(parent_state));
+
+  initialize();
+  EXPECT_EQ(1, TestUtility::findCounter(context_.store_, "dns_cache.foo.cache_load")->value());
+  EXPECT_TRUE(loader.instance().takeParentSection("dns_cache.other").has_value());
+  EXPECT_FALSE(loader.instance().takeParentSection("dns_cache.foo").has_value());
+
+  MockLoadDnsCacheEntryCallbacks callbacks;
+  auto result = dns_cache_->loadDnsCacheEntry("foo.com", 80, false, callbacks);
+  EXPECT_EQ(DnsCache::LoadDnsCacheEntryStatus::InCache, result.status_);
+  ASSERT_NE(absl::nullopt, result.host_info_);
+  EXPECT_EQ("10.0.0.2:80", result.host_info_.value()->address()->asString());
+
+  Server::HotRestart::State state = loader.instance().exportState();
+  ASSERT_EQ(1, state["dns_cache.foo"].size());
+  EXPECT_THAT(state["dns_cache.foo"]["foo.com:80"], testing::StartsWith("10.0.0.2:80|40|"));
+
+  // Nothing is exported once the cache is gone.
+  dns_cache_.reset();
+  EXPECT_TRUE(loader.instance().exportState().empty());
+}
+
 // Make sure the cache manager can handle the context going out of scope.
 TEST(DnsCacheManagerImplTest, TestLifetime) {
   NiceMock<Server::Configuration::MockFactoryContext> context;
@@ -2,6 +2,7 @@
 #include "source/common/common/thread_synchronizer.h"
 #include "source/extensions/common/wasm/wasm.h"
 
+#include "test/mocks/init/mocks.h"
 #include "test/mocks/server/mocks.h"
 #include "test/mocks/upstream/mocks.h"
 #include "test/test_common/environment.h"
@@ -63,6 +64,137 @@ void bmWasmSpeedTest(benchmark::State& state) {
 
 BENCHMARK(bmWasmSpeedTest);
 
+namespace {
+
+envoy::extensions::wasm::v3::PluginConfig pluginConfig(const std::string& runtime,
+                                                       const std::string& name) {
+  std::string filename;
+  if (runtime == "null") {
+    // The name of the Null VM plugin.
+    filename = Envoy::TestEnvironment::writeStringToFileForTest("speed_test_plugin",
+                                                                "CommonWasmTestCpp");
+  } else {
+    filename =
+        Envoy::TestEnvironment::runfilesPath("test/extensions/common/wasm/test_data/test_cpp.wasm");
+  }
+  envoy::extensions::wasm::v3::PluginConfig plugin_config;
+  plugin_config.set_name(name);
+  plugin_config.mutable_vm_config()->set_runtime(absl::StrCat("envoy.wasm.runtime.", runtime));
+  plugin_config.mutable_vm_config()->mutable_code()->mutable_local()->set_filename(filename);
+  return plugin_config;
+}
+
+} // namespace
+
+// Startup of a module shared by the plugins of state.range(0) filter configurations, on
+// state.range(1) workers: each plugin is created from the module file, and each worker clones the
+// VM of the module.
+void bmWasmStartup(benchmark::State& state, const std::string& runtime) {
+  Envoy::Logger::Registry::getLog(Envoy::Logger::Id::wasm).set_level(spdlog::level::off);
+  Envoy::Stats::IsolatedStoreImpl stats_store;
+  Envoy::Api::ApiPtr api = Envoy::Api::createApiForTest(stats_store);
+  testing::NiceMock<Envoy::Upstream::MockClusterManager> cluster_manager;
+  testing::NiceMock<Envoy::Init::MockManager> init_manager;
+  testing::NiceMock<Envoy::Server::MockServerLifecycleNotifier> lifecycle_notifier;
+  testing::NiceMock<Envoy::LocalInfo::MockLocalInfo> local_info;
+  Envoy::Event::DispatcherPtr dispatcher(api->allocateDispatcher("wasm_test"));
+  Envoy::Config::DataSource::RemoteAsyncDataProviderPtr remote_data_provider;
+  auto scope = Envoy::Stats::ScopeSharedPtr(stats_store.createScope("wasm."));
+  Envoy::Thread::ThreadFactory& thread_factory{Envoy::Thread::threadFactoryForTest()};
+
+  std::vector<Envoy::Extensions::Common::Wasm::PluginSharedPtr> plugins;
+  for (int i = 0; i < state.range(0); ++i) {
+    plugins.push_back(std::make_shared<Envoy::Extensions::Common::Wasm::Plugin>(
+        pluginConfig(runtime, absl::StrCat("plugin", i)),
+        envoy::config::core::v3::TrafficDirection::UNSPECIFIED, local_info, nullptr));
+  }
+
+  for (__attribute__((unused)) auto _ : state) {
+    std::vector<Envoy::Extensions::Common::Wasm::WasmHandleSharedPtr> wasm_handles;
+    for (const auto& plugin : plugins) {
+      Envoy::Extensions::Common::Wasm::createWasm(
+          plugin, scope, cluster_manager, init_manager, *dispatcher, *api, lifecycle_notifier,
+          remote_data_provider,
+          [&wasm_handles](const Envoy::Extensions::Common::Wasm::WasmHandleSharedPtr& w) {
+            wasm_handles.push_back(w);
+          });
+    }
+    RELEASE_ASSERT(wasm_handles.size() == plugins.size() && wasm_handles.front() != nullptr, "");
+
+    auto thread_fn = [&]() {
+      Envoy::Event::DispatcherPtr worker_dispatcher(api->allocateDispatcher("worker"));
+      for (size_t i = 0; i < plugins.size(); ++i) {
+        benchmark::DoNotOptimize(Envoy::Extensions::Common::Wasm::getOrCreateThreadLocalPlugin(
+            wasm_handles[i], plugins[i], *worker_dispatcher));
+      }
+    };
+    std::vector<Envoy::Thread::ThreadPtr> threads;
+    for (int i = 0; i < state.range(1); ++i) {
+      std::string name = absl::StrCat("worker", i);
+      threads.emplace_back(thread_factory.createThread(thread_fn, Envoy::Thread::Options{name}));
+    }
+    for (auto& thread : threads) {
+      thread->join();
+    }
+
+    // Start the next iteration from cold VMs, but keep the module files cached.
+    wasm_handles.clear();
+    dispatcher->run(Envoy::Event::Dispatcher::RunType::NonBlock);
+    proxy_wasm::clearWasmCachesForTesting();
+  }
+}
+
+// Calls into the VM of a plugin: the root context of the plugin is configured on each iteration.
+void bmWasmCall(benchmark::State& state, const std::string& runtime) {
+  Envoy::Logger::Registry::getLog(Envoy::Logger::Id::wasm).set_level(spdlog::level::off);
+  Envoy::Stats::IsolatedStoreImpl stats_store;
+  Envoy::Api::ApiPtr api = Envoy::Api::createApiForTest(stats_store);
+  testing::NiceMock<Envoy::Upstream::MockClusterManager> cluster_manager;
+  testing::NiceMock<Envoy::Init::MockManager> init_manager;
+  testing::NiceMock<Envoy::Server::MockServerLifecycleNotifier> lifecycle_notifier;
+  testing::NiceMock<Envoy::LocalInfo::MockLocalInfo> local_info;
+  Envoy::Event::DispatcherPtr dispatcher(api->allocateDispatcher("wasm_test"));
+  Envoy::Config::DataSource::RemoteAsyncDataProviderPtr remote_data_provider;
+  auto scope = Envoy::Stats::ScopeSharedPtr(stats_store.createScope("wasm."));
+
+  auto plugin = std::make_shared<Envoy::Extensions::Common::Wasm::Plugin>(
+      pluginConfig(runtime, "plugin"), envoy::config::core::v3::TrafficDirection::UNSPECIFIED,
+      local_info, nullptr);
+  Envoy::Extensions::Common::Wasm::WasmHandleSharedPtr wasm_handle;
+  Envoy::Extensions::Common::Wasm::createWasm(
+      plugin, scope, cluster_manager, init_manager, *dispatcher, *api, lifecycle_notifier,
+      remote_data_provider,
+      [&wasm_handle](const Envoy::Extensions::Common::Wasm::WasmHandleSharedPtr& w) {
+        wasm_handle = w;
+      });
+  RELEASE_ASSERT(wasm_handle != nullptr, "");
+  auto plugin_handle = Envoy::Extensions::Common::Wasm::getOrCreateThreadLocalPlugin(
+      wasm_handle, plugin, *dispatcher);
+  auto* root_context = plugin_handle->wasmHandle()->wasm()->getRootContext(plugin, false);
+
+  for (__attribute__((unused)) auto _ : state) {
+    benchmark::DoNotOptimize(root_context->onConfigure(plugin));
+  }
+
+  plugin_handle.reset();
+  wasm_handle.reset();
+  dispatcher->run(Envoy::Event::Dispatcher::RunType::NonBlock);
+  proxy_wasm::clearWasmCachesForTesting();
+}
+
+BENCHMARK_CAPTURE(bmWasmStartup, null, std::string("null"))
+    ->Args({1, 1})
+    ->Args({16, 8})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(bmWasmCall, null, std::string("null"));
+#if defined(PROXY_WASM_HAS_RUNTIME_V8)
+BENCHMARK_CAPTURE(bmWasmStartup, v8, std::string("v8"))
+    ->Args({1, 1})
+    ->Args({16, 8})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(bmWasmCall, v8, std::string("v8"));
+#endif
+
 } // namespace Envoy
 
 int main(int argc, char** argv) {
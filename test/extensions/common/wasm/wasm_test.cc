@@ -726,6 +726,60 @@ TEST_P(WasmCommonTest, VmCache) {
   proxy_wasm::clearWasmCachesForTesting();
 }
 
+// Module files are read once and then served from the local code cache until they change.
+TEST_P(WasmCommonTest, LocalCodeCache) {
+  Stats::IsolatedStoreImpl stats_store;
+  Api::ApiPtr api = Api::createApiForTest(stats_store);
+  NiceMock<Upstream::MockClusterManager> cluster_manager;
+  NiceMock<Init::MockManager> init_manager;
+  NiceMock<Server::MockServerLifecycleNotifier> lifecycle_notifier;
+  Event::DispatcherPtr dispatcher(api->allocateDispatcher("wasm_test"));
+  Config::DataSource::RemoteAsyncDataProviderPtr remote_data_provider;
+  auto scope = Stats::ScopeSharedPtr(stats_store.createScope("wasm."));
+  NiceMock<LocalInfo::MockLocalInfo> local_info;
+
+  std::string code;
+  if (std::get<0>(GetParam()) != "null") {
+    code = TestEnvironment::readFileToStringForTest(TestEnvironment::substitute(
+        absl::StrCat("{{ test_rundir }}/test/extensions/common/wasm/test_data/test_cpp.wasm")));
+  } else {
+    // The name of the Null VM plugin.
+    code = "CommonWasmTestCpp";
+  }
+  EXPECT_FALSE(code.empty());
+  const std::string filename = TestEnvironment::writeStringToFileForTest("local_code.wasm", code);
+
+  envoy::extensions::wasm::v3::PluginConfig plugin_config;
+  auto vm_config = plugin_config.mutable_vm_config();
+  vm_config->set_runtime(absl::StrCat("envoy.wasm.runtime.", std::get<0>(GetParam())));
+  vm_config->mutable_code()->mutable_local()->set_filename(filename);
+  auto plugin = std::make_shared<Extensions::Common::Wasm::Plugin>(
+      plugin_config, envoy::config::core::v3::TrafficDirection::UNSPECIFIED, local_info, nullptr);
+
+  const auto create_wasm = [&]() {
+    WasmHandleSharedPtr wasm_handle;
+    createWasm(plugin, scope, cluster_manager, init_manager, *dispatcher, *api, lifecycle_notifier,
+               remote_data_provider,
+               [&wasm_handle](const WasmHandleSharedPtr& w) { wasm_handle = w; });
+    return wasm_handle;
+  };
+
+  WasmHandleSharedPtr wasm_handle = create_wasm();
+  ASSERT_NE(wasm_handle, nullptr);
+  EXPECT_EQ(wasm_handle, create_wasm());
+
+  // A changed file is read again.
+  TestEnvironment::writeStringToFileForTest("local_code.wasm", "bad code");
+  EXPECT_EQ(create_wasm(), nullptr);
+  TestEnvironment::writeStringToFileForTest("local_code.wasm", code);
+  EXPECT_EQ(wasm_handle, create_wasm());
+
+  wasm_handle.reset();
+  dispatcher->run(Event::Dispatcher::RunType::NonBlock);
+  dispatcher->clearDeferredDeleteList();
+  proxy_wasm::clearWasmCachesForTesting();
+}
+
 TEST_P(WasmCommonTest, RemoteCode) {
   if (std::get<0>(GetParam()) == "null") {
     return;
@@ -18,6 +18,8 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
+using testing::AnyNumber;
+using testing::InSequence;
 using testing::IsSubstring;
 using testing::NiceMock;
 using testing::Pair;
@@ -713,6 +715,74 @@ TEST_P(DeltaSubscriptionStateTest, AckGenerated) {
   }
 }
 
+// Verifies that the client tells the server, through the node of every request, that it tracks
+// updates split into chunks.
+TEST_P(DeltaSubscriptionStateTest, AdvertisesChunkedUpdates) {
+  if (should_use_unified_) {
+    GTEST_SKIP() << "Chunked updates are only tracked by the legacy delta subscription state";
+  }
+  for (int i = 0; i < 2; ++i) {
+    auto req = getNextRequestAckless();
+    ASSERT_EQ(1, req->node().client_features().size());
+    EXPECT_EQ(NewDeltaSubscriptionState::DeltaChunksClientFeature,
+              req->node().client_features(0));
+    markStreamFresh();
+  }
+}
+
+// Verifies that a resource may only appear in one chunk of an update that the server split into
+// several responses, and that the update ends with its last chunk or with a rejected chunk.
+TEST_P(DeltaSubscriptionStateTest, ChunkedUpdate) {
+  if (should_use_unified_) {
+    GTEST_SKIP() << "Chunked updates are only tracked by the legacy delta subscription state";
+  }
+  auto deliver_chunk = [this](std::vector<std::pair<std::string, std::string>> added_resources,
+                              std::vector<std::string> removed_resources, bool more_chunks) {
+    envoy::service::discovery::v3::DeltaDiscoveryResponse message;
+    *message.mutable_resources() = populateRepeatedResource(added_resources);
+    *message.mutable_removed_resources() = populateRepeatedString(removed_resources);
+    message.set_more_chunks(more_chunks);
+    return handleResponse(message).error_detail_.code();
+  };
+  EXPECT_CALL(*ttl_timer_, disableTimer()).Times(AnyNumber());
+  EXPECT_CALL(callbacks_, onConfigUpdateFailed(_, _)).Times(2);
+  EXPECT_CALL(callbacks_, onConfigUpdate(_, _, _)).Times(0);
+
+  EXPECT_CALL(callbacks_, onChunkedConfigUpdate(_, _, _, true)).Times(2);
+  EXPECT_EQ(Grpc::Status::WellKnownGrpcStatus::Ok, deliver_chunk({{"name1", "v1A"}}, {}, true));
+  EXPECT_EQ(Grpc::Status::WellKnownGrpcStatus::Ok,
+            deliver_chunk({{"name2", "v2A"}}, {"name3"}, true));
+  // name1 was already updated by an earlier chunk of the update. The rejected chunk ends the
+  // update, handing the earlier chunks to the watches still holding them.
+  EXPECT_CALL(callbacks_, onChunkedConfigUpdate(_, _, _, _)).Times(0);
+  EXPECT_CALL(callbacks_, onChunkedConfigUpdateInterrupted());
+  EXPECT_NE(Grpc::Status::WellKnownGrpcStatus::Ok, deliver_chunk({{"name1", "v1B"}}, {}, false));
+
+  EXPECT_CALL(callbacks_, onChunkedConfigUpdate(_, _, _, true));
+  EXPECT_EQ(Grpc::Status::WellKnownGrpcStatus::Ok, deliver_chunk({{"name3", "v3A"}}, {}, true));
+  EXPECT_CALL(callbacks_, onChunkedConfigUpdate(_, _, _, _)).Times(0);
+  EXPECT_CALL(callbacks_, onChunkedConfigUpdateInterrupted());
+  EXPECT_NE(Grpc::Status::WellKnownGrpcStatus::Ok, deliver_chunk({}, {"name3"}, false));
+
+  // The last chunk of an update ends it, after which its resources can be updated again.
+  EXPECT_CALL(callbacks_, onChunkedConfigUpdateInterrupted()).Times(0);
+  {
+    InSequence s;
+    EXPECT_CALL(callbacks_, onChunkedConfigUpdate(_, _, _, true));
+    EXPECT_CALL(callbacks_, onChunkedConfigUpdate(_, _, _, false));
+    EXPECT_CALL(callbacks_, onChunkedConfigUpdate(_, _, _, true));
+  }
+  EXPECT_EQ(Grpc::Status::WellKnownGrpcStatus::Ok, deliver_chunk({{"name1", "v1B"}}, {}, true));
+  EXPECT_EQ(Grpc::Status::WellKnownGrpcStatus::Ok, deliver_chunk({{"name2", "v2B"}}, {}, false));
+  EXPECT_EQ(Grpc::Status::WellKnownGrpcStatus::Ok, deliver_chunk({{"name1", "v1C"}}, {}, true));
+
+  // So does a new stream.
+  EXPECT_CALL(callbacks_, onChunkedConfigUpdateInterrupted());
+  markStreamFresh();
+  EXPECT_CALL(callbacks_, onConfigUpdate(_, _, _));
+  EXPECT_EQ(Grpc::Status::WellKnownGrpcStatus::Ok, deliver_chunk({{"name1", "v1D"}}, {}, false));
+}
+
 // Tests population of the initial_resource_versions map in the first request of a new stream.
 // Tests that
 // 1) resources we have a version of are present in the map,
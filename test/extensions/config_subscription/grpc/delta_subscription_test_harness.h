@@ -114,6 +114,10 @@ public:
                          std::map<std::string, std::string> initial_resource_versions) {
     API_NO_BOOST(envoy::service::discovery::v3::DeltaDiscoveryRequest) expected_request;
     expected_request.mutable_node()->CopyFrom(node_);
+    if (!should_use_unified_) {
+      expected_request.mutable_node()->add_client_features(
+          std::string(NewDeltaSubscriptionState::DeltaChunksClientFeature));
+    }
     std::copy(
         subscribe.begin(), subscribe.end(),
         Protobuf::RepeatedFieldBackInserter(expected_request.mutable_resource_names_subscribe()));
@@ -94,6 +94,10 @@ public:
                          const std::map<std::string, std::string>& initial_resource_versions = {}) {
     API_NO_BOOST(envoy::service::discovery::v3::DeltaDiscoveryRequest) expected_request;
     expected_request.mutable_node()->CopyFrom(local_info_.node());
+    if (!isUnifiedMuxTest()) {
+      expected_request.mutable_node()->add_client_features(
+          std::string(NewDeltaSubscriptionState::DeltaChunksClientFeature));
+    }
     for (const auto& resource : resource_names_subscribe) {
       expected_request.add_resource_names_subscribe(resource);
     }
@@ -418,6 +422,55 @@ TEST_P(NewGrpcMuxImplTest, ConfigUpdateWithAliases) {
   EXPECT_EQ("HAL 9000", stats_.textReadout("control_plane.identifier").value());
 }
 
+// Only the last chunk of an update split into several responses is ACKed, while a rejected chunk
+// is NACKed right away.
+TEST_P(NewGrpcMuxImplTest, ChunkedUpdateAckedOnLastChunk) {
+  if (isUnifiedMuxTest()) {
+    GTEST_SKIP() << "Chunked updates are only supported by the legacy delta mux";
+  }
+  setup();
+  InSequence s;
+  const std::string& type_url = Config::TypeUrl::get().ClusterLoadAssignment;
+  auto watch = grpc_mux_->addWatch(type_url, {"x", "y", "z"}, callbacks_, resource_decoder_, {});
+  EXPECT_CALL(*async_client_, startRaw(_, _, _, _)).WillOnce(Return(&async_stream_));
+  expectSendMessage(type_url, {"x", "y", "z"}, {});
+  grpc_mux_->start();
+
+  auto send_chunk = [this, &type_url](const std::string& name, const std::string& nonce,
+                                      bool more_chunks) {
+    auto response = std::make_unique<envoy::service::discovery::v3::DeltaDiscoveryResponse>();
+    response->set_type_url(type_url);
+    response->set_system_version_info("1");
+    response->set_nonce(nonce);
+    response->set_more_chunks(more_chunks);
+    envoy::config::endpoint::v3::ClusterLoadAssignment cla;
+    cla.set_cluster_name(name);
+    auto* resource = response->add_resources();
+    resource->set_name(name);
+    resource->mutable_resource()->PackFrom(cla);
+    resource->set_version("1");
+    onDiscoveryResponse(std::move(response));
+  };
+
+  // The watch has yet to receive an update, so it gets the whole update with its last chunk.
+  EXPECT_CALL(callbacks_, onConfigUpdate(_, _, _)).Times(0);
+  send_chunk("x", "1", true);
+  EXPECT_CALL(callbacks_, onConfigUpdate(_, _, "1"))
+      .WillOnce(Invoke([](const std::vector<DecodedResourceRef>& added_resources,
+                          const Protobuf::RepeatedPtrField<std::string>&, const std::string&) {
+        EXPECT_EQ(2, added_resources.size());
+      }));
+  expectSendMessage(type_url, {}, {}, "2");
+  send_chunk("y", "2", false);
+
+  EXPECT_CALL(callbacks_, onConfigUpdate(_, _, "1"));
+  send_chunk("z", "3", true);
+  EXPECT_CALL(callbacks_, onConfigUpdateFailed(ConfigUpdateFailureReason::UpdateRejected, _));
+  expectSendMessage(type_url, {}, {}, "4", Grpc::Status::WellKnownGrpcStatus::Internal,
+                    "duplicate name z found in an earlier chunk of the update");
+  send_chunk("z", "4", true);
+}
+
 // DeltaDiscoveryResponse that comes in response to an on-demand request that couldn't be resolved
 // will contain an empty Resource. The Resource's aliases field will be populated with the alias
 // originally used in the request.
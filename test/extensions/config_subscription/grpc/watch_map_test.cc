@@ -110,6 +110,29 @@ void doDeltaUpdate(WatchMap& watch_map,
   watch_map.onConfigUpdate(delta_resources, removed_names_proto, version);
 }
 
+void doChunkedDeltaUpdate(WatchMap& watch_map,
+                          const Protobuf::RepeatedPtrField<ProtobufWkt::Any>& sotw_resources,
+                          const std::string& version, bool more_chunks) {
+  watch_map.onChunkedConfigUpdate(wrapInResource(sotw_resources, version), {}, version,
+                                  more_chunks);
+}
+
+// Expects a delta update of the named resources, which may come from chunks of several versions.
+void expectDeltaUpdateOfNames(MockSubscriptionCallbacks& callbacks,
+                              const std::vector<std::string>& expected_names,
+                              const std::string& version) {
+  EXPECT_CALL(callbacks, onConfigUpdate(_, _, version))
+      .WillOnce(Invoke([expected_names](const std::vector<DecodedResourceRef>& gotten_resources,
+                                        const Protobuf::RepeatedPtrField<std::string>&,
+                                        const std::string&) {
+        std::vector<std::string> gotten_names;
+        for (const auto& resource : gotten_resources) {
+          gotten_names.push_back(resource.get().name());
+        }
+        EXPECT_EQ(expected_names, gotten_names);
+      }));
+}
+
 // Similar to expectDeltaAndSotwUpdate(), but making the onConfigUpdate() happen, rather than
 // EXPECT-ing it.
 void doDeltaAndSotwUpdate(WatchMap& watch_map,
@@ -602,6 +625,72 @@ TEST(WatchMapTest, DeltaOnConfigUpdate) {
   doDeltaAndSotwUpdate(watch_map, update, {"removed"}, "version1");
 }
 
+// A watch that has yet to receive an update holds the chunks of a chunked update until its last
+// one, while a watch that already received an update gets each chunk as it arrives.
+TEST(WatchMapTest, ChunkedDeltaUpdateHeldUntilLastChunk) {
+  MockSubscriptionCallbacks callbacks1;
+  MockSubscriptionCallbacks callbacks2;
+  TestUtility::TestOpaqueResourceDecoderImpl<envoy::config::endpoint::v3::ClusterLoadAssignment>
+      resource_decoder("cluster_name");
+  NiceMock<MockCustomConfigValidators> config_validators;
+  WatchMap watch_map(false, "ClusterLoadAssignmentType", config_validators, {});
+  Watch* watch1 = watch_map.addWatch(callbacks1, resource_decoder);
+  Watch* watch2 = watch_map.addWatch(callbacks2, resource_decoder);
+  watch_map.updateWatchInterest(watch1, {"dummy"});
+  watch_map.updateWatchInterest(watch2, {"alice", "bob"});
+
+  Protobuf::RepeatedPtrField<ProtobufWkt::Any> alice_update;
+  envoy::config::endpoint::v3::ClusterLoadAssignment alice;
+  alice.set_cluster_name("alice");
+  alice_update.Add()->PackFrom(alice);
+  Protobuf::RepeatedPtrField<ProtobufWkt::Any> bob_update;
+  envoy::config::endpoint::v3::ClusterLoadAssignment bob;
+  bob.set_cluster_name("bob");
+  bob_update.Add()->PackFrom(bob);
+
+  // Only the second watch received an update before the chunked update.
+  expectDeltaUpdate(callbacks2, {alice}, {}, "version0");
+  doDeltaUpdate(watch_map, alice_update, {}, "version0");
+  watch_map.updateWatchInterest(watch1, {"alice", "bob"});
+
+  expectNoUpdate(callbacks1, "version1");
+  expectDeltaUpdate(callbacks2, {alice}, {}, "version1");
+  doChunkedDeltaUpdate(watch_map, alice_update, "version1", true);
+
+  expectDeltaUpdateOfNames(callbacks1, {"alice", "bob"}, "version2");
+  expectDeltaUpdate(callbacks2, {bob}, {}, "version2");
+  doChunkedDeltaUpdate(watch_map, bob_update, "version2", false);
+
+  // Once it received an update, the first watch gets each chunk as it arrives too.
+  expectDeltaUpdate(callbacks1, {alice}, {}, "version3");
+  expectDeltaUpdate(callbacks2, {alice}, {}, "version3");
+  doChunkedDeltaUpdate(watch_map, alice_update, "version3", true);
+}
+
+// The chunks held by a watch are delivered if the chunked update ends before its last chunk.
+TEST(WatchMapTest, ChunkedDeltaUpdateInterrupted) {
+  MockSubscriptionCallbacks callbacks;
+  TestUtility::TestOpaqueResourceDecoderImpl<envoy::config::endpoint::v3::ClusterLoadAssignment>
+      resource_decoder("cluster_name");
+  NiceMock<MockCustomConfigValidators> config_validators;
+  WatchMap watch_map(false, "ClusterLoadAssignmentType", config_validators, {});
+  Watch* watch = watch_map.addWatch(callbacks, resource_decoder);
+  watch_map.updateWatchInterest(watch, {"alice", "bob"});
+
+  Protobuf::RepeatedPtrField<ProtobufWkt::Any> alice_update;
+  envoy::config::endpoint::v3::ClusterLoadAssignment alice;
+  alice.set_cluster_name("alice");
+  alice_update.Add()->PackFrom(alice);
+
+  expectNoUpdate(callbacks, "version1");
+  doChunkedDeltaUpdate(watch_map, alice_update, "version1", true);
+
+  // Nothing is held past the interruption.
+  expectDeltaUpdate(callbacks, {alice}, {}, "version1");
+  watch_map.onChunkedConfigUpdateInterrupted();
+  watch_map.onChunkedConfigUpdateInterrupted();
+}
+
 TEST(WatchMapTest, OnConfigUpdateFailed) {
   NiceMock<MockCustomConfigValidators> config_validators;
   WatchMap watch_map(false, "ClusterLoadAssignmentType", config_validators, {});
@@ -4,6 +4,8 @@
 
 #include "source/common/buffer/buffer_impl.h"
 #include "source/common/network/address_impl.h"
+#include "source/common/network/lc_trie.h"
+#include "source/common/network/poptrie.h"
 #include "source/common/network/utility.h"
 #include "source/extensions/filters/http/ip_tagging/ip_tagging_filter.h"
 
@@ -43,6 +45,10 @@ ip_tags:
   void initializeFilter(const std::string& yaml) {
     envoy::extensions::filters::http::ip_tagging::v3::IPTagging config;
     TestUtility::loadFromYaml(yaml, config);
+    initializeFilter(config);
+  }
+
+  void initializeFilter(const envoy::extensions::filters::http::ip_tagging::v3::IPTagging& config) {
     config_ =
         std::make_shared<IpTaggingFilterConfig>(config, "prefix.", *stats_.rootScope(), runtime_);
     filter_ = std::make_unique<IpTaggingFilter>(config_);
@@ -62,6 +68,8 @@ ip_tags:
 TEST_F(IpTaggingFilterTest, InternalRequest) {
   initializeFilter(internal_request_yaml);
   EXPECT_EQ(FilterRequestType::INTERNAL, config_->requestType());
+  // Tables an LcTrie can hold are held in one.
+  EXPECT_NE(nullptr, dynamic_cast<const Network::LcTrie::LcTrie<std::string>*>(&config_->trie()));
   Http::TestRequestHeaderMapImpl request_headers{{"x-envoy-internal", "true"}};
 
   Network::Address::InstanceConstSharedPtr remote_address =
@@ -231,6 +239,32 @@ ip_tags:
   EXPECT_EQ(Http::FilterTrailersStatus::Continue, filter_->decodeTrailers(request_trailers));
 }
 
+// Tables too large for an LcTrie fall back to a Poptrie.
+TEST_F(IpTaggingFilterTest, LargeTable) {
+  envoy::extensions::filters::http::ip_tagging::v3::IPTagging config;
+  config.set_request_type(envoy::extensions::filters::http::ip_tagging::v3::IPTagging::BOTH);
+  auto* ip_tag = config.add_ip_tags();
+  ip_tag->set_ip_tag_name("threat");
+  for (uint32_t i = 0; i < 300000; i++) {
+    auto* cidr_range = ip_tag->add_ip_list();
+    cidr_range->set_address_prefix(
+        fmt::format("10.{}.{}.{}", i >> 16 & 0xff, i >> 8 & 0xff, i & 0xff));
+    cidr_range->mutable_prefix_len()->set_value(32);
+  }
+  initializeFilter(config);
+  EXPECT_NE(nullptr,
+            dynamic_cast<const Network::Poptrie::Poptrie<std::string>*>(&config_->trie()));
+
+  for (const auto& [address, tagged] : std::vector<std::pair<std::string, bool>>{
+           {"10.0.0.1", true}, {"10.4.147.223", true}, {"10.4.147.224", false}}) {
+    Http::TestRequestHeaderMapImpl request_headers;
+    filter_callbacks_.stream_info_.downstream_connection_info_provider_->setRemoteAddress(
+        Network::Utility::parseInternetAddress(address));
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers, false));
+    EXPECT_EQ(tagged ? "threat" : "", request_headers.get_(Http::Headers::get().EnvoyIpTags));
+  }
+}
+
 TEST_F(IpTaggingFilterTest, Ipv6Address) {
   const std::string ipv6_addresses_yaml = R"EOF(
 ip_tags:
@@ -117,6 +117,20 @@ TEST_F(KeyValueStoreTest, MaxEntries) {
   EXPECT_EQ(absl::nullopt, store_->get("1"));
 }
 
+TEST_F(KeyValueStoreTest, MaxEntriesUnchangedValueRefreshesOrder) {
+  createStore(2);
+  store_->addOrUpdate("1", "a", absl::nullopt);
+  store_->addOrUpdate("2", "b", absl::nullopt);
+  // Rewriting '1' with the same value makes it the most recent entry.
+  store_->addOrUpdate("1", "a", absl::nullopt);
+
+  // Adding '3' should evict '2'.
+  store_->addOrUpdate("3", "c", absl::nullopt);
+  EXPECT_EQ("a", store_->get("1").value());
+  EXPECT_EQ(absl::nullopt, store_->get("2"));
+  EXPECT_EQ("c", store_->get("3").value());
+}
+
 TEST_F(KeyValueStoreTest, Persist) {
   store_->addOrUpdate("foo", "bar", absl::nullopt);
   store_->addOrUpdate("ba\nz", "ee\np", absl::nullopt);
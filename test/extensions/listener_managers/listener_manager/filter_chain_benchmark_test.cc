@@ -267,6 +267,47 @@ BENCHMARK_DEFINE_F(FilterChainBenchmarkFixture, FilterChainFindTest)
     }
   }
 }
+// Updates a listener with state.range(0) filter chains, each for its own server name, by adding
+// one more filter chain.
+// NOLINTNEXTLINE(readability-redundant-member-init)
+BENCHMARK_DEFINE_F(FilterChainBenchmarkFixture, FilterChainManagerUpdateTest)
+(::benchmark::State& state) {
+  if (benchmark::skipExpensiveBenchmarks() && state.range(0) > 64) {
+    state.SkipWithError("Skipping expensive benchmark");
+    return;
+  }
+
+  const int64_t input_size = state.range(0);
+  std::vector<envoy::config::listener::v3::FilterChain> filter_chain_messages(input_size + 1);
+  for (int64_t i = 0; i <= input_size; i++) {
+    filter_chain_messages[i].set_name(absl::StrCat("server", i));
+    auto* filter_chain_match = filter_chain_messages[i].mutable_filter_chain_match();
+    filter_chain_match->add_server_names(absl::StrCat("server", i, ".example.com"));
+    filter_chain_match->set_transport_protocol("tls");
+  }
+  std::vector<const envoy::config::listener::v3::FilterChain*> filter_chains;
+  filter_chains.reserve(input_size + 1);
+  for (int64_t i = 0; i < input_size; i++) {
+    filter_chains.push_back(&filter_chain_messages[i]);
+  }
+
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  std::vector<Network::Address::InstanceConstSharedPtr> addresses;
+  addresses.emplace_back(std::make_shared<Network::Address::Ipv4Instance>("127.0.0.1", 1234));
+  FilterChainManagerImpl origin_filter_chain_manager{addresses, factory_context, init_manager_};
+  origin_filter_chain_manager.addFilterChains(nullptr, filter_chains, nullptr, dummy_builder_,
+                                              origin_filter_chain_manager);
+
+  filter_chains.push_back(&filter_chain_messages[input_size]);
+  for (auto _ : state) {
+    UNREFERENCED_PARAMETER(_);
+    FilterChainManagerImpl filter_chain_manager{addresses, factory_context, init_manager_,
+                                                origin_filter_chain_manager};
+    filter_chain_manager.addFilterChains(nullptr, filter_chains, nullptr, dummy_builder_,
+                                         filter_chain_manager);
+  }
+}
+
 BENCHMARK_REGISTER_F(FilterChainBenchmarkFixture, FilterChainManagerBuildTest)
     ->Ranges({
         // scale of the chains
@@ -279,6 +320,11 @@ BENCHMARK_REGISTER_F(FilterChainBenchmarkFixture, FilterChainFindTest)
         {1, 4096},
     })
     ->Unit(::benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(FilterChainBenchmarkFixture, FilterChainManagerUpdateTest)
+    ->Arg(64)
+    ->Arg(10000)
+    ->Arg(100000)
+    ->Unit(::benchmark::kMillisecond);
 
 /*
 clang-format off
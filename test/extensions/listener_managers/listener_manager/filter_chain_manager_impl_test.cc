@@ -256,6 +256,63 @@ TEST_P(FilterChainManagerImplTest, DuplicateContextsAreNotBuilt) {
       nullptr, filter_chain_factory_builder_, new_filter_chain_manager);
 }
 
+// An update that leaves the filter chains below a server name unchanged shares that part of the
+// index with the previous filter chain manager, which may then go away.
+TEST_P(FilterChainManagerImplTest, UpdateSharesIndexOfUnchangedServerNames) {
+  if (GetParam()) {
+    return;
+  }
+  std::vector<envoy::config::listener::v3::FilterChain> filter_chain_messages;
+  std::vector<std::shared_ptr<Network::MockFilterChain>> built_filter_chains;
+  for (int i = 0; i < 4; i++) {
+    envoy::config::listener::v3::FilterChain new_filter_chain = filter_chain_template_;
+    new_filter_chain.set_name(absl::StrCat("filter_chain_", i));
+    new_filter_chain.mutable_filter_chain_match()->add_server_names(
+        absl::StrCat("server", i, ".example.com"));
+    new_filter_chain.mutable_filter_chain_match()->set_transport_protocol("tls");
+    filter_chain_messages.push_back(std::move(new_filter_chain));
+    built_filter_chains.push_back(std::make_shared<Network::MockFilterChain>());
+  }
+
+  EXPECT_CALL(filter_chain_factory_builder_, buildFilterChain(_, _))
+      .WillOnce(Return(built_filter_chains[0]))
+      .WillOnce(Return(built_filter_chains[1]))
+      .WillOnce(Return(built_filter_chains[2]));
+  filter_chain_manager_->addFilterChains(
+      nullptr,
+      std::vector<const envoy::config::listener::v3::FilterChain*>{
+          &filter_chain_messages[0], &filter_chain_messages[1], &filter_chain_messages[2]},
+      nullptr, filter_chain_factory_builder_, *filter_chain_manager_);
+
+  // Change the filter chain of server 2 and add one for server 3.
+  envoy::config::listener::v3::FilterChain changed_filter_chain = filter_chain_messages[2];
+  changed_filter_chain.mutable_filter_chain_match()->add_application_protocols("h2");
+  auto changed_built_filter_chain = std::make_shared<Network::MockFilterChain>();
+  auto new_filter_chain_manager = std::make_unique<FilterChainManagerImpl>(
+      addresses_, parent_context_, init_manager_, *filter_chain_manager_);
+  EXPECT_CALL(filter_chain_factory_builder_, buildFilterChain(_, _))
+      .WillOnce(Return(changed_built_filter_chain))
+      .WillOnce(Return(built_filter_chains[3]));
+  new_filter_chain_manager->addFilterChains(
+      nullptr,
+      std::vector<const envoy::config::listener::v3::FilterChain*>{
+          &filter_chain_messages[0], &filter_chain_messages[1], &changed_filter_chain,
+          &filter_chain_messages[3]},
+      nullptr, filter_chain_factory_builder_, *new_filter_chain_manager);
+  filter_chain_manager_ = std::move(new_filter_chain_manager);
+
+  for (int i : {0, 1, 3}) {
+    EXPECT_EQ(built_filter_chains[i].get(),
+              findFilterChainHelper(10000, "127.0.0.1", absl::StrCat("server", i, ".example.com"),
+                                    "tls", {}, "8.8.8.8", 111));
+  }
+  EXPECT_EQ(nullptr, findFilterChainHelper(10000, "127.0.0.1", "server2.example.com", "tls", {},
+                                           "8.8.8.8", 111));
+  EXPECT_EQ(changed_built_filter_chain.get(),
+            findFilterChainHelper(10000, "127.0.0.1", "server2.example.com", "tls", {"h2"},
+                                  "8.8.8.8", 111));
+}
+
 TEST_P(FilterChainManagerImplTest, CreatedFilterChainFactoryContextHasIndependentDrainClose) {
   std::vector<envoy::config::listener::v3::FilterChain> filter_chain_messages;
   for (int i = 0; i < 3; i++) {
@@ -10,17 +10,24 @@
 #include "source/extensions/stat_sinks/common/statsd/statsd.h"
 #include "source/extensions/stat_sinks/common/statsd/tag_formats.h"
 
+#include "test/mocks/api/mocks.h"
+#include "test/mocks/event/mocks.h"
 #include "test/mocks/stats/mocks.h"
 #include "test/mocks/thread_local/mocks.h"
 #include "test/test_common/environment.h"
 #include "test/test_common/network_utility.h"
+#include "test/test_common/threadsafe_singleton_injector.h"
 #include "test/test_common/utility.h"
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "spdlog/spdlog.h"
 
+using testing::_;
+using testing::Invoke;
 using testing::NiceMock;
+using testing::Return;
+using testing::SizeIs;
 
 namespace Envoy {
 namespace Extensions {
@@ -32,12 +39,15 @@ namespace {
 class MockWriter : public UdpStatsdSink::Writer {
 public:
   MOCK_METHOD(void, write, (const std::string& message));
-  MOCK_METHOD(void, writeBuffer, (Buffer::Instance & buffer));
+  MOCK_METHOD(void, writeDatagrams, (absl::Span<const absl::string_view> datagrams));
 
   void delegateBufferFake() {
-    ON_CALL(*this, writeBuffer).WillByDefault([this](Buffer::Instance& buffer) {
-      this->buffer_writes.push_back(buffer.toString());
-    });
+    ON_CALL(*this, writeDatagrams)
+        .WillByDefault([this](absl::Span<const absl::string_view> datagrams) {
+          for (const absl::string_view datagram : datagrams) {
+            this->buffer_writes.emplace_back(datagram);
+          }
+        });
   }
 
   std::vector<std::string> buffer_writes;
@@ -174,7 +184,7 @@ TEST(UdpStatsdSinkTest, CheckActualStats) {
   counter.latch_ = 1;
   snapshot.counters_.push_back({1, counter});
 
-  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr), writeBuffer(_));
+  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr), writeDatagrams(_));
   sink.flush(snapshot);
   EXPECT_EQ(writer_ptr->buffer_writes.size(), 1);
   EXPECT_EQ(writer_ptr->buffer_writes.at(0), "envoy.test_counter:1|c");
@@ -186,7 +196,7 @@ TEST(UdpStatsdSinkTest, CheckActualStats) {
   gauge.used_ = true;
   snapshot.gauges_.push_back(gauge);
 
-  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr), writeBuffer(_));
+  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr), writeDatagrams(_));
   sink.flush(snapshot);
   EXPECT_EQ(writer_ptr->buffer_writes.size(), 2);
   EXPECT_EQ(writer_ptr->buffer_writes.at(1), "envoy.test_gauge:1|g");
@@ -214,10 +224,11 @@ TEST(UdpStatsdSinkTest, CheckMetricLargerThanBuffer) {
   counter.latch_ = 1;
   snapshot.counters_.push_back({1, counter});
 
-  // Expect the metric to skip the buffer
-  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr),
-              write("envoy.test_counter:1|c"));
+  // Expect the metric to be sent in a datagram of its own
+  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr), writeDatagrams(_));
   sink.flush(snapshot);
+  EXPECT_EQ(writer_ptr->buffer_writes.size(), 1);
+  EXPECT_EQ(writer_ptr->buffer_writes.at(0), "envoy.test_counter:1|c");
   counter.used_ = false;
 
   NiceMock<Stats::MockGauge> gauge;
@@ -226,10 +237,11 @@ TEST(UdpStatsdSinkTest, CheckMetricLargerThanBuffer) {
   gauge.used_ = true;
   snapshot.gauges_.push_back(gauge);
 
-  // Expect the metric to skip the buffer
-  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr),
-              write("envoy.test_gauge:1|g"));
+  // Expect the metric to be sent in a datagram of its own
+  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr), writeDatagrams(_));
   sink.flush(snapshot);
+  EXPECT_EQ(writer_ptr->buffer_writes.size(), 2);
+  EXPECT_EQ(writer_ptr->buffer_writes.at(1), "envoy.test_gauge:1|g");
 
   tls_.shutdownThread();
 }
@@ -255,7 +267,7 @@ TEST(UdpStatsdSinkTest, CheckBufferedWritesWithinBufferSize) {
   snapshot.gauges_.push_back(gauge);
 
   // Expect both metrics to be present in single write
-  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr), writeBuffer(_));
+  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr), writeDatagrams(_));
   sink.flush(snapshot);
   EXPECT_EQ(writer_ptr->buffer_writes.size(), 1);
   EXPECT_EQ(writer_ptr->buffer_writes.at(0), "envoy.test_counter:1|c\nenvoy.test_gauge:1|g");
@@ -289,9 +301,8 @@ TEST(UdpStatsdSinkTest, CheckBufferedWritesExceedingBufferSize) {
   gauge.used_ = true;
   snapshot.gauges_.push_back(gauge);
 
-  // Expect both metrics to be present in single write
-  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr), writeBuffer(_))
-      .Times(2);
+  // Expect the counters to share a datagram, and both datagrams to be sent at once
+  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr), writeDatagrams(_));
   sink.flush(snapshot);
   EXPECT_EQ(writer_ptr->buffer_writes.size(), 2);
   EXPECT_EQ(writer_ptr->buffer_writes.at(0), "envoy.test_counter_1:1|c\nenvoy.test_counter_2:1|c");
@@ -313,7 +324,7 @@ TEST(UdpStatsdSinkTest, CheckActualStatsWithCustomPrefix) {
   counter.latch_ = 1;
   snapshot.counters_.push_back({1, counter});
 
-  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr), writeBuffer(_));
+  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr), writeDatagrams(_));
   sink.flush(snapshot);
   EXPECT_EQ(writer_ptr->buffer_writes.size(), 1);
   EXPECT_EQ(writer_ptr->buffer_writes.at(0), "test_prefix.test_counter:1|c");
@@ -395,7 +406,7 @@ TEST(UdpStatsdSinkWithTagsTest, CheckActualStats) {
   counter.setTags(tags);
   snapshot.counters_.push_back({1, counter});
 
-  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr), writeBuffer(_));
+  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr), writeDatagrams(_));
   sink.flush(snapshot);
   EXPECT_EQ(writer_ptr->buffer_writes.size(), 1);
   EXPECT_EQ(writer_ptr->buffer_writes.at(0), "envoy.test_counter:1|c|#key1:value1,key2:value2");
@@ -408,7 +419,7 @@ TEST(UdpStatsdSinkWithTagsTest, CheckActualStats) {
   gauge.setTags(tags);
   snapshot.gauges_.push_back(gauge);
 
-  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr), writeBuffer(_));
+  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr), writeDatagrams(_));
   sink.flush(snapshot);
   EXPECT_EQ(writer_ptr->buffer_writes.size(), 2);
   EXPECT_EQ(writer_ptr->buffer_writes.at(1), "envoy.test_gauge:1|g|#key1:value1,key2:value2");
@@ -485,7 +496,7 @@ TEST(UdpStatsdSinkWithTagsTest, GraphiteTagSyntax) {
   counter.setTags(tags);
   snapshot.counters_.push_back({1, counter});
 
-  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr), writeBuffer(_));
+  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr), writeDatagrams(_));
   sink.flush(snapshot);
   EXPECT_EQ(writer_ptr->buffer_writes.size(), 1);
   EXPECT_EQ(writer_ptr->buffer_writes.at(0), "envoy.test_counter;key1=value1;key2=value2:1|c");
@@ -498,7 +509,7 @@ TEST(UdpStatsdSinkWithTagsTest, GraphiteTagSyntax) {
   gauge.setTags(tags);
   snapshot.gauges_.push_back(gauge);
 
-  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr), writeBuffer(_));
+  EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr), writeDatagrams(_));
   sink.flush(snapshot);
   EXPECT_EQ(writer_ptr->buffer_writes.size(), 2);
   EXPECT_EQ(writer_ptr->buffer_writes.at(1), "envoy.test_gauge;key1=value1;key2=value2:1|g");
@@ -513,6 +524,126 @@ TEST(UdpStatsdSinkWithTagsTest, GraphiteTagSyntax) {
   tls_.shutdownThread();
 }
 
+TEST(DatagramBuilderTest, PacksLinesIntoDatagrams) {
+  DatagramBuilder builder(16);
+  const auto add_line = [&builder](absl::string_view line) {
+    builder.beginLine().append(line.data(), line.size());
+    builder.endLine();
+  };
+
+  add_line("aaaaa");
+  add_line("bbbbb");
+  // Doesn't fit with the separator, so it starts a new datagram.
+  add_line("ccccc");
+  // Larger than a datagram, so it is sent by itself.
+  add_line("dddddddddddddddddd");
+  add_line("e");
+  EXPECT_THAT(builder.datagrams(),
+              testing::ElementsAre("aaaaa\nbbbbb", "ccccc", "dddddddddddddddddd", "e"));
+
+  // Clearing keeps no datagrams from the previous round.
+  builder.clear();
+  add_line("f");
+  EXPECT_THAT(builder.datagrams(), testing::ElementsAre("f"));
+}
+
+TEST(DatagramBuilderTest, ZeroSizeSendsOneLinePerDatagram) {
+  DatagramBuilder builder(0);
+  for (absl::string_view line : {"a", "b", "c"}) {
+    builder.beginLine().append(line.data(), line.size());
+    builder.endLine();
+  }
+  EXPECT_THAT(builder.datagrams(), testing::ElementsAre("a", "b", "c"));
+}
+
+TEST(UdpStatsdSinkTest, FlushSpread) {
+  NiceMock<Stats::MockMetricSnapshot> snapshot;
+  auto writer_ptr = std::make_shared<NiceMock<MockWriter>>();
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  NiceMock<Event::MockDispatcher> dispatcher;
+  auto* timer = new NiceMock<Event::MockTimer>(&dispatcher);
+  UdpStatsdSink sink(tls_, writer_ptr, false);
+  sink.setFlushSpread(dispatcher, std::chrono::milliseconds(10));
+
+  // Each counter is sent in its own datagram, so the flush has 130 datagrams. Spread over 10ms
+  // with at least 64 datagrams per batch, they are sent in 3 batches 3ms apart.
+  std::vector<std::unique_ptr<NiceMock<Stats::MockCounter>>> counters;
+  for (int i = 0; i < 130; ++i) {
+    auto counter = std::make_unique<NiceMock<Stats::MockCounter>>();
+    counter->name_ = absl::StrCat("test_counter_", i);
+    counter->used_ = true;
+    snapshot.counters_.push_back({1, *counter});
+    counters.push_back(std::move(counter));
+  }
+
+  EXPECT_CALL(*writer_ptr, writeDatagrams(SizeIs(64)));
+  EXPECT_CALL(*timer, enableTimer(std::chrono::milliseconds(3), _));
+  sink.flush(snapshot);
+
+  EXPECT_CALL(*writer_ptr, writeDatagrams(SizeIs(64)));
+  EXPECT_CALL(*timer, enableTimer(std::chrono::milliseconds(3), _));
+  timer->invokeCallback();
+
+  EXPECT_CALL(*writer_ptr, writeDatagrams(SizeIs(2)));
+  EXPECT_CALL(*timer, enableTimer(_, _)).Times(0);
+  timer->invokeCallback();
+
+  // Datagrams still pending when the next flush starts are sent right away.
+  EXPECT_CALL(*timer, enableTimer(std::chrono::milliseconds(3), _)).Times(2);
+  EXPECT_CALL(*writer_ptr, writeDatagrams(SizeIs(64))).Times(2);
+  EXPECT_CALL(*writer_ptr, writeDatagrams(SizeIs(66)));
+  sink.flush(snapshot);
+  sink.flush(snapshot);
+
+  tls_.shutdownThread();
+}
+
+TEST(UdpStatsdSinkTest, WriteDatagramsResumesAfterPartialSend) {
+  NiceMock<Stats::MockMetricSnapshot> snapshot;
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  UdpStatsdSink sink(tls_, std::make_shared<Network::Address::Ipv4Instance>("127.0.0.1", 8125),
+                     false);
+
+  // Each counter is sent in its own datagram, so the flush has 100 datagrams and takes two
+  // batches.
+  std::vector<std::unique_ptr<NiceMock<Stats::MockCounter>>> counters;
+  for (int i = 0; i < 100; ++i) {
+    auto counter = std::make_unique<NiceMock<Stats::MockCounter>>();
+    counter->name_ = absl::StrCat("test_counter_", i);
+    counter->used_ = true;
+    snapshot.counters_.push_back({1, *counter});
+    counters.push_back(std::move(counter));
+  }
+
+  NiceMock<Api::MockOsSysCalls> os_sys_calls;
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+  EXPECT_CALL(os_sys_calls, supportsMmsg()).WillRepeatedly(Return(true));
+  {
+    testing::InSequence s;
+    // After a partial send, the next batch starts from the first datagram that wasn't sent.
+    EXPECT_CALL(os_sys_calls, sendmmsg(_, _, 64, 0))
+        .WillOnce(Return(Api::SysCallIntResult{10, 0}));
+    EXPECT_CALL(os_sys_calls, sendmmsg(_, _, 64, 0))
+        .WillOnce(Invoke([](os_fd_t, struct mmsghdr* msgvec, unsigned int,
+                            int) -> Api::SysCallIntResult {
+          EXPECT_EQ("envoy.test_counter_10:1|c",
+                    absl::string_view(static_cast<char*>(msgvec[0].msg_hdr.msg_iov->iov_base),
+                                      msgvec[0].msg_hdr.msg_iov->iov_len));
+          return {64, 0};
+        }));
+    EXPECT_CALL(os_sys_calls, sendmmsg(_, _, 26, 0))
+        .WillOnce(Return(Api::SysCallIntResult{26, 0}));
+  }
+  sink.flush(snapshot);
+
+  // A failed send drops the rest of the flush.
+  EXPECT_CALL(os_sys_calls, sendmmsg(_, _, 64, 0))
+      .WillOnce(Return(Api::SysCallIntResult{-1, SOCKET_ERROR_AGAIN}));
+  sink.flush(snapshot);
+
+  tls_.shutdownThread();
+}
+
 } // namespace
 } // namespace Statsd
 } // namespace Common
@@ -191,6 +191,20 @@ TEST(StatsdConfigTest, ValidateFail) {
       ProtoValidationException);
 }
 
+// A negative flush spread is rejected rather than turned into a negative batch interval.
+TEST(StatsdConfigTest, NegativeFlushSpread) {
+  envoy::config::metrics::v3::StatsdSink sink_config;
+  envoy::config::core::v3::SocketAddress& socket_address =
+      *sink_config.mutable_address()->mutable_socket_address();
+  socket_address.set_protocol(envoy::config::core::v3::SocketAddress::UDP);
+  socket_address.set_address("127.0.0.1");
+  socket_address.set_port_value(8125);
+  sink_config.mutable_flush_spread()->set_seconds(-1);
+
+  NiceMock<Server::Configuration::MockServerFactoryContext> server;
+  EXPECT_THROW(StatsdSinkFactory().createStatsSink(sink_config, server), ProtoValidationException);
+}
+
 } // namespace
 } // namespace Statsd
 } // namespace StatSinks
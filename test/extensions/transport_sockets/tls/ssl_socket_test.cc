@@ -7,6 +7,7 @@
 #include "envoy/extensions/transport_sockets/tls/v3/cert.pb.h"
 #include "envoy/network/transport_socket.h"
 
+#include "source/common/api/os_sys_calls_impl.h"
 #include "source/common/buffer/buffer_impl.h"
 #include "source/common/common/empty_string.h"
 #include "source/common/event/dispatcher_impl.h"
@@ -53,6 +54,7 @@
 #include "test/test_common/network_utility.h"
 #include "test/test_common/registry.h"
 #include "test/test_common/test_runtime.h"
+#include "test/test_common/threadsafe_singleton_injector.h"
 #include "test/test_common/utility.h"
 
 #include "absl/strings/str_replace.h"
@@ -5853,6 +5855,8 @@ protected:
   void initialize() {
     TestUtility::loadFromYaml(TestEnvironment::substitute(server_ctx_yaml_),
                               downstream_tls_context_);
+    downstream_tls_context_.mutable_common_tls_context()->set_kernel_tls_offload(
+        kernel_tls_offload_);
     auto server_cfg =
         std::make_unique<ServerContextConfigImpl>(downstream_tls_context_, factory_context_);
     manager_ = std::make_unique<ContextManagerImpl>(time_system_);
@@ -5867,6 +5871,8 @@ protected:
         dispatcher_->createListener(socket_, listener_callbacks_, runtime_, listener_config);
 
     TestUtility::loadFromYaml(TestEnvironment::substitute(client_ctx_yaml_), upstream_tls_context_);
+    upstream_tls_context_.mutable_common_tls_context()->set_kernel_tls_offload(kernel_tls_offload_);
+    *upstream_tls_context_.mutable_common_tls_context()->mutable_tls_params() = client_tls_params_;
     auto client_cfg =
         std::make_unique<ClientContextConfigImpl>(upstream_tls_context_, factory_context_);
 
@@ -6049,6 +6055,8 @@ protected:
   std::shared_ptr<Network::MockReadFilter> read_filter_;
   StrictMock<Network::MockConnectionCallbacks> client_callbacks_;
   Network::Address::InstanceConstSharedPtr source_address_;
+  bool kernel_tls_offload_{false};
+  envoy::extensions::transport_sockets::tls::v3::TlsParameters client_tls_params_;
 };
 
 INSTANTIATE_TEST_SUITE_P(IpVersions, SslReadBufferLimitTest,
@@ -6069,6 +6077,407 @@ TEST_P(SslReadBufferLimitTest, SomeLimit) {
   readBufferLimitTest(32 * 1024, 32 * 1024, 256 * 1024, 1, false);
 }
 
+#if defined(__linux__) && __has_include(<linux/tls.h>)
+constexpr bool KernelTlsBuilt = true;
+#else
+constexpr bool KernelTlsBuilt = false;
+#endif
+
+// Passes system calls through to the kernel and counts the kernel TLS socket options that are set.
+// The outcome of those options can also be forced, without calling into the kernel.
+class KernelTlsOsSysCalls : public Api::OsSysCallsImpl {
+public:
+  // From <netinet/tcp.h> and <linux/tls.h>.
+  static constexpr int TcpUlp = 31;
+  static constexpr int SolTls = 282;
+  static constexpr int TlsTx = 1;
+  static constexpr int TlsRx = 2;
+
+  Api::SysCallIntResult setsockopt(os_fd_t sockfd, int level, int optname, const void* optval,
+                                   socklen_t optlen) override {
+    absl::optional<Api::SysCallIntResult>* forced_result;
+    if (level == IPPROTO_TCP && optname == TcpUlp) {
+      ++ulp_calls_;
+      forced_result = &ulp_result_;
+    } else if (level == SolTls && optname == TlsTx) {
+      ++tx_calls_;
+      forced_result = &tx_result_;
+    } else if (level == SolTls && optname == TlsRx) {
+      ++rx_calls_;
+      forced_result = &rx_result_;
+    } else {
+      return Api::OsSysCallsImpl::setsockopt(sockfd, level, optname, optval, optlen);
+    }
+    const Api::SysCallIntResult result =
+        forced_result->has_value()
+            ? forced_result->value()
+            : Api::OsSysCallsImpl::setsockopt(sockfd, level, optname, optval, optlen);
+    if (level == SolTls && result.return_value_ == 0) {
+      ++crypto_info_set_;
+    }
+    return result;
+  }
+
+  absl::optional<Api::SysCallIntResult> ulp_result_;
+  absl::optional<Api::SysCallIntResult> tx_result_;
+  absl::optional<Api::SysCallIntResult> rx_result_;
+  uint32_t ulp_calls_{0};
+  uint32_t tx_calls_{0};
+  uint32_t rx_calls_{0};
+  uint32_t crypto_info_set_{0};
+};
+
+// TLS 1.2 AES-GCM connections are offloaded in both directions when the kernel supports it, and
+// keep using BoringSSL otherwise. Either way, data is exchanged and the connection is closed
+// gracefully.
+TEST_P(SslReadBufferLimitTest, KernelTlsOffload) {
+  KernelTlsOsSysCalls os_sys_calls;
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+  kernel_tls_offload_ = true;
+  client_tls_params_.set_tls_maximum_protocol_version(
+      envoy::extensions::transport_sockets::tls::v3::TlsParameters::TLSv1_2);
+  client_tls_params_.add_cipher_suites("ECDHE-RSA-AES128-GCM-SHA256");
+  readBufferLimitTest(0, 256 * 1024, 256 * 1024, 1, false);
+
+  if (!KernelTlsBuilt) {
+    EXPECT_EQ(0U, os_sys_calls.ulp_calls_);
+  } else {
+    // Both sides negotiated TLS 1.2 with AES-GCM and attempted the offload.
+    EXPECT_EQ(2U, os_sys_calls.ulp_calls_);
+  }
+  // The kernel accepted the key material of both directions on both sides, or none of it.
+  const bool offloaded = os_sys_calls.crypto_info_set_ == 4;
+  if (!offloaded) {
+    EXPECT_EQ(0U, os_sys_calls.crypto_info_set_);
+    EXPECT_EQ(0U, os_sys_calls.tx_calls_);
+  }
+  for (Stats::TestUtil::TestStore* store : {&server_stats_store_, &client_stats_store_}) {
+    EXPECT_EQ(offloaded ? 1UL : 0UL, store->counter("ssl.kernel_tls_offloaded").value());
+    EXPECT_EQ(offloaded ? 0UL : 1UL, store->counter("ssl.kernel_tls_offload_failed").value());
+  }
+}
+
+// TLS 1.3 connections are never offloaded.
+TEST_P(SslReadBufferLimitTest, KernelTlsOffloadTls13) {
+  KernelTlsOsSysCalls os_sys_calls;
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+  kernel_tls_offload_ = true;
+  client_tls_params_.set_tls_minimum_protocol_version(
+      envoy::extensions::transport_sockets::tls::v3::TlsParameters::TLSv1_3);
+  client_tls_params_.set_tls_maximum_protocol_version(
+      envoy::extensions::transport_sockets::tls::v3::TlsParameters::TLSv1_3);
+  readBufferLimitTest(0, 256 * 1024, 256 * 1024, 1, false);
+
+  EXPECT_EQ(0U, os_sys_calls.ulp_calls_);
+  for (Stats::TestUtil::TestStore* store : {&server_stats_store_, &client_stats_store_}) {
+    EXPECT_EQ(0UL, store->counter("ssl.kernel_tls_offloaded").value());
+    EXPECT_EQ(1UL, store->counter("ssl.kernel_tls_offload_failed").value());
+  }
+}
+
+#if defined(__linux__) && __has_include(<linux/tls.h>)
+// When the kernel can't decrypt records, encryption isn't offloaded either, and the connection
+// keeps using BoringSSL in both directions.
+TEST_P(SslReadBufferLimitTest, KernelTlsOffloadRxFailure) {
+  KernelTlsOsSysCalls os_sys_calls;
+  // No ULP is actually attached, so the socket stays a plain TCP socket.
+  os_sys_calls.ulp_result_ = Api::SysCallIntResult{0, 0};
+  os_sys_calls.rx_result_ = Api::SysCallIntResult{-1, ENOPROTOOPT};
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+  kernel_tls_offload_ = true;
+  client_tls_params_.set_tls_maximum_protocol_version(
+      envoy::extensions::transport_sockets::tls::v3::TlsParameters::TLSv1_2);
+  client_tls_params_.add_cipher_suites("ECDHE-RSA-AES128-GCM-SHA256");
+  readBufferLimitTest(0, 256 * 1024, 256 * 1024, 1, false);
+
+  EXPECT_EQ(2U, os_sys_calls.rx_calls_);
+  EXPECT_EQ(0U, os_sys_calls.tx_calls_);
+  for (Stats::TestUtil::TestStore* store : {&server_stats_store_, &client_stats_store_}) {
+    EXPECT_EQ(0UL, store->counter("ssl.kernel_tls_offloaded").value());
+    EXPECT_EQ(1UL, store->counter("ssl.kernel_tls_offload_failed").value());
+  }
+}
+
+// Once the kernel decrypts records, a connection whose encryption can't be offloaded can't go back
+// to BoringSSL, and is closed instead of being offloaded in one direction only.
+TEST_P(SslReadBufferLimitTest, KernelTlsOffloadTxFailure) {
+  KernelTlsOsSysCalls os_sys_calls;
+  // Nothing is actually handed over to the kernel, so the close_notify sent by BoringSSL is still
+  // readable by the peer.
+  os_sys_calls.ulp_result_ = Api::SysCallIntResult{0, 0};
+  os_sys_calls.rx_result_ = Api::SysCallIntResult{0, 0};
+  os_sys_calls.tx_result_ = Api::SysCallIntResult{-1, ENOPROTOOPT};
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+  kernel_tls_offload_ = true;
+  client_tls_params_.set_tls_maximum_protocol_version(
+      envoy::extensions::transport_sockets::tls::v3::TlsParameters::TLSv1_2);
+  client_tls_params_.add_cipher_suites("ECDHE-RSA-AES128-GCM-SHA256");
+  initialize();
+
+  EXPECT_CALL(listener_callbacks_, onAccept_(_))
+      .WillOnce(Invoke([&](Network::ConnectionSocketPtr& socket) -> void {
+        server_connection_ = dispatcher_->createServerConnection(
+            std::move(socket), server_ssl_socket_factory_->createDownstreamTransportSocket(),
+            stream_info_);
+        server_connection_->addConnectionCallbacks(server_callbacks_);
+      }));
+  EXPECT_CALL(listener_callbacks_, recordConnectionsAcceptedOnSocketEvent(_));
+  EXPECT_CALL(server_callbacks_, onEvent(Network::ConnectionEvent::Connected)).Times(0);
+  EXPECT_CALL(server_callbacks_, onEvent(Network::ConnectionEvent::LocalClose));
+  // The client is never connected. Depending on which side completes the handshake first, it
+  // closes the connection itself or sees the server close it.
+  EXPECT_CALL(client_callbacks_, onEvent(testing::AnyOf(Network::ConnectionEvent::LocalClose,
+                                                        Network::ConnectionEvent::RemoteClose)))
+      .WillOnce(Invoke([&](Network::ConnectionEvent) -> void { dispatcher_->exit(); }));
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+
+  EXPECT_EQ(0UL, server_stats_store_.counter("ssl.kernel_tls_offloaded").value());
+  EXPECT_EQ(1UL, server_stats_store_.counter("ssl.kernel_tls_offload_failed").value());
+  EXPECT_EQ(0UL, client_stats_store_.counter("ssl.kernel_tls_offloaded").value());
+}
+
+// Fakes the offload of both directions without handing anything over to the kernel, so records go
+// over the socket unencrypted. Control messages carrying a TLS record type are captured instead of
+// being sent. A read can be failed once, and with EIO, which the kernel returns when the next
+// record isn't application data, the following recvmsg() returns the given record.
+class KernelTlsRecordOsSysCalls : public KernelTlsOsSysCalls {
+public:
+  // From <linux/tls.h>.
+  static constexpr int TlsSetRecordType = 1;
+  static constexpr int TlsGetRecordType = 2;
+
+  using Record = std::pair<uint8_t, std::string>;
+
+  KernelTlsRecordOsSysCalls() {
+    ulp_result_ = Api::SysCallIntResult{0, 0};
+    rx_result_ = Api::SysCallIntResult{0, 0};
+    tx_result_ = Api::SysCallIntResult{0, 0};
+  }
+
+  void failNextRead(int error, absl::optional<Record> record = absl::nullopt) {
+    read_errno_ = error;
+    pending_record_ = std::move(record);
+  }
+
+  Api::SysCallSizeResult recv(os_fd_t socket, void* buffer, size_t length, int flags) override {
+    if (read_errno_ != 0) {
+      return {-1, std::exchange(read_errno_, 0)};
+    }
+    return Api::OsSysCallsImpl::recv(socket, buffer, length, flags);
+  }
+
+  Api::SysCallSizeResult readv(os_fd_t fd, const iovec* iov, int num_iov) override {
+    if (read_errno_ != 0) {
+      return {-1, std::exchange(read_errno_, 0)};
+    }
+    return Api::OsSysCallsImpl::readv(fd, iov, num_iov);
+  }
+
+  Api::SysCallSizeResult writev(os_fd_t fd, const iovec* iov, int num_iov) override {
+    if (write_errno_ != 0) {
+      return {-1, std::exchange(write_errno_, 0)};
+    }
+    return Api::OsSysCallsImpl::writev(fd, iov, num_iov);
+  }
+
+  Api::SysCallSizeResult recvmsg(os_fd_t sockfd, msghdr* msg, int flags) override {
+    if (!pending_record_.has_value()) {
+      return Api::OsSysCallsImpl::recvmsg(sockfd, msg, flags);
+    }
+    ++records_received_;
+    const Record record = *std::exchange(pending_record_, absl::nullopt);
+    EXPECT_EQ(1U, msg->msg_iovlen);
+    const size_t length = std::min(record.second.size(), msg->msg_iov[0].iov_len);
+    memcpy(msg->msg_iov[0].iov_base, record.second.data(), length);
+    cmsghdr* cmsg = CMSG_FIRSTHDR(msg);
+    EXPECT_NE(nullptr, cmsg);
+    cmsg->cmsg_level = SolTls;
+    cmsg->cmsg_type = TlsGetRecordType;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(uint8_t));
+    *CMSG_DATA(cmsg) = record.first;
+    return {static_cast<ssize_t>(length), 0};
+  }
+
+  Api::SysCallSizeResult sendmsg(os_fd_t fd, const msghdr* message, int flags) override {
+    const cmsghdr* cmsg = CMSG_FIRSTHDR(message);
+    if (cmsg == nullptr || cmsg->cmsg_level != SolTls) {
+      return Api::OsSysCallsImpl::sendmsg(fd, message, flags);
+    }
+    EXPECT_EQ(TlsSetRecordType, cmsg->cmsg_type);
+    std::string data;
+    for (size_t i = 0; i < message->msg_iovlen; ++i) {
+      data.append(static_cast<const char*>(message->msg_iov[i].iov_base),
+                  message->msg_iov[i].iov_len);
+    }
+    sent_records_.emplace_back(*CMSG_DATA(cmsg), data);
+    return {static_cast<ssize_t>(data.size()), 0};
+  }
+
+  int read_errno_{0};
+  int write_errno_{0};
+  absl::optional<Record> pending_record_;
+  uint32_t records_received_{0};
+  std::vector<Record> sent_records_;
+};
+
+KernelTlsRecordOsSysCalls::Record alertRecord(uint8_t level, uint8_t description) {
+  return {SSL3_RT_ALERT, std::string{static_cast<char>(level), static_cast<char>(description)}};
+}
+
+KernelTlsRecordOsSysCalls::Record closeNotifyRecord() {
+  return alertRecord(SSL3_AL_WARNING, SSL_AD_CLOSE_NOTIFY);
+}
+
+// Tests the I/O path of connections whose records are encrypted and decrypted by the kernel.
+class SslKernelTlsTest : public SslReadBufferLimitTest {
+protected:
+  SslKernelTlsTest() : os_calls_(&os_sys_calls_) {
+    kernel_tls_offload_ = true;
+    client_tls_params_.set_tls_maximum_protocol_version(
+        envoy::extensions::transport_sockets::tls::v3::TlsParameters::TLSv1_2);
+    client_tls_params_.add_cipher_suites("ECDHE-RSA-AES128-GCM-SHA256");
+  }
+
+  // Connects the client to the server, and offloads both of them.
+  void connect() {
+    initialize();
+    EXPECT_CALL(listener_callbacks_, onAccept_(_))
+        .WillOnce(Invoke([&](Network::ConnectionSocketPtr& socket) -> void {
+          server_connection_ = dispatcher_->createServerConnection(
+              std::move(socket), server_ssl_socket_factory_->createDownstreamTransportSocket(),
+              stream_info_);
+          server_connection_->enableHalfClose(true);
+          server_connection_->addConnectionCallbacks(server_callbacks_);
+          server_connection_->addReadFilter(read_filter_);
+        }));
+    EXPECT_CALL(listener_callbacks_, recordConnectionsAcceptedOnSocketEvent(_));
+    EXPECT_CALL(client_callbacks_, onEvent(Network::ConnectionEvent::Connected))
+        .WillOnce(Invoke([&](Network::ConnectionEvent) -> void { dispatcher_->exit(); }));
+    dispatcher_->run(Event::Dispatcher::RunType::Block);
+    EXPECT_CALL(*read_filter_, onNewConnection()).Times(testing::AnyNumber());
+
+    for (Stats::TestUtil::TestStore* store : {&server_stats_store_, &client_stats_store_}) {
+      EXPECT_EQ(1UL, store->counter("ssl.kernel_tls_offloaded").value());
+    }
+  }
+
+  // Runs until both the server and the client saw their connection close.
+  void waitForClose(Network::ConnectionEvent server_event, Network::ConnectionEvent client_event) {
+    uint32_t closed = 0;
+    const auto on_close = [&](Network::ConnectionEvent) -> void {
+      if (++closed == 2) {
+        dispatcher_->exit();
+      }
+    };
+    EXPECT_CALL(server_callbacks_, onEvent(server_event)).WillOnce(Invoke(on_close));
+    EXPECT_CALL(client_callbacks_, onEvent(client_event)).WillOnce(Invoke(on_close));
+    dispatcher_->run(Event::Dispatcher::RunType::Block);
+  }
+
+  KernelTlsRecordOsSysCalls os_sys_calls_;
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls_;
+};
+
+INSTANTIATE_TEST_SUITE_P(IpVersions, SslKernelTlsTest,
+                         testing::ValuesIn(TestEnvironment::getIpVersionsForTest()),
+                         TestUtility::ipTestParamsToString);
+
+// Data is read and written straight from and to the socket, in chunks bounded by the read buffer
+// limit, and closing the connection sends a close_notify alert record.
+TEST_P(SslKernelTlsTest, ReadWrite) {
+  readBufferLimitTest(32 * 1024, 32 * 1024, 256 * 1024, 1, false);
+
+  for (Stats::TestUtil::TestStore* store : {&server_stats_store_, &client_stats_store_}) {
+    EXPECT_EQ(1UL, store->counter("ssl.kernel_tls_offloaded").value());
+    EXPECT_EQ(0UL, store->counter("ssl.kernel_tls_offload_failed").value());
+  }
+  // Both sides sent a close_notify alert when closing their connection.
+  EXPECT_THAT(os_sys_calls_.sent_records_,
+              testing::ElementsAre(closeNotifyRecord(), closeNotifyRecord()));
+}
+
+// A close_notify alert received from the peer ends the stream.
+TEST_P(SslKernelTlsTest, ReceiveCloseNotify) {
+  connect();
+
+  os_sys_calls_.failNextRead(EIO, closeNotifyRecord());
+  EXPECT_CALL(*read_filter_, onData(_, true))
+      .WillOnce(Invoke([&](Buffer::Instance&, bool) -> Network::FilterStatus {
+        server_connection_->close(Network::ConnectionCloseType::NoFlush);
+        return Network::FilterStatus::StopIteration;
+      }));
+  Buffer::OwnedImpl data("hello");
+  client_connection_->write(data, false);
+  waitForClose(Network::ConnectionEvent::LocalClose, Network::ConnectionEvent::RemoteClose);
+
+  EXPECT_EQ(1U, os_sys_calls_.records_received_);
+  EXPECT_THAT(os_sys_calls_.sent_records_,
+              testing::ElementsAre(closeNotifyRecord(), closeNotifyRecord()));
+}
+
+// Any other alert closes the connection, even with half-close enabled.
+TEST_P(SslKernelTlsTest, ReceiveOtherAlert) {
+  connect();
+
+  os_sys_calls_.failNextRead(EIO, alertRecord(SSL3_AL_FATAL, SSL_AD_HANDSHAKE_FAILURE));
+  EXPECT_CALL(*read_filter_, onData(_, _)).Times(0);
+  Buffer::OwnedImpl data("hello");
+  client_connection_->write(data, false);
+  waitForClose(Network::ConnectionEvent::RemoteClose, Network::ConnectionEvent::RemoteClose);
+
+  EXPECT_EQ(1U, os_sys_calls_.records_received_);
+}
+
+// Post-handshake messages can't be handed to BoringSSL, so they close the connection too.
+TEST_P(SslKernelTlsTest, ReceiveHandshakeRecord) {
+  connect();
+
+  const KernelTlsRecordOsSysCalls::Record new_session_ticket{
+      SSL3_RT_HANDSHAKE, std::string{static_cast<char>(SSL3_MT_NEW_SESSION_TICKET), 0}};
+  os_sys_calls_.failNextRead(EIO, new_session_ticket);
+  EXPECT_CALL(*read_filter_, onData(_, _)).Times(0);
+  Buffer::OwnedImpl data("hello");
+  client_connection_->write(data, false);
+  waitForClose(Network::ConnectionEvent::RemoteClose, Network::ConnectionEvent::RemoteClose);
+
+  EXPECT_EQ(1U, os_sys_calls_.records_received_);
+}
+
+// Read errors other than a record that isn't application data close the connection without
+// looking for a record.
+TEST_P(SslKernelTlsTest, ReadError) {
+  connect();
+
+  os_sys_calls_.failNextRead(ECONNRESET);
+  EXPECT_CALL(*read_filter_, onData(_, _)).Times(0);
+  Buffer::OwnedImpl data("hello");
+  client_connection_->write(data, false);
+  waitForClose(Network::ConnectionEvent::RemoteClose, Network::ConnectionEvent::RemoteClose);
+
+  EXPECT_EQ(0U, os_sys_calls_.records_received_);
+}
+
+// Write errors close the connection, which still tries to send a close_notify alert.
+TEST_P(SslKernelTlsTest, WriteError) {
+  connect();
+
+  os_sys_calls_.write_errno_ = EPIPE;
+  // The server only sees the client close the connection.
+  EXPECT_CALL(*read_filter_, onData(_, true))
+      .WillOnce(Invoke([&](Buffer::Instance& data, bool) -> Network::FilterStatus {
+        EXPECT_EQ(0U, data.length());
+        server_connection_->close(Network::ConnectionCloseType::NoFlush);
+        return Network::FilterStatus::StopIteration;
+      }));
+  Buffer::OwnedImpl data("hello");
+  client_connection_->write(data, false);
+  waitForClose(Network::ConnectionEvent::LocalClose, Network::ConnectionEvent::RemoteClose);
+
+  EXPECT_THAT(os_sys_calls_.sent_records_,
+              testing::ElementsAre(closeNotifyRecord(), closeNotifyRecord()));
+}
+#endif
+
 TEST_P(SslReadBufferLimitTest, WritesSmallerThanBufferLimit) { singleWriteTest(5 * 1024, 1024); }
 
 TEST_P(SslReadBufferLimitTest, WritesLargerThanBufferLimit) { singleWriteTest(1024, 5 * 1024); }
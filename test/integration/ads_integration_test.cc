@@ -57,6 +57,47 @@ TEST_P(AdsIntegrationTest, BasicClusterInitialWarming) {
   test_server_->waitForGaugeEq("cluster.cluster_0.warming_state", 0);
 }
 
+// Validate that an update split into several delta responses is applied chunk by chunk and only
+// ACKed once its last chunk arrives.
+TEST_P(AdsIntegrationTest, ChunkedDeltaUpdate) {
+  if (sotw_or_delta_ != Grpc::SotwOrDelta::Delta) {
+    GTEST_SKIP() << "Chunked updates are only supported by the legacy delta mux";
+  }
+  initialize();
+  const auto cds_type_url = Config::getTypeUrl<envoy::config::cluster::v3::Cluster>();
+  const auto eds_type_url =
+      Config::getTypeUrl<envoy::config::endpoint::v3::ClusterLoadAssignment>();
+
+  EXPECT_TRUE(compareDiscoveryRequest(cds_type_url, "", {}, {}, {}, true));
+  auto first_chunk = createDeltaDiscoveryResponse<envoy::config::cluster::v3::Cluster>(
+      cds_type_url, {buildCluster("cluster_0")}, {}, "1", {});
+  first_chunk.set_more_chunks(true);
+  xds_stream_->sendGrpcMessage(first_chunk);
+
+  // CDS is waiting for its first update, so it gets the whole update with the last chunk and
+  // starts warming both clusters at once.
+  const auto last_chunk = createDeltaDiscoveryResponse<envoy::config::cluster::v3::Cluster>(
+      cds_type_url, {buildCluster("cluster_1")}, {}, "1", {});
+  xds_stream_->sendGrpcMessage(last_chunk);
+  test_server_->waitForGaugeEq("cluster_manager.warming_clusters", 2);
+  EXPECT_EQ(1, test_server_->counter("cluster_manager.cds.update_success")->value());
+
+  // Skip the EDS requests of the new clusters; the first CDS request must ACK the last chunk.
+  envoy::service::discovery::v3::DeltaDiscoveryRequest request;
+  do {
+    ASSERT_TRUE(xds_stream_->waitForGrpcMessage(*dispatcher_, request));
+  } while (request.type_url() != cds_type_url);
+  EXPECT_EQ(last_chunk.nonce(), request.response_nonce());
+  EXPECT_FALSE(request.has_error_detail());
+
+  const std::vector<envoy::config::endpoint::v3::ClusterLoadAssignment> load_assignments = {
+      buildClusterLoadAssignment("cluster_0"), buildClusterLoadAssignment("cluster_1")};
+  sendDiscoveryResponse<envoy::config::endpoint::v3::ClusterLoadAssignment>(
+      eds_type_url, load_assignments, load_assignments, {}, "1");
+  test_server_->waitForGaugeEq("cluster_manager.warming_clusters", 0);
+  test_server_->waitForGaugeGe("cluster_manager.active_clusters", 3);
+}
+
 // Tests that the Envoy xDS client can handle updates to a subset of the subscribed resources from
 // an xDS server without removing the resources not included in the DiscoveryResponse from the xDS
 // server.
@@ -1417,7 +1458,13 @@ TEST_P(AdsIntegrationTest, NodeMessage) {
   build_version_msg.MergeFrom(node->user_agent_build_version());
   EXPECT_THAT(build_version_msg, ProtoEq(VersionInfo::buildVersion()));
   EXPECT_GE(node->extensions().size(), 0);
-  EXPECT_EQ(0, node->client_features().size());
+  // Only the legacy delta implementation with explicit wildcard resources tracks chunked updates.
+  if (sotw_or_delta_ == Grpc::SotwOrDelta::Delta && oldDssOrNewDss() == OldDssOrNewDss::New) {
+    ASSERT_EQ(1, node->client_features().size());
+    EXPECT_EQ("envoy.config.supports-delta-chunks", node->client_features(0));
+  } else {
+    EXPECT_EQ(0, node->client_features().size());
+  }
   xds_stream_->finishGrpcStream(Grpc::Status::Ok);
 }
 
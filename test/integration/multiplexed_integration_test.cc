@@ -2120,6 +2120,111 @@ TEST_P(Http2FrameIntegrationTest, DownstreamSendingEmptyMetadata) {
   tcp_client_->close();
 }
 
+// Verify that all requests sent in one I/O cycle are served when the number of requests
+// dispatched per I/O cycle is limited.
+TEST_P(Http2FrameIntegrationTest, MultipleRequestsDeferredToNextIoCycle) {
+  const int kRequestsSentPerIOCycle = 20;
+  autonomous_upstream_ = true;
+  config_helper_.addRuntimeOverride("http.max_requests_per_io_cycle", "1");
+  beginSession();
+
+  std::string buffer;
+  for (int i = 0; i < kRequestsSentPerIOCycle; ++i) {
+    auto request = Http2Frame::makeRequest(Http2Frame::makeClientStreamId(i), "a", "/",
+                                           {{"response_data_blocks", "0"}, {"no_trailers", "1"}});
+    absl::StrAppend(&buffer, std::string(request));
+  }
+
+  ASSERT_TRUE(tcp_client_->write(buffer, false, false));
+
+  for (int i = 0; i < kRequestsSentPerIOCycle; ++i) {
+    auto frame = readFrame();
+    EXPECT_EQ(Http2Frame::Type::Headers, frame.type());
+    EXPECT_EQ(Http2Frame::ResponseStatus::Ok, frame.responseStatus());
+  }
+  tcp_client_->close();
+}
+
+// Verify that request bodies received while a request is deferred to the next I/O cycle are
+// forwarded upstream.
+TEST_P(Http2FrameIntegrationTest, MultipleRequestsWithBodyDeferredToNextIoCycle) {
+  const int kRequestsSentPerIOCycle = 10;
+  autonomous_upstream_ = true;
+  config_helper_.addRuntimeOverride("http.max_requests_per_io_cycle", "2");
+  beginSession();
+
+  std::string buffer;
+  for (int i = 0; i < kRequestsSentPerIOCycle; ++i) {
+    const uint32_t stream_id = Http2Frame::makeClientStreamId(i);
+    auto request = Http2Frame::makePostRequest(
+        stream_id, "a", "/", {{"response_data_blocks", "0"}, {"no_trailers", "1"}});
+    auto data = Http2Frame::makeDataFrame(stream_id, "hello", Http2Frame::DataFlags::EndStream);
+    absl::StrAppend(&buffer, std::string(request), std::string(data));
+  }
+
+  ASSERT_TRUE(tcp_client_->write(buffer, false, false));
+
+  for (int i = 0; i < kRequestsSentPerIOCycle; ++i) {
+    auto frame = readFrame();
+    EXPECT_EQ(Http2Frame::Type::Headers, frame.type());
+    EXPECT_EQ(Http2Frame::ResponseStatus::Ok, frame.responseStatus());
+  }
+  tcp_client_->close();
+}
+
+// Verify that request metadata received while a request is deferred to the next I/O cycle is
+// forwarded upstream, in order with the request body.
+TEST_P(Http2FrameIntegrationTest, MultipleRequestsWithMetadataDeferredToNextIoCycle) {
+  const int kRequestsSentPerIOCycle = 4;
+  config_helper_.addRuntimeOverride("http.max_requests_per_io_cycle", "1");
+  // Allow metadata usage.
+  config_helper_.addConfigModifier([&](envoy::config::bootstrap::v3::Bootstrap& bootstrap) -> void {
+    RELEASE_ASSERT(bootstrap.mutable_static_resources()->clusters_size() >= 1, "");
+    ConfigHelper::HttpProtocolOptions protocol_options;
+    protocol_options.mutable_explicit_http_config()
+        ->mutable_http2_protocol_options()
+        ->set_allow_metadata(true);
+    ConfigHelper::setProtocolOptions(*bootstrap.mutable_static_resources()->mutable_clusters(0),
+                                     protocol_options);
+  });
+  config_helper_.addConfigModifier(
+      [&](envoy::extensions::filters::network::http_connection_manager::v3::HttpConnectionManager&
+              hcm) -> void { hcm.mutable_http2_protocol_options()->set_allow_metadata(true); });
+  beginSession();
+
+  std::string buffer;
+  for (int i = 0; i < kRequestsSentPerIOCycle; ++i) {
+    const uint32_t stream_id = Http2Frame::makeClientStreamId(i);
+    const Http::MetadataMap metadata_map{{"key", absl::StrCat("value", i)}};
+    absl::StrAppend(
+        &buffer, std::string(Http2Frame::makePostRequest(stream_id, "a", "/")),
+        std::string(Http2Frame::makeDataFrame(stream_id, "hello")),
+        std::string(Http2Frame::makeMetadataFrameFromMetadataMap(
+            stream_id, metadata_map, Http2Frame::MetadataFlags::EndMetadata)),
+        std::string(
+            Http2Frame::makeDataFrame(stream_id, "world", Http2Frame::DataFlags::EndStream)));
+  }
+
+  ASSERT_TRUE(tcp_client_->write(buffer, false, false));
+
+  ASSERT_TRUE(fake_upstreams_[0]->waitForHttpConnection(*dispatcher_, fake_upstream_connection_));
+  for (int i = 0; i < kRequestsSentPerIOCycle; ++i) {
+    FakeStreamPtr upstream_request;
+    ASSERT_TRUE(fake_upstream_connection_->waitForNewStream(*dispatcher_, upstream_request));
+    ASSERT_TRUE(upstream_request->waitForEndStream(*dispatcher_));
+    EXPECT_EQ("helloworld", upstream_request->body().toString());
+    EXPECT_EQ(absl::StrCat("value", i), upstream_request->metadataMap()["key"]);
+    upstream_request->encodeHeaders(default_response_headers_, true);
+  }
+
+  for (int i = 0; i < kRequestsSentPerIOCycle; ++i) {
+    auto frame = readFrame();
+    EXPECT_EQ(Http2Frame::Type::Headers, frame.type());
+    EXPECT_EQ(Http2Frame::ResponseStatus::Ok, frame.responseStatus());
+  }
+  tcp_client_->close();
+}
+
 // Tests that an empty metadata map from upstream is ignored.
 TEST_P(Http2MetadataIntegrationTest, UpstreamSendingEmptyMetadata) {
   initialize();
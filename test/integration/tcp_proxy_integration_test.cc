@@ -272,6 +272,58 @@ TEST_P(TcpProxyIntegrationTest, TcpProxyLargeWrite) {
   EXPECT_EQ(downstream_pauses, downstream_resumes);
 }
 
+// Test that data and half closes are forwarded in both directions when splicing, and that the
+// forwarded data is still accounted for.
+TEST_P(TcpProxyIntegrationTest, ZeroCopyForwarding) {
+  setupByteMeterAccessLog();
+  config_helper_.addConfigModifier([&](envoy::config::bootstrap::v3::Bootstrap& bootstrap) -> void {
+    auto* listener = bootstrap.mutable_static_resources()->mutable_listeners(0);
+    auto* filter_chain = listener->mutable_filter_chains(0);
+    auto* config_blob = filter_chain->mutable_filters(0)->mutable_typed_config();
+
+    ASSERT_TRUE(config_blob->Is<envoy::extensions::filters::network::tcp_proxy::v3::TcpProxy>());
+    auto tcp_proxy_config =
+        MessageUtil::anyConvert<envoy::extensions::filters::network::tcp_proxy::v3::TcpProxy>(
+            *config_blob);
+    tcp_proxy_config.set_zero_copy_forwarding(true);
+    config_blob->PackFrom(tcp_proxy_config);
+  });
+  config_helper_.setBufferLimits(1024, 1024);
+  initialize();
+
+  IntegrationTcpClientPtr tcp_client = makeTcpConnection(lookupPort("tcp_proxy"));
+  ASSERT_TRUE(tcp_client->write("hello"));
+  FakeRawConnectionPtr fake_upstream_connection;
+  ASSERT_TRUE(fake_upstreams_[0]->waitForRawConnection(fake_upstream_connection));
+  ASSERT_TRUE(fake_upstream_connection->waitForData(5));
+
+  // Larger than both the buffer limits and the splice pipe.
+  const std::string data(512 * 1024, 'a');
+  ASSERT_TRUE(tcp_client->write(data));
+  ASSERT_TRUE(fake_upstream_connection->waitForData(5 + data.size()));
+  ASSERT_TRUE(fake_upstream_connection->write(data));
+  tcp_client->waitForData(data);
+
+  ASSERT_TRUE(tcp_client->write("", true));
+  ASSERT_TRUE(fake_upstream_connection->waitForHalfClose());
+  ASSERT_TRUE(fake_upstream_connection->write("world", true));
+  tcp_client->waitForData(data + "world");
+  tcp_client->waitForHalfClose();
+  ASSERT_TRUE(fake_upstream_connection->waitForDisconnect());
+  tcp_client->close();
+
+  test_server_.reset();
+  const uint64_t received = 5 + data.size();
+  const uint64_t sent = data.size() + 5;
+  auto log_result = waitForAccessLog(listener_access_log_name_);
+  EXPECT_THAT(log_result,
+              MatchesRegex(fmt::format("DOWNSTREAM_WIRE_BYTES_SENT={0} "
+                                       "DOWNSTREAM_WIRE_BYTES_RECEIVED={1} "
+                                       "UPSTREAM_WIRE_BYTES_SENT={1} "
+                                       "UPSTREAM_WIRE_BYTES_RECEIVED={0}\r?.*",
+                                       sent, received)));
+}
+
 // Test that a downstream flush works correctly (all data is flushed)
 TEST_P(TcpProxyIntegrationTest, TcpProxyDownstreamFlush) {
   // Use a very large size to make sure it is larger than the kernel socket read buffer.
@@ -61,6 +61,12 @@ public:
       (const Protobuf::RepeatedPtrField<envoy::service::discovery::v3::Resource>& added_resources,
        const Protobuf::RepeatedPtrField<std::string>& removed_resources,
        const std::string& system_version_info));
+  MOCK_METHOD(
+      void, onChunkedConfigUpdate,
+      (const Protobuf::RepeatedPtrField<envoy::service::discovery::v3::Resource>& added_resources,
+       const Protobuf::RepeatedPtrField<std::string>& removed_resources,
+       const std::string& system_version_info, bool more_chunks));
+  MOCK_METHOD(void, onChunkedConfigUpdateInterrupted, ());
   MOCK_METHOD(void, onConfigUpdateFailed,
               (Envoy::Config::ConfigUpdateFailureReason reason, const EnvoyException* e));
 };
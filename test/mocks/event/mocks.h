@@ -103,6 +103,10 @@ public:
     return timer;
   }
 
+  // Coarse timers are plain timers for mocking purposes, so that expectations set on
+  // createTimer_() cover them.
+  Event::TimerPtr createCoarseTimer(Event::TimerCb cb) override { return createTimer(cb); }
+
   Event::SchedulableCallbackPtr createSchedulableCallback(std::function<void()> cb) override {
     auto schedulable_cb = Event::SchedulableCallbackPtr{createSchedulableCallback_(cb)};
     if (!allow_null_callback_) {
@@ -81,6 +81,8 @@ public:
     return impl_.createScaledTimer(timer_type, std::move(cb));
   }
 
+  TimerPtr createCoarseTimer(TimerCb cb) override { return impl_.createCoarseTimer(std::move(cb)); }
+
   Event::SchedulableCallbackPtr createSchedulableCallback(std::function<void()> cb) override {
     return impl_.createSchedulableCallback(std::move(cb));
   }
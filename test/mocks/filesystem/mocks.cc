@@ -31,6 +31,34 @@ Api::IoCallSizeResult MockFile::write(absl::string_view buffer) {
   return result;
 }
 
+Api::IoCallSizeResult MockFile::writev(absl::Span<const absl::string_view> buffers) {
+  absl::MutexLock lock(&mutex_);
+  if (!is_open_) {
+    return {-1, Api::IoErrorPtr(nullptr, [](Api::IoError*) { PANIC("reached unexpected code"); })};
+  }
+
+  // Each buffer is passed to write_(), so that expectations on write_() cover both calls, and the
+  // buffers after a partial write are left unwritten.
+  num_writevs_++;
+  ssize_t total_written = 0;
+  for (absl::string_view buffer : buffers) {
+    Api::IoCallSizeResult result = write_(buffer);
+    num_writes_++;
+    if (!result.ok()) {
+      if (total_written > 0) {
+        break;
+      }
+      return result;
+    }
+    total_written += result.return_value_;
+    if (result.return_value_ < static_cast<ssize_t>(buffer.size())) {
+      break;
+    }
+  }
+  return {total_written,
+          Api::IoErrorPtr(nullptr, [](Api::IoError*) { PANIC("reached unexpected code"); })};
+}
+
 Api::IoCallSizeResult MockFile::pread(void* buf, uint64_t count, uint64_t offset) {
   absl::MutexLock lock(&mutex_);
   if (!is_open_) {
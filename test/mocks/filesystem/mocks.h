@@ -21,6 +21,7 @@ public:
   // Filesystem::File
   Api::IoCallBoolResult open(FlagSet flag) override;
   Api::IoCallSizeResult write(absl::string_view buffer) override;
+  Api::IoCallSizeResult writev(absl::Span<const absl::string_view> buffers) override;
   Api::IoCallBoolResult close() override;
   Api::IoCallSizeResult pread(void* buf, uint64_t count, uint64_t offset) override;
   Api::IoCallSizeResult pwrite(const void* buf, uint64_t count, uint64_t offset) override;
@@ -39,6 +40,7 @@ public:
   absl::Mutex mutex_;
   uint64_t num_opens_{0};
   uint64_t num_writes_{0};
+  uint64_t num_writevs_{0};
   uint64_t num_preads_{0};
   uint64_t num_pwrites_{0};
 
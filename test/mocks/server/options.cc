@@ -48,6 +48,10 @@ MockOptions::MockOptions(const std::string& config_path) : config_path_(config_p
   ON_CALL(*this, socketPath()).WillByDefault(ReturnRef(socket_path_));
   ON_CALL(*this, socketMode()).WillByDefault(ReturnPointee(&socket_mode_));
   ON_CALL(*this, statsTags()).WillByDefault(ReturnRef(stats_tags_));
+  ON_CALL(*this, statsCompactStorageEnabled())
+      .WillByDefault(ReturnPointee(&stats_compact_storage_));
+  ON_CALL(*this, statsScopeTlsCachesDisabled())
+      .WillByDefault(ReturnPointee(&stats_scope_tls_caches_disabled_));
 }
 
 MockOptions::~MockOptions() = default;
@@ -54,6 +54,8 @@ public:
   MOCK_METHOD(const std::string&, socketPath, (), (const));
   MOCK_METHOD(mode_t, socketMode, (), (const));
   MOCK_METHOD((const Stats::TagVector&), statsTags, (), (const));
+  MOCK_METHOD(bool, statsCompactStorageEnabled, (), (const));
+  MOCK_METHOD(bool, statsScopeTlsCachesDisabled, (), (const));
 
   std::string config_path_;
   envoy::config::bootstrap::v3::Bootstrap config_proto_;
@@ -79,6 +81,8 @@ public:
   std::string socket_path_;
   mode_t socket_mode_;
   Stats::TagVector stats_tags_;
+  bool stats_compact_storage_{};
+  bool stats_scope_tls_caches_disabled_{};
 };
 } // namespace Server
 } // namespace Envoy
@@ -74,7 +74,9 @@ public:
   std::string tagExtractedName() const override {
     return tag_extracted_name_.empty() ? name() : tag_extracted_name_;
   }
-  StatName tagExtractedStatName() const override { return tag_extracted_stat_name_->statName(); }
+  StatName tagExtractedStatName() const override {
+    return tag_extracted_stat_name_ == nullptr ? statName() : tag_extracted_stat_name_->statName();
+  }
   void iterateTagStatNames(const Metric::TagStatNameIterFn& fn) const override {
     ASSERT((tag_names_and_values_.size() % 2) == 0);
     for (size_t i = 0; i < tag_names_and_values_.size(); i += 2) {
@@ -168,6 +170,7 @@ public:
   MOCK_METHOD(uint64_t, value, (), (const));
   MOCK_METHOD(absl::optional<bool>, cachedShouldImport, (), (const));
   MOCK_METHOD(ImportMode, importMode, (), (const));
+  MOCK_METHOD(bool, latchChanged, ());
 
   bool used_;
   bool hidden_;
@@ -239,6 +242,7 @@ public:
   MOCK_METHOD(bool, used, (), (const, override));
   MOCK_METHOD(bool, hidden, (), (const));
   MOCK_METHOD(std::string, value, (), (const, override));
+  MOCK_METHOD(bool, latchChanged, (), (override));
 
   bool used_;
   bool hidden_;
@@ -270,6 +274,7 @@ public:
 
   MOCK_METHOD(void, flush, (MetricSnapshot & snapshot));
   MOCK_METHOD(void, onHistogramComplete, (const Histogram& histogram, uint64_t value));
+  MOCK_METHOD(bool, supportsChangedMetricsOnly, (), (const));
 };
 
 class MockSinkPredicates : public SinkPredicates {
@@ -10,7 +10,10 @@
 #include "test/mocks/stats/mocks.h"
 #include "test/test_common/utility.h"
 
+#include "io/prometheus/client/metrics.pb.h"
+
 using testing::NiceMock;
+using testing::Return;
 using testing::ReturnRef;
 
 namespace Envoy {
@@ -87,6 +90,36 @@ protected:
 
   Stats::StatName makeStat(absl::string_view name) { return pool_.add(name); }
 
+  // Renders all the chunks of a streaming request.
+  std::string render(Admin::Request& request) {
+    Http::TestResponseHeaderMapImpl response_headers;
+    EXPECT_EQ(Http::Code::OK, request.start(response_headers));
+    Buffer::OwnedImpl response;
+    std::string output;
+    bool more;
+    do {
+      more = request.nextChunk(response);
+      output += response.toString();
+      response.drain(response.length());
+    } while (more);
+    return output;
+  }
+
+  // Parses a response made of length-delimited MetricFamily messages.
+  std::vector<io::prometheus::client::MetricFamily> parseFamilies(const std::string& response) {
+    std::vector<io::prometheus::client::MetricFamily> families;
+    Protobuf::io::ArrayInputStream stream(response.data(), response.size());
+    Protobuf::io::CodedInputStream coded_stream(&stream);
+    uint32_t size;
+    while (coded_stream.ReadVarint32(&size)) {
+      const auto limit = coded_stream.PushLimit(size);
+      families.emplace_back();
+      EXPECT_TRUE(families.back().ParseFromCodedStream(&coded_stream));
+      coded_stream.PopLimit(limit);
+    }
+    return families;
+  }
+
   // Format tags into the name to create a unique stat_name for each name:tag combination.
   // If the same stat_name is passed to makeGauge() or makeCounter(), even with different
   // tags, a copy of the previous metric will be returned.
@@ -290,23 +323,20 @@ envoy_cluster_default_total_match_count{envoy_cluster_name="a"} 0
 envoy_cluster_default_total_match_count{envoy_cluster_name="x"} 0
 )EOF";
 
-  // Note: in the version of prometheus_stats_test.cc that works with the
-  // streaming GroupedStatsRequest, the test code is slightly different;
-  // it's based on the local 'store' object rather than being based on
-  // the counters_ member variable.
-  //    StatsParams params;
-  //    params.type_ = StatsType::Counters;
-  //    params.format_ = StatsFormat::Prometheus;
-  //    auto request = std::make_unique<GroupedStatsRequest>(store, params, custom_namespaces_);
-  //    EXPECT_EQ(expected_output, response(*request));
-  // This code is left here so that we can verify the bug is fixed if we decide to
-  // re-try the streaming Prometheus implementation.
-
   Buffer::OwnedImpl response;
   const uint64_t size = PrometheusStatsFormatter::statsAsPrometheus(
       counters_, gauges_, histograms_, textReadouts_, response, StatsParams(), custom_namespaces);
   EXPECT_EQ(1, size);
   EXPECT_EQ(expected_output, response.toString());
+
+  // The streaming request must render both counters in the same family, even though the family
+  // spans scopes that are not adjacent, and whatever the chunk size.
+  for (uint64_t chunk_size : {1, 1000}) {
+    PrometheusStatsRequest request(store, StatsParams(), custom_namespaces);
+    request.setChunkSize(chunk_size);
+    EXPECT_EQ(expected_output, render(request));
+    EXPECT_EQ(1, request.familyCount());
+  }
 }
 
 TEST_F(PrometheusStatsFormatterTest, HistogramWithNonDefaultBuckets) {
@@ -915,5 +945,130 @@ envoy_cluster_test_1_upstream_cx_total{a_tag_name="a.tag-value"} 0
   }
 }
 
+TEST_F(PrometheusStatsFormatterTest, StreamingMatchesBuffered) {
+  Stats::CustomStatNamespacesImpl custom_namespaces;
+  Stats::ThreadLocalStoreImpl store(alloc_);
+  envoy::config::metrics::v3::StatsConfig stats_config;
+  store.setTagProducer(std::make_unique<Stats::TagProducerImpl>(stats_config));
+  for (absl::string_view cluster : {"z", "b", "m"}) {
+    Stats::ScopeSharedPtr scope = store.rootScope()->createScope(absl::StrCat("cluster.", cluster));
+    scope->counterFromString("upstream_cx_total").add(cluster.size());
+    scope->counterFromString("upstream_rq_total").inc();
+    scope->gaugeFromString("upstream_cx_active", Stats::Gauge::ImportMode::Accumulate).set(2);
+    scope->textReadoutFromString("version").set(absl::StrCat("v\"", cluster));
+  }
+  store.rootScope()->counterFromString("server.total_connections");
+
+  for (const bool text_readouts : {false, true}) {
+    StatsParams params;
+    params.prometheus_text_readouts_ = text_readouts;
+    Buffer::OwnedImpl expected;
+    const uint64_t size = PrometheusStatsFormatter::statsAsPrometheus(
+        store.counters(), store.gauges(), store.histograms(),
+        text_readouts ? store.textReadouts() : std::vector<Stats::TextReadoutSharedPtr>(),
+        expected, params, custom_namespaces);
+    EXPECT_EQ(text_readouts ? 5 : 4, size);
+
+    for (uint64_t chunk_size : {1, 100, 1000000}) {
+      PrometheusStatsRequest request(store, params, custom_namespaces);
+      request.setChunkSize(chunk_size);
+      EXPECT_EQ(expected.toString(), render(request)) << chunk_size;
+      EXPECT_EQ(size, request.familyCount());
+    }
+  }
+}
+
+TEST_F(PrometheusStatsFormatterTest, ProtobufOutput) {
+  Stats::CustomStatNamespacesImpl custom_namespaces;
+  addCounter("cluster.test_1.upstream_cx_total",
+             {{makeStat("a.tag-name"), makeStat("a.tag-value")}});
+  addCounter("cluster.test_1.upstream_cx_total",
+             {{makeStat("a.tag-name"), makeStat("another\"tag-value")}});
+  addGauge("cluster.test_1.upstream_cx_active", {});
+  addTextReadout("control_plane.identifier", "CP-1", {{makeStat("cluster"), makeStat("c1")}});
+
+  HistogramWrapper h1_cumulative;
+  h1_cumulative.setHistogramValues({1, 2, 100});
+  Stats::HistogramStatisticsImpl h1_cumulative_statistics(
+      h1_cumulative.getHistogram(), Stats::Histogram::Unit::Unspecified, {10, 1000});
+  auto histogram1 = makeHistogram("cluster.test_1.upstream_rq_time", {});
+  EXPECT_CALL(*histogram1, cumulativeStatistics()).WillOnce(ReturnRef(h1_cumulative_statistics));
+  // Zero lands in the zero bucket, 1.05 and 1.075 both land in the exponential bucket
+  // (1, 2^(1/8)] of index 1, and 3.05 in the bucket of index 13.
+  EXPECT_CALL(*histogram1, detailedTotalBuckets())
+      .WillOnce(Return(std::vector<Stats::ParentHistogram::Bucket>{
+          {0, 0, 2}, {1, 0.1, 3}, {1.05, 0.05, 1}, {3, 0.1, 4}}));
+  addHistogram(histogram1);
+
+  StatsParams params;
+  params.prometheus_protobuf_ = true;
+  params.prometheus_text_readouts_ = true;
+  Buffer::OwnedImpl response;
+  EXPECT_EQ(4UL, PrometheusStatsFormatter::statsAsPrometheus(counters_, gauges_, histograms_,
+                                                             textReadouts_, response, params,
+                                                             custom_namespaces));
+  const std::vector<io::prometheus::client::MetricFamily> families =
+      parseFamilies(response.toString());
+  ASSERT_EQ(4, families.size());
+
+  EXPECT_EQ("envoy_cluster_test_1_upstream_cx_total", families[0].name());
+  EXPECT_EQ(io::prometheus::client::COUNTER, families[0].type());
+  ASSERT_EQ(2, families[0].metric_size());
+  ASSERT_EQ(1, families[0].metric(1).label_size());
+  EXPECT_EQ("a_tag_name", families[0].metric(1).label(0).name());
+  // Label values are not escaped in the protobuf format.
+  EXPECT_EQ("another\"tag-value", families[0].metric(1).label(0).value());
+
+  EXPECT_EQ("envoy_cluster_test_1_upstream_cx_active", families[1].name());
+  EXPECT_EQ(io::prometheus::client::GAUGE, families[1].type());
+  ASSERT_EQ(1, families[1].metric_size());
+  EXPECT_EQ(0, families[1].metric(0).label_size());
+
+  EXPECT_EQ("envoy_control_plane_identifier", families[2].name());
+  EXPECT_EQ(io::prometheus::client::GAUGE, families[2].type());
+  ASSERT_EQ(1, families[2].metric_size());
+  ASSERT_EQ(2, families[2].metric(0).label_size());
+  EXPECT_EQ("text_value", families[2].metric(0).label(1).name());
+  EXPECT_EQ("CP-1", families[2].metric(0).label(1).value());
+
+  EXPECT_EQ("envoy_cluster_test_1_upstream_rq_time", families[3].name());
+  EXPECT_EQ(io::prometheus::client::HISTOGRAM, families[3].type());
+  ASSERT_EQ(1, families[3].metric_size());
+  const io::prometheus::client::Histogram& histogram = families[3].metric(0).histogram();
+  EXPECT_EQ(3, histogram.sample_count());
+  ASSERT_EQ(2, histogram.bucket_size());
+  EXPECT_EQ(10, histogram.bucket(0).upper_bound());
+  EXPECT_EQ(2, histogram.bucket(0).cumulative_count());
+  EXPECT_EQ(1000, histogram.bucket(1).upper_bound());
+  EXPECT_EQ(3, histogram.bucket(1).cumulative_count());
+  EXPECT_EQ(3, histogram.schema());
+  EXPECT_EQ(2, histogram.zero_count());
+  ASSERT_EQ(2, histogram.positive_span_size());
+  EXPECT_EQ(1, histogram.positive_span(0).offset());
+  EXPECT_EQ(1, histogram.positive_span(0).length());
+  EXPECT_EQ(11, histogram.positive_span(1).offset());
+  EXPECT_EQ(1, histogram.positive_span(1).length());
+  ASSERT_EQ(2, histogram.positive_delta_size());
+  EXPECT_EQ(4, histogram.positive_delta(0));
+  EXPECT_EQ(0, histogram.positive_delta(1));
+}
+
+TEST(PrometheusStatsFormatterAcceptTest, AcceptsProtobuf) {
+  // The Accept header sent by Prometheus when native histograms are enabled.
+  EXPECT_TRUE(PrometheusStatsFormatter::acceptsProtobuf(
+      "application/vnd.google.protobuf;proto=io.prometheus.client.MetricFamily;"
+      "encoding=delimited;q=0.7,text/plain;version=0.0.4;q=0.3,*/*;q=0.1"));
+  EXPECT_TRUE(PrometheusStatsFormatter::acceptsProtobuf(
+      "text/plain, application/vnd.google.protobuf; proto=io.prometheus.client.MetricFamily; "
+      "encoding=delimited"));
+  EXPECT_FALSE(PrometheusStatsFormatter::acceptsProtobuf(""));
+  EXPECT_FALSE(PrometheusStatsFormatter::acceptsProtobuf("text/plain;version=0.0.4;q=1,*/*;q=0.1"));
+  EXPECT_FALSE(PrometheusStatsFormatter::acceptsProtobuf(
+      "application/vnd.google.protobuf;proto=io.prometheus.client.MetricFamily;encoding=text"));
+  EXPECT_FALSE(PrometheusStatsFormatter::acceptsProtobuf(
+      "application/vnd.google.protobuf;proto=io.prometheus.client.MetricFamily;"
+      "encoding=delimited;q=0"));
+}
+
 } // namespace Server
 } // namespace Envoy
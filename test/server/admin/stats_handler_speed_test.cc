@@ -36,11 +36,10 @@ public:
    */
   uint64_t handlerStats(const StatsParams& params) {
     Buffer::OwnedImpl data;
-    if (params.format_ == Envoy::Server::StatsFormat::Prometheus) {
-      Envoy::Server::StatsHandler::prometheusRender(store_, custom_namespaces_, params, data);
-      return data.length();
-    }
-    Admin::RequestPtr request = StatsHandler::makeRequest(store_, params);
+    Admin::RequestPtr request =
+        params.format_ == Envoy::Server::StatsFormat::Prometheus
+            ? StatsHandler::makePrometheusRequest(store_, custom_namespaces_, params)
+            : StatsHandler::makeRequest(store_, params);
     auto response_headers = Http::ResponseHeaderMapImpl::create();
     request->start(*response_headers);
     uint64_t count = 0;
@@ -193,3 +192,18 @@ static void BM_FilteredCountersPrometheus(benchmark::State& state) {
   }
 }
 BENCHMARK(BM_FilteredCountersPrometheus)->Unit(benchmark::kMillisecond);
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_AllCountersPrometheusProtobuf(benchmark::State& state) {
+  Envoy::Server::StatsHandlerTest& test_context = testContext();
+  Envoy::Server::StatsParams params;
+  Envoy::Buffer::OwnedImpl response;
+  params.parse("?format=prometheus", response);
+  params.prometheus_protobuf_ = true;
+
+  for (auto _ : state) { // NOLINT
+    uint64_t count = test_context.handlerStats(params);
+    RELEASE_ASSERT(count > 100 * 1000 * 1000, "expected count > 100M");
+  }
+}
+BENCHMARK(BM_AllCountersPrometheusProtobuf)->Unit(benchmark::kMillisecond);
@@ -159,6 +159,33 @@ TEST_F(ConfigurationImplTest, StatsOnAdmin) {
   EXPECT_TRUE(config.statsConfig().flushOnAdmin());
 }
 
+TEST_F(ConfigurationImplTest, ChangedStatsFlush) {
+  {
+    envoy::config::bootstrap::v3::Bootstrap bootstrap;
+    MainImpl config;
+    config.initialize(bootstrap, server_, cluster_manager_factory_);
+    EXPECT_FALSE(config.statsConfig().fullFlushInterval().has_value());
+  }
+  {
+    envoy::config::bootstrap::v3::Bootstrap bootstrap;
+    TestUtility::loadFromYaml("changed_stats_flush: {}", bootstrap);
+    MainImpl config;
+    config.initialize(bootstrap, server_, cluster_manager_factory_);
+    EXPECT_EQ(std::chrono::milliseconds(60000), config.statsConfig().fullFlushInterval());
+  }
+  {
+    envoy::config::bootstrap::v3::Bootstrap bootstrap;
+    TestUtility::loadFromYaml(R"EOF(
+changed_stats_flush:
+  full_flush_interval: 30s
+)EOF",
+                              bootstrap);
+    MainImpl config;
+    config.initialize(bootstrap, server_, cluster_manager_factory_);
+    EXPECT_EQ(std::chrono::milliseconds(30000), config.statsConfig().fullFlushInterval());
+  }
+}
+
 TEST_F(ConfigurationImplTest, NegativeStatsOnAdmin) {
   std::string json = R"EOF(
   {
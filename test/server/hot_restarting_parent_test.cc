@@ -1,6 +1,7 @@
 #include <memory>
 
 #include "source/common/network/address_impl.h"
+#include "source/server/hot_restart_state.h"
 #include "source/server/hot_restarting_child.h"
 #include "source/server/hot_restarting_parent.h"
 
@@ -302,6 +303,43 @@ TEST_F(HotRestartingParentTest, DrainListeners) {
   hot_restarting_parent_.drainListeners();
 }
 
+TEST_F(HotRestartingParentTest, ExportStateToChild) {
+  ScopedInjectableLoader<HotRestartState> loader(std::make_unique<HotRestartState>());
+  Common::CallbackHandlePtr exporter =
+      loader.instance().addExporter([](HotRestart::State& state) {
+        state["dns_cache.foo"]["foo.com:80"] = "10.0.0.1:80|30|1";
+        state["dns_cache.foo"]["bar.com:443"] = "10.0.0.2:443|30|1";
+      });
+  Common::CallbackHandlePtr removed_exporter = loader.instance().addExporter(
+      [](HotRestart::State& state) { state["removed"]["key"] = "value"; });
+  removed_exporter.reset();
+
+  HotRestartMessage::Reply::State state;
+  hot_restarting_parent_.exportStateToChild(&state);
+  ASSERT_EQ(1, state.sections().size());
+  const auto& entries = state.sections().at("dns_cache.foo").entries();
+  EXPECT_EQ(2, entries.size());
+  EXPECT_EQ("10.0.0.1:80|30|1", entries.at("foo.com:80"));
+  EXPECT_EQ("10.0.0.2:443|30|1", entries.at("bar.com:443"));
+
+  // Each section of the parent's state is handed out to the child once.
+  HotRestart::State parent_state;
+  parent_state["dns_cache.foo"]["foo.com:80"] = "10.0.0.1:80|30|1";
+  loader.instance().setParentState(std::move(parent_state));
+  EXPECT_FALSE(loader.instance().takeParentSection("dns_cache.bar").has_value());
+  absl::optional<HotRestart::StateSection> section =
+      loader.instance().takeParentSection("dns_cache.foo");
+  ASSERT_TRUE(section.has_value());
+  EXPECT_EQ("10.0.0.1:80|30|1", section->at("foo.com:80"));
+  EXPECT_FALSE(loader.instance().takeParentSection("dns_cache.foo").has_value());
+}
+
+TEST_F(HotRestartingParentTest, ExportStateToChildWithoutState) {
+  HotRestartMessage::Reply::State state;
+  hot_restarting_parent_.exportStateToChild(&state);
+  EXPECT_TRUE(state.sections().empty());
+}
+
 } // namespace
 } // namespace Server
 } // namespace Envoy
@@ -103,6 +103,7 @@ TEST_F(OptionsImplTest, All) {
       "--reject-unknown-dynamic-fields --base-id 5 "
       "--use-dynamic-base-id --base-id-path /foo/baz "
       "--stats-tag foo:bar --stats-tag baz:bar "
+      "--stats-compact-storage --disable-stats-scope-tls-caches "
       "--socket-path /foo/envoy_domain_socket --socket-mode 644");
   EXPECT_EQ(Server::Mode::Validate, options->mode());
   EXPECT_EQ(2U, options->concurrency());
@@ -132,6 +133,8 @@ TEST_F(OptionsImplTest, All) {
   EXPECT_EQ("/foo/envoy_domain_socket", options->socketPath());
   EXPECT_EQ(0644, options->socketMode());
   EXPECT_EQ(2U, options->statsTags().size());
+  EXPECT_TRUE(options->statsCompactStorageEnabled());
+  EXPECT_TRUE(options->statsScopeTlsCachesDisabled());
 
   options = createOptionsImpl("envoy --mode init_only");
   EXPECT_EQ(Server::Mode::InitOnly, options->mode());
@@ -194,6 +197,8 @@ TEST_F(OptionsImplTest, SetAll) {
   options->setSocketPath("/foo/envoy_domain_socket");
   options->setSocketMode(0644);
   options->setStatsTags({{"foo", "bar"}});
+  options->setStatsCompactStorage(true);
+  options->setStatsScopeTlsCachesDisabled(true);
 
   EXPECT_EQ(109876, options->baseId());
   EXPECT_EQ(true, options->useDynamicBaseId());
@@ -226,6 +231,8 @@ TEST_F(OptionsImplTest, SetAll) {
   EXPECT_TRUE(options->rejectUnknownDynamicFields());
   EXPECT_EQ("/foo/envoy_domain_socket", options->socketPath());
   EXPECT_EQ(0644, options->socketMode());
+  EXPECT_TRUE(options->statsCompactStorageEnabled());
+  EXPECT_TRUE(options->statsScopeTlsCachesDisabled());
 
   // Validate that CommandLineOptions is constructed correctly.
   Server::CommandLineOptionsPtr command_line_options = options->toCommandLineOptions();
@@ -260,6 +267,9 @@ TEST_F(OptionsImplTest, SetAll) {
   EXPECT_EQ(options->socketMode(), command_line_options->socket_mode());
   EXPECT_EQ(1U, command_line_options->stats_tag().size());
   EXPECT_EQ("foo:bar", command_line_options->stats_tag(0));
+  EXPECT_EQ(options->statsCompactStorageEnabled(), command_line_options->stats_compact_storage());
+  EXPECT_EQ(options->statsScopeTlsCachesDisabled(),
+            command_line_options->disable_stats_scope_tls_caches());
 }
 
 TEST_F(OptionsImplTest, DefaultParams) {
@@ -276,6 +286,8 @@ TEST_F(OptionsImplTest, DefaultParams) {
   EXPECT_EQ(0U, options->statsTags().size());
   EXPECT_FALSE(options->hotRestartDisabled());
   EXPECT_FALSE(options->cpusetThreadsEnabled());
+  EXPECT_FALSE(options->statsCompactStorageEnabled());
+  EXPECT_FALSE(options->statsScopeTlsCachesDisabled());
 
   // Validate that CommandLineOptions is constructed correctly with default params.
   Server::CommandLineOptionsPtr command_line_options = options->toCommandLineOptions();
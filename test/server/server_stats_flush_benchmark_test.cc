@@ -80,6 +80,41 @@ public:
     }
   }
 
+  // Flushes only the metrics that changed to a sink that supports it, with 5% of the counters and
+  // gauges changing between flushes.
+  void testChangedOnly(::benchmark::State& state) {
+    std::vector<Stats::CounterSharedPtr> counters;
+    std::vector<Stats::GaugeSharedPtr> gauges;
+    stats_store_.forEachCounter(nullptr, [&counters](Stats::Counter& counter) {
+      counters.emplace_back(&counter);
+    });
+    stats_store_.forEachGauge(
+        nullptr, [&gauges](Stats::Gauge& gauge) { gauges.emplace_back(&gauge); });
+
+    std::list<Stats::SinkPtr> sinks;
+    auto* sink = new testing::NiceMock<Stats::MockSink>();
+    ON_CALL(*sink, supportsChangedMetricsOnly()).WillByDefault(testing::Return(true));
+    sinks.emplace_back(sink);
+    Server::InstanceUtil::flushMetricsToSinks(sinks, stats_store_, time_system_,
+                                              Server::StatsFlushMode::FullResync);
+
+    size_t offset = 0;
+    for (auto _ : state) {
+      UNREFERENCED_PARAMETER(_);
+      state.PauseTiming();
+      for (size_t idx = offset % 20; idx < counters.size(); idx += 20) {
+        counters[idx]->inc();
+      }
+      for (size_t idx = offset % 20; idx < gauges.size(); idx += 20) {
+        gauges[idx]->inc();
+      }
+      ++offset;
+      state.ResumeTiming();
+      Server::InstanceUtil::flushMetricsToSinks(sinks, stats_store_, time_system_,
+                                                Server::StatsFlushMode::ChangedOnly);
+    }
+  }
+
 private:
   Stats::SymbolTableImpl symbol_table_;
   Stats::StatNamePool pool_;
@@ -110,10 +145,25 @@ static void bmFlushToSinksWithPredicatesSet(::benchmark::State& state) {
   speed_test.test(state);
 }
 
+static void bmFlushChangedToSinks(::benchmark::State& state) {
+  // Skip expensive benchmarks for unit tests.
+  if (benchmark::skipExpensiveBenchmarks() && state.range(0) > 100) {
+    state.SkipWithError("Skipping expensive benchmark");
+    return;
+  }
+
+  StatsSinkFlushSpeedTest speed_test(state.range(0));
+  speed_test.testChangedOnly(state);
+}
+
 BENCHMARK(bmFlushToSinks)->Unit(::benchmark::kMillisecond)->RangeMultiplier(10)->Range(10, 1000000);
 BENCHMARK(bmFlushToSinksWithPredicatesSet)
     ->Unit(::benchmark::kMillisecond)
     ->RangeMultiplier(10)
     ->Range(10, 1000000);
+BENCHMARK(bmFlushChangedToSinks)
+    ->Unit(::benchmark::kMillisecond)
+    ->RangeMultiplier(10)
+    ->Range(10, 1000000);
 
 } // namespace Envoy
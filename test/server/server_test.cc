@@ -112,6 +112,71 @@ TEST(ServerInstanceUtil, flushHelper) {
   InstanceUtil::flushMetricsToSinks(sinks, mock_store, time_system);
 }
 
+TEST(ServerInstanceUtil, flushChangedMetricsOnly) {
+  Stats::TestUtil::TestStore store;
+  Event::SimulatedTimeSystem time_system;
+  Stats::Counter& c1 = store.counter("c1");
+  Stats::Counter& c2 = store.counter("c2");
+  Stats::Gauge& g1 = store.gauge("g1", Stats::Gauge::ImportMode::Accumulate);
+  Stats::Gauge& g2 = store.gauge("g2", Stats::Gauge::ImportMode::Accumulate);
+  Stats::TextReadout& t1 = store.textReadout("t1");
+  Stats::TextReadout& t2 = store.textReadout("t2");
+  c1.inc();
+  c2.inc();
+  g1.set(1);
+  g2.set(2);
+  t1.set("one");
+  t2.set("two");
+
+  std::list<Stats::SinkPtr> sinks;
+  auto* changed_sink = new NiceMock<Stats::MockSink>();
+  ON_CALL(*changed_sink, supportsChangedMetricsOnly()).WillByDefault(Return(true));
+  sinks.emplace_back(changed_sink);
+  auto* full_sink = new NiceMock<Stats::MockSink>();
+  sinks.emplace_back(full_sink);
+
+  // A full resync flushes all metrics to every sink, and clears the changed state.
+  EXPECT_CALL(*changed_sink, flush(_)).WillOnce(Invoke([](Stats::MetricSnapshot& snapshot) {
+    EXPECT_EQ(2, snapshot.counters().size());
+    EXPECT_EQ(2, snapshot.gauges().size());
+    EXPECT_EQ(2, snapshot.textReadouts().size());
+  }));
+  EXPECT_CALL(*full_sink, flush(_)).WillOnce(Invoke([](Stats::MetricSnapshot& snapshot) {
+    EXPECT_EQ(2, snapshot.counters().size());
+  }));
+  InstanceUtil::flushMetricsToSinks(sinks, store, time_system, StatsFlushMode::FullResync);
+
+  c2.add(3);
+  g1.set(1);
+  g2.set(5);
+  t1.set("uno");
+  t2.set("two");
+  EXPECT_CALL(*changed_sink, flush(_)).WillOnce(Invoke([](Stats::MetricSnapshot& snapshot) {
+    ASSERT_EQ(1, snapshot.counters().size());
+    EXPECT_EQ("c2", snapshot.counters()[0].counter_.get().name());
+    EXPECT_EQ(3, snapshot.counters()[0].delta_);
+    ASSERT_EQ(1, snapshot.gauges().size());
+    EXPECT_EQ("g2", snapshot.gauges()[0].get().name());
+    ASSERT_EQ(1, snapshot.textReadouts().size());
+    EXPECT_EQ("t1", snapshot.textReadouts()[0].get().name());
+  }));
+  EXPECT_CALL(*full_sink, flush(_)).WillOnce(Invoke([](Stats::MetricSnapshot& snapshot) {
+    EXPECT_EQ(2, snapshot.counters().size());
+    EXPECT_EQ(2, snapshot.gauges().size());
+    EXPECT_EQ(2, snapshot.textReadouts().size());
+  }));
+  InstanceUtil::flushMetricsToSinks(sinks, store, time_system, StatsFlushMode::ChangedOnly);
+
+  // Nothing changed since the previous flush.
+  sinks.pop_back();
+  EXPECT_CALL(*changed_sink, flush(_)).WillOnce(Invoke([](Stats::MetricSnapshot& snapshot) {
+    EXPECT_TRUE(snapshot.counters().empty());
+    EXPECT_TRUE(snapshot.gauges().empty());
+    EXPECT_TRUE(snapshot.textReadouts().empty());
+  }));
+  InstanceUtil::flushMetricsToSinks(sinks, store, time_system, StatsFlushMode::ChangedOnly);
+}
+
 class RunHelperTest : public testing::Test {
 public:
   RunHelperTest() {
@@ -0,0 +1,87 @@
+// Prints the records of a file written by the envoy.access_loggers.binary_file access logger as
+// tab separated values, with a header line naming the fields whenever they change.
+//
+// Usage: binary_access_log_dump <path>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "source/extensions/access_loggers/binary_file/binary_format.h"
+
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_join.h"
+
+namespace Envoy {
+namespace {
+
+using Extensions::AccessLoggers::BinaryFile::DecodedBatch;
+using Extensions::AccessLoggers::BinaryFile::DecodedColumn;
+using Extensions::AccessLoggers::BinaryFile::Field;
+using ProtoConfig = envoy::extensions::access_loggers::binary_file::v3::BinaryFileAccessLog;
+
+std::string formatValue(const DecodedColumn& column, uint64_t record) {
+  if (!column.strings_.empty()) {
+    const absl::optional<std::string>& value = column.strings_[record];
+    return value.has_value() ? absl::CEscape(value.value()) : "-";
+  }
+  return std::to_string(column.ints_[record]);
+}
+
+int run(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    std::cerr << "unable to open " << path << std::endl;
+    return 1;
+  }
+  std::stringstream contents;
+  contents << file.rdbuf();
+  const std::string buffer = contents.str();
+
+  absl::string_view data = buffer;
+  std::vector<Field> fields;
+  while (!data.empty()) {
+    const size_t offset = buffer.size() - data.size();
+    absl::StatusOr<DecodedBatch> batch =
+        Extensions::AccessLoggers::BinaryFile::decodeBatch(data);
+    if (!batch.ok()) {
+      std::cerr << "invalid batch at offset " << offset << ": " << batch.status() << std::endl;
+      return 1;
+    }
+
+    std::vector<Field> batch_fields;
+    for (const DecodedColumn& column : batch->columns_) {
+      batch_fields.push_back(column.field_);
+    }
+    if (batch_fields != fields) {
+      fields = std::move(batch_fields);
+      std::vector<std::string> names;
+      for (const Field field : fields) {
+        names.push_back(ProtoConfig::Field_Name(field));
+      }
+      std::cout << absl::StrJoin(names, "\t") << "\n";
+    }
+
+    for (uint64_t record = 0; record < batch->record_count_; ++record) {
+      std::vector<std::string> values;
+      for (const DecodedColumn& column : batch->columns_) {
+        values.push_back(formatValue(column, record));
+      }
+      std::cout << absl::StrJoin(values, "\t") << "\n";
+    }
+  }
+  return 0;
+}
+
+} // namespace
+} // namespace Envoy
+
+int main(int argc, char** argv) {
+  if (argc != 2) {
+    std::cerr << "Usage: " << argv[0] << " <path>" << std::endl;
+    return 1;
+  }
+  return Envoy::run(argv[1]);
+}